@@ -0,0 +1,614 @@
+/** \file qar_bench.c
+ *  \brief Frame-loop micro-benchmark for CPU render senders.
+ *
+ * Measures qar_render_sender_begin_frame -> qar_render_sender_frame_cpu ->
+ * qar_render_sender_show_frame for every frame layout, color format and
+ * per-view resolution, and reports latency percentiles, throughput and heap
+ * allocations per frame.
+ *
+ * The benchmark runs against any runtime library, like the examples:
+ * \code{.bash}
+ * qar_bench <path-to-qar-streaming-c-library> [--frames N] [--warmup N]
+ *           [--pairing-code CODE]
+ * \endcode
+ *
+ * Against the loopback runtime (qar-streaming-c-loopback) any pairing code
+ * is accepted and a render stream is requested immediately, so it runs on a
+ * headless machine. Allocations per frame are read from
+ * qar_loopback_get_allocation_stats when the library exports it and reported
+ * as "n/a" otherwise.
+ *
+ * qar_bench_static is the same benchmark built with QAR_STATIC_LINKING and
+ * linked against qar-streaming-c-loopback-static, so it takes no library
+ * path; compare the two to see what inlining across the API boundary buys.
+ */
+
+#include "common.h"
+
+#if !defined(QAR_ENABLE_DYNAMIC_LOADING) && !defined(QAR_STATIC_LINKING)
+#define QAR_ENABLE_DYNAMIC_LOADING
+#endif
+#include <math.h>
+#include <qar_loopback.h>
+#include <qar_streaming.h>
+
+#ifdef QAR_STATIC_LINKING
+#define BENCH_FIRST_OPTION 1
+#define BENCH_USAGE_LIBRARY ""
+#else
+#define BENCH_FIRST_OPTION 2
+#define BENCH_USAGE_LIBRARY " <path-to-qar-streaming-c-library>"
+QAR_IMPLEMENT_DYNAMIC_LOADING()
+#endif
+
+#define BENCH_DEFAULT_FRAMES 600
+#define BENCH_DEFAULT_WARMUP 60
+#define BENCH_REQUEST_TIMEOUT_MS 30000
+
+typedef struct BenchLayout
+{
+	QarFrameLayout layout;
+	const char* name;
+} BenchLayout;
+
+typedef struct BenchFormat
+{
+	QarPixelFormat format;
+	const char* name;
+} BenchFormat;
+
+static const BenchLayout k_bench_layouts[] = {
+	{ QAR_FRAME_LAYOUT_SIDE_BY_SIDE, "side_by_side" },
+	{ QAR_FRAME_LAYOUT_SEPARATED_TEXTURES, "separated" },
+	{ QAR_FRAME_LAYOUT_LAYERED, "layered" },
+};
+
+static const BenchFormat k_bench_formats[] = {
+	{ QAR_PIXEL_FORMAT_R8G8B8A8, "rgba8" },
+	{ QAR_PIXEL_FORMAT_B8G8R8A8, "bgra8" },
+	{ QAR_PIXEL_FORMAT_R16G16B16A16, "rgba16" },
+	{ QAR_PIXEL_FORMAT_R32_FLOAT, "r32f" },
+};
+
+/* Per-view resolutions, square. */
+static const uint32_t k_bench_resolutions[] = { 512, 1024, 2048 };
+
+#define BENCH_COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+typedef struct BenchOptions
+{
+	const char* library_path;
+	const char* pairing_code;
+	size_t frames;
+	size_t warmup;
+} BenchOptions;
+
+typedef struct BenchStats
+{
+	uint64_t begin_p50;
+	uint64_t begin_p99;
+	uint64_t show_p50;
+	uint64_t show_p99;
+	uint64_t total_p50;
+	uint64_t total_p99;
+	uint64_t total_p999;
+	double frames_per_second;
+	double allocations_per_frame; // negative when unavailable
+} BenchStats;
+
+typedef struct RenderRequestState
+{
+	volatile bool has_request;
+	QarPeerId target_peer_id;
+} RenderRequestState;
+
+static qar_loopback_get_allocation_stats_fn_t g_get_allocation_stats;
+
+static uint64_t
+bench_allocation_count(void)
+{
+	if(g_get_allocation_stats == NULL)
+	{
+		return 0;
+	}
+	QarLoopbackAllocationStats stats;
+	g_get_allocation_stats(&stats);
+	return stats.allocation_count;
+}
+
+static int
+compare_u64(const void* a, const void* b)
+{
+	uint64_t lhs = *(const uint64_t*)a;
+	uint64_t rhs = *(const uint64_t*)b;
+	return (lhs > rhs) - (lhs < rhs);
+}
+
+/** \brief Nearest-rank percentile of a sorted sample set. */
+static uint64_t
+percentile(const uint64_t* sorted, size_t count, double fraction)
+{
+	size_t rank = (size_t)ceil(fraction * (double)count);
+	if(rank == 0)
+	{
+		rank = 1;
+	}
+	return sorted[(rank > count ? count : rank) - 1];
+}
+
+static void
+print_usage(const char* program_name)
+{
+	const char* name = program_name ? program_name : "qar_bench";
+	printf(
+		"Usage: %s" BENCH_USAGE_LIBRARY " [--frames N] [--warmup N] "
+		"[--pairing-code CODE]\n",
+		name
+	);
+	printf(
+		"The pairing code is required on the first run only; later runs "
+		"rejoin with the persisted onboarding id.\n"
+	);
+}
+
+static bool
+parse_options(int argc, char** argv, BenchOptions* out_options)
+{
+	if(argc < BENCH_FIRST_OPTION)
+	{
+		return false;
+	}
+	out_options->library_path = BENCH_FIRST_OPTION > 1 ? argv[1] : NULL;
+	out_options->pairing_code = NULL;
+	out_options->frames = BENCH_DEFAULT_FRAMES;
+	out_options->warmup = BENCH_DEFAULT_WARMUP;
+	for(int index = BENCH_FIRST_OPTION; index < argc; ++index)
+	{
+		const char* option = argv[index];
+		if(index + 1 >= argc)
+		{
+			return false;
+		}
+		const char* value = argv[++index];
+		if(strcmp(option, "--frames") == 0)
+		{
+			out_options->frames = (size_t)strtoul(value, NULL, 10);
+		}
+		else if(strcmp(option, "--warmup") == 0)
+		{
+			out_options->warmup = (size_t)strtoul(value, NULL, 10);
+		}
+		else if(strcmp(option, "--pairing-code") == 0)
+		{
+			out_options->pairing_code = value;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return out_options->frames > 0;
+}
+
+static void
+on_render_request(QarRenderStreamRequest* request, void* user_state)
+{
+	RenderRequestState* state = (RenderRequestState*)user_state;
+	QarPeerId target_peer_id = qar_peer_id_default();
+	if(!state->has_request
+	   && qar_result_is_success(
+		   qar_render_request_get_target_peer_id(request, &target_peer_id)
+	   ))
+	{
+		state->target_peer_id = target_peer_id;
+		state->has_request = true;
+	}
+	qar_render_request_handle_destroy(request);
+}
+
+/** \brief `value * resolution / extent`, multiplied first in 64 bits so
+ * offsets that are not multiples of `extent` keep their position. */
+static uint32_t
+scale_coordinate(uint32_t value, uint32_t resolution, uint32_t extent)
+{
+	return (uint32_t)((uint64_t)value * resolution / extent);
+}
+
+/** \brief Rescale a layout so every view is `resolution` pixels square.
+ *
+ * View rectangles and texture extents are scaled by the ratio between the
+ * new resolution and the size of the first view, which keeps side-by-side,
+ * separated and layered arrangements intact. */
+static QarVideoFrameLayout
+scale_layout(const QarVideoFrameLayout* layout, uint32_t resolution)
+{
+	QarVideoFrameLayout scaled = *layout;
+	const QarVideoFrameView* first = &layout->views[0];
+	uint32_t view_width = first->end_x > first->start_x
+		? first->end_x - first->start_x
+		: first->start_x - first->end_x;
+	uint32_t view_height = first->end_y > first->start_y
+		? first->end_y - first->start_y
+		: first->start_y - first->end_y;
+	if(view_width == 0 || view_height == 0)
+	{
+		return scaled;
+	}
+	for(size_t index = 0; index < scaled.views_count; ++index)
+	{
+		QarVideoFrameView* view = &scaled.views[index];
+		view->start_x = scale_coordinate(view->start_x, resolution, view_width);
+		view->end_x = scale_coordinate(view->end_x, resolution, view_width);
+		view->start_y =
+			scale_coordinate(view->start_y, resolution, view_height);
+		view->end_y = scale_coordinate(view->end_y, resolution, view_height);
+	}
+	for(size_t index = 0; index < scaled.textures_count; ++index)
+	{
+		QarTextureSize* texture = &scaled.textures[index];
+		texture->width =
+			scale_coordinate(texture->width, resolution, view_width);
+		texture->height =
+			scale_coordinate(texture->height, resolution, view_height);
+	}
+	return scaled;
+}
+
+/** \brief Run `warmup + frames` iterations of the frame loop.
+ *
+ * Only the API calls are timed; the frame content is left untouched so the
+ * numbers isolate runtime overhead from application rendering cost. */
+static bool
+run_frames(
+	QarRenderSender* sender,
+	const BenchOptions* options,
+	uint64_t* samples,
+	BenchStats* out_stats
+)
+{
+	uint64_t* begin_ns = samples;
+	uint64_t* show_ns = samples + options->frames;
+	uint64_t* total_ns = samples + 2 * options->frames;
+	uint64_t allocations_before = 0;
+	uint64_t measure_start_ns = 0;
+
+	for(size_t iteration = 0; iteration < options->warmup + options->frames;
+		++iteration)
+	{
+		if(iteration == options->warmup)
+		{
+			allocations_before = bench_allocation_count();
+			measure_start_ns = example_now_ns();
+		}
+
+		uint64_t t0 = example_now_ns();
+		QarRenderFrameInfo* frame_info = NULL;
+		QarResult begin_result =
+			qar_render_sender_begin_frame(sender, NULL, &frame_info);
+		uint64_t t1 = example_now_ns();
+		if(qar_result_is_error(begin_result))
+		{
+			log_result("qar_render_sender_begin_frame", begin_result);
+			return false;
+		}
+
+		QarVideoFrameCpu frame = qar_video_frame_cpu_default();
+		QarResult frame_result = qar_render_sender_frame_cpu(sender, &frame);
+		uint64_t t2 = example_now_ns();
+
+		QarRenderFrameShow show = qar_render_frame_show_default();
+		QarResult show_result = qar_render_sender_show_frame(sender, &show);
+		uint64_t t3 = example_now_ns();
+		qar_render_frame_info_handle_destroy(frame_info);
+		if(qar_result_is_error(frame_result)
+		   || qar_result_is_error(show_result))
+		{
+			log_result("qar_render_sender_frame_cpu", frame_result);
+			log_result("qar_render_sender_show_frame", show_result);
+			return false;
+		}
+
+		if(iteration >= options->warmup)
+		{
+			size_t sample = iteration - options->warmup;
+			begin_ns[sample] = t1 - t0;
+			show_ns[sample] = t3 - t2;
+			total_ns[sample] = t3 - t0;
+		}
+	}
+
+	uint64_t elapsed_ns = example_now_ns() - measure_start_ns;
+	uint64_t allocations = bench_allocation_count() - allocations_before;
+
+	qsort(begin_ns, options->frames, sizeof(uint64_t), compare_u64);
+	qsort(show_ns, options->frames, sizeof(uint64_t), compare_u64);
+	qsort(total_ns, options->frames, sizeof(uint64_t), compare_u64);
+	out_stats->begin_p50 = percentile(begin_ns, options->frames, 0.50);
+	out_stats->begin_p99 = percentile(begin_ns, options->frames, 0.99);
+	out_stats->show_p50 = percentile(show_ns, options->frames, 0.50);
+	out_stats->show_p99 = percentile(show_ns, options->frames, 0.99);
+	out_stats->total_p50 = percentile(total_ns, options->frames, 0.50);
+	out_stats->total_p99 = percentile(total_ns, options->frames, 0.99);
+	out_stats->total_p999 = percentile(total_ns, options->frames, 0.999);
+	out_stats->frames_per_second = elapsed_ns > 0
+		? (double)options->frames * 1e9 / (double)elapsed_ns
+		: 0.0;
+	out_stats->allocations_per_frame = g_get_allocation_stats != NULL
+		? (double)allocations / (double)options->frames
+		: -1.0;
+	return true;
+}
+
+static void
+print_header(void)
+{
+	printf(
+		"%-13s %-7s %-10s %9s %9s %9s %9s %9s %9s %9s %10s %12s\n",
+		"layout",
+		"format",
+		"view",
+		"begin_p50",
+		"begin_p99",
+		"show_p50",
+		"show_p99",
+		"p50",
+		"p99",
+		"p99.9",
+		"fps",
+		"allocs/frame"
+	);
+}
+
+static void
+print_row(
+	const BenchLayout* layout,
+	const BenchFormat* format,
+	uint32_t resolution,
+	const BenchStats* stats
+)
+{
+	char view[32];
+	char allocations[32];
+	snprintf(view, sizeof(view), "%ux%u", resolution, resolution);
+	if(stats->allocations_per_frame < 0.0)
+	{
+		snprintf(allocations, sizeof(allocations), "n/a");
+	}
+	else
+	{
+		snprintf(
+			allocations,
+			sizeof(allocations),
+			"%.3f",
+			stats->allocations_per_frame
+		);
+	}
+	// Latencies in microseconds.
+	printf(
+		"%-13s %-7s %-10s %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %10.1f "
+		"%12s\n",
+		layout->name,
+		format->name,
+		view,
+		(double)stats->begin_p50 / 1000.0,
+		(double)stats->begin_p99 / 1000.0,
+		(double)stats->show_p50 / 1000.0,
+		(double)stats->show_p99 / 1000.0,
+		(double)stats->total_p50 / 1000.0,
+		(double)stats->total_p99 / 1000.0,
+		(double)stats->total_p999 / 1000.0,
+		stats->frames_per_second,
+		allocations
+	);
+	fflush(stdout);
+}
+
+/** \brief Benchmark one layout and color format at every resolution. */
+static bool
+run_case(
+	QarSession* session,
+	const QarPeerId* target_peer_id,
+	const BenchLayout* layout,
+	const BenchFormat* format,
+	const BenchOptions* options,
+	uint64_t* samples
+)
+{
+	QarRenderSenderInit sender_init = qar_render_sender_init_default();
+	sender_init.graphics_api = QAR_GRAPHICS_API_CPU;
+	sender_init.peer_id = *target_peer_id;
+	sender_init.texture_layout = layout->layout;
+	sender_init.color_format = format->format;
+	sender_init.frame_views[0].data_type = QAR_VIDEO_FRAME_VIEW_TYPE_COLOR;
+	sender_init.frame_views[0].eye = QAR_VIDEO_FRAME_VIEW_EYE_LEFT;
+	sender_init.frame_views[0].texture_index = 0;
+	sender_init.frame_views[1].data_type = QAR_VIDEO_FRAME_VIEW_TYPE_COLOR;
+	sender_init.frame_views[1].eye = QAR_VIDEO_FRAME_VIEW_EYE_RIGHT;
+	sender_init.frame_views[1].texture_index = 0;
+	sender_init.frame_views_count = 2;
+
+	QarRenderSender* sender = NULL;
+	QarResult create_result =
+		qar_render_sender_create(session, &sender_init, NULL, &sender);
+	if(qar_result_is_error(create_result) || sender == NULL)
+	{
+		printf("%-13s %-7s ", layout->name, format->name);
+		log_result("qar_render_sender_create", create_result);
+		return qar_result_has_code(
+			create_result, QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+		);
+	}
+
+	QarVideoFrameLayout base_layout = qar_video_frame_layout_default();
+	bool ok = qar_result_is_success(
+		qar_render_sender_layout(sender, &base_layout)
+	);
+	for(size_t index = 0; ok && index < BENCH_COUNT(k_bench_resolutions);
+		++index)
+	{
+		uint32_t resolution = k_bench_resolutions[index];
+		QarVideoFrameLayout scaled = scale_layout(&base_layout, resolution);
+		QarResult change_result =
+			qar_render_sender_change_layout(sender, &scaled, NULL);
+		if(qar_result_is_error(change_result))
+		{
+			log_result("qar_render_sender_change_layout", change_result);
+			continue;
+		}
+		BenchStats stats;
+		ok = run_frames(sender, options, samples, &stats);
+		if(ok)
+		{
+			print_row(layout, format, resolution, &stats);
+		}
+	}
+	qar_render_stream_handle_destroy(sender);
+	return ok;
+}
+
+static bool
+bench_load_library(const BenchOptions* options)
+{
+#ifdef QAR_STATIC_LINKING
+	(void)options;
+	g_get_allocation_stats = qar_loopback_get_allocation_stats;
+#else
+	if(!qar_library_load(options->library_path))
+	{
+		fprintf(
+			stderr,
+			"Failed to load '%s'. Ensure the path is correct.\n",
+			options->library_path
+		);
+		return false;
+	}
+	g_get_allocation_stats =
+		(qar_loopback_get_allocation_stats_fn_t)qar_load_symbol(
+			g_qar_dynamic_library_handle, "qar_loopback_get_allocation_stats"
+		);
+#endif
+	return true;
+}
+
+static void
+bench_unload_library(void)
+{
+#ifndef QAR_STATIC_LINKING
+	qar_library_unload();
+#endif
+}
+
+int
+main(int argc, char** argv)
+{
+	BenchOptions options;
+	if(!parse_options(argc, argv, &options))
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if(!bench_load_library(&options))
+	{
+		return 2;
+	}
+
+	QarLibraryInit library_init = qar_library_init_default();
+	QarResult library_result = qar_library_init(&library_init);
+	if(qar_result_is_error(library_result))
+	{
+		log_result("qar_library_init", library_result);
+		bench_unload_library();
+		return 3;
+	}
+
+	QarRuntimeInit runtime_init = qar_runtime_init_default();
+	QarRuntime* runtime = NULL;
+	QarResult runtime_result = qar_runtime_create(&runtime_init, &runtime);
+	if(qar_result_is_error(runtime_result) || runtime == NULL)
+	{
+		log_result("qar_runtime_create", runtime_result);
+		qar_library_destroy();
+		bench_unload_library();
+		return 4;
+	}
+
+	QarOnboardingId onboarding_id = qar_onboarding_id_default();
+	QarSession* session = NULL;
+	if(example_obtain_session(
+		   runtime,
+		   options.pairing_code,
+		   "qar_bench.onboarding-id.txt",
+		   "qar_bench",
+		   &onboarding_id,
+		   &session
+	   ) != 0
+	   || session == NULL)
+	{
+		qar_runtime_destroy(runtime);
+		qar_library_destroy();
+		bench_unload_library();
+		return 5;
+	}
+
+	RenderRequestState request_state = { false, qar_peer_id_default() };
+	log_result(
+		"qar_render_sender_subscribe_requests",
+		qar_render_sender_subscribe_requests(
+			session, on_render_request, &request_state, NULL
+		)
+	);
+	printf("Waiting for a peer to request a render stream ...\n");
+	for(uint32_t waited_ms = 0;
+		!request_state.has_request && waited_ms < BENCH_REQUEST_TIMEOUT_MS;
+		waited_ms += 10)
+	{
+		example_sleep_ms(10);
+	}
+
+	int exit_code = 0;
+	uint64_t* samples = calloc(3 * options.frames, sizeof(uint64_t));
+	if(!request_state.has_request || samples == NULL)
+	{
+		printf("No render stream request received.\n");
+		exit_code = 6;
+	}
+	else
+	{
+		printf(
+			"%zu frames per case after %zu warm-up frames; latencies in "
+			"microseconds.\n",
+			options.frames,
+			options.warmup
+		);
+		print_header();
+		for(size_t layout = 0;
+			exit_code == 0 && layout < BENCH_COUNT(k_bench_layouts);
+			++layout)
+		{
+			for(size_t format = 0;
+				exit_code == 0 && format < BENCH_COUNT(k_bench_formats);
+				++format)
+			{
+				if(!run_case(
+					   session,
+					   &request_state.target_peer_id,
+					   &k_bench_layouts[layout],
+					   &k_bench_formats[format],
+					   &options,
+					   samples
+				   ))
+				{
+					exit_code = 7;
+				}
+			}
+		}
+	}
+	free(samples);
+
+	qar_session_handle_destroy(session);
+	qar_runtime_destroy(runtime);
+	qar_library_destroy();
+	bench_unload_library();
+	return exit_code;
+}
@@ -217,7 +217,6 @@ main(int argc, char** argv)
 	}
 	//! [app_create]
 
-	log_result("qar_session_leave", qar_session_leave(session));
 	qar_session_handle_destroy(session);
 	qar_runtime_destroy(runtime);
 	QarResult destroy_result = qar_library_destroy();
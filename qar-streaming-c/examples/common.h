@@ -1,4 +1,9 @@
 #pragma once
+/* clock_gettime() and nanosleep() are POSIX, not C11: request them before
+ * the first system header, so include common.h first. */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
 #include "qar_streaming.h"
 #include <inttypes.h>
 #include <stdbool.h>
@@ -6,8 +11,55 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/** \brief Monotonic clock in nanoseconds, for frame pacing and timing. */
+static inline uint64_t
+example_now_ns(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	if(frequency.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ull
+		+ (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ull
+		/ (uint64_t)frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/** \brief Sleep the calling thread for at least \p milliseconds. */
+static inline void
+example_sleep_ms(uint32_t milliseconds)
+{
+#ifdef _WIN32
+	Sleep(milliseconds);
+#else
+	struct timespec duration = { (time_t)(milliseconds / 1000),
+								 (long)(milliseconds % 1000) * 1000000L };
+	while(nanosleep(&duration, &duration) != 0)
+	{
+		// Interrupted by a signal: sleep for the remaining time.
+	}
+#endif
+}
+
 /** \brief Print a fixed-size identifier as hex bytes separated by colons. */
-static void
+static inline void
 print_hex_id(const uint8_t* data, size_t len)
 {
 	for(size_t i = 0; i < len; ++i)
@@ -21,7 +73,7 @@ print_hex_id(const uint8_t* data, size_t len)
 }
 
 /** \brief Log a \ref QarResult with a label to stdout. */
-static void
+static inline void
 log_result(const char* label, QarResult r)
 {
 	if(qar_result_is_success(r))
@@ -39,7 +91,7 @@ log_result(const char* label, QarResult r)
 //! [example_onboarding_persistence]
 /** \brief Load a persisted onboarding id (UUID text) from a small state file.
  *  Returns false when the file does not exist yet (first run). */
-static bool
+static inline bool
 load_onboarding_id(const char* path, QarOnboardingId* out_id)
 {
 	FILE* file = fopen(path, "r");
@@ -60,7 +112,7 @@ load_onboarding_id(const char* path, QarOnboardingId* out_id)
 }
 
 /** \brief Persist an onboarding id (UUID text) so the next run can rejoin. */
-static void
+static inline void
 save_onboarding_id(const char* path, const QarOnboardingId* id)
 {
 	char text[64] = { 0 };
@@ -87,7 +139,7 @@ save_onboarding_id(const char* path, const QarOnboardingId* id)
  *
  *  Returns 0 on success; on success *out_session and *out_onboarding_id are
  *  set and the id has been persisted to id_file_path for the next run. */
-static int
+static inline int
 example_obtain_session(
 	QarRuntime* runtime,
 	const char* pairing_code, /* may be NULL when a persisted id exists */
@@ -169,7 +221,7 @@ example_obtain_session(
 
 /** \brief Extract directory portion from a path (both '/' and '\\' on Windows).
  */
-static const char*
+static inline const char*
 get_dir_from_path(const char* path, char* out_dir, size_t out_sz)
 {
 	if(!path || !out_dir || out_sz == 0)
@@ -43,8 +43,6 @@
 
 #include "common.h"
 
-#include <windows.h>
-
 #ifndef QAR_ENABLE_DYNAMIC_LOADING
 #define QAR_ENABLE_DYNAMIC_LOADING
 #endif
@@ -226,7 +224,7 @@ main(int argc, char** argv)
 	);
 	while(!request_state.has_request)
 	{
-		Sleep(50);
+		example_sleep_ms(50);
 	}
 	//! [cpu_request]
 
@@ -241,7 +239,6 @@ main(int argc, char** argv)
 	if(qar_result_is_error(sender_result) || sender == NULL)
 	{
 		log_result("qar_render_sender_create", sender_result);
-		log_result("qar_session_leave", qar_session_leave(session));
 		qar_session_handle_destroy(session);
 		qar_runtime_destroy(runtime);
 		qar_library_destroy();
@@ -288,7 +285,6 @@ main(int argc, char** argv)
 	qar_render_stream_handle_destroy(sender);
 	//! [cpu_frames]
 
-	log_result("qar_session_leave", qar_session_leave(session));
 	qar_session_handle_destroy(session);
 	qar_runtime_destroy(runtime);
 	QarResult destroy_result = qar_library_destroy();
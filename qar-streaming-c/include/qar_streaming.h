@@ -35,16 +35,30 @@
 #define QAR_STREAMING_EXTERN_C // Not needed in C
 #endif
 
+#if defined(QAR_STATIC_LINKING) // Building or linking the static archive
+#ifdef QAR_ENABLE_DYNAMIC_LOADING
+#error "QAR_STATIC_LINKING and QAR_ENABLE_DYNAMIC_LOADING are exclusive"
+#endif
+// Plain declarations: no import thunk, so LTO can inline across the API.
+#define QAR_C_API QAR_STREAMING_EXTERN_C
+#elif defined(_WIN32)
 #ifdef QAR_STREAMING_EXPORTS // Defined when building the qar-streaming-c DLL
 #define QAR_C_API QAR_STREAMING_EXTERN_C __declspec(dllexport)
-#else // Defined when using the qar-streaming-c DLL OR static lib
-// If primarily used via DLL, dllimport is okay.
-// If static linking is a common use case, __declspec(dllimport) is problematic.
-// Consider separating macros for static linking vs DLL usage,
-// or just remove __declspec(dllimport) if static linking is preferred.
-// For now, keep original logic but with corrected EXTERN_C:
+#else // Defined when using the qar-streaming-c DLL through its import library
 #define QAR_C_API QAR_STREAMING_EXTERN_C __declspec(dllimport)
 #endif
+#else // ELF/Mach-O: shared libraries are built with hidden visibility
+#define QAR_C_API QAR_STREAMING_EXTERN_C __attribute__((visibility("default")))
+#endif
+
+// Header-inline value operations are constant expressions in C++14 and later.
+#if defined(__cplusplus)                                                       \
+	&& (__cplusplus >= 201402L                                                 \
+		|| (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L))
+#define QAR_CONSTEXPR constexpr
+#else
+#define QAR_CONSTEXPR
+#endif
 
 #if defined(_WIN32) || defined(_WIN64)
 #ifndef QAR_ENABLE_D3D11
@@ -116,6 +130,13 @@ extern "C"
 #define QAR_UUID_TEXT_BUFFER_SIZE 37
 #define QAR_MAX_FRAME_VIEWS 8
 #define QAR_MAX_FRAME_TEXTURES 4
+#define QAR_MAX_CPU_BUFFER_RING_SIZE 8
+#define QAR_CPU_BUFFER_ALIGNMENT 4096
+#define QAR_MAX_DIRTY_RECTS 64
+#define QAR_OCCUPANCY_TILE_SIZE 32
+#define QAR_MAX_FRAMES_IN_FLIGHT 4
+#define QAR_MAX_EVENT_NAME_LENGTH 64
+#define QAR_DEFAULT_EVENT_QUEUE_CAPACITY 256
 
 // ============================================================================
 // Identifiers
@@ -207,6 +228,10 @@ typedef enum QarStatusCode
 	QAR_STATUS_ARGUMENT_NOT_SUPPORTED = 5,
 	QAR_STATUS_TIMEOUT = 6,
 	QAR_STATUS_LOGIC_ERROR = 7,
+	/// A polled event queue was full and dropped events since the last poll.
+	/// The events that were kept are still returned; resynchronize state with
+	/// the qar_query_* calls.
+	QAR_STATUS_EVENT_QUEUE_OVERFLOW = 8,
 	QAR_STATUS_GUI_PANEL_INVALID_ID = 305,
 	QAR_STATUS_APP_VOLUME_INVALID_ID = 325,
 	QAR_STATUS_RENDERING_PRODUCER_UNABLE_TO_DO_BEGIN_FRAME = 803,
@@ -312,6 +337,8 @@ typedef struct QarNearFar
 #define QAR_POSITION_VALID_BIT 0x00000002ULL
 #define QAR_ORIENTATION_TRACKED_BIT 0x00000004ULL
 #define QAR_POSITION_TRACKED_BIT 0x00000008ULL
+#define QAR_LINEAR_VELOCITY_VALID_BIT 0x00000001ULL
+#define QAR_ANGULAR_VELOCITY_VALID_BIT 0x00000002ULL
 
 typedef enum QarHandJoint
 {
@@ -380,6 +407,13 @@ typedef struct QarDeviceHandsWithJoints
 	QarHandJoints right_hand;
 } QarDeviceHandsWithJoints;
 
+/// Hand tracking samples a render sender keeps for
+/// qar_render_sender_hands_since; about 0.7 s of a 90 Hz tracker.
+#define QAR_HAND_HISTORY_CAPACITY 64
+/// qar_render_sender_sample_hands_at predicts at most this far past the
+/// newest tracker sample.
+#define QAR_HAND_MAX_EXTRAPOLATION_MS 100
+
 // ============================================================================
 // GRAPHICS TYPES
 // ============================================================================
@@ -400,6 +434,33 @@ typedef enum QarPixelFormat
 	QAR_PIXEL_FORMAT_D32_FLOAT = 101
 } QarPixelFormat;
 
+/**
+ * @brief How depth views are quantized before they are sent.
+ *
+ * Depth views are always rendered as D32_FLOAT (hardware depth of a
+ * conventional projection) or R32_FLOAT (linear view depth); the runtime
+ * linearizes and encodes them while it reads the frame. Reconstruction uses
+ * QarRenderFrameShow::rendered_near_far and scales the result by
+ * QarRenderFrameShow::depth_scale as before. Error bounds below are for a
+ * linear depth `z` and the frame's near plane `n` and far plane `f`.
+ */
+typedef enum QarDepthEncoding
+{
+	/// 32-bit float depth as rendered (4 bytes per pixel).
+	QAR_DEPTH_ENCODING_FLOAT32 = 0,
+	/// 16-bit reversed-Z `round(65535 * n / z)`, 0 meaning infinitely far
+	/// (2 bytes per pixel). Absolute error at most `z * z / (130000 * n)`:
+	/// 0.08 mm at 1 m and 7.7 mm at 10 m with n = 0.1 m. Needs n > 0; the
+	/// far plane is not used.
+	QAR_DEPTH_ENCODING_REVERSED_Z16 = 1,
+	/// 12-bit logarithmic `round(4095 * ln(z / n) / ln(f / n))`, clamped to
+	/// [n, f] and stored in the upper 12 bits of a 16-bit sample so it fits
+	/// a 12-bit video plane (2 bytes per pixel). Relative error at most
+	/// `ln(f / n) / 8180`: 0.085 % (8.5 mm at 10 m) with n = 0.1 m and
+	/// f = 100 m. Needs 0 < n < f.
+	QAR_DEPTH_ENCODING_LOG12 = 2
+} QarDepthEncoding;
+
 // ============================================================================
 // VIDEO STREAM LAYOUT TYPES
 // ============================================================================
@@ -424,6 +485,19 @@ typedef enum QarVideoFrameViewEye
 	QAR_VIDEO_FRAME_VIEW_EYE_RIGHT = 20
 } QarVideoFrameViewEye;
 
+/** @brief Part of the eye's field of view a frame view covers. */
+typedef enum QarVideoFrameViewRegion
+{
+	/// The whole FOV at uniform resolution.
+	QAR_VIDEO_FRAME_VIEW_REGION_FULL = 0,
+	/// Foveated layout: the inner part of the FOV at full pixel density.
+	QAR_VIDEO_FRAME_VIEW_REGION_FOVEA = 1,
+	/// Foveated layout: the whole FOV at reduced pixel density. The mixer
+	/// uses it wherever the fovea view of the same eye and type has no
+	/// pixels.
+	QAR_VIDEO_FRAME_VIEW_REGION_PERIPHERY = 2
+} QarVideoFrameViewRegion;
+
 typedef struct QarRenderFrameView
 {
 	QarVideoFrameViewType data_type;
@@ -464,6 +538,9 @@ typedef struct QarVideoFrameView
 	QarPixelFormat texture_format;
 	QarVideoFrameViewType data_type;
 	QarVideoFrameViewEye eye;
+	/// Which part of the eye's FOV the view covers; the per-view FOV from
+	/// the frame info always matches it.
+	QarVideoFrameViewRegion region;
 } QarVideoFrameView;
 
 /** @brief Video frame layout with views and backing textures. */
@@ -612,6 +689,21 @@ typedef struct QarAppVolumeEditingStatus
 	QarPeerId editor_peer;
 } QarAppVolumeEditingStatus;
 
+/**
+ * @brief Latest locally known fast-path state of one app volume, read from a
+ * single consistent snapshot.
+ */
+typedef struct QarAppVolumeLatestState
+{
+	/// False when the id is unknown or the volume closed; other fields are
+	/// then left at their defaults.
+	bool is_valid;
+	QarPose pose;
+	QarAppVolumeSize size;
+	QarPose app_pose;
+	float app_scale;
+} QarAppVolumeLatestState;
+
 typedef enum QarGestureKind
 {
 	/* Short tap/click gesture emitted as an instant event. */
@@ -731,6 +823,53 @@ typedef struct QarAppVolumeGestureEvent
 	bool was_mapped_to_app_transform;
 } QarAppVolumeGestureEvent;
 
+// ============================================================================
+// POLLED EVENTS
+// ============================================================================
+
+/** @brief Event sources that can be switched to polled queues. */
+typedef enum QarEventQueueSource
+{
+	QAR_EVENT_QUEUE_SOURCE_PEERS = 1 << 0,
+	QAR_EVENT_QUEUE_SOURCE_GUI_PANELS = 1 << 1,
+	QAR_EVENT_QUEUE_SOURCE_APP_VOLUMES = 1 << 2,
+	QAR_EVENT_QUEUE_SOURCE_APP_VOLUME_GESTURES = 1 << 3
+} QarEventQueueSource;
+
+/** @brief Snapshot of a peer spec after it changed. */
+typedef struct QarPeerEvent
+{
+	QarPeerId peer_id;
+	QarAppState app_state;
+	/// Truncated to QAR_MAX_EVENT_NAME_LENGTH - 1 bytes; query the peer spec
+	/// for the full name.
+	char display_name[QAR_MAX_EVENT_NAME_LENGTH];
+	QarTimePoint timestamp;
+} QarPeerEvent;
+
+/** @brief Snapshot of a GUI panel after it changed. */
+typedef struct QarGuiPanelEvent
+{
+	QarGuiPanelId panel_id;
+	QarPose pose;
+	QarGuiPanelSize size;
+	QarGuiPanelState state;
+	QarTimePoint timestamp;
+} QarGuiPanelEvent;
+
+/** @brief Snapshot of an app volume after it changed. */
+typedef struct QarAppVolumeEvent
+{
+	QarAppVolumeId volume_id;
+	QarPose pose;
+	QarAppVolumeSize size;
+	QarPose app_pose;
+	float app_scale;
+	QarAppVolumeLifetimeStatus lifetime_status;
+	QarAppVolumeEditingStatus editing_status;
+	QarTimePoint timestamp;
+} QarAppVolumeEvent;
+
 // ============================================================================
 // INIT STRUCTURES
 // ============================================================================
@@ -755,10 +894,21 @@ typedef enum QarStructureType
 	QAR_STRUCTURE_TYPE_SESSION_GRAPHICS_DEVICE_ID = 0x2004,
 	QAR_STRUCTURE_TYPE_SESSION_REQUEST_INVITE_INIT = 0x2005,
 	QAR_STRUCTURE_TYPE_PEER_PRESENTATION = 0x2006,
+	QAR_STRUCTURE_TYPE_SESSION_EVENT_QUEUE_INIT = 0x2007,
 	QAR_STRUCTURE_TYPE_RENDERING_STREAM_SENDER_INIT = 0x3000,
 	QAR_STRUCTURE_TYPE_RENDERING_BEGIN_FRAME = 0x3001,
 	QAR_STRUCTURE_TYPE_RENDERING_END_FRAME = 0x3002,
 	QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_VIEW_OVERRIDES_EXT = 0x3004,
+	QAR_STRUCTURE_TYPE_RENDERING_CPU_BUFFER_RING = 0x3005,
+	QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_CPU_BUFFER_EXT = 0x3006,
+	QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_DIRTY_RECTS_EXT = 0x3007,
+	QAR_STRUCTURE_TYPE_RENDERING_SENDER_STATS = 0x3008,
+	QAR_STRUCTURE_TYPE_RENDERING_STREAM_SENDER_FOVEATION_EXT = 0x3009,
+	QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_OCCUPANCY_EXT = 0x300A,
+	QAR_STRUCTURE_TYPE_RENDERING_SENDER_FRAMES_IN_FLIGHT_EXT = 0x300B,
+	QAR_STRUCTURE_TYPE_RENDERING_SENDER_DYNAMIC_RESOLUTION_EXT = 0x300C,
+	QAR_STRUCTURE_TYPE_RENDERING_SENDER_DEPTH_ENCODING_EXT = 0x300D,
+	QAR_STRUCTURE_TYPE_RENDERING_SENDER_TRANSPARENT_TILES_EXT = 0x300E,
 	QAR_STRUCTURE_TYPE_STREAM_D3D11_PARAMS_EXT = 0x4000,
 	QAR_STRUCTURE_TYPE_GUI_PANEL_INIT = 0x5001,
 	QAR_STRUCTURE_TYPE_APP_VOLUME_INIT = 0x5501,
@@ -1013,6 +1163,27 @@ typedef struct QarRequestInviteInit
 		header; /**< QAR_STRUCTURE_TYPE_SESSION_REQUEST_INVITE_INIT */
 } QarRequestInviteInit;
 
+/**
+ * @brief Switch session event sources from callbacks to polled queues.
+ *
+ * Each enabled source gets its own single-producer/single-consumer ring of
+ * `capacity` events. The runtime thread enqueues immutable event snapshots
+ * and the application drains them with the matching `*_poll_events` call,
+ * without locks or context switches; overflow is reported through the poll
+ * status, not a stored error message. Subscriptions keep working for sources
+ * that are not enabled here.
+ */
+typedef struct QarEventQueueInit
+{
+	QarStructureHeader
+		header; /**< QAR_STRUCTURE_TYPE_SESSION_EVENT_QUEUE_INIT */
+	/// Bitwise OR of QarEventQueueSource values. 0 disables all queues.
+	uint32_t sources;
+	/// Events per queue. Rounded up to a power of two; 0 selects
+	/// QAR_DEFAULT_EVENT_QUEUE_CAPACITY.
+	size_t capacity;
+} QarEventQueueInit;
+
 /** @brief Teardown — erase a persisted identity slot. */
 typedef struct QarForgetInit
 {
@@ -1147,6 +1318,92 @@ typedef struct QarRenderSenderInit
 	QarGraphicsAPI graphics_api;
 } QarRenderSenderInit;
 
+/**
+ * @brief Extension of QarRenderSenderInit: foveated (multi-resolution)
+ * views.
+ *
+ * Every requested frame view is split into two views packed into the same
+ * texture: a QAR_VIDEO_FRAME_VIEW_REGION_FOVEA view covering the central
+ * `fovea_fraction` of the image plane at full pixel density, and a
+ * QAR_VIDEO_FRAME_VIEW_REGION_PERIPHERY view covering the whole FOV at
+ * 1/`periphery_downscale` density per axis. The frame info reports the
+ * narrower FOV of each fovea view, so both are rendered like ordinary views.
+ * The mixer reconstructs the full view before warping.
+ *
+ * The defaults (half the image plane, half density outside) halve the pixels
+ * per eye. Foveation is fixed at the view center. Requires at most
+ * QAR_MAX_FRAME_VIEWS / 2 requested views.
+ */
+typedef struct QarRenderSenderFoveationExt
+{
+	QarStructureHeader
+		header; /**< QAR_STRUCTURE_TYPE_RENDERING_STREAM_SENDER_FOVEATION_EXT */
+	/// Share of the view's image plane (tangent space, per axis) covered by
+	/// the fovea, in (0, 1).
+	float fovea_fraction;
+	/// Per-axis downscale factor of the periphery, at least 2.
+	uint32_t periphery_downscale;
+} QarRenderSenderFoveationExt;
+
+/**
+ * @brief Extension of QarRenderSenderInit: render ahead of the encoder.
+ *
+ * Without it one frame is in flight: begin_frame waits until the previous
+ * frame was shown and consumed. Larger values let the caller render ahead
+ * while earlier frames are still being encoded; every in-flight frame gets
+ * its own textures and poses predicted for its own display time.
+ */
+typedef struct QarRenderSenderFramesInFlightExt
+{
+	QarStructureHeader
+		header; /**< QAR_STRUCTURE_TYPE_RENDERING_SENDER_FRAMES_IN_FLIGHT_EXT */
+	/// How many frames may be begun before the oldest one is shown
+	/// (1..QAR_MAX_FRAMES_IN_FLIGHT).
+	uint32_t max_frames_in_flight;
+} QarRenderSenderFramesInFlightExt;
+
+/**
+ * @brief Extension of QarRenderSenderInit: dynamic resolution.
+ *
+ * The textures keep their size, and the runtime chooses per frame how much
+ * of every view is rendered, based on encode time and network backpressure.
+ * Each frame reports its area through
+ * qar_render_frame_info_get_view_active_rect. This holds the frame rate
+ * under load without the stall of a layout change.
+ */
+typedef struct QarRenderSenderDynamicResolutionExt
+{
+	QarStructureHeader header; /**<
+		QAR_STRUCTURE_TYPE_RENDERING_SENDER_DYNAMIC_RESOLUTION_EXT */
+	/// Smallest per-axis scale of the active area, in (0, 1].
+	float min_resolution_scale;
+} QarRenderSenderDynamicResolutionExt;
+
+/** @brief Extension of QarRenderSenderInit: depth quantization. */
+typedef struct QarRenderSenderDepthEncodingExt
+{
+	QarStructureHeader
+		header; /**< QAR_STRUCTURE_TYPE_RENDERING_SENDER_DEPTH_ENCODING_EXT */
+	/// Quantization of depth views on the wire. Anything but
+	/// QAR_DEPTH_ENCODING_FLOAT32 halves the depth bytes per frame and
+	/// requires valid QarRenderFrameShow::rendered_near_far on every frame.
+	QarDepthEncoding depth_encoding;
+} QarRenderSenderDepthEncodingExt;
+
+/** @brief Extension of QarRenderSenderInit: transparent tile skipping. */
+typedef struct QarRenderSenderTransparentTilesExt
+{
+	QarStructureHeader header; /**<
+		QAR_STRUCTURE_TYPE_RENDERING_SENDER_TRANSPARENT_TILES_EXT */
+	/// Skip QAR_OCCUPANCY_TILE_SIZE square tiles of color views whose alpha
+	/// is zero everywhere; the receiver shows them as fully transparent, so
+	/// encode time and bandwidth follow the content rather than the texture
+	/// size. The runtime scans the alpha channel unless the frame carries a
+	/// QarRenderFrameShowOccupancyExt. Formats without alpha are always sent
+	/// in full.
+	bool skip_transparent_tiles;
+} QarRenderSenderTransparentTilesExt;
+
 /** Callback invoked for each pending render stream request. */
 typedef void (*qar_render_sender_request_callback_t)(
 	QarRenderStreamRequest* request, void* user_state
@@ -1172,6 +1429,9 @@ typedef struct QarStreamParamsD3D11
  *
  * Optional extensions (via header.next chain):
  * - QarRenderFrameShowViewOverridesExt
+ * - QarRenderFrameShowCpuBufferExt
+ * - QarRenderFrameShowDirtyRectsExt
+ * - QarRenderFrameShowOccupancyExt
  */
 typedef struct QarRenderFrameShow
 {
@@ -1198,6 +1458,181 @@ typedef struct QarRenderFrameShowViewOverridesExt
 	size_t view_overrides_count;
 } QarRenderFrameShowViewOverridesExt;
 
+/**
+ * @brief Caller-owned ring of CPU frame buffers for a CPU render sender.
+ *
+ * Each slot holds one texture per QarVideoFrameLayout texture (same index,
+ * size and format). Buffers are owned by the caller, must start on a
+ * QAR_CPU_BUFFER_ALIGNMENT boundary and must stay alive until the ring is
+ * replaced, the layout changes, or the sender handle is destroyed. The
+ * runtime encodes straight from these buffers, so the caller can render the
+ * next slot while earlier slots are still being encoded.
+ */
+typedef struct QarRenderSenderCpuBufferRing
+{
+	QarStructureHeader header; /**< QAR_STRUCTURE_TYPE_RENDERING_CPU_BUFFER_RING
+								*/
+	/// slots[slot][texture]; `pitch` may be larger than the packed row size.
+	QarVideoTextureCpu slots[QAR_MAX_CPU_BUFFER_RING_SIZE]
+							[QAR_MAX_FRAME_TEXTURES];
+	/// Ring depth. 0 unregisters the ring and returns to runtime-owned
+	/// buffers.
+	size_t slot_count;
+	/// Must match QarVideoFrameLayout::textures_count.
+	size_t textures_count;
+} QarRenderSenderCpuBufferRing;
+
+/**
+ * @brief Extension: the frame being shown was rendered into a registered
+ * caller-owned buffer slot.
+ */
+typedef struct QarRenderFrameShowCpuBufferExt
+{
+	QarStructureHeader
+		header; /**< QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_CPU_BUFFER_EXT */
+	/// Slot index returned by qar_render_sender_acquire_cpu_buffer.
+	uint32_t buffer_index;
+} QarRenderFrameShowCpuBufferExt;
+
+/**
+ * @brief Damaged region of one frame view, in pixels relative to the view's
+ * (start_x, start_y) corner.
+ */
+typedef struct QarRenderFrameDirtyRect
+{
+	size_t view_index;
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+} QarRenderFrameDirtyRect;
+
+/**
+ * @brief Rectangle inside one frame view, in pixels relative to the view's
+ * (start_x, start_y) corner.
+ */
+typedef struct QarRenderFrameViewRect
+{
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+} QarRenderFrameViewRect;
+
+/**
+ * @brief Extension: only the listed rectangles changed since the previously
+ * shown frame.
+ *
+ * Views without a rectangle are treated as unchanged, so a frame with
+ * `rects_count == 0` re-sends the previous image at near zero cost. Pixels
+ * outside the rectangles must still hold the previous frame's content
+ * wherever the runtime has to fall back to a full frame (first frame, layout
+ * change, reconnect or receiver-requested refresh). Rectangles are clipped to
+ * their view and may overlap. When more regions changed than fit, merge them
+ * into bounding rectangles.
+ */
+typedef struct QarRenderFrameShowDirtyRectsExt
+{
+	QarStructureHeader
+		header; /**< QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_DIRTY_RECTS_EXT */
+	QarRenderFrameDirtyRect rects[QAR_MAX_DIRTY_RECTS];
+	size_t rects_count;
+} QarRenderFrameShowDirtyRectsExt;
+
+/**
+ * @brief Extension: caller-known tile occupancy of the frame's color views.
+ *
+ * Each mask holds one byte per QAR_OCCUPANCY_TILE_SIZE square tile of its
+ * view, row by row from the view's (start_x, start_y) corner, with
+ * `ceil(view width / QAR_OCCUPANCY_TILE_SIZE)` bytes per row; partial tiles
+ * at the right and bottom edges count as whole tiles. A zero byte marks a
+ * fully transparent tile, which is sent as such without reading its pixels.
+ * A NULL mask leaves that view to the sender's
+ * QarRenderSenderTransparentTilesExt. Masks of depth views are ignored.
+ * Masks are only read during qar_render_sender_show_frame.
+ */
+typedef struct QarRenderFrameShowOccupancyExt
+{
+	QarStructureHeader
+		header; /**< QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_OCCUPANCY_EXT */
+	const uint8_t* view_tile_masks[QAR_MAX_FRAME_VIEWS];
+} QarRenderFrameShowOccupancyExt;
+
+/**
+ * @brief Everything qar_render_sender_begin_frame_ex reports about a frame.
+ *
+ * Holds the same values as the QarRenderFrameInfo getters, for all views at
+ * once. The per-view arrays are indexed like the sender's layout views; only
+ * the first `views_count` entries are valid.
+ */
+typedef struct QarRenderFrameBegin
+{
+	QarStructureHeader header; /**< QAR_STRUCTURE_TYPE_RENDERING_BEGIN_FRAME */
+	/// Sequence number of the frame, increasing by one per begin_frame.
+	uint64_t frame_index;
+	/// Time at which the frame is predicted to be displayed.
+	QarTimePoint predicted_display_time;
+	/// Time the tracking sample the view poses were predicted from was taken.
+	QarTimePoint pose_sample_time;
+	/// Duration from pose_sample_time to the time the view poses were
+	/// predicted for. Reaches predicted_display_time unless the sender set
+	/// another horizon with qar_render_sender_set_prediction_horizon.
+	QarTimePoint prediction_horizon;
+	size_t views_count;
+	QarPose view_poses[QAR_MAX_FRAME_VIEWS];
+	QarFov view_fovs[QAR_MAX_FRAME_VIEWS];
+	/// Area of each view to render into; the whole view unless dynamic
+	/// resolution is enabled.
+	QarRenderFrameViewRect view_active_rects[QAR_MAX_FRAME_VIEWS];
+	/// Per-axis scale of the active rectangles, in (0, 1].
+	float resolution_scale;
+} QarRenderFrameBegin;
+
+/**
+ * @brief Live counters and timings of one render sender.
+ *
+ * These are the per-source numbers the mixer's warping monitor shows, made
+ * available to the producing application. Counters accumulate from sender
+ * creation. Rates and times are smoothed over roughly the last 16 frames and
+ * stay 0 until the first frame was sent.
+ */
+typedef struct QarRenderSenderStats
+{
+	QarStructureHeader
+		header; /**< QAR_STRUCTURE_TYPE_RENDERING_SENDER_STATS */
+	/// Frames submitted with show_frame.
+	uint64_t frames_shown;
+	/// Frames encoded and sent to the receiving peer.
+	uint64_t frames_sent;
+	/// Frames shown but never sent, e.g. replaced by a newer frame while the
+	/// encoder was busy or lost during a reconnect.
+	uint64_t frames_dropped;
+	/// Encoded bytes sent to the receiving peer.
+	uint64_t bytes_sent;
+	/// Frames begun but not shown yet, plus frames shown but not encoded yet.
+	uint32_t queue_depth;
+	/// Rate of show_frame calls, in frames per second.
+	float upstream_fps;
+	/// Rate at which frames arrive at the receiving peer, in frames per
+	/// second.
+	float downstream_fps;
+	/// Time the encoder spends per frame, in milliseconds.
+	float encode_time_ms;
+	/// Time from show_frame until the frame arrived at the receiving peer,
+	/// in milliseconds.
+	float latency_ms;
+	/// Variation of the frame interval at the receiving peer, in
+	/// milliseconds.
+	float jitter_ms;
+	/// Estimated time from the pose sample a frame was rendered with
+	/// (begin_frame) until it is lit on the receiver's display, in
+	/// milliseconds.
+	float pose_to_photon_ms;
+	/// Per-axis scale of the active area of the most recent frame; 1 unless
+	/// dynamic resolution is enabled.
+	float resolution_scale;
+} QarRenderSenderStats;
+
 #ifdef __cplusplus
 }
 #endif
@@ -1219,6 +1654,15 @@ typedef struct QarRenderFrameShowViewOverridesExt
  * @defgroup qar_c_dynamic_loading Dynamic Loading
  * @ingroup qar_c_api
  * @brief Dynamic library load/unload helpers for the C API.
+ *
+ * Define QAR_ENABLE_DISPATCH_TABLE as well to resolve every entry point into
+ * one cache-line-aligned table at load time. The wrappers then call through
+ * it without a per-call loaded check, so the API must not be called before
+ * qar_library_load() succeeds.
+ *
+ * Alternatively, define QAR_ENABLE_LAZY_LOADING to defer resolving each
+ * module until the first call into it; qar_library_load() then only opens the
+ * library. Lazy loading needs pthreads on POSIX systems.
  * @{ */
 /** @brief Load the shared library from a custom path for dynamic mode. */
 static inline bool qar_library_load(const char* library_path);
@@ -1269,16 +1713,17 @@ static inline QarResult qar_library_destroy(void);
  * @{ */
 // Forward declarations
 /** @brief Construct a success result (code = QAR_STATUS_SUCCESS). */
-static inline QarResult qar_result_success(void);
+static inline QAR_CONSTEXPR QarResult qar_result_success(void);
 /** @brief Construct an error result with code and optional message. */
 static inline QarResult
 qar_result_error(QarStatusCode code, const char* message);
 /** @brief Check if result indicates success. */
-static inline bool qar_result_is_success(QarResult result);
+static inline QAR_CONSTEXPR bool qar_result_is_success(QarResult result);
 /** @brief Check if result indicates failure. */
-static inline bool qar_result_is_error(QarResult result);
+static inline QAR_CONSTEXPR bool qar_result_is_error(QarResult result);
 /** @brief Test a result against a specific status code. */
-static inline bool qar_result_has_code(QarResult result, QarStatusCode code);
+static inline QAR_CONSTEXPR bool
+qar_result_has_code(QarResult result, QarStatusCode code);
 /**
  * @brief Wrap an existing result with a new code/message for propagation.
  */
@@ -1624,6 +2069,24 @@ static inline void qar_session_handle_destroy(QarSession* handle);
 static inline QarResult
 qar_session_get_id(const QarSession* session, QarSessionId* out_session_id);
 
+/** @brief Default init for QarEventQueueInit (no sources enabled). */
+static inline QarEventQueueInit qar_event_queue_init_default(void);
+
+/**
+ * @brief Enable (or reconfigure) polled event queues for this session.
+ *
+ * Events of an enabled source are no longer delivered to its subscription
+ * callbacks; they wait in the queue until polled from a single consumer
+ * thread. Reconfiguring drops every event still queued. It may run while
+ * another thread polls: it waits for polls in flight to finish, and polls
+ * that start during the swap return no events.
+ * @retval QAR_STATUS_ARGUMENT_NOT_SUPPORTED init->capacity exceeds the
+ *   runtime's maximum queue size.
+ */
+static inline QarResult qar_session_enable_event_queues(
+	QarSession* session, const QarEventQueueInit* init
+);
+
 /**
  * @brief Invite a peer to the current session.
  * @param session Active session handle.
@@ -1704,6 +2167,22 @@ static inline QarResult qar_peer_subscribe_updates(
 	void* user_state,
 	QarCancelToken* token
 );
+/**
+ * @brief Drain up to `capacity` queued peer events without blocking.
+ *
+ * Requires QAR_EVENT_QUEUE_SOURCE_PEERS in qar_session_enable_event_queues.
+ * Events are returned oldest first; `*out_count` is 0 when the queue is
+ * empty. Must only be called from one thread at a time.
+ * @retval QAR_STATUS_EVENT_QUEUE_OVERFLOW events were dropped since the last
+ *   poll; `out_events` still holds the kept events.
+ * @retval QAR_STATUS_LOGIC_ERROR the peer queue is not enabled.
+ */
+static inline QarResult qar_peer_poll_events(
+	QarSession* session,
+	QarPeerEvent* out_events,
+	size_t capacity,
+	size_t* out_count
+);
 
 /** @} */ /* end of qar_c_peer */
 
@@ -1745,6 +2224,13 @@ static inline QarResult qar_render_request_get_stream_id(
  * @param init Stream configuration (views, formats, target peer, etc.).
  * @param cancel Optional cancellation token for creation.
  * @param out_stream Receives the created stream sender handle.
+ *
+ * Chain QarRenderSenderFoveationExt into `init->header.next` for foveated
+ * views; query the resulting views with qar_render_sender_layout. Chain
+ * QarRenderSenderFramesInFlightExt to render ahead of the encoder,
+ * QarRenderSenderDynamicResolutionExt for dynamic resolution,
+ * QarRenderSenderDepthEncodingExt to quantize depth and
+ * QarRenderSenderTransparentTilesExt to skip transparent tiles.
  */
 static inline QarResult qar_render_sender_create(
 	QarSession* session,
@@ -1794,17 +2280,79 @@ static inline QarResult qar_render_sender_frame_d3d11(
 	QarRenderSender* stream, QarVideoFrameD3D11* out_frame
 );
 #endif
+/**
+ * @brief Register a ring of caller-owned CPU buffers for a CPU sender.
+ *
+ * Replaces any previously registered ring. Pass a ring with slot_count = 0
+ * to go back to runtime-owned buffers (qar_render_sender_frame_cpu).
+ * A layout change drops the ring; register a new one that matches the new
+ * layout.
+ *
+ * @retval QAR_STATUS_ARGUMENT_NOT_SUPPORTED the sender is not a CPU sender,
+ *   a slot does not match the layout textures, a buffer is too small or not
+ *   aligned to QAR_CPU_BUFFER_ALIGNMENT, or slot_count exceeds
+ *   QAR_MAX_CPU_BUFFER_RING_SIZE.
+ */
+static inline QarResult qar_render_sender_register_cpu_buffers(
+	QarRenderSender* stream, const QarRenderSenderCpuBufferRing* ring
+);
+/**
+ * @brief Acquire the next free slot of the registered buffer ring.
+ *
+ * Slots are handed out in ring order and stay in use from this call until
+ * the frame rendered into them was shown and encoded. When the next slot is
+ * still in use, blocks until the encoder released it or `token` is
+ * cancelled. `out_frame` describes the slot's caller-owned textures with the
+ * current layout views. Render into it, then chain
+ * QarRenderFrameShowCpuBufferExt with `out_buffer_index` into
+ * qar_render_sender_show_frame.
+ *
+ * @retval QAR_STATUS_LOGIC_ERROR no ring is registered (or a layout change
+ *   dropped it).
+ * @retval QAR_STATUS_TIMEOUT `token` timed out while every slot was in use.
+ */
+static inline QarResult qar_render_sender_acquire_cpu_buffer(
+	QarRenderSender* stream,
+	QarCancelToken* token,
+	QarVideoFrameCpu* out_frame,
+	uint32_t* out_buffer_index
+);
 
 /**
  * @brief Begin producing a new frame.
  *
  * Returns per-frame information such as per-eye pose/FOV to render with.
+ *
+ * Up to QarRenderSenderFramesInFlightExt::max_frames_in_flight frames (1
+ * without the extension) may be begun before the oldest one is shown; only
+ * then does this call block. Frames are shown
+ * in the order they were begun. The textures returned by
+ * qar_render_sender_frame_cpu belong to the most recently begun frame, so
+ * fetch them right after this call.
  */
 static inline QarResult qar_render_sender_begin_frame(
 	QarRenderSender* stream,
 	QarCancelToken* token,
 	QarRenderFrameInfo** out_frame_info
 );
+/**
+ * @brief Begin producing a new frame, reporting it in a caller-owned struct.
+ *
+ * Behaves like qar_render_sender_begin_frame, but copies the frame index,
+ * its display and pose timing and every view's pose, FOV and active
+ * rectangle into `out_frame` instead of returning a QarRenderFrameInfo
+ * handle. Nothing is allocated and no further calls are needed to read the
+ * views. Initialize `out_frame` with qar_render_frame_begin_default(); the
+ * header is left untouched.
+ *
+ * @retval QAR_STATUS_ARGUMENT_NOT_SUPPORTED `out_frame` is NULL or has the
+ *   wrong structure type.
+ */
+static inline QarResult qar_render_sender_begin_frame_ex(
+	QarRenderSender* stream,
+	QarCancelToken* token,
+	QarRenderFrameBegin* out_frame
+);
 typedef void (*qar_render_sender_begin_frame_callback_t)(
 	QarResult status, QarRenderFrameInfo* frame_info, void* user_state
 );
@@ -1817,16 +2365,88 @@ static inline QarResult qar_render_sender_begin_frame_async(
 );
 /**
  * @brief Submit the rendered frame for presentation/streaming.
+ *
+ * With several frames in flight this shows the oldest begun frame.
  */
 static inline QarResult qar_render_sender_show_frame(
 	QarRenderSender* stream, const QarRenderFrameShow* frame_show
 );
+/**
+ * @brief Predict the view poses of frames begun from now on for a fixed
+ * horizon instead of their display time.
+ *
+ * By default every frame's poses are predicted for its predicted display
+ * time. With a horizon set, they are predicted for the pose sample time plus
+ * `horizon`, e.g. the time step of a simulation; the compositor reprojects
+ * the difference to the display time. Frames report the horizon they got.
+ * A horizon with count 0 restores the default.
+ *
+ * @retval QAR_STATUS_ARGUMENT_NOT_SUPPORTED `horizon.precision` is neither
+ *   milliseconds (0) nor nanoseconds (1).
+ */
+static inline QarResult qar_render_sender_set_prediction_horizon(
+	QarRenderSender* stream, QarTimePoint horizon
+);
 /**
  * @brief Query the last tracked hands data associated with the stream.
  */
 static inline QarResult qar_render_sender_last_hands(
 	QarRenderSender* stream, QarDeviceHandsWithJoints* out_hands
 );
+/**
+ * @brief Copy every hand tracking sample taken after `since`, oldest first.
+ *
+ * The sender keeps the target device's last QAR_HAND_HISTORY_CAPACITY
+ * samples at the tracker's own rate, independent of the frame rate. Each
+ * copied sample carries its capture time in `device_timestamp`, on the same
+ * clock as the frame times. Pass the `device_timestamp` of the last sample
+ * received to continue without gaps or duplicates; a zero time point copies
+ * the whole history. When more samples are pending than `capacity`, the
+ * oldest ones are copied and the rest remain for the next call.
+ *
+ * @retval QAR_STATUS_ARGUMENT_NOT_SUPPORTED `out_count` is NULL, or
+ *   `out_samples` is NULL while `capacity` is not 0.
+ */
+static inline QarResult qar_render_sender_hands_since(
+	QarRenderSender* stream,
+	QarTimePoint since,
+	QarDeviceHandsWithJoints* out_samples,
+	size_t capacity,
+	size_t* out_count
+);
+/**
+ * @brief Sample the target device's hands at an arbitrary time, e.g. the
+ * predicted display time of the frame being rendered.
+ *
+ * Between two samples of the hand history, positions, radii and velocities
+ * are interpolated linearly and orientations spherically. Past the newest
+ * sample, joints move on with their reported linear and angular velocities
+ * for at most QAR_HAND_MAX_EXTRAPOLATION_MS; hands without velocities keep
+ * their last pose. Before the oldest sample, the oldest one is returned.
+ * `device_timestamp` is set to the time the returned hands describe.
+ *
+ * @retval QAR_STATUS_ARGUMENT_NOT_SUPPORTED `out_hands` is NULL or
+ *   `time.precision` is neither milliseconds (0) nor nanoseconds (1).
+ */
+static inline QarResult qar_render_sender_sample_hands_at(
+	QarRenderSender* stream,
+	QarTimePoint time,
+	QarDeviceHandsWithJoints* out_hands
+);
+/**
+ * @brief Read the live statistics of the sender.
+ *
+ * Cheap enough to call once per frame, e.g. from an adaptive-quality
+ * controller that lowers the resolution when encode time or queue depth
+ * grow. Initialize `out_stats` with qar_render_sender_stats_default(); the
+ * header is left untouched.
+ *
+ * @retval QAR_STATUS_ARGUMENT_NOT_SUPPORTED `out_stats` is NULL or has the
+ *   wrong structure type.
+ */
+static inline QarResult qar_render_sender_get_stats(
+	QarRenderSender* stream, QarRenderSenderStats* out_stats
+);
 
 static inline bool
 qar_render_frame_info_handle_is_valid(QarRenderFrameInfo* handle);
@@ -1838,6 +2458,62 @@ static inline QarResult qar_render_frame_info_get_view_pose(
 static inline QarResult qar_render_frame_info_get_view_fov(
 	QarRenderFrameInfo* handle, size_t view_index, QarFov* out_fov
 );
+/**
+ * @brief Sequence number of the frame, increasing by one per begin_frame.
+ */
+static inline QarResult qar_render_frame_info_get_frame_index(
+	QarRenderFrameInfo* handle, uint64_t* out_frame_index
+);
+/**
+ * @brief Time at which the frame is predicted to be displayed.
+ *
+ * View poses are predicted for this time unless the sender set another
+ * horizon with qar_render_sender_set_prediction_horizon. Frames begun further
+ * ahead in the pipeline get later display times.
+ */
+static inline QarResult qar_render_frame_info_get_predicted_display_time(
+	QarRenderFrameInfo* handle, QarTimePoint* out_display_time
+);
+/**
+ * @brief Time the tracking sample the view poses were predicted from was
+ * taken, on the same clock as the predicted display time.
+ */
+static inline QarResult qar_render_frame_info_get_pose_sample_time(
+	QarRenderFrameInfo* handle, QarTimePoint* out_sample_time
+);
+/**
+ * @brief How far ahead of the pose sample time the view poses were
+ * predicted, as a duration.
+ *
+ * The poses hold for pose sample time + horizon. A simulation that advances
+ * to exactly that time renders what the poses show, leaving the compositor
+ * only the remaining difference to the display time to reproject.
+ */
+static inline QarResult qar_render_frame_info_get_prediction_horizon(
+	QarRenderFrameInfo* handle, QarTimePoint* out_horizon
+);
+/**
+ * @brief Area of a view to render into for this frame.
+ *
+ * Without dynamic resolution this is always the whole view. With
+ * QarRenderSenderDynamicResolutionExt the runtime may pick a
+ * smaller rectangle at the view's corner. Render the view's full FOV into
+ * that rectangle (set the viewport to it); the receiver scales it back up.
+ * Pixels outside the rectangle are ignored. Dirty rectangles are clipped to
+ * it as well.
+ */
+static inline QarResult qar_render_frame_info_get_view_active_rect(
+	QarRenderFrameInfo* handle,
+	size_t view_index,
+	QarRenderFrameViewRect* out_rect
+);
+/**
+ * @brief Per-axis scale of the active rectangles of this frame, in
+ * (0, 1]; see qar_render_frame_info_get_view_active_rect.
+ */
+static inline QarResult qar_render_frame_info_get_resolution_scale(
+	QarRenderFrameInfo* handle, float* out_scale
+);
 
 /** @} */ /* end of qar_c_render_sender */
 
@@ -1908,6 +2584,16 @@ static inline QarResult qar_gui_panels_subscribe_panel_updates(
 	void* user_state,
 	QarCancelToken* token
 );
+/**
+ * @brief Drain queued GUI panel events without blocking (see
+ * qar_peer_poll_events). Requires QAR_EVENT_QUEUE_SOURCE_GUI_PANELS.
+ */
+static inline QarResult qar_gui_panels_poll_events(
+	QarSession* session,
+	QarGuiPanelEvent* out_events,
+	size_t capacity,
+	size_t* out_count
+);
 
 static inline QarResult
 qar_query_gui_panels_count(QarSession* session, size_t* out_count);
@@ -2052,6 +2738,27 @@ static inline QarResult qar_app_volumes_subscribe_gesture_updates(
 	void* user_state,
 	QarCancelToken* token
 );
+/**
+ * @brief Drain queued app volume events without blocking (see
+ * qar_peer_poll_events). Requires QAR_EVENT_QUEUE_SOURCE_APP_VOLUMES.
+ */
+static inline QarResult qar_app_volumes_poll_events(
+	QarSession* session,
+	QarAppVolumeEvent* out_events,
+	size_t capacity,
+	size_t* out_count
+);
+/**
+ * @brief Drain queued gesture events of all app volumes without blocking
+ * (see qar_peer_poll_events). Requires
+ * QAR_EVENT_QUEUE_SOURCE_APP_VOLUME_GESTURES.
+ */
+static inline QarResult qar_app_volumes_poll_gesture_events(
+	QarSession* session,
+	QarAppVolumeGestureEvent* out_events,
+	size_t capacity,
+	size_t* out_count
+);
 
 // APP VOLUME GETTERS
 
@@ -2129,6 +2836,22 @@ static inline QarResult qar_app_volume_get_latest_size(
 	const QarAppVolumeId* volume_id,
 	QarAppVolumeSize* out_size
 );
+/**
+ * @brief Batched fast-path read of pose, size, app pose and app scale for
+ * `count` app volumes.
+ *
+ * `out_states[i]` receives the state of `volume_ids[i]`. All entries come
+ * from one snapshot, so pose and size never tear against each other. Unknown
+ * ids do not stop the batch; their entries have `is_valid == false`.
+ * @retval QAR_STATUS_APP_VOLUME_INVALID_ID at least one id is unknown (all
+ *   other entries are still filled).
+ */
+static inline QarResult qar_app_volumes_get_latest_states(
+	QarSession* session,
+	const QarAppVolumeId* volume_ids,
+	size_t count,
+	QarAppVolumeLatestState* out_states
+);
 /** @brief Get gesture configuration for an app volume handle.
  *
  * Mapping rules are returned in priority order. Earlier entries in
@@ -2169,6 +2892,37 @@ static inline QarLibraryInit qar_library_init_default(void);
 static inline QarRuntimeInit qar_runtime_init_default(void);
 /** @brief Default init for QarRenderFrameShow. */
 static inline QarRenderFrameShow qar_render_frame_show_default(void);
+/** @brief Default init for QarRenderSenderCpuBufferRing (empty ring). */
+static inline QarRenderSenderCpuBufferRing
+qar_render_sender_cpu_buffer_ring_default(void);
+/** @brief Default init for QarRenderFrameShowCpuBufferExt. */
+static inline QarRenderFrameShowCpuBufferExt
+qar_render_frame_show_cpu_buffer_ext_default(void);
+/** @brief Default init for QarRenderFrameShowDirtyRectsExt (no damage). */
+static inline QarRenderFrameShowDirtyRectsExt
+qar_render_frame_show_dirty_rects_ext_default(void);
+/** @brief Default init for QarRenderFrameShowOccupancyExt (no masks). */
+static inline QarRenderFrameShowOccupancyExt
+qar_render_frame_show_occupancy_ext_default(void);
+/** @brief Default init for QarRenderSenderFoveationExt. */
+static inline QarRenderSenderFoveationExt
+qar_render_sender_foveation_ext_default(void);
+/** @brief Default init for QarRenderSenderFramesInFlightExt (2 frames). */
+static inline QarRenderSenderFramesInFlightExt
+qar_render_sender_frames_in_flight_ext_default(void);
+/** @brief Default init for QarRenderSenderDynamicResolutionExt (0.5). */
+static inline QarRenderSenderDynamicResolutionExt
+qar_render_sender_dynamic_resolution_ext_default(void);
+/** @brief Default init for QarRenderSenderDepthEncodingExt (reversed-Z). */
+static inline QarRenderSenderDepthEncodingExt
+qar_render_sender_depth_encoding_ext_default(void);
+/** @brief Default init for QarRenderSenderTransparentTilesExt (skipping). */
+static inline QarRenderSenderTransparentTilesExt
+qar_render_sender_transparent_tiles_ext_default(void);
+/** @brief Default init for QarRenderSenderStats (all zero). */
+static inline QarRenderSenderStats qar_render_sender_stats_default(void);
+/** @brief Default init for QarRenderFrameBegin (no views). */
+static inline QarRenderFrameBegin qar_render_frame_begin_default(void);
 /** @brief Default init for QarGuiPanelInit. */
 static inline QarGuiPanelInit qar_gui_panel_init_default(void);
 /** @brief Default init for QarAppVolumeInit. */
@@ -2223,6 +2977,8 @@ static inline QarVideoFrameLayout qar_video_frame_layout_default(void);
 static inline QarVideoTextureCpu qar_video_texture_cpu_default(void);
 /** @brief Default CPU video frame. */
 static inline QarVideoFrameCpu qar_video_frame_cpu_default(void);
+/** @brief Bytes per pixel of a pixel format (0 if unknown). */
+static inline uint32_t qar_pixel_format_size(QarPixelFormat format);
 
 /** @brief Default GUI panel size. */
 static inline QarGuiPanelSize qar_gui_panel_size_default(void);
@@ -2266,11 +3022,11 @@ static inline QarAppVolumeId qar_app_volume_id_default(void);
 /** @brief Zero/invalid stream id. */
 static inline QarStreamId qar_stream_id_default(void);
 /** @brief Serialize a UUID (16 bytes) to text representation. */
-static inline QarResult qar_uuid_to_string(
+static inline QAR_CONSTEXPR QarResult qar_uuid_to_string(
 	const uint8_t* uuid_bytes, char* out_buffer, size_t buffer_size
 );
 /** @brief Parse a UUID text representation into 16 bytes. */
-static inline QarResult
+static inline QAR_CONSTEXPR QarResult
 qar_uuid_from_string(const char* text, uint8_t* out_uuid_bytes);
 
 /** @brief Compare two peer ids for equality. */
@@ -2340,14 +3096,62 @@ qar_gui_panel_id_equals(const QarGuiPanelId* id1, const QarGuiPanelId* id2);
 #define QAR_DECLARE_SYMBOL_NAME_EX(STATUS, RET, NAME, PARAMS, ARGS)            \
 	"qar_impl_" #NAME,
 
+#define QAR_DECLARE_SYMBOL_REQUIRED_EX(STATUS, RET, NAME, PARAMS, ARGS)        \
+	QAR_SYMBOL_REQUIRED_##STATUS,
+
+/*
+ * Entry status, the first column of every QAR_*_FUNCTION_LIST entry:
+ * ACTIVE and DEPRECATED entries must be exported by every runtime.
+ * OPTIONAL entries were added after the first runtime release and must
+ * return QarResult; a runtime that predates one leaves it NULL and its
+ * wrapper returns QAR_STATUS_NOT_IMPLEMENTED instead of aborting. The
+ * first entry of a module list must not be OPTIONAL: the lazy loader reads
+ * it to tell whether the module was resolved.
+ */
 #define QAR_WRAPPER_ATTR_ACTIVE
 #define QAR_WRAPPER_ATTR_DEPRECATED                                            \
 	QAR_DEPRECATED(                                                            \
 		"Deprecated API. The DLL implementation may return a deprecation "     \
 		"error code."                                                          \
 	)
+#define QAR_WRAPPER_ATTR_OPTIONAL
+
+#define QAR_SYMBOL_REQUIRED_ACTIVE true
+#define QAR_SYMBOL_REQUIRED_DEPRECATED true
+#define QAR_SYMBOL_REQUIRED_OPTIONAL false
+
+#define QAR_API_MISSING_ABORT(FUNC_NAME, MODULE_NAME)                          \
+	QAR_API_MISSING_ERR_PRINT(FUNC_NAME, MODULE_NAME);                         \
+	abort();
+
+// Runs for an entry the loaded runtime does not provide.
+#define QAR_API_MISSING_ACTIVE(FUNC_NAME, MODULE_NAME)                         \
+	QAR_API_MISSING_ABORT(FUNC_NAME, MODULE_NAME)
+#define QAR_API_MISSING_DEPRECATED(FUNC_NAME, MODULE_NAME)                     \
+	QAR_API_MISSING_ABORT(FUNC_NAME, MODULE_NAME)
+#define QAR_API_MISSING_OPTIONAL(FUNC_NAME, MODULE_NAME)                       \
+	{                                                                          \
+		QarResult missing = { QAR_STATUS_NOT_IMPLEMENTED, 0 };                 \
+		return missing;                                                        \
+	}
 
-#ifdef QAR_ENABLE_DYNAMIC_LOADING
+#if defined(QAR_ENABLE_DYNAMIC_LOADING) && defined(QAR_ENABLE_DISPATCH_TABLE)
+
+// The wrappers call through the single g_qar_dispatch_table, which can only
+// be laid out once every function list is known; the loader section at the
+// end of this header defines it and emits the wrappers.
+#define QAR_DECLARE_MODULE_COMMON(                                             \
+	MODULE_UPPER, MODULE_CAMEL, MODULE_LOWER, FUNC_LIST                        \
+)                                                                              \
+	FUNC_LIST(QAR_DECLARE_FUNC_TYPEDEF_EX)
+
+#define QAR_DEFINE_MODULE_STORAGE(MODULE_CAMEL, MODULE_LOWER)
+
+#define QAR_DECLARE_WRAPPER_EX(                                                \
+	MODULE_API_VAR, MODULE_STR, STATUS, RET, NAME, PARAMS, ARGS                \
+)
+
+#elif defined(QAR_ENABLE_DYNAMIC_LOADING)
 
 #define QAR_DECLARE_MODULE_COMMON(                                             \
 	MODULE_UPPER, MODULE_CAMEL, MODULE_LOWER, FUNC_LIST                        \
@@ -2365,6 +3169,10 @@ qar_gui_panel_id_equals(const QarGuiPanelId* id1, const QarGuiPanelId* id2);
 		FUNC_LIST(QAR_DECLARE_SYMBOL_NAME_EX)                                  \
 	};                                                                         \
                                                                                \
+	static const bool qar_##MODULE_LOWER##_symbol_required[] = {               \
+		FUNC_LIST(QAR_DECLARE_SYMBOL_REQUIRED_EX)                              \
+	};                                                                         \
+                                                                               \
 	enum                                                                       \
 	{                                                                          \
 		QAR_##MODULE_UPPER##_FUNC_COUNT =                                      \
@@ -2375,6 +3183,48 @@ qar_gui_panel_id_equals(const QarGuiPanelId* id1, const QarGuiPanelId* id2);
 #define QAR_DEFINE_MODULE_STORAGE(MODULE_CAMEL, MODULE_LOWER)                  \
 	Qar##MODULE_CAMEL##LoadedApi g_qar_##MODULE_LOWER##_api = { 0 }
 
+#ifdef QAR_ENABLE_LAZY_LOADING
+
+// Entries are published by another thread the first time their module is
+// used, so the wrappers read them with acquire semantics.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define QAR_LOAD_ACQUIRE(LOCATION)                                             \
+	ReadPointerAcquire((PVOID const volatile*)(LOCATION))
+#define QAR_STORE_RELEASE(LOCATION, VALUE)                                     \
+	WritePointerRelease((PVOID volatile*)(LOCATION), (PVOID)(VALUE))
+#else
+#define QAR_LOAD_ACQUIRE(LOCATION) __atomic_load_n(LOCATION, __ATOMIC_ACQUIRE)
+#define QAR_STORE_RELEASE(LOCATION, VALUE)                                     \
+	__atomic_store_n(LOCATION, VALUE, __ATOMIC_RELEASE)
+#endif
+
+// Resolves the module owning MODULE_API on first use; defined with the
+// loader at the end of this header.
+static inline bool qar_load_module_lazily(void* module_api);
+
+#define QAR_DECLARE_WRAPPER_EX(                                                \
+	MODULE_API_VAR, MODULE_STR, STATUS, RET, NAME, PARAMS, ARGS                \
+)                                                                              \
+	QAR_WRAPPER_ATTR_##STATUS static inline RET qar_##NAME PARAMS              \
+	{                                                                          \
+		qar_##NAME##_func_t function =                                         \
+			(qar_##NAME##_func_t)QAR_LOAD_ACQUIRE(&(MODULE_API_VAR).NAME);     \
+		if(function == NULL)                                                   \
+		{                                                                      \
+			if(qar_load_module_lazily(&(MODULE_API_VAR)))                      \
+			{                                                                  \
+				function = (MODULE_API_VAR).NAME;                              \
+			}                                                                  \
+			if(function == NULL)                                               \
+			{                                                                  \
+				QAR_API_MISSING_##STATUS("qar_" #NAME, MODULE_STR)             \
+			}                                                                  \
+		}                                                                      \
+		return function ARGS;                                                  \
+	}
+
+#else
+
 #define QAR_DECLARE_WRAPPER_EX(                                                \
 	MODULE_API_VAR, MODULE_STR, STATUS, RET, NAME, PARAMS, ARGS                \
 )                                                                              \
@@ -2382,12 +3232,13 @@ qar_gui_panel_id_equals(const QarGuiPanelId* id1, const QarGuiPanelId* id2);
 	{                                                                          \
 		if((MODULE_API_VAR).NAME == NULL)                                      \
 		{                                                                      \
-			QAR_API_MISSING_ERR_PRINT("qar_" #NAME, MODULE_STR);               \
-			abort();                                                           \
+			QAR_API_MISSING_##STATUS("qar_" #NAME, MODULE_STR)                 \
 		}                                                                      \
 		return (MODULE_API_VAR).NAME ARGS;                                     \
 	}
 
+#endif
+
 #else
 
 #define QAR_DECLARE_MODULE_COMMON(                                             \
@@ -2639,12 +3490,36 @@ typedef void (*qar_app_volume_gesture_event_callback_t)(
 	  (QarSession * session,                                                   \
 	   const QarAppVolumeId* volume_id,                                        \
 	   QarAppVolumeSize* out_size),                                            \
-	  (session, volume_id, out_size))
-
-QAR_DECLARE_MODULE_COMMON(
-	APP_VOLUMES, AppVolumes, app_volumes, QAR_APP_VOLUMES_FUNCTION_LIST
-);
-QAR_DECLARE_MODULE_IMPL_EXTERNS(QAR_APP_VOLUMES_FUNCTION_LIST)
+	  (session, volume_id, out_size))                                          \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  app_volumes_poll_events,                                                 \
+	  (QarSession * session,                                                   \
+	   QarAppVolumeEvent * out_events,                                         \
+	   size_t capacity,                                                        \
+	   size_t* out_count),                                                     \
+	  (session, out_events, capacity, out_count))                              \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  app_volumes_poll_gesture_events,                                         \
+	  (QarSession * session,                                                   \
+	   QarAppVolumeGestureEvent * out_events,                                  \
+	   size_t capacity,                                                        \
+	   size_t* out_count),                                                     \
+	  (session, out_events, capacity, out_count))                              \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  app_volumes_get_latest_states,                                           \
+	  (QarSession * session,                                                   \
+	   const QarAppVolumeId* volume_ids,                                       \
+	   size_t count,                                                           \
+	   QarAppVolumeLatestState* out_states),                                   \
+	  (session, volume_ids, count, out_states))
+
+QAR_DECLARE_MODULE_COMMON(
+	APP_VOLUMES, AppVolumes, app_volumes, QAR_APP_VOLUMES_FUNCTION_LIST
+);
+QAR_DECLARE_MODULE_IMPL_EXTERNS(QAR_APP_VOLUMES_FUNCTION_LIST)
 
 #define QAR_APP_VOLUMES_DECLARE_WRAPPER(STATUS, RET, NAME, PARAMS, ARGS)       \
 	QAR_DECLARE_WRAPPER_EX(                                                    \
@@ -2664,17 +3539,7 @@ QAR_APP_VOLUMES_FUNCTION_LIST(QAR_APP_VOLUMES_DECLARE_WRAPPER)
 #define QAR_TYPES_FUNCTION_LIST(X)                                             \
 	X(ACTIVE, QarPeerId, peer_id_unique, (void), ())                           \
 	X(ACTIVE, QarSessionId, session_unique, (void), ())                        \
-	X(ACTIVE, QarGuiPanelId, gui_panel_id_unique, (void), ())                  \
-	X(ACTIVE,                                                                  \
-	  QarResult,                                                               \
-	  uuid_to_string,                                                          \
-	  (const uint8_t* uuid_bytes, char* out_buffer, size_t buffer_size),       \
-	  (uuid_bytes, out_buffer, buffer_size))                                   \
-	X(ACTIVE,                                                                  \
-	  QarResult,                                                               \
-	  uuid_from_string,                                                        \
-	  (const char* text, uint8_t* out_uuid_bytes),                             \
-	  (text, out_uuid_bytes))
+	X(ACTIVE, QarGuiPanelId, gui_panel_id_unique, (void), ())
 
 QAR_DECLARE_MODULE_COMMON(TYPES, Types, types, QAR_TYPES_FUNCTION_LIST);
 QAR_DECLARE_MODULE_IMPL_EXTERNS(QAR_TYPES_FUNCTION_LIST)
@@ -2688,6 +3553,111 @@ QAR_TYPES_FUNCTION_LIST(QAR_TYPES_DECLARE_WRAPPER)
 
 #undef QAR_TYPES_DECLARE_WRAPPER
 
+// UUID text conversion is a pure value operation and stays in the header; the
+// runtime is only entered to attach a message when the arguments are invalid.
+
+static inline QAR_CONSTEXPR char
+qar_uuid_hex_digit(uint8_t nibble)
+{
+	return (char)(nibble < 10 ? '0' + nibble : 'a' + (nibble - 10));
+}
+
+static inline QAR_CONSTEXPR int
+qar_uuid_hex_value(char c)
+{
+	if(c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+	if(c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+	if(c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+static inline QAR_CONSTEXPR QarResult
+qar_uuid_to_string(
+	const uint8_t* uuid_bytes, char* out_buffer, size_t buffer_size
+)
+{
+	if(uuid_bytes == NULL || out_buffer == NULL
+	   || buffer_size < QAR_UUID_TEXT_BUFFER_SIZE)
+	{
+		return qar_result_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"uuid_to_string needs QAR_UUID_TEXT_BUFFER_SIZE bytes of output"
+		);
+	}
+
+	size_t out = 0;
+	for(size_t i = 0; i < QAR_MAX_ID_LENGTH; i++)
+	{
+		if(i == 4 || i == 6 || i == 8 || i == 10)
+		{
+			out_buffer[out++] = '-';
+		}
+		out_buffer[out++] = qar_uuid_hex_digit((uint8_t)(uuid_bytes[i] >> 4));
+		out_buffer[out++] = qar_uuid_hex_digit((uint8_t)(uuid_bytes[i] & 0x0f));
+	}
+	out_buffer[out] = '\0';
+
+	return qar_result_success();
+}
+
+static inline QAR_CONSTEXPR QarResult
+qar_uuid_from_string(const char* text, uint8_t* out_uuid_bytes)
+{
+	if(text == NULL || out_uuid_bytes == NULL)
+	{
+		return qar_result_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "text or out_uuid_bytes is NULL"
+		);
+	}
+
+	// Parse into a local copy so a malformed string leaves the output as is.
+	// Each character is checked before the next one is read, so a string that
+	// is too short stops at its terminator.
+	uint8_t bytes[QAR_MAX_ID_LENGTH] = { 0 };
+	size_t byte_index = 0;
+	bool well_formed = true;
+	for(size_t i = 0; well_formed && i < QAR_UUID_TEXT_LENGTH;)
+	{
+		if(i == 8 || i == 13 || i == 18 || i == 23)
+		{
+			well_formed = text[i] == '-';
+			i++;
+			continue;
+		}
+		const int high = qar_uuid_hex_value(text[i]);
+		const int low = high < 0 ? -1 : qar_uuid_hex_value(text[i + 1]);
+		well_formed = low >= 0;
+		if(well_formed)
+		{
+			bytes[byte_index++] = (uint8_t)(high << 4 | low);
+		}
+		i += 2;
+	}
+	if(!well_formed || text[QAR_UUID_TEXT_LENGTH] != '\0')
+	{
+		return qar_result_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"expected xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+		);
+	}
+
+	for(size_t i = 0; i < QAR_MAX_ID_LENGTH; i++)
+	{
+		out_uuid_bytes[i] = bytes[i];
+	}
+
+	return qar_result_success();
+}
+
 static inline bool
 qar_peer_id_equals(const QarPeerId* id1, const QarPeerId* id2)
 {
@@ -2764,6 +3734,22 @@ qar_gui_panel_id_equals(const QarGuiPanelId* id1, const QarGuiPanelId* id2)
 	return true;
 }
 
+static inline uint32_t
+qar_pixel_format_size(QarPixelFormat format)
+{
+	switch(format)
+	{
+	case QAR_PIXEL_FORMAT_R32_FLOAT:
+	case QAR_PIXEL_FORMAT_R8G8B8A8:
+	case QAR_PIXEL_FORMAT_B8G8R8A8:
+	case QAR_PIXEL_FORMAT_D32_FLOAT:
+		return 4;
+	case QAR_PIXEL_FORMAT_R16G16B16A16:
+		return 8;
+	}
+	return 0;
+}
+
 #endif // QAR_STREAMING_C_V0_DETAIL_BASIC_TYPES_H
 
 #ifndef QAR_STREAMING_C_V0_DETAIL_CANCELATION_TOKEN_H
@@ -2996,7 +3982,8 @@ qar_video_frame_view_default(void)
 		0,								 // array_layer_index
 		QAR_PIXEL_FORMAT_B8G8R8A8,		 // texture_format
 		QAR_VIDEO_FRAME_VIEW_TYPE_COLOR, // data_type
-		QAR_VIDEO_FRAME_VIEW_EYE_NONE	 // eye
+		QAR_VIDEO_FRAME_VIEW_EYE_NONE,	 // eye
+		QAR_VIDEO_FRAME_VIEW_REGION_FULL // region
 	};
 	return view;
 }
@@ -3268,6 +4255,17 @@ qar_forget_init_default(void)
 	return init;
 }
 
+static inline QarEventQueueInit
+qar_event_queue_init_default(void)
+{
+	QarEventQueueInit init = {
+		{ QAR_STRUCTURE_TYPE_SESSION_EVENT_QUEUE_INIT, NULL }, // header
+		0,													   // sources
+		QAR_DEFAULT_EVENT_QUEUE_CAPACITY					   // capacity
+	};
+	return init;
+}
+
 static inline QarRenderSenderInit
 qar_render_sender_init_default(void)
 {
@@ -3332,6 +4330,152 @@ qar_render_frame_show_default(void)
 	return init;
 }
 
+static inline QarRenderSenderCpuBufferRing
+qar_render_sender_cpu_buffer_ring_default(void)
+{
+	QarRenderSenderCpuBufferRing ring = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_CPU_BUFFER_RING, NULL }, // header
+		{},														// slots
+		0,														// slot_count
+		0 // textures_count
+	};
+	for(size_t slot = 0; slot < QAR_MAX_CPU_BUFFER_RING_SIZE; slot++)
+	{
+		for(size_t tex = 0; tex < QAR_MAX_FRAME_TEXTURES; tex++)
+		{
+			ring.slots[slot][tex] = qar_video_texture_cpu_default();
+		}
+	}
+	return ring;
+}
+
+static inline QarRenderFrameShowCpuBufferExt
+qar_render_frame_show_cpu_buffer_ext_default(void)
+{
+	QarRenderFrameShowCpuBufferExt ext = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_CPU_BUFFER_EXT, NULL }, // header
+		0 // buffer_index
+	};
+	return ext;
+}
+
+static inline QarRenderFrameShowDirtyRectsExt
+qar_render_frame_show_dirty_rects_ext_default(void)
+{
+	QarRenderFrameShowDirtyRectsExt ext = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_DIRTY_RECTS_EXT, NULL }, // header
+		{},																  // rects
+		0 // rects_count
+	};
+	return ext;
+}
+
+static inline QarRenderFrameShowOccupancyExt
+qar_render_frame_show_occupancy_ext_default(void)
+{
+	QarRenderFrameShowOccupancyExt ext = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_OCCUPANCY_EXT, NULL }, // header
+		{} // view_tile_masks
+	};
+	return ext;
+}
+
+static inline QarRenderSenderFoveationExt
+qar_render_sender_foveation_ext_default(void)
+{
+	QarRenderSenderFoveationExt ext = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_STREAM_SENDER_FOVEATION_EXT,
+		  NULL }, // header
+		0.5f,	  // fovea_fraction
+		2		  // periphery_downscale
+	};
+	return ext;
+}
+
+static inline QarRenderSenderFramesInFlightExt
+qar_render_sender_frames_in_flight_ext_default(void)
+{
+	QarRenderSenderFramesInFlightExt ext = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_SENDER_FRAMES_IN_FLIGHT_EXT,
+		  NULL }, // header
+		2		  // max_frames_in_flight
+	};
+	return ext;
+}
+
+static inline QarRenderSenderDynamicResolutionExt
+qar_render_sender_dynamic_resolution_ext_default(void)
+{
+	QarRenderSenderDynamicResolutionExt ext = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_SENDER_DYNAMIC_RESOLUTION_EXT,
+		  NULL }, // header
+		0.5f	  // min_resolution_scale
+	};
+	return ext;
+}
+
+static inline QarRenderSenderDepthEncodingExt
+qar_render_sender_depth_encoding_ext_default(void)
+{
+	QarRenderSenderDepthEncodingExt ext = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_SENDER_DEPTH_ENCODING_EXT,
+		  NULL },					    // header
+		QAR_DEPTH_ENCODING_REVERSED_Z16 // depth_encoding
+	};
+	return ext;
+}
+
+static inline QarRenderSenderTransparentTilesExt
+qar_render_sender_transparent_tiles_ext_default(void)
+{
+	QarRenderSenderTransparentTilesExt ext = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_SENDER_TRANSPARENT_TILES_EXT,
+		  NULL }, // header
+		true	  // skip_transparent_tiles
+	};
+	return ext;
+}
+
+static inline QarRenderSenderStats
+qar_render_sender_stats_default(void)
+{
+	QarRenderSenderStats stats = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_SENDER_STATS, NULL }, // header
+		0,													 // frames_shown
+		0,													 // frames_sent
+		0,													 // frames_dropped
+		0,													 // bytes_sent
+		0,													 // queue_depth
+		0.0f,												 // upstream_fps
+		0.0f,												 // downstream_fps
+		0.0f,												 // encode_time_ms
+		0.0f,												 // latency_ms
+		0.0f,												 // jitter_ms
+		0.0f,												 // pose_to_photon_ms
+		1.0f												 // resolution_scale
+	};
+	return stats;
+}
+
+static inline QarRenderFrameBegin
+qar_render_frame_begin_default(void)
+{
+	QarRenderFrameBegin frame = {
+		{ QAR_STRUCTURE_TYPE_RENDERING_BEGIN_FRAME,
+		  NULL }, // header
+		0,		  // frame_index
+		{ 0, 0 }, // predicted_display_time
+		{ 0, 0 }, // pose_sample_time
+		{ 0, 0 }, // prediction_horizon
+		0,		  // views_count
+		{},		  // view_poses
+		{},		  // view_fovs
+		{},		  // view_active_rects
+		1.0f	  // resolution_scale
+	};
+	return frame;
+}
+
 #ifdef QAR_ENABLE_D3D11
 static inline QarStreamParamsD3D11
 qar_stream_params_d3d11_default(void)
@@ -3490,7 +4634,15 @@ typedef void (*qar_gui_panel_update_callback_t)(
 	   QarGuiPanel * *out_handles,                                             \
 	   size_t handles_buffer_size,                                             \
 	   size_t* out_handles_written),                                           \
-	  (session, out_handles, handles_buffer_size, out_handles_written))
+	  (session, out_handles, handles_buffer_size, out_handles_written))        \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  gui_panels_poll_events,                                                  \
+	  (QarSession * session,                                                   \
+	   QarGuiPanelEvent * out_events,                                          \
+	   size_t capacity,                                                        \
+	   size_t* out_count),                                                     \
+	  (session, out_events, capacity, out_count))
 
 QAR_DECLARE_MODULE_COMMON(
 	GUI_PANELS, GuiPanels, gui_panels, QAR_GUI_PANELS_FUNCTION_LIST
@@ -3764,7 +4916,15 @@ typedef void (*qar_peer_update_callback_t)(
 	   qar_peer_update_callback_t callback,                                    \
 	   void* user_state,                                                       \
 	   QarCancelToken* token),                                                 \
-	  (session, callback, user_state, token))
+	  (session, callback, user_state, token))                                  \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  peer_poll_events,                                                        \
+	  (QarSession * session,                                                   \
+	   QarPeerEvent * out_events,                                              \
+	   size_t capacity,                                                        \
+	   size_t* out_count),                                                     \
+	  (session, out_events, capacity, out_count))
 
 QAR_DECLARE_MODULE_COMMON(
 	PEER_MANAGEMENT,
@@ -3918,7 +5078,85 @@ typedef void (*qar_render_sender_begin_frame_callback_t)(
 	  QarResult,                                                               \
 	  render_frame_info_get_view_fov,                                          \
 	  (QarRenderFrameInfo * handle, size_t view_index, QarFov* out_fov),       \
-	  (handle, view_index, out_fov))
+	  (handle, view_index, out_fov))                                           \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_sender_register_cpu_buffers,                                      \
+	  (QarRenderSender * stream, const QarRenderSenderCpuBufferRing* ring),    \
+	  (stream, ring))                                                          \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_sender_acquire_cpu_buffer,                                        \
+	  (QarRenderSender * stream,                                               \
+	   QarCancelToken * token,                                                 \
+	   QarVideoFrameCpu * out_frame,                                           \
+	   uint32_t * out_buffer_index),                                           \
+	  (stream, token, out_frame, out_buffer_index))                            \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_frame_info_get_frame_index,                                       \
+	  (QarRenderFrameInfo * handle, uint64_t * out_frame_index),               \
+	  (handle, out_frame_index))                                               \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_frame_info_get_predicted_display_time,                            \
+	  (QarRenderFrameInfo * handle, QarTimePoint * out_display_time),          \
+	  (handle, out_display_time))                                              \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_sender_get_stats,                                                 \
+	  (QarRenderSender * stream, QarRenderSenderStats * out_stats),            \
+	  (stream, out_stats))                                                     \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_frame_info_get_view_active_rect,                                  \
+	  (QarRenderFrameInfo * handle,                                            \
+	   size_t view_index,                                                      \
+	   QarRenderFrameViewRect * out_rect),                                     \
+	  (handle, view_index, out_rect))                                          \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_frame_info_get_resolution_scale,                                  \
+	  (QarRenderFrameInfo * handle, float* out_scale),                         \
+	  (handle, out_scale))                                                     \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_sender_begin_frame_ex,                                            \
+	  (QarRenderSender * stream,                                               \
+	   QarCancelToken * token,                                                 \
+	   QarRenderFrameBegin * out_frame),                                       \
+	  (stream, token, out_frame))                                              \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_frame_info_get_pose_sample_time,                                  \
+	  (QarRenderFrameInfo * handle, QarTimePoint * out_sample_time),           \
+	  (handle, out_sample_time))                                               \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_frame_info_get_prediction_horizon,                                \
+	  (QarRenderFrameInfo * handle, QarTimePoint * out_horizon),               \
+	  (handle, out_horizon))                                                   \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_sender_set_prediction_horizon,                                    \
+	  (QarRenderSender * stream, QarTimePoint horizon),                        \
+	  (stream, horizon))                                                       \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_sender_hands_since,                                               \
+	  (QarRenderSender * stream,                                               \
+	   QarTimePoint since,                                                     \
+	   QarDeviceHandsWithJoints * out_samples,                                 \
+	   size_t capacity,                                                        \
+	   size_t * out_count),                                                    \
+	  (stream, since, out_samples, capacity, out_count))                       \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  render_sender_sample_hands_at,                                           \
+	  (QarRenderSender * stream,                                               \
+	   QarTimePoint time,                                                      \
+	   QarDeviceHandsWithJoints * out_hands),                                  \
+	  (stream, time, out_hands))
 
 #ifdef QAR_ENABLE_D3D11
 #define QAR_RENDER_STREAM_SENDER_FUNCTION_LIST_D3D11(X)                        \
@@ -3959,8 +5197,6 @@ QAR_DECLARE_MODULE_IMPL_EXTERNS(QAR_RENDER_STREAM_SENDER_FUNCTION_LIST)
 QAR_RENDER_STREAM_SENDER_FUNCTION_LIST(QAR_RENDER_STREAM_SENDER_DECLARE_WRAPPER)
 
 #undef QAR_RENDER_STREAM_SENDER_DECLARE_WRAPPER
-#undef QAR_RENDER_STREAM_SENDER_FUNCTION_LIST_D3D11
-#undef QAR_RENDER_STREAM_SENDER_FUNCTION_LIST_BASE
 
 static inline bool
 qar_render_frame_info_handle_is_valid(QarRenderFrameInfo* handle)
@@ -3981,19 +5217,11 @@ qar_render_request_handle_is_valid(QarRenderStreamRequest* handle)
 
 
 #define QAR_RESULT_FUNCTION_LIST(X)                                            \
-	X(ACTIVE, QarResult, result_success, (void), ())                           \
 	X(ACTIVE,                                                                  \
 	  QarResult,                                                               \
 	  result_error,                                                            \
 	  (QarStatusCode code, const char* message),                               \
 	  (code, message))                                                         \
-	X(ACTIVE, bool, result_is_success, (QarResult result), (result))           \
-	X(ACTIVE, bool, result_is_error, (QarResult result), (result))             \
-	X(ACTIVE,                                                                  \
-	  bool,                                                                    \
-	  result_has_code,                                                         \
-	  (QarResult result, QarStatusCode code),                                  \
-	  (result, code))                                                          \
 	X(ACTIVE,                                                                  \
 	  QarResult,                                                               \
 	  error_wrap_result,                                                       \
@@ -4020,6 +5248,35 @@ QAR_RESULT_FUNCTION_LIST(QAR_RESULT_DECLARE_WRAPPER)
 
 #undef QAR_RESULT_DECLARE_WRAPPER
 
+// Constructing and testing a result only looks at its code, so these compile
+// to a single compare at the call site. Error construction and messages stay
+// in the runtime, which owns the error handles.
+
+static inline QAR_CONSTEXPR QarResult
+qar_result_success(void)
+{
+	QarResult result = { QAR_STATUS_SUCCESS, 0 };
+	return result;
+}
+
+static inline QAR_CONSTEXPR bool
+qar_result_is_success(QarResult result)
+{
+	return result.code == QAR_STATUS_SUCCESS;
+}
+
+static inline QAR_CONSTEXPR bool
+qar_result_is_error(QarResult result)
+{
+	return result.code != QAR_STATUS_SUCCESS;
+}
+
+static inline QAR_CONSTEXPR bool
+qar_result_has_code(QarResult result, QarStatusCode code)
+{
+	return result.code == code;
+}
+
 #endif // QAR_STREAMING_C_V0_DETAIL_RESULT_H
 
 #ifndef QAR_STREAMING_C_V0_DETAIL_RUNTIME_H
@@ -4061,7 +5318,12 @@ QAR_RUNTIME_FUNCTION_LIST(QAR_RUNTIME_DECLARE_WRAPPER)
 	  QarResult,                                                               \
 	  session_get_id,                                                          \
 	  (const QarSession* session, QarSessionId* out_session_id),               \
-	  (session, out_session_id))
+	  (session, out_session_id))                                               \
+	X(OPTIONAL,                                                                \
+	  QarResult,                                                               \
+	  session_enable_event_queues,                                             \
+	  (QarSession * session, const QarEventQueueInit* init),                   \
+	  (session, init))
 
 QAR_DECLARE_MODULE_COMMON(SESSION, Session, session, QAR_SESSION_FUNCTION_LIST);
 QAR_DECLARE_MODULE_IMPL_EXTERNS(QAR_SESSION_FUNCTION_LIST)
@@ -4077,6 +5339,63 @@ QAR_SESSION_FUNCTION_LIST(QAR_SESSION_DECLARE_WRAPPER)
 
 #endif // QAR_STREAMING_C_V0_DETAIL_SESSION_H
 
+#ifndef QAR_STREAMING_C_V0_DETAIL_DISPATCH_TABLE_H
+#define QAR_STREAMING_C_V0_DETAIL_DISPATCH_TABLE_H
+
+/**
+ * Layout version of QarDispatchTable. Bump it whenever an entry is added to,
+ * removed from or moved within any QAR_*_FUNCTION_LIST, so that runtimes
+ * built against another layout refuse the bulk request instead of handing
+ * out mismatched entries.
+ */
+#define QAR_DISPATCH_TABLE_VERSION 6u
+
+#define QAR_DISPATCH_FUNCTION_LIST(X)                                          \
+	QAR_RESULT_FUNCTION_LIST(X)                                                \
+	QAR_CANCELATION_TOKEN_FUNCTION_LIST(X)                                     \
+	QAR_RUNTIME_FUNCTION_LIST(X)                                               \
+	QAR_SESSION_FUNCTION_LIST(X)                                               \
+	QAR_ONBOARDING_FUNCTION_LIST(X)                                            \
+	QAR_PEER_MANAGEMENT_FUNCTION_LIST(X)                                       \
+	QAR_RENDER_STREAM_SENDER_FUNCTION_LIST(X)                                  \
+	QAR_GUI_PANELS_FUNCTION_LIST(X)                                            \
+	QAR_APP_VOLUMES_FUNCTION_LIST(X)                                           \
+	QAR_TYPES_FUNCTION_LIST(X)
+
+/**
+ * Every entry point of every module, in one contiguous table. The modules
+ * follow each other in QAR_DISPATCH_FUNCTION_LIST order, each laid out like
+ * its own function list.
+ */
+typedef struct QarDispatchTable
+{
+	QAR_DISPATCH_FUNCTION_LIST(QAR_DECLARE_LOADED_FIELD_EX)
+} QarDispatchTable;
+
+enum
+{
+	QAR_DISPATCH_FUNC_COUNT =
+		(int)(sizeof(QarDispatchTable) / sizeof(void (*)(void)))
+};
+
+static const bool qar_dispatch_symbol_required[] = {
+	QAR_DISPATCH_FUNCTION_LIST(QAR_DECLARE_SYMBOL_REQUIRED_EX)
+};
+
+/**
+ * Fill \p out_table with the runtime's entry points in one call.
+ *
+ * Loaders try this before resolving every qar_impl_* symbol by name.
+ * Returns QAR_STATUS_ARGUMENT_NOT_SUPPORTED when \p version or
+ * \p table_size does not match the layout the runtime was built with, in
+ * which case the loader falls back to per-symbol lookup.
+ */
+QAR_C_API QarResult qar_impl_get_dispatch_table(
+	uint32_t version, QarDispatchTable* out_table, size_t table_size
+);
+
+#endif // QAR_STREAMING_C_V0_DETAIL_DISPATCH_TABLE_H
+
 
 #ifdef QAR_ENABLE_DYNAMIC_LOADING
 #ifndef QAR_DYNAMIC_LOADING_H
@@ -4130,32 +5449,56 @@ qar_load_symbol(QAR_DLL_HANDLE_TYPE handle, const char* name)
 	return (void*)GetProcAddress(handle, name);
 }
 
+#ifdef QAR_ENABLE_LAZY_LOADING
+typedef SRWLOCK QAR_LAZY_LOCK_TYPE;
+#define QAR_LAZY_LOCK_INIT SRWLOCK_INIT
+#define qar_lazy_lock(LOCK) AcquireSRWLockExclusive(LOCK)
+#define qar_lazy_unlock(LOCK) ReleaseSRWLockExclusive(LOCK)
+#endif
+
 #else
 
 #include <dlfcn.h>
-#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef QAR_ENABLE_LAZY_LOADING
+#include <pthread.h>
+typedef pthread_mutex_t QAR_LAZY_LOCK_TYPE;
+#define QAR_LAZY_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+#define qar_lazy_lock(LOCK) pthread_mutex_lock(LOCK)
+#define qar_lazy_unlock(LOCK) pthread_mutex_unlock(LOCK)
+#endif
+
 typedef void* QAR_DLL_HANDLE_TYPE;
 
 static inline void*
 qar_loadlib(const char* path)
 {
-	char* abs_path = realpath(path, NULL);
-	if(abs_path == NULL)
+	// Like GetFullPathName on Windows, a bare file name refers to the working
+	// directory instead of the library search path. Plain C11 has no
+	// realpath, so prefix "./" and let dlopen resolve the rest.
+	char* local_path = NULL;
+	if(strchr(path, '/') == NULL)
 	{
-		printf("realpath failed for '%s': %s\n", path, strerror(errno));
-		return NULL;
+		size_t length = strlen(path);
+		local_path = (char*)malloc(length + 3);
+		if(local_path == NULL)
+		{
+			return NULL;
+		}
+		memcpy(local_path, "./", 2);
+		memcpy(local_path + 2, path, length + 1);
+		path = local_path;
 	}
 
-	void* handle = dlopen(abs_path, RTLD_NOW | RTLD_LOCAL);
+	void* handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
 	if(handle == NULL)
 	{
-		printf("dlopen failed for '%s': %s\n", abs_path, dlerror());
+		printf("dlopen failed for '%s': %s\n", path, dlerror());
 	}
 
-	free(abs_path);
+	free(local_path);
 	return handle;
 }
 
@@ -4190,6 +5533,78 @@ qar_load_symbol(QAR_DLL_HANDLE_TYPE handle, const char* name)
 
 extern QAR_DLL_HANDLE_TYPE g_qar_dynamic_library_handle;
 
+#if defined(QAR_ENABLE_LAZY_LOADING) && defined(QAR_ENABLE_DISPATCH_TABLE)
+#error "QAR_ENABLE_LAZY_LOADING and QAR_ENABLE_DISPATCH_TABLE are exclusive"
+#endif
+
+#ifdef QAR_ENABLE_LAZY_LOADING
+extern QAR_LAZY_LOCK_TYPE g_qar_lazy_load_lock;
+#define QAR_DEFINE_LAZY_LOADING_STORAGE()                                      \
+	QAR_LAZY_LOCK_TYPE g_qar_lazy_load_lock = QAR_LAZY_LOCK_INIT;
+#else
+#define QAR_DEFINE_LAZY_LOADING_STORAGE()
+#endif
+
+#ifdef QAR_ENABLE_DISPATCH_TABLE
+
+#ifndef QAR_CACHE_LINE_SIZE
+#define QAR_CACHE_LINE_SIZE 64
+#endif
+
+#ifdef __cplusplus
+#define QAR_ALIGNAS(N) alignas(N)
+#else
+#define QAR_ALIGNAS(N) _Alignas(N)
+#endif
+
+/*
+ * qar_library_load() resolves all symbols before publishing the table, so
+ * every required entry is either set or the whole table is NULL, and it is
+ * not written again until qar_library_unload(). The wrappers of required
+ * entries therefore skip the per-call NULL check and compile to a single
+ * indirect call. Calling the API while the library is not loaded
+ * dereferences NULL instead of aborting with a diagnostic. OPTIONAL entries
+ * the runtime does not provide stay NULL and keep their check.
+ *
+ * The table is writable memory and read-only by convention only:
+ * applications must never write it, as every later call goes through it.
+ */
+extern QarDispatchTable g_qar_dispatch_table;
+
+static const char* const qar_dispatch_symbol_names[] = {
+	QAR_DISPATCH_FUNCTION_LIST(QAR_DECLARE_SYMBOL_NAME_EX)
+};
+
+#define QAR_DISPATCH_CHECK_ACTIVE(NAME)
+#define QAR_DISPATCH_CHECK_DEPRECATED(NAME)
+#define QAR_DISPATCH_CHECK_OPTIONAL(NAME)                                      \
+	if(g_qar_dispatch_table.NAME == NULL)                                      \
+	{                                                                          \
+		QAR_API_MISSING_OPTIONAL("qar_" #NAME, "dispatch")                     \
+	}
+
+#define QAR_DECLARE_DISPATCH_WRAPPER_EX(STATUS, RET, NAME, PARAMS, ARGS)       \
+	QAR_WRAPPER_ATTR_##STATUS static inline RET qar_##NAME PARAMS              \
+	{                                                                          \
+		QAR_DISPATCH_CHECK_##STATUS(NAME)                                      \
+		return g_qar_dispatch_table.NAME ARGS;                                 \
+	}
+
+QAR_DISPATCH_FUNCTION_LIST(QAR_DECLARE_DISPATCH_WRAPPER_EX)
+
+#undef QAR_DECLARE_DISPATCH_WRAPPER_EX
+#undef QAR_DISPATCH_CHECK_OPTIONAL
+#undef QAR_DISPATCH_CHECK_DEPRECATED
+#undef QAR_DISPATCH_CHECK_ACTIVE
+
+// Aligned so the hot entries start on a cache line of their own.
+#define QAR_IMPLEMENT_DYNAMIC_LOADING()                                        \
+	QAR_ALIGNAS(QAR_CACHE_LINE_SIZE)                                           \
+	QarDispatchTable g_qar_dispatch_table = { 0 };                             \
+	QAR_DLL_HANDLE_TYPE g_qar_dynamic_library_handle = NULL;
+
+#else
+
 #define QAR_IMPLEMENT_DYNAMIC_LOADING()                                        \
 	QAR_DEFINE_MODULE_STORAGE(Result, result);                                 \
 	QAR_DEFINE_MODULE_STORAGE(CancelationToken, cancelation_token);            \
@@ -4201,15 +5616,21 @@ extern QAR_DLL_HANDLE_TYPE g_qar_dynamic_library_handle;
 	QAR_DEFINE_MODULE_STORAGE(GuiPanels, gui_panels);                          \
 	QAR_DEFINE_MODULE_STORAGE(AppVolumes, app_volumes);                        \
 	QAR_DEFINE_MODULE_STORAGE(Types, types);                                   \
+	QAR_DEFINE_LAZY_LOADING_STORAGE()                                          \
 	QAR_DLL_HANDLE_TYPE g_qar_dynamic_library_handle = NULL;
 
+#endif
+
 typedef void (*qar_generic_func_t)(void);
 
+/* Resolves every symbol of a module by name. Optional symbols the runtime
+ * does not export are left NULL; a missing required one fails the module. */
 static inline bool
 qar_load_module_symbols(
 	QAR_DLL_HANDLE_TYPE library_handle,
 	const char* module_name,
 	const char* const* symbol_names,
+	const bool* symbol_required,
 	size_t symbol_count,
 	qar_generic_func_t* out_functions
 )
@@ -4219,7 +5640,7 @@ qar_load_module_symbols(
 		out_functions[index] = (qar_generic_func_t)qar_load_symbol(
 			library_handle, symbol_names[index]
 		);
-		if(out_functions[index] == NULL)
+		if(out_functions[index] == NULL && symbol_required[index])
 		{
 			fprintf(
 				stderr,
@@ -4243,11 +5664,66 @@ qar_clear_module_symbols(size_t symbol_count, qar_generic_func_t* out_functions)
 	}
 }
 
+typedef QarResult (*qar_get_dispatch_table_func_t)(
+	uint32_t version, QarDispatchTable* out_table, size_t table_size
+);
+
+/* Resolves the whole table with one symbol lookup. Returns false for
+ * runtimes that predate qar_impl_get_dispatch_table or were built with
+ * another table layout; the caller then resolves every symbol by name. */
+static inline bool
+qar_load_dispatch_table(
+	QAR_DLL_HANDLE_TYPE library_handle, QarDispatchTable* out_table
+)
+{
+	qar_get_dispatch_table_func_t get_dispatch_table =
+		(qar_get_dispatch_table_func_t)qar_load_symbol(
+			library_handle, "qar_impl_get_dispatch_table"
+		);
+	if(get_dispatch_table == NULL)
+	{
+		return false;
+	}
+
+	QarResult result = get_dispatch_table(
+		QAR_DISPATCH_TABLE_VERSION, out_table, sizeof(*out_table)
+	);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return false;
+	}
+
+	const qar_generic_func_t* functions = (const qar_generic_func_t*)out_table;
+	for(size_t index = 0; index < QAR_DISPATCH_FUNC_COUNT; index++)
+	{
+		if(functions[index] == NULL && qar_dispatch_symbol_required[index])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static inline void
+qar_copy_module_symbols(
+	size_t symbol_count,
+	const qar_generic_func_t* functions,
+	qar_generic_func_t* out_functions
+)
+{
+	for(size_t index = 0; index < symbol_count; index++)
+	{
+		out_functions[index] = functions[index];
+	}
+}
+
 #define QAR_LOAD_MODULE_ENTRY(MODULE_UPPER, MODULE_CAMEL, MODULE_LOWER)        \
 	if(!qar_load_module_symbols(                                               \
 		   g_qar_dynamic_library_handle,                                       \
 		   #MODULE_LOWER,                                                      \
 		   qar_##MODULE_LOWER##_symbol_names,                                  \
+		   qar_##MODULE_LOWER##_symbol_required,                               \
 		   QAR_##MODULE_UPPER##_FUNC_COUNT,                                    \
 		   (qar_generic_func_t*)&g_qar_##MODULE_LOWER##_api                    \
 	   ))                                                                      \
@@ -4255,6 +5731,85 @@ qar_clear_module_symbols(size_t symbol_count, qar_generic_func_t* out_functions)
 		goto cleanup;                                                          \
 	}
 
+#ifdef QAR_ENABLE_LAZY_LOADING
+
+typedef struct QarLazyModule
+{
+	const char* name;
+	const char* const* symbol_names;
+	const bool* symbol_required;
+	size_t symbol_count;
+	qar_generic_func_t* functions;
+} QarLazyModule;
+
+#define QAR_LAZY_MODULE_ENTRY(MODULE_UPPER, MODULE_CAMEL, MODULE_LOWER)        \
+	{ #MODULE_LOWER,                                                           \
+	  qar_##MODULE_LOWER##_symbol_names,                                       \
+	  qar_##MODULE_LOWER##_symbol_required,                                    \
+	  QAR_##MODULE_UPPER##_FUNC_COUNT,                                         \
+	  (qar_generic_func_t*)&g_qar_##MODULE_LOWER##_api },
+
+/* Called by a wrapper that found its entry NULL. Each module table is
+ * resolved at most once per qar_library_load(), under the lock, into a
+ * scratch table first so that it is published complete or not at all. */
+static inline bool
+qar_load_module_lazily(void* module_api)
+{
+	static const QarLazyModule modules[] = {
+		QAR_DYNAMIC_MODULE_LIST(QAR_LAZY_MODULE_ENTRY)
+	};
+
+	QarDispatchTable scratch;
+	qar_generic_func_t* resolved = (qar_generic_func_t*)&scratch;
+	bool loaded = false;
+	qar_lazy_lock(&g_qar_lazy_load_lock);
+	for(size_t index = 0; index < sizeof(modules) / sizeof(modules[0]);
+		index++)
+	{
+		const QarLazyModule* module = &modules[index];
+		if((void*)module->functions != module_api)
+		{
+			continue;
+		}
+		if(g_qar_dynamic_library_handle == NULL)
+		{
+			break;
+		}
+		loaded = module->functions[0] != NULL;
+		if(!loaded
+		   && qar_load_module_symbols(
+			   g_qar_dynamic_library_handle,
+			   module->name,
+			   module->symbol_names,
+			   module->symbol_required,
+			   module->symbol_count,
+			   resolved
+		   ))
+		{
+			for(size_t entry = 0; entry < module->symbol_count; entry++)
+			{
+				QAR_STORE_RELEASE(&module->functions[entry], resolved[entry]);
+			}
+			loaded = true;
+		}
+		break;
+	}
+	qar_lazy_unlock(&g_qar_lazy_load_lock);
+	return loaded;
+}
+
+#undef QAR_LAZY_MODULE_ENTRY
+
+#endif
+
+#define QAR_COPY_MODULE_ENTRY(MODULE_UPPER, MODULE_CAMEL, MODULE_LOWER)        \
+	qar_copy_module_symbols(                                                   \
+		QAR_##MODULE_UPPER##_FUNC_COUNT,                                       \
+		functions,                                                             \
+		(qar_generic_func_t*)&g_qar_##MODULE_LOWER##_api                       \
+	);                                                                         \
+	functions += QAR_##MODULE_UPPER##_FUNC_COUNT;
+
 #define QAR_CLEAR_MODULE_ENTRY(MODULE_UPPER, MODULE_CAMEL, MODULE_LOWER)       \
 	qar_clear_module_symbols(                                                  \
 		QAR_##MODULE_UPPER##_FUNC_COUNT,                                       \
@@ -4275,19 +5830,64 @@ qar_library_load(const char* library_path)
 		return false;
 	}
 
-	QAR_DYNAMIC_MODULE_LIST(QAR_LOAD_MODULE_ENTRY);
+#ifdef QAR_ENABLE_LAZY_LOADING
+	// Modules are resolved on their first call; a runtime missing a symbol
+	// is reported then instead of failing the load.
+	return true;
+#else
+	QarDispatchTable loaded;
+	bool bulk_loaded =
+		qar_load_dispatch_table(g_qar_dynamic_library_handle, &loaded);
+
+#ifdef QAR_ENABLE_DISPATCH_TABLE
+	if(!bulk_loaded
+	   && !qar_load_module_symbols(
+		   g_qar_dynamic_library_handle,
+		   "dispatch",
+		   qar_dispatch_symbol_names,
+		   qar_dispatch_symbol_required,
+		   QAR_DISPATCH_FUNC_COUNT,
+		   (qar_generic_func_t*)&loaded
+	   ))
+	{
+		goto cleanup;
+	}
+	g_qar_dispatch_table = loaded;
+#else
+	if(bulk_loaded)
+	{
+		const qar_generic_func_t* functions =
+			(const qar_generic_func_t*)&loaded;
+		QAR_DYNAMIC_MODULE_LIST(QAR_COPY_MODULE_ENTRY);
+	}
+	else
+	{
+		QAR_DYNAMIC_MODULE_LIST(QAR_LOAD_MODULE_ENTRY);
+	}
+#endif
 
 	return true;
 
 cleanup:
 	qar_library_unload();
 	return false;
+#endif
 }
 
 static inline void
 qar_library_unload(void)
 {
+#ifdef QAR_ENABLE_DISPATCH_TABLE
+	qar_clear_module_symbols(
+		QAR_DISPATCH_FUNC_COUNT, (qar_generic_func_t*)&g_qar_dispatch_table
+	);
+#elif defined(QAR_ENABLE_LAZY_LOADING)
+	qar_lazy_lock(&g_qar_lazy_load_lock);
+	QAR_DYNAMIC_MODULE_LIST(QAR_CLEAR_MODULE_ENTRY);
+	qar_lazy_unlock(&g_qar_lazy_load_lock);
+#else
 	QAR_DYNAMIC_MODULE_LIST(QAR_CLEAR_MODULE_ENTRY);
+#endif
 
 	if(g_qar_dynamic_library_handle != NULL)
 	{
@@ -4303,6 +5903,7 @@ qar_is_library_loaded(void)
 }
 
 #undef QAR_CLEAR_MODULE_ENTRY
+#undef QAR_COPY_MODULE_ENTRY
 #undef QAR_LOAD_MODULE_ENTRY
 #undef QAR_DYNAMIC_MODULE_LIST
 
@@ -0,0 +1,406 @@
+/**
+ * @file qar_streaming.hpp
+ * @brief Header-only C++17 RAII layer over qar_streaming.h.
+ *
+ * Every type here is a thin value wrapper around the C API: owning handles
+ * are a single pointer that calls the matching `*_handle_destroy` (or
+ * qar_runtime_destroy) when it goes out of scope, and results and texture
+ * views are the C structs themselves. Nothing allocates and every call
+ * inlines to the same C wrapper call, so the wrappers are safe to use on the
+ * frame loop.
+ *
+ * Owning handles plug into the C out-parameters through put():
+ *
+ * @code
+ * qar::RenderSender sender;
+ * qar::Result result =
+ *     qar_render_sender_create(session.get(), &init, nullptr, sender.put());
+ * @endcode
+ *
+ * Include this header instead of qar_streaming.h; QAR_IMPLEMENT_DYNAMIC_LOADING
+ * and the other C macros keep working unchanged.
+ */
+#ifndef QAR_STREAMING_HPP
+#define QAR_STREAMING_HPP
+
+#include "qar_streaming.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+#include <span>
+#endif
+
+namespace qar
+{
+
+// ============================================================================
+// RESULTS
+// ============================================================================
+
+/** @brief QarResult that cannot be silently dropped. */
+class [[nodiscard]] Result
+{
+public:
+	constexpr Result() noexcept
+		: m_result{ QAR_STATUS_SUCCESS, 0 }
+	{
+	}
+
+	constexpr Result(QarResult result) noexcept
+		: m_result(result)
+	{
+	}
+
+	constexpr bool ok() const noexcept
+	{
+		return qar_result_is_success(m_result);
+	}
+	constexpr explicit operator bool() const noexcept { return ok(); }
+
+	constexpr QarStatusCode code() const noexcept { return m_result.code; }
+	constexpr bool has_code(QarStatusCode code) const noexcept
+	{
+		return qar_result_has_code(m_result, code);
+	}
+
+	/** @brief Copy the error message into `out_buffer` (NUL-terminated). */
+	void message(char* out_buffer, std::size_t buffer_size) const noexcept
+	{
+		qar_result_message(m_result, out_buffer, buffer_size);
+	}
+
+	/** @brief Log and return whether the result was an error. */
+	bool log_if_error() const noexcept
+	{
+		qar_result_log_if_error(m_result);
+		return !ok();
+	}
+
+	const QarResult& c() const noexcept { return m_result; }
+	operator QarResult() const noexcept { return m_result; }
+
+private:
+	QarResult m_result;
+};
+
+// ============================================================================
+// OWNING HANDLES
+// ============================================================================
+
+/** @brief Destroy policy for each opaque handle type. */
+template<typename T>
+struct HandleTraits;
+
+#define QAR_CPP_DECLARE_HANDLE_TRAITS(TYPE, DESTROY)                           \
+	template<>                                                                 \
+	struct HandleTraits<TYPE>                                                  \
+	{                                                                          \
+		static void destroy(TYPE* handle) noexcept { DESTROY(handle); }        \
+	};
+
+QAR_CPP_DECLARE_HANDLE_TRAITS(QarCancelToken, qar_cancel_token_handle_destroy)
+QAR_CPP_DECLARE_HANDLE_TRAITS(QarRuntime, qar_runtime_destroy)
+QAR_CPP_DECLARE_HANDLE_TRAITS(QarSession, qar_session_handle_destroy)
+QAR_CPP_DECLARE_HANDLE_TRAITS(
+	QarOnboardingInvite, qar_onboarding_invite_handle_destroy
+)
+QAR_CPP_DECLARE_HANDLE_TRAITS(QarAppVolume, qar_app_volume_handle_destroy)
+QAR_CPP_DECLARE_HANDLE_TRAITS(QarGuiPanel, qar_gui_panel_handle_destroy)
+QAR_CPP_DECLARE_HANDLE_TRAITS(QarPeerSpec, qar_peer_spec_handle_destroy)
+QAR_CPP_DECLARE_HANDLE_TRAITS(QarRenderSender, qar_render_stream_handle_destroy)
+QAR_CPP_DECLARE_HANDLE_TRAITS(
+	QarRenderStreamRequest, qar_render_request_handle_destroy
+)
+QAR_CPP_DECLARE_HANDLE_TRAITS(
+	QarRenderFrameInfo, qar_render_frame_info_handle_destroy
+)
+
+#undef QAR_CPP_DECLARE_HANDLE_TRAITS
+
+/**
+ * @brief Move-only owner of one opaque C handle.
+ *
+ * Same size as the raw pointer. Destroys the handle on reset() and in the
+ * destructor; release() hands ownership back to C code.
+ */
+template<typename T>
+class [[nodiscard]] UniqueHandle
+{
+public:
+	constexpr UniqueHandle() noexcept = default;
+	constexpr explicit UniqueHandle(T* handle) noexcept
+		: m_handle(handle)
+	{
+	}
+
+	UniqueHandle(const UniqueHandle&) = delete;
+	UniqueHandle& operator=(const UniqueHandle&) = delete;
+
+	UniqueHandle(UniqueHandle&& other) noexcept
+		: m_handle(other.release())
+	{
+	}
+
+	UniqueHandle& operator=(UniqueHandle&& other) noexcept
+	{
+		if(this != &other)
+		{
+			reset(other.release());
+		}
+		return *this;
+	}
+
+	~UniqueHandle() { reset(); }
+
+	T* get() const noexcept { return m_handle; }
+	explicit operator bool() const noexcept { return m_handle != nullptr; }
+
+	/** @brief Give up ownership without destroying the handle. */
+	[[nodiscard]] T* release() noexcept
+	{
+		return std::exchange(m_handle, nullptr);
+	}
+
+	void reset(T* handle = nullptr) noexcept
+	{
+		T* old = std::exchange(m_handle, handle);
+		if(old != nullptr)
+		{
+			HandleTraits<T>::destroy(old);
+		}
+	}
+
+	/**
+	 * @brief Destroy the current handle and return the slot for a C
+	 * `T** out_*` parameter.
+	 */
+	T** put() noexcept
+	{
+		reset();
+		return &m_handle;
+	}
+
+private:
+	T* m_handle = nullptr;
+};
+
+using CancelToken = UniqueHandle<QarCancelToken>;
+/** @brief Owns a runtime; destruction shuts it down (qar_runtime_destroy). */
+using Runtime = UniqueHandle<QarRuntime>;
+using Session = UniqueHandle<QarSession>;
+using OnboardingInvite = UniqueHandle<QarOnboardingInvite>;
+using AppVolume = UniqueHandle<QarAppVolume>;
+using GuiPanel = UniqueHandle<QarGuiPanel>;
+using PeerSpec = UniqueHandle<QarPeerSpec>;
+using RenderSender = UniqueHandle<QarRenderSender>;
+using RenderStreamRequest = UniqueHandle<QarRenderStreamRequest>;
+using RenderFrameInfo = UniqueHandle<QarRenderFrameInfo>;
+
+static_assert(
+	sizeof(RenderSender) == sizeof(QarRenderSender*),
+	"owning handles must stay pointer-sized"
+);
+
+// ============================================================================
+// SPANS
+// ============================================================================
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+template<typename T>
+using span = std::span<T>;
+#else
+/** @brief Minimal stand-in for std::span<T> on C++17 standard libraries. */
+template<typename T>
+class span
+{
+public:
+	using element_type = T;
+	using value_type = std::remove_cv_t<T>;
+	using size_type = std::size_t;
+	using pointer = T*;
+	using reference = T&;
+	using iterator = T*;
+
+	constexpr span() noexcept = default;
+	constexpr span(T* data, std::size_t size) noexcept
+		: m_data(data)
+		, m_size(size)
+	{
+	}
+	template<
+		typename U,
+		typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+	constexpr span(const span<U>& other) noexcept
+		: m_data(other.data())
+		, m_size(other.size())
+	{
+	}
+
+	constexpr T* data() const noexcept { return m_data; }
+	constexpr std::size_t size() const noexcept { return m_size; }
+	constexpr std::size_t size_bytes() const noexcept
+	{
+		return m_size * sizeof(T);
+	}
+	constexpr bool empty() const noexcept { return m_size == 0; }
+	constexpr T& operator[](std::size_t index) const noexcept
+	{
+		return m_data[index];
+	}
+	constexpr T* begin() const noexcept { return m_data; }
+	constexpr T* end() const noexcept { return m_data + m_size; }
+
+	constexpr span subspan(std::size_t offset, std::size_t count) const noexcept
+	{
+		return span(m_data + offset, count);
+	}
+
+private:
+	T* m_data = nullptr;
+	std::size_t m_size = 0;
+};
+#endif
+
+/** @brief Pixel view over one QarVideoTextureCpu; rows honor the pitch. */
+class TextureView
+{
+public:
+	TextureView() noexcept = default;
+	explicit TextureView(const QarVideoTextureCpu& texture) noexcept
+		: m_texture(texture)
+	{
+	}
+
+	std::uint32_t width() const noexcept { return m_texture.size.width; }
+	std::uint32_t height() const noexcept { return m_texture.size.height; }
+	std::uint32_t pitch() const noexcept { return m_texture.pitch; }
+	QarPixelFormat format() const noexcept { return m_texture.size.format; }
+
+	/** @brief The whole buffer, including row padding. */
+	span<std::uint8_t> bytes() const noexcept
+	{
+		return { m_texture.texture_data, m_texture.texture_data_size };
+	}
+
+	/** @brief Row `y` without padding (width * pixel size bytes). */
+	span<std::uint8_t> row(std::uint32_t y) const noexcept
+	{
+		return { m_texture.texture_data + std::size_t(y) * m_texture.pitch,
+				 std::size_t(m_texture.size.width)
+					 * qar_pixel_format_size(m_texture.size.format) };
+	}
+
+	/**
+	 * @brief Row `y` as pixels of type `P`, e.g. std::uint32_t for RGBA8 or
+	 * float for R32/D32. `sizeof(P)` must match the pixel size.
+	 */
+	template<typename P>
+	span<P> row_as(std::uint32_t y) const noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<P>, "P must be a pixel type");
+		return { reinterpret_cast<P*>(
+					 m_texture.texture_data + std::size_t(y) * m_texture.pitch
+				 ),
+				 m_texture.size.width };
+	}
+
+	const QarVideoTextureCpu& c() const noexcept { return m_texture; }
+
+private:
+	QarVideoTextureCpu m_texture = qar_video_texture_cpu_default();
+};
+
+/** @brief The valid textures of a CPU frame. */
+inline span<QarVideoTextureCpu>
+textures(QarVideoFrameCpu& frame) noexcept
+{
+	return { frame.textures, frame.textures_count };
+}
+
+/** @brief The valid views of a CPU frame. */
+inline span<const QarVideoFrameView>
+views(const QarVideoFrameCpu& frame) noexcept
+{
+	return { frame.texture_views, frame.texture_views_count };
+}
+
+/** @brief Pixel view of texture `index` of a CPU frame. */
+inline TextureView
+texture(const QarVideoFrameCpu& frame, std::size_t index) noexcept
+{
+	return TextureView(frame.textures[index]);
+}
+
+// ============================================================================
+// FRAME LOOP
+// ============================================================================
+
+/** @brief qar_render_sender_begin_frame into an owning frame info. */
+inline Result
+begin_frame(
+	QarRenderSender* sender,
+	RenderFrameInfo& out_frame_info,
+	QarCancelToken* token = nullptr
+) noexcept
+{
+	return qar_render_sender_begin_frame(sender, token, out_frame_info.put());
+}
+
+/** @brief qar_render_sender_begin_frame_ex into a value. */
+inline Result
+begin_frame(
+	QarRenderSender* sender,
+	QarRenderFrameBegin& out_frame,
+	QarCancelToken* token = nullptr
+) noexcept
+{
+	out_frame = qar_render_frame_begin_default();
+	return qar_render_sender_begin_frame_ex(sender, token, &out_frame);
+}
+
+/** @brief The valid view poses of a begun frame. */
+inline span<const QarPose>
+view_poses(const QarRenderFrameBegin& frame) noexcept
+{
+	return { frame.view_poses, frame.views_count };
+}
+
+/** @brief The valid view FOVs of a begun frame. */
+inline span<const QarFov>
+view_fovs(const QarRenderFrameBegin& frame) noexcept
+{
+	return { frame.view_fovs, frame.views_count };
+}
+
+/** @brief qar_render_sender_frame_cpu. */
+inline Result
+frame_cpu(QarRenderSender* sender, QarVideoFrameCpu& out_frame) noexcept
+{
+	return qar_render_sender_frame_cpu(sender, &out_frame);
+}
+
+/** @brief qar_render_sender_show_frame. */
+inline Result
+show_frame(QarRenderSender* sender, const QarRenderFrameShow& show) noexcept
+{
+	return qar_render_sender_show_frame(sender, &show);
+}
+
+/** @brief qar_render_sender_get_stats into a value. */
+inline Result
+get_stats(QarRenderSender* sender, QarRenderSenderStats& out_stats) noexcept
+{
+	out_stats = qar_render_sender_stats_default();
+	return qar_render_sender_get_stats(sender, &out_stats);
+}
+
+} // namespace qar
+
+#endif // QAR_STREAMING_HPP
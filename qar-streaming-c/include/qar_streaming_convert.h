@@ -0,0 +1,724 @@
+/**
+ * @file qar_streaming_convert.h
+ * @brief Header-only pixel format conversion kernels for the CPU render path.
+ *
+ * Converts application render targets into the formats accepted by
+ * QarRenderSenderInit (see QarPixelFormat). The kernels write straight into a
+ * QarVideoTextureCpu obtained from qar_render_sender_frame_cpu or
+ * qar_render_sender_acquire_cpu_buffer, so the conversion doubles as the
+ * final copy into the frame. Source and destination rows honor each
+ * texture's `pitch`; only the first array layer is converted.
+ *
+ * The SIMD path is selected at compile time: AVX2 (F16C is used for half
+ * floats when available), SSE4.1, or NEON on AArch64, with a scalar fallback
+ * for everything else. Define QAR_CONVERT_NO_SIMD to force the scalar path.
+ */
+#ifndef QAR_STREAMING_CONVERT_H
+#define QAR_STREAMING_CONVERT_H
+
+#include "qar_streaming.h"
+
+#include <string.h>
+
+#ifndef QAR_CONVERT_NO_SIMD
+#if defined(__AVX2__)
+#define QAR_CONVERT_AVX2
+#include <immintrin.h>
+#if defined(__F16C__) || defined(_MSC_VER)
+#define QAR_CONVERT_F16C
+#endif
+#elif defined(__SSE4_1__)
+#define QAR_CONVERT_SSE41
+#include <smmintrin.h>
+#if defined(__F16C__)
+#define QAR_CONVERT_F16C
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define QAR_CONVERT_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @defgroup qar_c_convert Pixel Conversion
+ * @ingroup qar_c_api
+ * @brief Pitch-aware conversion of render targets into stream textures.
+ *
+ * Every kernel converts the whole `src` image into `dst` at pixel offset
+ * (`dst_x`, `dst_y`), e.g. the `start_x`/`start_y` of a QarVideoFrameView in a
+ * side-by-side texture. They return false without writing anything when a
+ * format is not supported by the kernel, a pointer is NULL, or the image does
+ * not fit into `dst`.
+ * @{ */
+
+/**
+ * @brief Linear RGBA16F -> 8-bit sRGB color.
+ *
+ * `src` must be QAR_PIXEL_FORMAT_R16G16B16A16 holding IEEE half floats in
+ * linear space. `dst` may be QAR_PIXEL_FORMAT_R8G8B8A8 or
+ * QAR_PIXEL_FORMAT_B8G8R8A8; the swizzle is fused into the conversion. Color
+ * channels are clamped to [0, 1] and sRGB encoded (max error 0.544 LSB
+ * against the exact curve); alpha stays linear.
+ */
+static inline bool qar_convert_rgba16f_to_srgb8(
+	const QarVideoTextureCpu* src,
+	QarVideoTextureCpu* dst,
+	uint32_t dst_x,
+	uint32_t dst_y
+);
+
+/**
+ * @brief Copy 8-bit RGBA/BGRA pixels, swapping R and B when the formats
+ * differ.
+ *
+ * `src` and `dst` may each be QAR_PIXEL_FORMAT_R8G8B8A8 or
+ * QAR_PIXEL_FORMAT_B8G8R8A8. Converting a texture onto itself (same data and
+ * offset 0) swizzles in place.
+ */
+static inline bool qar_convert_swizzle_rgba8(
+	const QarVideoTextureCpu* src,
+	QarVideoTextureCpu* dst,
+	uint32_t dst_x,
+	uint32_t dst_y
+);
+
+/**
+ * @brief Hardware depth -> linear view depth in meters.
+ *
+ * `src` may be QAR_PIXEL_FORMAT_D32_FLOAT or QAR_PIXEL_FORMAT_R32_FLOAT and
+ * holds [0, 1] depth from a conventional (non-reversed) projection built with
+ * `near_far`, so 0 maps to near_plane and 1 to far_plane. `dst` must be
+ * QAR_PIXEL_FORMAT_R32_FLOAT. Converting a texture onto itself is allowed.
+ */
+static inline bool qar_convert_depth_to_linear(
+	const QarVideoTextureCpu* src,
+	QarNearFar near_far,
+	QarVideoTextureCpu* dst,
+	uint32_t dst_x,
+	uint32_t dst_y
+);
+
+/** @brief Decode one IEEE 754 half float. */
+static inline float qar_convert_half_to_float(uint16_t half);
+
+/** @brief Encode one linear value in [0, 1] as an 8-bit sRGB value. */
+static inline uint8_t qar_convert_linear_to_srgb8(float linear);
+
+/** @} */ /* end of qar_c_convert */
+
+// ============================================================================
+// IMPLEMENTATION
+// ============================================================================
+
+/* Piecewise-linear fit of the sRGB curve, 8 buckets per binade over
+ * [2^-13, 1). Upper 16 bits: bias (scaled by 2^9), lower 16 bits: slope. */
+static const uint32_t qar_convert_srgb8_table[104] = {
+	0x0073000d, 0x007a000d, 0x0080000d, 0x0087000d,
+	0x008d000d, 0x0094000d, 0x009a000d, 0x00a1000d,
+	0x00a7001a, 0x00b4001a, 0x00c1001a, 0x00ce001a,
+	0x00da001a, 0x00e7001a, 0x00f4001a, 0x0101001a,
+	0x010e0033, 0x01280033, 0x01410033, 0x015b0033,
+	0x01750033, 0x018f0033, 0x01a80033, 0x01c20033,
+	0x01dc0067, 0x020f0067, 0x02430067, 0x02760067,
+	0x02aa0067, 0x02dd0067, 0x03110067, 0x03440067,
+	0x037800ce, 0x03df00ce, 0x044600ce, 0x04ad00ce,
+	0x051400ce, 0x057b00c5, 0x05dd00bc, 0x063b00b5,
+	0x06970158, 0x07420142, 0x07e30130, 0x087b0120,
+	0x090b0112, 0x09940106, 0x0a1700fc, 0x0a9500f2,
+	0x0b0f01cb, 0x0bf401ae, 0x0ccb0195, 0x0d950180,
+	0x0e56016e, 0x0f0d015e, 0x0fbc0150, 0x10630143,
+	0x11070264, 0x1238023e, 0x1357021d, 0x14660201,
+	0x156601e9, 0x165a01d3, 0x174401c0, 0x182401af,
+	0x18fe0331, 0x1a9602fe, 0x1c1502d2, 0x1d7e02ad,
+	0x1ed4028d, 0x201a0270, 0x21520256, 0x227d0240,
+	0x239f0443, 0x25c003fe, 0x27bf03c4, 0x29a10392,
+	0x2b6a0367, 0x2d1d0341, 0x2ebe031f, 0x304d0300,
+	0x31d105b0, 0x34a80555, 0x37520507, 0x39d504c5,
+	0x3c37048b, 0x3e7c0458, 0x40a8042a, 0x42bd0401,
+	0x44c20798, 0x488e071e, 0x4c1c06b6, 0x4f76065d,
+	0x52a50610, 0x55ac05cc, 0x5892058f, 0x5b590559,
+	0x5e0c0a23, 0x631c0980, 0x67db08f6, 0x6c55087f,
+	0x70940818, 0x74a007bd, 0x787d076c, 0x7c330723,
+};
+
+#define QAR_CONVERT_SRGB8_MIN_BITS ((uint32_t)(127 - 13) << 23)
+#define QAR_CONVERT_SRGB8_ALMOST_ONE_BITS 0x3f7fffffu
+
+static inline float
+qar_convert_half_to_float(uint16_t half)
+{
+	const uint32_t sign = (uint32_t)(half & 0x8000u) << 16;
+	uint32_t exponent = (half >> 10) & 0x1fu;
+	uint32_t mantissa = half & 0x3ffu;
+	uint32_t bits;
+
+	if(exponent == 0)
+	{
+		if(mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			// Subnormal: normalize into a float exponent.
+			exponent = 113;
+			while((mantissa & 0x400u) == 0)
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+		}
+	}
+	else if(exponent == 31)
+	{
+		bits = sign | 0x7f800000u | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static inline uint8_t
+qar_convert_linear_to_srgb8(float linear)
+{
+	const uint32_t min_bits = QAR_CONVERT_SRGB8_MIN_BITS;
+	const uint32_t almost_one_bits = QAR_CONVERT_SRGB8_ALMOST_ONE_BITS;
+	float min_value;
+	float almost_one;
+	memcpy(&min_value, &min_bits, sizeof(min_value));
+	memcpy(&almost_one, &almost_one_bits, sizeof(almost_one));
+
+	// Written this way so NaN clamps to 0.
+	if(!(linear > min_value))
+	{
+		linear = min_value;
+	}
+	if(linear > almost_one)
+	{
+		linear = almost_one;
+	}
+
+	uint32_t bits;
+	memcpy(&bits, &linear, sizeof(bits));
+	const uint32_t entry = qar_convert_srgb8_table[(bits - min_bits) >> 20];
+	const uint32_t bias = (entry >> 16) << 9;
+	const uint32_t scale = entry & 0xffffu;
+	const uint32_t t = (bits >> 12) & 0xffu;
+	return (uint8_t)((bias + scale * t) >> 16);
+}
+
+static inline uint8_t
+qar_convert_linear_to_unorm8(float value)
+{
+	// Written this way so NaN clamps to 0.
+	if(!(value > 0.0f))
+	{
+		return 0;
+	}
+	if(value >= 1.0f)
+	{
+		return 255;
+	}
+	return (uint8_t)(value * 255.0f + 0.5f);
+}
+
+static inline bool
+qar_convert_is_rgba8(QarPixelFormat format)
+{
+	return format == QAR_PIXEL_FORMAT_R8G8B8A8
+		|| format == QAR_PIXEL_FORMAT_B8G8R8A8;
+}
+
+/* Common argument validation: formats are checked by the callers. */
+static inline bool
+qar_convert_check_fit(
+	const QarVideoTextureCpu* src,
+	const QarVideoTextureCpu* dst,
+	uint32_t dst_x,
+	uint32_t dst_y
+)
+{
+	if(src == NULL || dst == NULL || src->texture_data == NULL
+	   || dst->texture_data == NULL)
+	{
+		return false;
+	}
+
+	const uint32_t width = src->size.width;
+	const uint32_t height = src->size.height;
+	if(width == 0 || height == 0)
+	{
+		return true;
+	}
+	if(dst_x > dst->size.width || width > dst->size.width - dst_x
+	   || dst_y > dst->size.height || height > dst->size.height - dst_y)
+	{
+		return false;
+	}
+
+	const size_t src_row =
+		(size_t)width * qar_pixel_format_size(src->size.format);
+	const size_t dst_row =
+		(size_t)(dst_x + width) * qar_pixel_format_size(dst->size.format);
+	if(src->pitch < src_row || dst->pitch < dst_row)
+	{
+		return false;
+	}
+
+	return src->texture_data_size >= (size_t)src->pitch * (height - 1) + src_row
+		&& dst->texture_data_size
+			   >= (size_t)dst->pitch * (dst_y + height - 1) + dst_row;
+}
+
+#if defined(QAR_CONVERT_AVX2) || defined(QAR_CONVERT_SSE41)
+
+/* Four floats -> four sRGB8 values in the low byte of each 32-bit lane. */
+static inline __m128i
+qar_convert_srgb8_x4(__m128 linear)
+{
+	const __m128i min_bits = _mm_set1_epi32((int)QAR_CONVERT_SRGB8_MIN_BITS);
+	// maxps returns its second operand for NaN, so NaN clamps to 0.
+	linear = _mm_max_ps(linear, _mm_castsi128_ps(min_bits));
+	linear = _mm_min_ps(
+		linear,
+		_mm_castsi128_ps(_mm_set1_epi32((int)QAR_CONVERT_SRGB8_ALMOST_ONE_BITS))
+	);
+
+	const __m128i bits = _mm_castps_si128(linear);
+	uint32_t index[4];
+	_mm_storeu_si128(
+		(__m128i*)index, _mm_srli_epi32(_mm_sub_epi32(bits, min_bits), 20)
+	);
+	const __m128i entry = _mm_setr_epi32(
+		(int)qar_convert_srgb8_table[index[0]],
+		(int)qar_convert_srgb8_table[index[1]],
+		(int)qar_convert_srgb8_table[index[2]],
+		(int)qar_convert_srgb8_table[index[3]]
+	);
+
+	const __m128i bias = _mm_slli_epi32(_mm_srli_epi32(entry, 16), 9);
+	const __m128i scale = _mm_and_si128(entry, _mm_set1_epi32(0xffff));
+	const __m128i t =
+		_mm_and_si128(_mm_srli_epi32(bits, 12), _mm_set1_epi32(0xff));
+	return _mm_srli_epi32(_mm_add_epi32(bias, _mm_mullo_epi32(scale, t)), 16);
+}
+
+#endif
+
+#ifdef QAR_CONVERT_AVX2
+
+/* Eight floats -> eight sRGB8 values in the low byte of each 32-bit lane. */
+static inline __m256i
+qar_convert_srgb8_x8(__m256 linear)
+{
+	const __m256i min_bits =
+		_mm256_set1_epi32((int)QAR_CONVERT_SRGB8_MIN_BITS);
+	linear = _mm256_max_ps(linear, _mm256_castsi256_ps(min_bits));
+	linear = _mm256_min_ps(
+		linear,
+		_mm256_castsi256_ps(
+			_mm256_set1_epi32((int)QAR_CONVERT_SRGB8_ALMOST_ONE_BITS)
+		)
+	);
+
+	const __m256i bits = _mm256_castps_si256(linear);
+	const __m256i index =
+		_mm256_srli_epi32(_mm256_sub_epi32(bits, min_bits), 20);
+	const __m256i entry = _mm256_i32gather_epi32(
+		(const int*)qar_convert_srgb8_table, index, 4
+	);
+
+	const __m256i bias = _mm256_slli_epi32(_mm256_srli_epi32(entry, 16), 9);
+	const __m256i scale = _mm256_and_si256(entry, _mm256_set1_epi32(0xffff));
+	const __m256i t =
+		_mm256_and_si256(_mm256_srli_epi32(bits, 12), _mm256_set1_epi32(0xff));
+	return _mm256_srli_epi32(
+		_mm256_add_epi32(bias, _mm256_mullo_epi32(scale, t)), 16
+	);
+}
+
+#endif
+
+#ifdef QAR_CONVERT_NEON
+
+/* Four floats -> four sRGB8 values in the low byte of each 32-bit lane. */
+static inline uint32x4_t
+qar_convert_srgb8_x4(float32x4_t linear)
+{
+	const uint32x4_t min_bits = vdupq_n_u32(QAR_CONVERT_SRGB8_MIN_BITS);
+	// vmaxnm returns the number when the other operand is NaN.
+	linear = vmaxnmq_f32(linear, vreinterpretq_f32_u32(min_bits));
+	linear = vminq_f32(
+		linear,
+		vreinterpretq_f32_u32(vdupq_n_u32(QAR_CONVERT_SRGB8_ALMOST_ONE_BITS))
+	);
+
+	const uint32x4_t bits = vreinterpretq_u32_f32(linear);
+	const uint32x4_t index = vshrq_n_u32(vsubq_u32(bits, min_bits), 20);
+	uint32x4_t entry = vdupq_n_u32(0);
+	entry = vsetq_lane_u32(
+		qar_convert_srgb8_table[vgetq_lane_u32(index, 0)], entry, 0
+	);
+	entry = vsetq_lane_u32(
+		qar_convert_srgb8_table[vgetq_lane_u32(index, 1)], entry, 1
+	);
+	entry = vsetq_lane_u32(
+		qar_convert_srgb8_table[vgetq_lane_u32(index, 2)], entry, 2
+	);
+	entry = vsetq_lane_u32(
+		qar_convert_srgb8_table[vgetq_lane_u32(index, 3)], entry, 3
+	);
+
+	const uint32x4_t bias = vshlq_n_u32(vshrq_n_u32(entry, 16), 9);
+	const uint32x4_t scale = vandq_u32(entry, vdupq_n_u32(0xffff));
+	const uint32x4_t t = vandq_u32(vshrq_n_u32(bits, 12), vdupq_n_u32(0xff));
+	return vshrq_n_u32(vmlaq_u32(bias, scale, t), 16);
+}
+
+#endif
+
+static inline void
+qar_convert_rgba16f_pixel_scalar(
+	const uint16_t* src, uint8_t* dst, bool swap_rb
+)
+{
+	const uint8_t r =
+		qar_convert_linear_to_srgb8(qar_convert_half_to_float(src[0]));
+	const uint8_t g =
+		qar_convert_linear_to_srgb8(qar_convert_half_to_float(src[1]));
+	const uint8_t b =
+		qar_convert_linear_to_srgb8(qar_convert_half_to_float(src[2]));
+	const uint8_t a =
+		qar_convert_linear_to_unorm8(qar_convert_half_to_float(src[3]));
+	dst[0] = swap_rb ? b : r;
+	dst[1] = g;
+	dst[2] = swap_rb ? r : b;
+	dst[3] = a;
+}
+
+static inline void
+qar_convert_rgba16f_row(
+	const uint16_t* src, uint8_t* dst, uint32_t width, bool swap_rb
+)
+{
+	uint32_t x = 0;
+
+#if defined(QAR_CONVERT_AVX2) && defined(QAR_CONVERT_F16C)
+	const __m256 scale_255 = _mm256_set1_ps(255.0f);
+	for(; x + 2 <= width; x += 2)
+	{
+		// Two pixels, eight channels per iteration.
+		const __m256 linear =
+			_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + x * 4)));
+		__m256i srgb = qar_convert_srgb8_x8(linear);
+		const __m256 clamped = _mm256_min_ps(
+			_mm256_max_ps(linear, _mm256_setzero_ps()), _mm256_set1_ps(1.0f)
+		);
+		const __m256i alpha =
+			_mm256_cvtps_epi32(_mm256_mul_ps(clamped, scale_255));
+		srgb = _mm256_blend_epi32(srgb, alpha, 0x88);
+		if(swap_rb)
+		{
+			srgb = _mm256_shuffle_epi32(srgb, _MM_SHUFFLE(3, 0, 1, 2));
+		}
+		__m256i packed = _mm256_packus_epi32(srgb, srgb);
+		packed = _mm256_packus_epi16(packed, packed);
+		packed = _mm256_permutevar8x32_epi32(
+			packed, _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4)
+		);
+		_mm_storel_epi64(
+			(__m128i*)(dst + x * 4), _mm256_castsi256_si128(packed)
+		);
+	}
+#elif defined(QAR_CONVERT_AVX2) || defined(QAR_CONVERT_SSE41)
+	const __m128 scale_255 = _mm_set1_ps(255.0f);
+	for(; x < width; x++)
+	{
+#ifdef QAR_CONVERT_F16C
+		const __m128 linear =
+			_mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(src + x * 4)));
+#else
+		const uint16_t* pixel = src + x * 4;
+		const __m128 linear = _mm_setr_ps(
+			qar_convert_half_to_float(pixel[0]),
+			qar_convert_half_to_float(pixel[1]),
+			qar_convert_half_to_float(pixel[2]),
+			qar_convert_half_to_float(pixel[3])
+		);
+#endif
+		__m128i srgb = qar_convert_srgb8_x4(linear);
+		const __m128 clamped =
+			_mm_min_ps(_mm_max_ps(linear, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		const __m128i alpha = _mm_cvtps_epi32(_mm_mul_ps(clamped, scale_255));
+		srgb = _mm_blend_epi16(srgb, alpha, 0xc0);
+		if(swap_rb)
+		{
+			srgb = _mm_shuffle_epi32(srgb, _MM_SHUFFLE(3, 0, 1, 2));
+		}
+		__m128i packed = _mm_packus_epi32(srgb, srgb);
+		packed = _mm_packus_epi16(packed, packed);
+		const uint32_t value = (uint32_t)_mm_cvtsi128_si32(packed);
+		memcpy(dst + x * 4, &value, sizeof(value));
+	}
+#elif defined(QAR_CONVERT_NEON)
+	const float32x4_t scale_255 = vdupq_n_f32(255.0f);
+	for(; x < width; x++)
+	{
+		const float32x4_t linear =
+			vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + x * 4)));
+		uint32x4_t srgb = qar_convert_srgb8_x4(linear);
+		const float32x4_t clamped = vminq_f32(
+			vmaxnmq_f32(linear, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f)
+		);
+		const uint32x4_t alpha = vcvtnq_u32_f32(vmulq_f32(clamped, scale_255));
+		srgb = vsetq_lane_u32(vgetq_lane_u32(alpha, 3), srgb, 3);
+		if(swap_rb)
+		{
+			const uint32_t r = vgetq_lane_u32(srgb, 0);
+			srgb = vsetq_lane_u32(vgetq_lane_u32(srgb, 2), srgb, 0);
+			srgb = vsetq_lane_u32(r, srgb, 2);
+		}
+		const uint16x4_t narrow = vmovn_u32(srgb);
+		const uint8x8_t bytes = vmovn_u16(vcombine_u16(narrow, narrow));
+		const uint32_t value = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+		memcpy(dst + x * 4, &value, sizeof(value));
+	}
+#endif
+
+	for(; x < width; x++)
+	{
+		qar_convert_rgba16f_pixel_scalar(src + x * 4, dst + x * 4, swap_rb);
+	}
+}
+
+static inline bool
+qar_convert_rgba16f_to_srgb8(
+	const QarVideoTextureCpu* src,
+	QarVideoTextureCpu* dst,
+	uint32_t dst_x,
+	uint32_t dst_y
+)
+{
+	if(src == NULL || dst == NULL
+	   || src->size.format != QAR_PIXEL_FORMAT_R16G16B16A16
+	   || !qar_convert_is_rgba8(dst->size.format)
+	   || !qar_convert_check_fit(src, dst, dst_x, dst_y))
+	{
+		return false;
+	}
+
+	const bool swap_rb = dst->size.format == QAR_PIXEL_FORMAT_B8G8R8A8;
+	for(uint32_t y = 0; y < src->size.height; y++)
+	{
+		const uint8_t* src_row = src->texture_data + (size_t)y * src->pitch;
+		uint8_t* dst_row = dst->texture_data + (size_t)(dst_y + y) * dst->pitch
+						 + (size_t)dst_x * 4;
+		qar_convert_rgba16f_row(
+			(const uint16_t*)src_row, dst_row, src->size.width, swap_rb
+		);
+	}
+	return true;
+}
+
+static inline void
+qar_convert_swizzle_row(const uint8_t* src, uint8_t* dst, uint32_t width)
+{
+	uint32_t x = 0;
+
+#if defined(QAR_CONVERT_AVX2)
+	const __m256i mask = _mm256_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+	);
+	for(; x + 8 <= width; x += 8)
+	{
+		const __m256i pixels =
+			_mm256_loadu_si256((const __m256i*)(src + x * 4));
+		_mm256_storeu_si256(
+			(__m256i*)(dst + x * 4), _mm256_shuffle_epi8(pixels, mask)
+		);
+	}
+#elif defined(QAR_CONVERT_SSE41)
+	const __m128i mask = _mm_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+	);
+	for(; x + 4 <= width; x += 4)
+	{
+		const __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * 4));
+		_mm_storeu_si128(
+			(__m128i*)(dst + x * 4), _mm_shuffle_epi8(pixels, mask)
+		);
+	}
+#elif defined(QAR_CONVERT_NEON)
+	for(; x + 16 <= width; x += 16)
+	{
+		uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+		const uint8x16_t r = pixels.val[0];
+		pixels.val[0] = pixels.val[2];
+		pixels.val[2] = r;
+		vst4q_u8(dst + x * 4, pixels);
+	}
+#endif
+
+	for(; x < width; x++)
+	{
+		const uint8_t r = src[x * 4 + 0];
+		dst[x * 4 + 0] = src[x * 4 + 2];
+		dst[x * 4 + 1] = src[x * 4 + 1];
+		dst[x * 4 + 2] = r;
+		dst[x * 4 + 3] = src[x * 4 + 3];
+	}
+}
+
+static inline bool
+qar_convert_swizzle_rgba8(
+	const QarVideoTextureCpu* src,
+	QarVideoTextureCpu* dst,
+	uint32_t dst_x,
+	uint32_t dst_y
+)
+{
+	if(src == NULL || dst == NULL || !qar_convert_is_rgba8(src->size.format)
+	   || !qar_convert_is_rgba8(dst->size.format)
+	   || !qar_convert_check_fit(src, dst, dst_x, dst_y))
+	{
+		return false;
+	}
+
+	const bool swap_rb = src->size.format != dst->size.format;
+	const size_t row_size = (size_t)src->size.width * 4;
+	for(uint32_t y = 0; y < src->size.height; y++)
+	{
+		const uint8_t* src_row = src->texture_data + (size_t)y * src->pitch;
+		uint8_t* dst_row = dst->texture_data + (size_t)(dst_y + y) * dst->pitch
+						 + (size_t)dst_x * 4;
+		if(swap_rb)
+		{
+			qar_convert_swizzle_row(src_row, dst_row, src->size.width);
+		}
+		else if(src_row != dst_row)
+		{
+			memmove(dst_row, src_row, row_size);
+		}
+	}
+	return true;
+}
+
+static inline void
+qar_convert_depth_row(
+	const float* src,
+	float* dst,
+	uint32_t width,
+	float near_plane,
+	float far_plane
+)
+{
+	const float numerator = near_plane * far_plane;
+	const float range = far_plane - near_plane;
+	uint32_t x = 0;
+
+#if defined(QAR_CONVERT_AVX2)
+	const __m256 numerator_x8 = _mm256_set1_ps(numerator);
+	const __m256 range_x8 = _mm256_set1_ps(range);
+	const __m256 far_x8 = _mm256_set1_ps(far_plane);
+	for(; x + 8 <= width; x += 8)
+	{
+		const __m256 depth = _mm256_loadu_ps(src + x);
+		_mm256_storeu_ps(
+			dst + x,
+			_mm256_div_ps(
+				numerator_x8,
+				_mm256_sub_ps(far_x8, _mm256_mul_ps(depth, range_x8))
+			)
+		);
+	}
+#elif defined(QAR_CONVERT_SSE41)
+	const __m128 numerator_x4 = _mm_set1_ps(numerator);
+	const __m128 range_x4 = _mm_set1_ps(range);
+	const __m128 far_x4 = _mm_set1_ps(far_plane);
+	for(; x + 4 <= width; x += 4)
+	{
+		const __m128 depth = _mm_loadu_ps(src + x);
+		_mm_storeu_ps(
+			dst + x,
+			_mm_div_ps(
+				numerator_x4, _mm_sub_ps(far_x4, _mm_mul_ps(depth, range_x4))
+			)
+		);
+	}
+#elif defined(QAR_CONVERT_NEON)
+	const float32x4_t numerator_x4 = vdupq_n_f32(numerator);
+	const float32x4_t range_x4 = vdupq_n_f32(range);
+	const float32x4_t far_x4 = vdupq_n_f32(far_plane);
+	for(; x + 4 <= width; x += 4)
+	{
+		const float32x4_t depth = vld1q_f32(src + x);
+		vst1q_f32(
+			dst + x,
+			vdivq_f32(numerator_x4, vmlsq_f32(far_x4, depth, range_x4))
+		);
+	}
+#endif
+
+	for(; x < width; x++)
+	{
+		dst[x] = numerator / (far_plane - src[x] * range);
+	}
+}
+
+static inline bool
+qar_convert_depth_to_linear(
+	const QarVideoTextureCpu* src,
+	QarNearFar near_far,
+	QarVideoTextureCpu* dst,
+	uint32_t dst_x,
+	uint32_t dst_y
+)
+{
+	if(src == NULL || dst == NULL
+	   || (src->size.format != QAR_PIXEL_FORMAT_D32_FLOAT
+		   && src->size.format != QAR_PIXEL_FORMAT_R32_FLOAT)
+	   || dst->size.format != QAR_PIXEL_FORMAT_R32_FLOAT
+	   || !(near_far.near_plane > 0.0f)
+	   || !(near_far.far_plane > near_far.near_plane)
+	   || !qar_convert_check_fit(src, dst, dst_x, dst_y))
+	{
+		return false;
+	}
+
+	for(uint32_t y = 0; y < src->size.height; y++)
+	{
+		const uint8_t* src_row = src->texture_data + (size_t)y * src->pitch;
+		uint8_t* dst_row = dst->texture_data + (size_t)(dst_y + y) * dst->pitch
+						 + (size_t)dst_x * 4;
+		qar_convert_depth_row(
+			(const float*)src_row,
+			(float*)dst_row,
+			src->size.width,
+			near_far.near_plane,
+			near_far.far_plane
+		);
+	}
+	return true;
+}
+
+#undef QAR_CONVERT_SRGB8_ALMOST_ONE_BITS
+#undef QAR_CONVERT_SRGB8_MIN_BITS
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // QAR_STREAMING_CONVERT_H
@@ -0,0 +1,763 @@
+/**
+ * @file qar_streaming_math.h
+ * @brief Header-only pose math for QarVector3, QarQuaternion and QarPose.
+ *
+ * Follows the conventions of the room space (see the Coordinate Systems
+ * guide): right-handed, Y-up, meters, quaternions stored scalar last. All
+ * quaternions are expected to be unit length. Poses map points from their
+ * own frame into the parent frame, so composing a volume's pose with its
+ * app pose yields the app-to-room transform.
+ *
+ * The batch hand transforms use AVX, SSE2, or NEON on AArch64 when the
+ * compiler targets them, with a scalar fallback for everything else. Define
+ * QAR_MATH_NO_SIMD to force the scalar path.
+ */
+#ifndef QAR_STREAMING_MATH_H
+#define QAR_STREAMING_MATH_H
+
+#include "qar_streaming.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifndef QAR_MATH_NO_SIMD
+#if defined(__AVX__)
+#define QAR_MATH_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)                                     \
+	|| (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QAR_MATH_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define QAR_MATH_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @defgroup qar_c_math Pose Math
+ * @ingroup qar_c_api
+ * @brief Vector, quaternion and pose helpers, and room <-> app space
+ * transforms.
+ * @{ */
+
+/**
+ * @brief Pose with a uniform scale: maps `x` to
+ * `pose.position + pose.orientation * (scale * x)`.
+ *
+ * Relates an app's content space to the room: one app-meter is `scale`
+ * room-meters (see qar_scaled_pose_app_to_room).
+ */
+typedef struct QarScaledPose
+{
+	QarPose pose;
+	float scale;
+} QarScaledPose;
+
+static inline QarVector3 qar_vector3_add(QarVector3 a, QarVector3 b);
+static inline QarVector3 qar_vector3_subtract(QarVector3 a, QarVector3 b);
+static inline QarVector3 qar_vector3_scale(QarVector3 v, float factor);
+static inline float qar_vector3_dot(QarVector3 a, QarVector3 b);
+static inline QarVector3 qar_vector3_cross(QarVector3 a, QarVector3 b);
+static inline QarVector3 qar_vector3_lerp(QarVector3 a, QarVector3 b, float t);
+
+/** @brief Hamilton product: rotates by `b`, then by `a`. */
+static inline QarQuaternion
+qar_quaternion_multiply(QarQuaternion a, QarQuaternion b);
+
+/** @brief Inverse of a unit quaternion (its conjugate). */
+static inline QarQuaternion qar_quaternion_inverse(QarQuaternion q);
+
+/** @brief Scale to unit length; a zero quaternion becomes the identity. */
+static inline QarQuaternion qar_quaternion_normalize(QarQuaternion q);
+
+/** @brief Rotate vector `v` by `q`. */
+static inline QarVector3 qar_quaternion_rotate(QarQuaternion q, QarVector3 v);
+
+/**
+ * @brief Spherical interpolation from `a` (t = 0) to `b` (t = 1) along the
+ * shorter arc.
+ */
+static inline QarQuaternion
+qar_quaternion_slerp(QarQuaternion a, QarQuaternion b, float t);
+
+/**
+ * @brief Pose `child`, given in the frame of `parent`, expressed in the
+ * parent's own parent frame.
+ */
+static inline QarPose qar_pose_compose(QarPose parent, QarPose child);
+
+/** @brief Inverse pose: maps points of the parent frame back into `pose`. */
+static inline QarPose qar_pose_inverse(QarPose pose);
+
+/** @brief Map a point from the frame of `pose` into its parent frame. */
+static inline QarVector3
+qar_pose_transform_point(QarPose pose, QarVector3 point);
+
+/**
+ * @brief Transform from an app volume's app content space into room space.
+ *
+ * Takes the volume's `pose`, `app_pose` and `app_scale`, e.g. from a
+ * QarAppVolumeLatestState read with qar_app_volumes_get_latest_states.
+ */
+static inline QarScaledPose qar_scaled_pose_app_to_room(
+	QarPose volume_pose, QarPose app_pose, float app_scale
+);
+
+/** @brief Transform from room space into an app volume's content space. */
+static inline QarScaledPose qar_scaled_pose_room_to_app(
+	QarPose volume_pose, QarPose app_pose, float app_scale
+);
+
+/** @brief Inverse transform; `transform.scale` must not be 0. */
+static inline QarScaledPose qar_scaled_pose_inverse(QarScaledPose transform);
+
+static inline QarVector3 qar_scaled_pose_transform_point(
+	const QarScaledPose* transform, QarVector3 point
+);
+
+/** @brief Transform a pose; its orientation is rotated but not scaled. */
+static inline QarPose
+qar_scaled_pose_transform_pose(const QarScaledPose* transform, QarPose pose);
+
+/**
+ * @brief Transform a whole hand skeleton, e.g. tracked hands from room space
+ * into app space.
+ *
+ * Transforms the hand pose and every joint pose, scales joint radii, and
+ * rotates velocities; linear velocities are scaled as well. Flags, ids and
+ * tracking state are copied unchanged. `out_hand` may equal `hand`.
+ */
+static inline void qar_scaled_pose_transform_hand(
+	const QarScaledPose* transform,
+	const QarHandJoints* hand,
+	QarHandJoints* out_hand
+);
+
+/** @brief Transform both hands of a device sample; `out_hands` may equal
+ * `hands`. */
+static inline void qar_scaled_pose_transform_hands(
+	const QarScaledPose* transform,
+	const QarDeviceHandsWithJoints* hands,
+	QarDeviceHandsWithJoints* out_hands
+);
+
+/** @} */ /* end of qar_c_math */
+
+// ============================================================================
+// IMPLEMENTATION
+// ============================================================================
+
+static inline QarVector3
+qar_vector3_add(QarVector3 a, QarVector3 b)
+{
+	QarVector3 result = { a.x + b.x, a.y + b.y, a.z + b.z };
+	return result;
+}
+
+static inline QarVector3
+qar_vector3_subtract(QarVector3 a, QarVector3 b)
+{
+	QarVector3 result = { a.x - b.x, a.y - b.y, a.z - b.z };
+	return result;
+}
+
+static inline QarVector3
+qar_vector3_scale(QarVector3 v, float factor)
+{
+	QarVector3 result = { v.x * factor, v.y * factor, v.z * factor };
+	return result;
+}
+
+static inline float
+qar_vector3_dot(QarVector3 a, QarVector3 b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline QarVector3
+qar_vector3_cross(QarVector3 a, QarVector3 b)
+{
+	QarVector3 result = { a.y * b.z - a.z * b.y,
+						  a.z * b.x - a.x * b.z,
+						  a.x * b.y - a.y * b.x };
+	return result;
+}
+
+static inline QarVector3
+qar_vector3_lerp(QarVector3 a, QarVector3 b, float t)
+{
+	QarVector3 result = { a.x + (b.x - a.x) * t,
+						  a.y + (b.y - a.y) * t,
+						  a.z + (b.z - a.z) * t };
+	return result;
+}
+
+static inline QarQuaternion
+qar_quaternion_multiply(QarQuaternion a, QarQuaternion b)
+{
+	QarQuaternion result = {
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+	};
+	return result;
+}
+
+static inline QarQuaternion
+qar_quaternion_inverse(QarQuaternion q)
+{
+	QarQuaternion result = { -q.x, -q.y, -q.z, q.w };
+	return result;
+}
+
+static inline QarQuaternion
+qar_quaternion_normalize(QarQuaternion q)
+{
+	const float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+	if(!(length > 0.0f))
+	{
+		return qar_quaternion_default();
+	}
+	QarQuaternion result = { q.x / length,
+							 q.y / length,
+							 q.z / length,
+							 q.w / length };
+	return result;
+}
+
+static inline QarVector3
+qar_quaternion_rotate(QarQuaternion q, QarVector3 v)
+{
+	// v + w * t + u x t with t = 2 * u x v, where u is the vector part.
+	const QarVector3 u = { q.x, q.y, q.z };
+	const QarVector3 t = qar_vector3_scale(qar_vector3_cross(u, v), 2.0f);
+	return qar_vector3_add(
+		qar_vector3_add(v, qar_vector3_scale(t, q.w)), qar_vector3_cross(u, t)
+	);
+}
+
+static inline QarQuaternion
+qar_quaternion_slerp(QarQuaternion a, QarQuaternion b, float t)
+{
+	float cos_angle = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	const float sign = cos_angle < 0.0f ? -1.0f : 1.0f;
+	cos_angle *= sign;
+	float weight_a = 1.0f - t;
+	float weight_b = t * sign;
+	// Close orientations fall back to a normalized lerp, where sin(angle)
+	// would lose all precision.
+	if(cos_angle < 0.9995f)
+	{
+		const float angle = acosf(cos_angle);
+		const float sin_angle = sinf(angle);
+		weight_a = sinf((1.0f - t) * angle) / sin_angle;
+		weight_b = sinf(t * angle) / sin_angle * sign;
+	}
+	QarQuaternion result = { weight_a * a.x + weight_b * b.x,
+							 weight_a * a.y + weight_b * b.y,
+							 weight_a * a.z + weight_b * b.z,
+							 weight_a * a.w + weight_b * b.w };
+	return qar_quaternion_normalize(result);
+}
+
+static inline QarPose
+qar_pose_compose(QarPose parent, QarPose child)
+{
+	QarPose result;
+	result.orientation =
+		qar_quaternion_multiply(parent.orientation, child.orientation);
+	result.position = qar_pose_transform_point(parent, child.position);
+	return result;
+}
+
+static inline QarPose
+qar_pose_inverse(QarPose pose)
+{
+	QarPose result;
+	result.orientation = qar_quaternion_inverse(pose.orientation);
+	result.position = qar_vector3_scale(
+		qar_quaternion_rotate(result.orientation, pose.position), -1.0f
+	);
+	return result;
+}
+
+static inline QarVector3
+qar_pose_transform_point(QarPose pose, QarVector3 point)
+{
+	return qar_vector3_add(
+		pose.position, qar_quaternion_rotate(pose.orientation, point)
+	);
+}
+
+static inline QarScaledPose
+qar_scaled_pose_app_to_room(
+	QarPose volume_pose, QarPose app_pose, float app_scale
+)
+{
+	QarScaledPose result;
+	result.pose = qar_pose_compose(volume_pose, app_pose);
+	result.scale = app_scale;
+	return result;
+}
+
+static inline QarScaledPose
+qar_scaled_pose_room_to_app(
+	QarPose volume_pose, QarPose app_pose, float app_scale
+)
+{
+	return qar_scaled_pose_inverse(
+		qar_scaled_pose_app_to_room(volume_pose, app_pose, app_scale)
+	);
+}
+
+static inline QarScaledPose
+qar_scaled_pose_inverse(QarScaledPose transform)
+{
+	QarScaledPose result;
+	result.scale = 1.0f / transform.scale;
+	result.pose = qar_pose_inverse(transform.pose);
+	result.pose.position =
+		qar_vector3_scale(result.pose.position, result.scale);
+	return result;
+}
+
+static inline QarVector3
+qar_scaled_pose_transform_point(
+	const QarScaledPose* transform, QarVector3 point
+)
+{
+	return qar_pose_transform_point(
+		transform->pose, qar_vector3_scale(point, transform->scale)
+	);
+}
+
+static inline QarPose
+qar_scaled_pose_transform_pose(const QarScaledPose* transform, QarPose pose)
+{
+	QarPose result;
+	result.orientation =
+		qar_quaternion_multiply(transform->pose.orientation, pose.orientation);
+	result.position = qar_scaled_pose_transform_point(transform, pose.position);
+	return result;
+}
+
+#if defined(QAR_MATH_AVX)
+typedef __m256 QarMathLanes;
+#define QAR_MATH_LANE_COUNT 8
+#elif defined(QAR_MATH_SSE)
+typedef __m128 QarMathLanes;
+#define QAR_MATH_LANE_COUNT 4
+#elif defined(QAR_MATH_NEON)
+typedef float32x4_t QarMathLanes;
+#define QAR_MATH_LANE_COUNT 4
+#endif
+
+#ifdef QAR_MATH_LANE_COUNT
+
+static inline QarMathLanes
+qar_math_splat(float value)
+{
+#if defined(QAR_MATH_AVX)
+	return _mm256_set1_ps(value);
+#elif defined(QAR_MATH_SSE)
+	return _mm_set1_ps(value);
+#else
+	return vdupq_n_f32(value);
+#endif
+}
+
+static inline QarMathLanes
+qar_math_add(QarMathLanes a, QarMathLanes b)
+{
+#if defined(QAR_MATH_AVX)
+	return _mm256_add_ps(a, b);
+#elif defined(QAR_MATH_SSE)
+	return _mm_add_ps(a, b);
+#else
+	return vaddq_f32(a, b);
+#endif
+}
+
+static inline QarMathLanes
+qar_math_sub(QarMathLanes a, QarMathLanes b)
+{
+#if defined(QAR_MATH_AVX)
+	return _mm256_sub_ps(a, b);
+#elif defined(QAR_MATH_SSE)
+	return _mm_sub_ps(a, b);
+#else
+	return vsubq_f32(a, b);
+#endif
+}
+
+static inline QarMathLanes
+qar_math_mul(QarMathLanes a, QarMathLanes b)
+{
+#if defined(QAR_MATH_AVX)
+	return _mm256_mul_ps(a, b);
+#elif defined(QAR_MATH_SSE)
+	return _mm_mul_ps(a, b);
+#else
+	return vmulq_f32(a, b);
+#endif
+}
+
+#if defined(QAR_MATH_NEON)
+static inline void
+qar_math_transpose4(
+	float32x4_t* r0, float32x4_t* r1, float32x4_t* r2, float32x4_t* r3
+)
+{
+	const float32x4x2_t t01 = vtrnq_f32(*r0, *r1);
+	const float32x4x2_t t23 = vtrnq_f32(*r2, *r3);
+	*r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+	*r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+	*r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+	*r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+#endif
+
+/* Load four consecutive floats from each of QAR_MATH_LANE_COUNT rows
+ * `stride` bytes apart, transposed: `out[i]` holds float i of every row. */
+static inline void
+qar_math_load_columns(const float* first, size_t stride, QarMathLanes out[4])
+{
+	const char* row = (const char*)first;
+#if defined(QAR_MATH_AVX)
+	__m128 r0 = _mm_loadu_ps((const float*)row);
+	__m128 r1 = _mm_loadu_ps((const float*)(row + stride));
+	__m128 r2 = _mm_loadu_ps((const float*)(row + 2 * stride));
+	__m128 r3 = _mm_loadu_ps((const float*)(row + 3 * stride));
+	__m128 r4 = _mm_loadu_ps((const float*)(row + 4 * stride));
+	__m128 r5 = _mm_loadu_ps((const float*)(row + 5 * stride));
+	__m128 r6 = _mm_loadu_ps((const float*)(row + 6 * stride));
+	__m128 r7 = _mm_loadu_ps((const float*)(row + 7 * stride));
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	_MM_TRANSPOSE4_PS(r4, r5, r6, r7);
+	out[0] = _mm256_insertf128_ps(_mm256_castps128_ps256(r0), r4, 1);
+	out[1] = _mm256_insertf128_ps(_mm256_castps128_ps256(r1), r5, 1);
+	out[2] = _mm256_insertf128_ps(_mm256_castps128_ps256(r2), r6, 1);
+	out[3] = _mm256_insertf128_ps(_mm256_castps128_ps256(r3), r7, 1);
+#elif defined(QAR_MATH_SSE)
+	__m128 r0 = _mm_loadu_ps((const float*)row);
+	__m128 r1 = _mm_loadu_ps((const float*)(row + stride));
+	__m128 r2 = _mm_loadu_ps((const float*)(row + 2 * stride));
+	__m128 r3 = _mm_loadu_ps((const float*)(row + 3 * stride));
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	out[0] = r0;
+	out[1] = r1;
+	out[2] = r2;
+	out[3] = r3;
+#else
+	out[0] = vld1q_f32((const float*)row);
+	out[1] = vld1q_f32((const float*)(row + stride));
+	out[2] = vld1q_f32((const float*)(row + 2 * stride));
+	out[3] = vld1q_f32((const float*)(row + 3 * stride));
+	qar_math_transpose4(&out[0], &out[1], &out[2], &out[3]);
+#endif
+}
+
+/* Inverse of qar_math_load_columns. */
+static inline void
+qar_math_store_columns(float* first, size_t stride, const QarMathLanes in[4])
+{
+	char* row = (char*)first;
+#if defined(QAR_MATH_AVX)
+	__m128 r0 = _mm256_castps256_ps128(in[0]);
+	__m128 r1 = _mm256_castps256_ps128(in[1]);
+	__m128 r2 = _mm256_castps256_ps128(in[2]);
+	__m128 r3 = _mm256_castps256_ps128(in[3]);
+	__m128 r4 = _mm256_extractf128_ps(in[0], 1);
+	__m128 r5 = _mm256_extractf128_ps(in[1], 1);
+	__m128 r6 = _mm256_extractf128_ps(in[2], 1);
+	__m128 r7 = _mm256_extractf128_ps(in[3], 1);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	_MM_TRANSPOSE4_PS(r4, r5, r6, r7);
+	_mm_storeu_ps((float*)row, r0);
+	_mm_storeu_ps((float*)(row + stride), r1);
+	_mm_storeu_ps((float*)(row + 2 * stride), r2);
+	_mm_storeu_ps((float*)(row + 3 * stride), r3);
+	_mm_storeu_ps((float*)(row + 4 * stride), r4);
+	_mm_storeu_ps((float*)(row + 5 * stride), r5);
+	_mm_storeu_ps((float*)(row + 6 * stride), r6);
+	_mm_storeu_ps((float*)(row + 7 * stride), r7);
+#elif defined(QAR_MATH_SSE)
+	__m128 r0 = in[0];
+	__m128 r1 = in[1];
+	__m128 r2 = in[2];
+	__m128 r3 = in[3];
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	_mm_storeu_ps((float*)row, r0);
+	_mm_storeu_ps((float*)(row + stride), r1);
+	_mm_storeu_ps((float*)(row + 2 * stride), r2);
+	_mm_storeu_ps((float*)(row + 3 * stride), r3);
+#else
+	float32x4_t r0 = in[0];
+	float32x4_t r1 = in[1];
+	float32x4_t r2 = in[2];
+	float32x4_t r3 = in[3];
+	qar_math_transpose4(&r0, &r1, &r2, &r3);
+	vst1q_f32((float*)row, r0);
+	vst1q_f32((float*)(row + stride), r1);
+	vst1q_f32((float*)(row + 2 * stride), r2);
+	vst1q_f32((float*)(row + 3 * stride), r3);
+#endif
+}
+
+/* Lane-wise qar_quaternion_rotate by the splatted quaternion `q`. */
+static inline void
+qar_math_rotate_lanes(
+	const QarMathLanes q[4], QarMathLanes* x, QarMathLanes* y, QarMathLanes* z
+)
+{
+	const QarMathLanes two = qar_math_splat(2.0f);
+	const QarMathLanes tx = qar_math_mul(
+		two, qar_math_sub(qar_math_mul(q[1], *z), qar_math_mul(q[2], *y))
+	);
+	const QarMathLanes ty = qar_math_mul(
+		two, qar_math_sub(qar_math_mul(q[2], *x), qar_math_mul(q[0], *z))
+	);
+	const QarMathLanes tz = qar_math_mul(
+		two, qar_math_sub(qar_math_mul(q[0], *y), qar_math_mul(q[1], *x))
+	);
+	*x = qar_math_add(
+		qar_math_add(*x, qar_math_mul(q[3], tx)),
+		qar_math_sub(qar_math_mul(q[1], tz), qar_math_mul(q[2], ty))
+	);
+	*y = qar_math_add(
+		qar_math_add(*y, qar_math_mul(q[3], ty)),
+		qar_math_sub(qar_math_mul(q[2], tx), qar_math_mul(q[0], tz))
+	);
+	*z = qar_math_add(
+		qar_math_add(*z, qar_math_mul(q[3], tz)),
+		qar_math_sub(qar_math_mul(q[0], ty), qar_math_mul(q[1], tx))
+	);
+}
+
+/* Lane-wise qar_quaternion_multiply(q, b) for a splatted `q`; `b` is
+ * overwritten. */
+static inline void
+qar_math_multiply_lanes(const QarMathLanes q[4], QarMathLanes b[4])
+{
+	const QarMathLanes x = qar_math_sub(
+		qar_math_add(
+			qar_math_add(qar_math_mul(q[3], b[0]), qar_math_mul(q[0], b[3])),
+			qar_math_mul(q[1], b[2])
+		),
+		qar_math_mul(q[2], b[1])
+	);
+	const QarMathLanes y = qar_math_add(
+		qar_math_add(
+			qar_math_sub(qar_math_mul(q[3], b[1]), qar_math_mul(q[0], b[2])),
+			qar_math_mul(q[1], b[3])
+		),
+		qar_math_mul(q[2], b[0])
+	);
+	const QarMathLanes z = qar_math_add(
+		qar_math_sub(
+			qar_math_add(qar_math_mul(q[3], b[2]), qar_math_mul(q[0], b[1])),
+			qar_math_mul(q[1], b[0])
+		),
+		qar_math_mul(q[2], b[3])
+	);
+	const QarMathLanes w = qar_math_sub(
+		qar_math_sub(
+			qar_math_sub(qar_math_mul(q[3], b[3]), qar_math_mul(q[0], b[0])),
+			qar_math_mul(q[1], b[1])
+		),
+		qar_math_mul(q[2], b[2])
+	);
+	b[0] = x;
+	b[1] = y;
+	b[2] = z;
+	b[3] = w;
+}
+
+#endif // QAR_MATH_LANE_COUNT
+
+/* Transform `count` joint locations from `src` into `dst`, which may be the
+ * same array. */
+static inline void
+qar_scaled_pose_transform_joint_locations(
+	const QarScaledPose* transform,
+	const QarHandJointLocation* src,
+	QarHandJointLocation* dst,
+	size_t count
+)
+{
+	size_t i = 0;
+
+#ifdef QAR_MATH_LANE_COUNT
+	const QarQuaternion rotation = transform->pose.orientation;
+	const QarMathLanes q[4] = { qar_math_splat(rotation.x),
+								qar_math_splat(rotation.y),
+								qar_math_splat(rotation.z),
+								qar_math_splat(rotation.w) };
+	const QarMathLanes scale = qar_math_splat(transform->scale);
+	const QarVector3 translation = transform->pose.position;
+	const QarMathLanes offset[3] = { qar_math_splat(translation.x),
+									 qar_math_splat(translation.y),
+									 qar_math_splat(translation.z) };
+	const size_t stride = sizeof(QarHandJointLocation);
+	for(; i + QAR_MATH_LANE_COUNT <= count; i += QAR_MATH_LANE_COUNT)
+	{
+		// Orientation is four floats; position is followed by the radius,
+		// so one load per joint picks up both and the radius scales along.
+		QarMathLanes orientation[4];
+		QarMathLanes position[4];
+		qar_math_load_columns(&src[i].pose.orientation.x, stride, orientation);
+		qar_math_load_columns(&src[i].pose.position.x, stride, position);
+
+		qar_math_multiply_lanes(q, orientation);
+		position[0] = qar_math_mul(position[0], scale);
+		position[1] = qar_math_mul(position[1], scale);
+		position[2] = qar_math_mul(position[2], scale);
+		position[3] = qar_math_mul(position[3], scale);
+		qar_math_rotate_lanes(q, &position[0], &position[1], &position[2]);
+		position[0] = qar_math_add(position[0], offset[0]);
+		position[1] = qar_math_add(position[1], offset[1]);
+		position[2] = qar_math_add(position[2], offset[2]);
+
+		for(size_t lane = i; lane < i + QAR_MATH_LANE_COUNT; lane++)
+		{
+			dst[lane].joint_id = src[lane].joint_id;
+			dst[lane].location_flags = src[lane].location_flags;
+		}
+		qar_math_store_columns(&dst[i].pose.orientation.x, stride, orientation);
+		qar_math_store_columns(&dst[i].pose.position.x, stride, position);
+	}
+#endif
+
+	for(; i < count; i++)
+	{
+		dst[i].joint_id = src[i].joint_id;
+		dst[i].location_flags = src[i].location_flags;
+		dst[i].pose = qar_scaled_pose_transform_pose(transform, src[i].pose);
+		dst[i].radius = src[i].radius * transform->scale;
+	}
+}
+
+/* Rotate `count` joint velocities from `src` into `dst`, which may be the
+ * same array; linear velocities are scaled too. */
+static inline void
+qar_scaled_pose_transform_joint_velocities(
+	const QarScaledPose* transform,
+	const QarHandJointVelocity* src,
+	QarHandJointVelocity* dst,
+	size_t count
+)
+{
+	const QarQuaternion rotation = transform->pose.orientation;
+	size_t i = 0;
+
+#ifdef QAR_MATH_LANE_COUNT
+	const QarMathLanes q[4] = { qar_math_splat(rotation.x),
+								qar_math_splat(rotation.y),
+								qar_math_splat(rotation.z),
+								qar_math_splat(rotation.w) };
+	const QarMathLanes scale = qar_math_splat(transform->scale);
+	const size_t stride = sizeof(QarHandJointVelocity);
+	for(; i + QAR_MATH_LANE_COUNT <= count; i += QAR_MATH_LANE_COUNT)
+	{
+		// The two velocities are six consecutive floats: load them as
+		// (lx, ly, lz, ax) and (lz, ax, ay, az) to stay inside the struct.
+		QarMathLanes linear[4];
+		QarMathLanes angular[4];
+		qar_math_load_columns(&src[i].linear_velocity.x, stride, linear);
+		qar_math_load_columns(&src[i].linear_velocity.z, stride, angular);
+
+		linear[0] = qar_math_mul(linear[0], scale);
+		linear[1] = qar_math_mul(linear[1], scale);
+		linear[2] = qar_math_mul(linear[2], scale);
+		qar_math_rotate_lanes(q, &linear[0], &linear[1], &linear[2]);
+		qar_math_rotate_lanes(q, &angular[1], &angular[2], &angular[3]);
+		linear[3] = angular[1];
+		angular[0] = linear[2];
+
+		for(size_t lane = i; lane < i + QAR_MATH_LANE_COUNT; lane++)
+		{
+			dst[lane].joint_id = src[lane].joint_id;
+			dst[lane].flags = src[lane].flags;
+		}
+		qar_math_store_columns(&dst[i].linear_velocity.x, stride, linear);
+		qar_math_store_columns(&dst[i].linear_velocity.z, stride, angular);
+	}
+#endif
+
+	for(; i < count; i++)
+	{
+		const QarVector3 linear =
+			qar_vector3_scale(src[i].linear_velocity, transform->scale);
+		dst[i].joint_id = src[i].joint_id;
+		dst[i].flags = src[i].flags;
+		dst[i].linear_velocity = qar_quaternion_rotate(rotation, linear);
+		dst[i].angular_velocity =
+			qar_quaternion_rotate(rotation, src[i].angular_velocity);
+	}
+}
+
+static inline void
+qar_scaled_pose_transform_hand(
+	const QarScaledPose* transform,
+	const QarHandJoints* hand,
+	QarHandJoints* out_hand
+)
+{
+	out_hand->is_tracked = hand->is_tracked;
+	out_hand->is_active = hand->is_active;
+	out_hand->has_velocity = hand->has_velocity;
+	out_hand->pose = qar_scaled_pose_transform_pose(transform, hand->pose);
+	qar_scaled_pose_transform_joint_locations(
+		transform,
+		hand->joint_locations,
+		out_hand->joint_locations,
+		QAR_HAND_JOINT_COUNT
+	);
+	if(hand->has_velocity)
+	{
+		qar_scaled_pose_transform_joint_velocities(
+			transform,
+			hand->joint_velocities,
+			out_hand->joint_velocities,
+			QAR_HAND_JOINT_COUNT
+		);
+	}
+	else if(out_hand != hand)
+	{
+		memcpy(
+			out_hand->joint_velocities,
+			hand->joint_velocities,
+			sizeof(hand->joint_velocities)
+		);
+	}
+}
+
+static inline void
+qar_scaled_pose_transform_hands(
+	const QarScaledPose* transform,
+	const QarDeviceHandsWithJoints* hands,
+	QarDeviceHandsWithJoints* out_hands
+)
+{
+	out_hands->device_id = hands->device_id;
+	out_hands->device_timestamp = hands->device_timestamp;
+	qar_scaled_pose_transform_hand(
+		transform, &hands->left_hand, &out_hands->left_hand
+	);
+	qar_scaled_pose_transform_hand(
+		transform, &hands->right_hand, &out_hands->right_hand
+	);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // QAR_STREAMING_MATH_H
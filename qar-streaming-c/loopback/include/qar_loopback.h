@@ -0,0 +1,140 @@
+/**
+ * @file qar_loopback.h
+ * @brief Control API of the qar-streaming-c loopback runtime.
+ *
+ * The loopback runtime is an in-process stand-in for the qar-streaming-c
+ * shared library. It exports every `qar_impl_*` symbol declared by
+ * qar_streaming.h, so applications load it with qar_library_load() exactly
+ * like the real runtime, but nothing leaves the process:
+ *
+ * - onboarding and rejoin always succeed against a synthetic hub,
+ * - every session sees two synthetic peers, the hub and a visualizer; the
+ *   visualizer requests a render stream as soon as the application subscribes
+ *   to render stream requests,
+ * - render senders copy every shown frame (or only its dirty rectangles) into
+ *   an internal buffer, the way an encoder would read it,
+ * - every active app volume receives a scripted click and a 6DoF drag every
+ *   `gesture_interval_ms`.
+ *
+ * Subscription callbacks run on one dispatcher thread per session, like the
+ * library threads of the real runtime. Use the loopback to run the examples
+ * and benchmarks on machines without a hub. It does not model networking,
+ * encoding cost or D3D11 senders.
+ *
+ * The functions below are exported by the loopback library only. When it was
+ * loaded with qar_library_load(), resolve them with the platform symbol
+ * lookup (dlsym / GetProcAddress) through the `*_fn_t` types.
+ *
+ * Defaults can also be overridden without code through the environment
+ * variables QAR_LOOPBACK_DISPLAY_HZ, QAR_LOOPBACK_PACED,
+ * QAR_LOOPBACK_EYE_WIDTH, QAR_LOOPBACK_EYE_HEIGHT and
+ * QAR_LOOPBACK_GESTURE_INTERVAL_MS, read by qar_library_init().
+ */
+#ifndef QAR_LOOPBACK_H
+#define QAR_LOOPBACK_H
+
+#include "qar_streaming.h"
+
+#define QAR_LOOPBACK_API QAR_C_API
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Behaviour of sessions and render senders created afterwards. */
+typedef struct QarLoopbackConfig
+{
+	/// Nominal display refresh rate used to predict display times, in Hz.
+	uint32_t display_hz;
+	/// When true, begin_frame waits for the next display tick like a headset
+	/// does. When false, frames are only limited by max_frames_in_flight.
+	bool paced;
+	/// Per-view resolution of the layout built when QarRenderSenderInit has
+	/// no frame views.
+	uint32_t eye_width;
+	uint32_t eye_height;
+	/// Period of the scripted gesture sequence played on every active app
+	/// volume, in milliseconds. 0 disables scripted gestures.
+	uint32_t gesture_interval_ms;
+} QarLoopbackConfig;
+
+/** @brief Heap usage of the loopback runtime since it was loaded. */
+typedef struct QarLoopbackAllocationStats
+{
+	uint64_t allocation_count;
+	uint64_t free_count;
+	uint64_t bytes_allocated;
+	uint64_t bytes_in_use;
+} QarLoopbackAllocationStats;
+
+static inline QarLoopbackConfig
+qar_loopback_config_default(void)
+{
+	QarLoopbackConfig config = {
+		90,	  // display_hz
+		false, // paced
+		1024,  // eye_width
+		1024,  // eye_height
+		1000   // gesture_interval_ms
+	};
+	return config;
+}
+
+/**
+ * @brief Replace the configuration used by sessions and render senders
+ * created after this call.
+ *
+ * @retval QAR_STATUS_ARGUMENT_NOT_SUPPORTED display_hz, eye_width or
+ *   eye_height is 0.
+ */
+QAR_LOOPBACK_API QarResult
+qar_loopback_configure(const QarLoopbackConfig* config);
+
+/** @brief Read the current configuration. */
+QAR_LOOPBACK_API QarResult
+qar_loopback_get_config(QarLoopbackConfig* out_config);
+
+/**
+ * @brief Add a synthetic visualizer peer to a session.
+ *
+ * Peer subscribers (or the peer event queue) are notified, and the new peer
+ * requests a render stream from every render request subscription.
+ */
+QAR_LOOPBACK_API QarResult qar_loopback_add_peer(
+	QarSession* session, const char* display_name, QarPeerId* out_peer_id
+);
+
+/**
+ * @brief Deliver a gesture event as if a peer had performed it.
+ *
+ * The event goes through the same path as the scripted gestures: gesture
+ * subscribers of `event->target_app_volume_id` or the gesture event queue.
+ *
+ * @retval QAR_STATUS_APP_VOLUME_INVALID_ID the target volume is unknown.
+ */
+QAR_LOOPBACK_API QarResult qar_loopback_inject_gesture(
+	QarSession* session, const QarAppVolumeGestureEvent* event
+);
+
+/** @brief Read the heap counters of the loopback runtime. */
+QAR_LOOPBACK_API void
+qar_loopback_get_allocation_stats(QarLoopbackAllocationStats* out_stats);
+
+typedef QarResult (*qar_loopback_configure_fn_t)(const QarLoopbackConfig*);
+typedef QarResult (*qar_loopback_get_config_fn_t)(QarLoopbackConfig*);
+typedef QarResult (*qar_loopback_add_peer_fn_t)(
+	QarSession*, const char*, QarPeerId*
+);
+typedef QarResult (*qar_loopback_inject_gesture_fn_t)(
+	QarSession*, const QarAppVolumeGestureEvent*
+);
+typedef void (*qar_loopback_get_allocation_stats_fn_t)(
+	QarLoopbackAllocationStats*
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // QAR_LOOPBACK_H
@@ -0,0 +1,1125 @@
+/**
+ * @file app_volumes.c
+ * @brief App volume table, volume snapshots, gestures and the scripted
+ * gesture sequence.
+ */
+#include "loopback_internal.h"
+#include "qar_streaming_math.h"
+
+#include <math.h>
+
+struct QarAppVolumeHandle
+{
+	LbAppVolume volume; // snapshot; owns its copy of used_by
+};
+
+// ============================================================================
+// VOLUME TABLE
+// ============================================================================
+
+static LbAppVolume*
+lb_app_volumes_find(QarSession* session, const QarAppVolumeId* id)
+{
+	for(size_t index = 0; index < session->app_volume_count; ++index)
+	{
+		if(lb_id_equals(session->app_volumes[index].id.data, id->data))
+		{
+			return &session->app_volumes[index];
+		}
+	}
+	return NULL;
+}
+
+void
+lb_app_volumes_free(QarSession* session)
+{
+	for(size_t index = 0; index < session->app_volume_count; ++index)
+	{
+		lb_peer_set_free(&session->app_volumes[index].used_by);
+	}
+	lb_free(session->app_volumes);
+	session->app_volumes = NULL;
+	session->app_volume_count = 0;
+	session->app_volume_capacity = 0;
+}
+
+static QarAppVolume*
+lb_app_volume_snapshot(const LbAppVolume* volume)
+{
+	QarAppVolume* handle = lb_alloc(sizeof(*handle));
+	if(handle == NULL)
+	{
+		return NULL;
+	}
+	handle->volume = *volume;
+	if(!lb_peer_set_copy(&handle->volume.used_by, &volume->used_by))
+	{
+		lb_free(handle);
+		return NULL;
+	}
+	return handle;
+}
+
+/* Publish a volume change to the volume queue, or to every volume
+ * subscription when the queue is not enabled. */
+static void
+lb_app_volumes_notify_locked(QarSession* session, const LbAppVolume* volume)
+{
+	if(lb_session_queue_enabled(session, LB_QUEUE_APP_VOLUMES))
+	{
+		QarAppVolumeEvent event;
+		memset(&event, 0, sizeof(event));
+		event.volume_id = volume->id;
+		event.pose = volume->pose;
+		event.size = volume->size;
+		event.app_pose = volume->app_pose;
+		event.app_scale = volume->app_scale;
+		event.lifetime_status = volume->lifetime_status;
+		event.editing_status = volume->editing_status;
+		event.timestamp = lb_time_point(lb_now_ns());
+		lb_session_enqueue_locked(session, LB_QUEUE_APP_VOLUMES, &event);
+		return;
+	}
+	for(LbSubscription* subscription = lb_session_next_subscription(
+			session, NULL, LB_SUBSCRIPTION_APP_VOLUMES
+		);
+		subscription != NULL;
+		subscription = lb_session_next_subscription(
+			session, subscription, LB_SUBSCRIPTION_APP_VOLUMES
+		))
+	{
+		LbTask* task = lb_task_create(LB_TASK_APP_VOLUME_UPDATE, subscription);
+		if(task == NULL)
+		{
+			continue;
+		}
+		task->data.app_volume = lb_app_volume_snapshot(volume);
+		if(task->data.app_volume == NULL)
+		{
+			lb_free(task);
+			continue;
+		}
+		lb_session_post_locked(session, task);
+	}
+}
+
+/* Publish a gesture to the gesture queue, or to every matching gesture
+ * subscription when the queue is not enabled. */
+static void
+lb_app_volumes_dispatch_gesture_locked(
+	QarSession* session, const QarAppVolumeGestureEvent* event
+)
+{
+	if(lb_session_queue_enabled(session, LB_QUEUE_APP_VOLUME_GESTURES))
+	{
+		lb_session_enqueue_locked(session, LB_QUEUE_APP_VOLUME_GESTURES, event);
+		return;
+	}
+	for(LbSubscription* subscription = lb_session_next_subscription(
+			session, NULL, LB_SUBSCRIPTION_APP_VOLUME_GESTURES
+		);
+		subscription != NULL;
+		subscription = lb_session_next_subscription(
+			session, subscription, LB_SUBSCRIPTION_APP_VOLUME_GESTURES
+		))
+	{
+		if(subscription->gesture_kind != event->gesture_kind
+		   || (subscription->has_filter
+			   && !lb_id_equals(
+				   subscription->filter_id, event->target_app_volume_id.data
+			   )))
+		{
+			continue;
+		}
+		LbTask* task = lb_task_create(LB_TASK_GESTURE, subscription);
+		if(task == NULL)
+		{
+			continue;
+		}
+		task->data.gesture = *event;
+		lb_session_post_locked(session, task);
+	}
+}
+
+/* Common prologue of the volume mutators: validates arguments and returns the
+ * volume with the session lock held, or NULL with the lock released. */
+static LbAppVolume*
+lb_app_volumes_lock(
+	QarSession* session, const QarAppVolumeId* id, QarResult* out_result
+)
+{
+	if(session == NULL || id == NULL)
+	{
+		*out_result = lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or volume id is NULL"
+		);
+		return NULL;
+	}
+	lb_mutex_lock(&session->lock);
+	LbAppVolume* volume = lb_app_volumes_find(session, id);
+	if(volume == NULL)
+	{
+		lb_mutex_unlock(&session->lock);
+		*out_result = lb_error(
+			QAR_STATUS_APP_VOLUME_INVALID_ID, "unknown app volume id"
+		);
+		return NULL;
+	}
+	*out_result = lb_ok();
+	return volume;
+}
+
+/* Epilogue of the volume mutators: notify and release the session lock. */
+static QarResult
+lb_app_volumes_unlock_notify(
+	QarSession* session, const LbAppVolume* volume, QarResult result
+)
+{
+	lb_app_volumes_notify_locked(session, volume);
+	lb_mutex_unlock(&session->lock);
+	return result;
+}
+
+// ============================================================================
+// VOLUME API
+// ============================================================================
+
+QAR_C_API QarResult
+qar_impl_app_volumes_get_or_create(
+	QarSession* session,
+	const QarAppVolumeInit* init,
+	QarAppVolumeId* out_volume
+)
+{
+	if(session == NULL || out_volume == NULL || init == NULL
+	   || init->header.type != QAR_STRUCTURE_TYPE_APP_VOLUME_INIT
+	   || init->common_name == NULL
+	   || (init->initial_peers == NULL && init->initial_peer_count > 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_app_volume_init_default with common_name "
+			"set"
+		);
+	}
+	if(!(init->app_scale > 0.0f))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "app_scale must be positive"
+		);
+	}
+	QarAppVolumeId id;
+	lb_name_id("app-volume", init->common_name, id.data);
+
+	lb_mutex_lock(&session->lock);
+	if(lb_app_volumes_find(session, &id) == NULL)
+	{
+		if(!lb_reserve(
+			   (void**)&session->app_volumes,
+			   &session->app_volume_capacity,
+			   session->app_volume_count + 1,
+			   sizeof(LbAppVolume)
+		   ))
+		{
+			lb_mutex_unlock(&session->lock);
+			return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+		}
+		LbAppVolume* volume =
+			&session->app_volumes[session->app_volume_count++];
+		memset(volume, 0, sizeof(*volume));
+		volume->id = id;
+		lb_copy_string(
+			volume->display_name,
+			sizeof(volume->display_name),
+			init->display_name != NULL ? init->display_name : init->common_name
+		);
+		volume->pose = init->pose;
+		volume->size = init->size;
+		for(size_t index = 0; index < init->initial_peer_count; ++index)
+		{
+			if(init->initial_peers[index] != NULL)
+			{
+				lb_peer_set_add(&volume->used_by, init->initial_peers[index]);
+			}
+		}
+		volume->app_pose = init->app_pose;
+		volume->app_scale = init->app_scale;
+		volume->app_world_anchor.has_anchor = init->has_app_world_anchor;
+		volume->app_world_anchor.anchor = init->app_world_anchor;
+		volume->lifetime_status = QAR_APP_VOLUME_ACTIVE;
+		volume->gesture_configuration = init->gesture_configuration != NULL
+			? *init->gesture_configuration
+			: qar_app_volume_gesture_configuration_default();
+		volume->gesture_configuration.header.next = NULL;
+		lb_app_volumes_notify_locked(session, volume);
+		// The gesture script may have been idle without volumes.
+		lb_cond_broadcast(&session->dispatcher_wake);
+	}
+	lb_mutex_unlock(&session->lock);
+	*out_volume = id;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_close_volume(
+	QarSession* session, const QarAppVolumeId* volume_id
+)
+{
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	volume->lifetime_status = QAR_APP_VOLUME_CLOSED;
+	lb_app_volumes_notify_locked(session, volume);
+	lb_peer_set_free(&volume->used_by);
+	*volume = session->app_volumes[--session->app_volume_count];
+	lb_mutex_unlock(&session->lock);
+	return result;
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_change_display_name(
+	QarSession* session,
+	const QarAppVolumeId* volume_id,
+	const char* display_name
+)
+{
+	if(display_name == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "display name is NULL"
+		);
+	}
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	lb_copy_string(
+		volume->display_name, sizeof(volume->display_name), display_name
+	);
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_change_size(
+	QarSession* session,
+	const QarAppVolumeId* volume_id,
+	const QarAppVolumeSize* size
+)
+{
+	if(size == NULL || size->width_meters <= 0.0f || size->length_meters <= 0.0f
+	   || size->height_meters <= 0.0f)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "volume size must be positive"
+		);
+	}
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	volume->size = *size;
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_change_pose(
+	QarSession* session, const QarAppVolumeId* volume_id, const QarPose* pose
+)
+{
+	if(pose == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "pose is NULL");
+	}
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	volume->pose = *pose;
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_update_used_by_peers(
+	QarSession* session,
+	const QarAppVolumeId* volume_id,
+	const QarPeerId* peer_additions,
+	size_t additions_count,
+	const QarPeerId* peer_removals,
+	size_t removals_count
+)
+{
+	if((peer_additions == NULL && additions_count > 0)
+	   || (peer_removals == NULL && removals_count > 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "peer id array is NULL"
+		);
+	}
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	for(size_t index = 0; index < additions_count; ++index)
+	{
+		if(!lb_peer_set_add(&volume->used_by, &peer_additions[index]))
+		{
+			result = lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+			break;
+		}
+	}
+	for(size_t index = 0; index < removals_count; ++index)
+	{
+		lb_peer_set_remove(&volume->used_by, &peer_removals[index]);
+	}
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_start_editing(
+	QarSession* session, const QarAppVolumeId* volume_id
+)
+{
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	volume->editing_status.is_being_edited = true;
+	volume->editing_status.editor_peer = session->self.id;
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_stop_editing(
+	QarSession* session, const QarAppVolumeId* volume_id
+)
+{
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	memset(&volume->editing_status, 0, sizeof(volume->editing_status));
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_change_app_pose(
+	QarSession* session,
+	const QarAppVolumeId* volume_id,
+	const QarPose* app_pose
+)
+{
+	if(app_pose == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "app_pose is NULL");
+	}
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	volume->app_pose = *app_pose;
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_change_app_scale(
+	QarSession* session, const QarAppVolumeId* volume_id, float scale
+)
+{
+	if(!(scale > 0.0f))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "app_scale must be positive"
+		);
+	}
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	volume->app_scale = scale;
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_change_app_world_anchor(
+	QarSession* session,
+	const QarAppVolumeId* volume_id,
+	const QarGeoAnchorFrame* anchor
+)
+{
+	if(anchor == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "anchor is NULL");
+	}
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	volume->app_world_anchor.has_anchor = true;
+	volume->app_world_anchor.anchor = *anchor;
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_clear_app_world_anchor(
+	QarSession* session, const QarAppVolumeId* volume_id
+)
+{
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	memset(&volume->app_world_anchor, 0, sizeof(volume->app_world_anchor));
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_change_gesture_configuration(
+	QarSession* session,
+	const QarAppVolumeId* volume_id,
+	const QarAppVolumeGestureConfiguration* config
+)
+{
+	if(config == NULL
+	   || config->header.type
+		   != QAR_STRUCTURE_TYPE_APP_VOLUME_GESTURE_CONFIGURATION
+	   || config->mapping_rule_count > QAR_MAX_APP_VOLUME_GESTURE_MAPPING_RULES)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"config must come from qar_app_volume_gesture_configuration_default"
+		);
+	}
+	QarResult result;
+	LbAppVolume* volume = lb_app_volumes_lock(session, volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	volume->gesture_configuration = *config;
+	volume->gesture_configuration.header.next = NULL;
+	return lb_app_volumes_unlock_notify(session, volume, result);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_subscribe_updates(
+	QarSession* session,
+	qar_app_volume_update_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	if(session == NULL || callback == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or callback is NULL"
+		);
+	}
+	LbSubscription subscription;
+	memset(&subscription, 0, sizeof(subscription));
+	subscription.kind = LB_SUBSCRIPTION_APP_VOLUMES;
+	subscription.callback.app_volume = callback;
+	subscription.user_state = user_state;
+	subscription.token = token;
+	return lb_session_subscribe(session, &subscription);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_subscribe_gesture_updates(
+	QarSession* session,
+	const QarAppVolumeId* volume_id,
+	QarGestureKind gesture_kind,
+	qar_app_volume_gesture_event_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	if(session == NULL || callback == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or callback is NULL"
+		);
+	}
+	LbSubscription subscription;
+	memset(&subscription, 0, sizeof(subscription));
+	subscription.kind = LB_SUBSCRIPTION_APP_VOLUME_GESTURES;
+	subscription.callback.gesture = callback;
+	subscription.user_state = user_state;
+	subscription.token = token;
+	subscription.gesture_kind = gesture_kind;
+	if(volume_id != NULL)
+	{
+		subscription.has_filter = true;
+		memcpy(subscription.filter_id, volume_id->data, QAR_MAX_ID_LENGTH);
+	}
+	return lb_session_subscribe(session, &subscription);
+}
+
+QAR_C_API QarResult
+qar_impl_query_app_volumes_count(QarSession* session, size_t* out_count)
+{
+	if(session == NULL || out_count == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or out pointer is NULL"
+		);
+	}
+	lb_mutex_lock(&session->lock);
+	*out_count = session->app_volume_count;
+	lb_mutex_unlock(&session->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_query_app_volumes(
+	QarSession* session,
+	QarAppVolume** out_handles,
+	size_t handles_buffer_size,
+	size_t* out_handles_written
+)
+{
+	if(session == NULL || out_handles_written == NULL
+	   || (out_handles == NULL && handles_buffer_size > 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or out pointer is NULL"
+		);
+	}
+	size_t written = 0;
+	lb_mutex_lock(&session->lock);
+	while(written < session->app_volume_count && written < handles_buffer_size)
+	{
+		out_handles[written] =
+			lb_app_volume_snapshot(&session->app_volumes[written]);
+		if(out_handles[written] == NULL)
+		{
+			break;
+		}
+		++written;
+	}
+	lb_mutex_unlock(&session->lock);
+	*out_handles_written = written;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_poll_events(
+	QarSession* session,
+	QarAppVolumeEvent* out_events,
+	size_t capacity,
+	size_t* out_count
+)
+{
+	return lb_session_poll(
+		session, LB_QUEUE_APP_VOLUMES, out_events, capacity, out_count
+	);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volumes_poll_gesture_events(
+	QarSession* session,
+	QarAppVolumeGestureEvent* out_events,
+	size_t capacity,
+	size_t* out_count
+)
+{
+	return lb_session_poll(
+		session, LB_QUEUE_APP_VOLUME_GESTURES, out_events, capacity, out_count
+	);
+}
+
+// ============================================================================
+// LATEST STATE
+// ============================================================================
+
+/* Copy one field of the live volume under the session lock. */
+#define LB_APP_VOLUME_GET_LATEST(SESSION, ID, OUT, FIELD)                      \
+	do                                                                         \
+	{                                                                          \
+		if((OUT) == NULL)                                                      \
+		{                                                                      \
+			return lb_error(                                                   \
+				QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "out pointer is NULL"       \
+			);                                                                 \
+		}                                                                      \
+		QarResult result;                                                      \
+		LbAppVolume* volume = lb_app_volumes_lock((SESSION), (ID), &result);   \
+		if(volume == NULL)                                                     \
+		{                                                                      \
+			return result;                                                     \
+		}                                                                      \
+		*(OUT) = volume->FIELD;                                                \
+		lb_mutex_unlock(&(SESSION)->lock);                                     \
+		return result;                                                         \
+	} while(0)
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_latest_app_pose(
+	QarSession* session, const QarAppVolumeId* volume_id, QarPose* out_pose
+)
+{
+	LB_APP_VOLUME_GET_LATEST(session, volume_id, out_pose, app_pose);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_latest_app_scale(
+	QarSession* session, const QarAppVolumeId* volume_id, float* out_scale
+)
+{
+	LB_APP_VOLUME_GET_LATEST(session, volume_id, out_scale, app_scale);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_latest_pose(
+	QarSession* session, const QarAppVolumeId* volume_id, QarPose* out_pose
+)
+{
+	LB_APP_VOLUME_GET_LATEST(session, volume_id, out_pose, pose);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_latest_size(
+	QarSession* session,
+	const QarAppVolumeId* volume_id,
+	QarAppVolumeSize* out_size
+)
+{
+	LB_APP_VOLUME_GET_LATEST(session, volume_id, out_size, size);
+}
+
+#undef LB_APP_VOLUME_GET_LATEST
+
+QAR_C_API QarResult
+qar_impl_app_volumes_get_latest_states(
+	QarSession* session,
+	const QarAppVolumeId* volume_ids,
+	size_t count,
+	QarAppVolumeLatestState* out_states
+)
+{
+	if(session == NULL
+	   || (count > 0 && (volume_ids == NULL || out_states == NULL)))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or arrays are NULL"
+		);
+	}
+	size_t unknown_count = 0;
+	lb_mutex_lock(&session->lock);
+	for(size_t index = 0; index < count; ++index)
+	{
+		QarAppVolumeLatestState* state = &out_states[index];
+		const LbAppVolume* volume =
+			lb_app_volumes_find(session, &volume_ids[index]);
+		if(volume == NULL)
+		{
+			memset(state, 0, sizeof(*state));
+			state->pose = qar_pose_default();
+			state->app_pose = qar_pose_default();
+			state->app_scale = 1.0f;
+			++unknown_count;
+			continue;
+		}
+		state->is_valid = true;
+		state->pose = volume->pose;
+		state->size = volume->size;
+		state->app_pose = volume->app_pose;
+		state->app_scale = volume->app_scale;
+	}
+	lb_mutex_unlock(&session->lock);
+	if(unknown_count > 0)
+	{
+		return lb_error(
+			QAR_STATUS_APP_VOLUME_INVALID_ID,
+			"%zu of %zu app volume ids are unknown",
+			unknown_count,
+			count
+		);
+	}
+	return lb_ok();
+}
+
+// ============================================================================
+// VOLUME HANDLE API
+// ============================================================================
+
+QAR_C_API bool
+qar_impl_app_volume_handle_is_valid(QarAppVolume* handle)
+{
+	return handle != NULL;
+}
+
+QAR_C_API void
+qar_impl_app_volume_handle_destroy(QarAppVolume* handle)
+{
+	if(handle != NULL)
+	{
+		lb_peer_set_free(&handle->volume.used_by);
+		lb_free(handle);
+	}
+}
+
+/* Copy one field of a volume snapshot. */
+#define LB_APP_VOLUME_HANDLE_GET(HANDLE, OUT, FIELD)                           \
+	do                                                                         \
+	{                                                                          \
+		if((HANDLE) == NULL || (OUT) == NULL)                                  \
+		{                                                                      \
+			return lb_error(                                                   \
+				QAR_STATUS_ARGUMENT_NOT_SUPPORTED,                             \
+				"handle or out pointer is NULL"                                \
+			);                                                                 \
+		}                                                                      \
+		*(OUT) = (HANDLE)->volume.FIELD;                                       \
+		return lb_ok();                                                        \
+	} while(0)
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_id(QarAppVolume* handle, QarAppVolumeId* out_id)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_id, id);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_display_name(
+	QarAppVolume* handle, char* out_buffer, size_t buffer_size
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_write_string(
+		handle->volume.display_name, out_buffer, buffer_size
+	);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_pose(QarAppVolume* handle, QarPose* out_pose)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_pose, pose);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_size(QarAppVolume* handle, QarAppVolumeSize* out_size)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_size, size);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_lifetime_status(
+	QarAppVolume* handle, QarAppVolumeLifetimeStatus* out_status
+)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_status, lifetime_status);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_editing_status(
+	QarAppVolume* handle, QarAppVolumeEditingStatus* out_status
+)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_status, editing_status);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_used_by_peers_count(
+	QarAppVolume* handle, size_t* out_peer_count
+)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_peer_count, used_by.count);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_used_by_peers(
+	QarAppVolume* handle,
+	QarPeerId* out_peers,
+	size_t peers_buffer_size,
+	size_t* out_peers_written
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_peer_set_write(
+		&handle->volume.used_by, out_peers, peers_buffer_size, out_peers_written
+	);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_app_pose(QarAppVolume* handle, QarPose* out_pose)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_pose, app_pose);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_app_scale(QarAppVolume* handle, float* out_scale)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_scale, app_scale);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_app_world_anchor(
+	QarAppVolume* handle, QarAppWorldAnchor* out_anchor
+)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_anchor, app_world_anchor);
+}
+
+QAR_C_API QarResult
+qar_impl_app_volume_get_gesture_configuration(
+	QarAppVolume* handle, QarAppVolumeGestureConfiguration* out_config
+)
+{
+	LB_APP_VOLUME_HANDLE_GET(handle, out_config, gesture_configuration);
+}
+
+#undef LB_APP_VOLUME_HANDLE_GET
+
+// ============================================================================
+// GESTURES
+// ============================================================================
+
+/* Scripted sequence, relative to the start of each cycle: a click, then a
+ * 6DoF drag of 10 cm along +x with a 15 degree yaw, in 8 updates. */
+#define LB_SCRIPT_MIN_PERIOD_MS 400
+#define LB_SCRIPT_DRAG_START_MS 250
+#define LB_SCRIPT_DRAG_UPDATES 8
+#define LB_SCRIPT_DRAG_STEP_MS 16
+#define LB_SCRIPT_STEP_COUNT (2 + LB_SCRIPT_DRAG_UPDATES + 1)
+#define LB_SCRIPT_DRAG_METERS 0.1f
+#define LB_SCRIPT_DRAG_YAW_RADIANS 0.2617994f
+
+static uint64_t
+lb_script_step_offset_ns(uint32_t step)
+{
+	uint64_t offset_ms = step == 0
+		? 0
+		: LB_SCRIPT_DRAG_START_MS
+			+ (uint64_t)(step - 1) * LB_SCRIPT_DRAG_STEP_MS;
+	return offset_ms * 1000000ull;
+}
+
+static QarQuaternion
+lb_quaternion_yaw(float radians)
+{
+	QarQuaternion rotation = { 0.0f, sinf(radians * 0.5f), 0.0f,
+							   cosf(radians * 0.5f) };
+	return rotation;
+}
+
+static const QarAppVolumeGestureMappingRule*
+lb_app_volume_find_rule(const LbAppVolume* volume, QarGestureKind kind)
+{
+	const QarAppVolumeGestureConfiguration* config =
+		&volume->gesture_configuration;
+	for(size_t index = 0; index < config->mapping_rule_count; ++index)
+	{
+		const QarAppVolumeGestureMappingRule* rule =
+			&config->mapping_rules[index];
+		if(rule->enabled && rule->gesture_kind == kind)
+		{
+			return rule;
+		}
+	}
+	return NULL;
+}
+
+/* Apply one drag increment to the app pose when the volume maps 6DoF
+ * gestures to it. Returns true when the app pose changed. */
+static bool
+lb_app_volume_map_drag_step(LbAppVolume* volume)
+{
+	const QarAppVolumeGestureMappingRule* rule =
+		lb_app_volume_find_rule(volume, QAR_GESTURE_SINGLE_POINTER_6DOF);
+	if(rule == NULL
+	   || rule->app_transform_mapping
+			  != QAR_GESTURE_APP_TRANSFORM_MAPPING_APP_POSE
+	   || !(rule->precision > 0.0f))
+	{
+		return false;
+	}
+	float gain = 1.0f / rule->precision;
+	if(rule->app_scale_sensitivity_mode
+	   == QAR_APP_SCALE_SENSITIVITY_INVERSE_TO_APP_SCALE)
+	{
+		gain /= volume->app_scale;
+	}
+	else if(rule->app_scale_sensitivity_mode
+			== QAR_APP_SCALE_SENSITIVITY_BASED_ON_APP_SCALE)
+	{
+		gain *= volume->app_scale;
+	}
+	if(rule->translation_axes & QAR_APP_VOLUME_AXIS_X)
+	{
+		volume->app_pose.position.x +=
+			gain * LB_SCRIPT_DRAG_METERS / LB_SCRIPT_DRAG_UPDATES;
+	}
+	if(rule->rotation_axes & QAR_APP_VOLUME_AXIS_Y)
+	{
+		volume->app_pose.orientation = qar_quaternion_multiply(
+			lb_quaternion_yaw(
+				LB_SCRIPT_DRAG_YAW_RADIANS / LB_SCRIPT_DRAG_UPDATES
+			),
+			volume->app_pose.orientation
+		);
+	}
+	return true;
+}
+
+static void
+lb_app_volumes_play_step(QarSession* session, uint32_t step, uint64_t now_ns)
+{
+	QarPeerId source = session->self.id;
+	for(size_t index = 0; index < session->peer_count; ++index)
+	{
+		if(session->peers[index].requests_render_stream)
+		{
+			source = session->peers[index].id;
+			break;
+		}
+	}
+
+	for(size_t index = 0; index < session->app_volume_count; ++index)
+	{
+		LbAppVolume* volume = &session->app_volumes[index];
+		if(volume->lifetime_status != QAR_APP_VOLUME_ACTIVE)
+		{
+			continue;
+		}
+		QarAppVolumeGestureEvent event;
+		memset(&event, 0, sizeof(event));
+		event.source_peer_id = source;
+		event.target_app_volume_id = volume->id;
+		event.timestamp = lb_time_point(now_ns);
+		event.has_start_point = true;
+		event.start_point = volume->pose.position;
+		event.has_action_point = true;
+		event.action_point = volume->pose.position;
+		event.rotation_delta = lb_quaternion_yaw(0.0f);
+		if(step == 0)
+		{
+			event.gesture_kind = QAR_GESTURE_CLICK;
+			event.state = QAR_GESTURE_PHASE_INSTANT;
+			lb_app_volumes_dispatch_gesture_locked(session, &event);
+			continue;
+		}
+
+		float progress = 0.0f;
+		event.gesture_kind = QAR_GESTURE_SINGLE_POINTER_6DOF;
+		if(step == 1)
+		{
+			event.state = QAR_GESTURE_PHASE_STARTED;
+		}
+		else if(step < LB_SCRIPT_STEP_COUNT - 1)
+		{
+			event.state = QAR_GESTURE_PHASE_UPDATED;
+			progress = (float)(step - 1) / LB_SCRIPT_DRAG_UPDATES;
+		}
+		else
+		{
+			event.state = QAR_GESTURE_PHASE_ENDED;
+			progress = 1.0f;
+		}
+		event.translation_delta.x = LB_SCRIPT_DRAG_METERS * progress;
+		event.action_point.x += event.translation_delta.x;
+		event.rotation_delta =
+			lb_quaternion_yaw(LB_SCRIPT_DRAG_YAW_RADIANS * progress);
+		if(event.state == QAR_GESTURE_PHASE_UPDATED
+		   && lb_app_volume_map_drag_step(volume))
+		{
+			event.was_mapped_to_app_transform = true;
+			lb_app_volumes_notify_locked(session, volume);
+		}
+		lb_app_volumes_dispatch_gesture_locked(session, &event);
+	}
+}
+
+uint64_t
+lb_app_volumes_script_tick(QarSession* session, uint64_t now_ns)
+{
+	LbGestureScript* script = &session->gesture_script;
+	if(session->config.gesture_interval_ms == 0
+	   || session->app_volume_count == 0)
+	{
+		script->cycle_start_ns = 0;
+		script->next_step = 0;
+		return 0;
+	}
+	uint32_t period_ms = session->config.gesture_interval_ms;
+	if(period_ms < LB_SCRIPT_MIN_PERIOD_MS)
+	{
+		period_ms = LB_SCRIPT_MIN_PERIOD_MS;
+	}
+	uint64_t period_ns = (uint64_t)period_ms * 1000000ull;
+	if(script->cycle_start_ns == 0)
+	{
+		script->cycle_start_ns = now_ns + period_ns;
+		script->next_step = 0;
+	}
+
+	while(script->cycle_start_ns + lb_script_step_offset_ns(script->next_step)
+		  <= now_ns)
+	{
+		lb_app_volumes_play_step(session, script->next_step, now_ns);
+		if(++script->next_step == LB_SCRIPT_STEP_COUNT)
+		{
+			script->next_step = 0;
+			script->cycle_start_ns += period_ns;
+			// Skip cycles missed while the dispatcher was busy.
+			if(script->cycle_start_ns + period_ns <= now_ns)
+			{
+				script->cycle_start_ns = now_ns;
+			}
+		}
+	}
+	return script->cycle_start_ns + lb_script_step_offset_ns(script->next_step);
+}
+
+// ============================================================================
+// LOOPBACK CONTROL
+// ============================================================================
+
+QAR_LOOPBACK_API QarResult
+qar_loopback_inject_gesture(
+	QarSession* session, const QarAppVolumeGestureEvent* event
+)
+{
+	if(event == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "event is NULL");
+	}
+	QarResult result;
+	LbAppVolume* volume =
+		lb_app_volumes_lock(session, &event->target_app_volume_id, &result);
+	if(volume == NULL)
+	{
+		return result;
+	}
+	lb_app_volumes_dispatch_gesture_locked(session, event);
+	lb_mutex_unlock(&session->lock);
+	return result;
+}
@@ -0,0 +1,591 @@
+/**
+ * @file gui_panels.c
+ * @brief GUI panel table, panel snapshots and panel notifications.
+ */
+#include "loopback_internal.h"
+
+struct QarGuiPanelHandle
+{
+	LbGuiPanel panel; // snapshot; owns its copy of visible_to
+};
+
+// ============================================================================
+// PANEL TABLE
+// ============================================================================
+
+static LbGuiPanel*
+lb_gui_panels_find(QarSession* session, const QarGuiPanelId* id)
+{
+	for(size_t index = 0; index < session->gui_panel_count; ++index)
+	{
+		if(lb_id_equals(session->gui_panels[index].id.data, id->data))
+		{
+			return &session->gui_panels[index];
+		}
+	}
+	return NULL;
+}
+
+static void
+lb_gui_panels_remove(QarSession* session, LbGuiPanel* panel)
+{
+	lb_peer_set_free(&panel->visible_to);
+	*panel = session->gui_panels[--session->gui_panel_count];
+}
+
+void
+lb_gui_panels_free(QarSession* session)
+{
+	for(size_t index = 0; index < session->gui_panel_count; ++index)
+	{
+		lb_peer_set_free(&session->gui_panels[index].visible_to);
+	}
+	lb_free(session->gui_panels);
+	session->gui_panels = NULL;
+	session->gui_panel_count = 0;
+	session->gui_panel_capacity = 0;
+}
+
+static QarGuiPanel*
+lb_gui_panel_snapshot(const LbGuiPanel* panel)
+{
+	QarGuiPanel* handle = lb_alloc(sizeof(*handle));
+	if(handle == NULL)
+	{
+		return NULL;
+	}
+	handle->panel = *panel;
+	if(!lb_peer_set_copy(&handle->panel.visible_to, &panel->visible_to))
+	{
+		lb_free(handle);
+		return NULL;
+	}
+	return handle;
+}
+
+/* Publish a panel change to the panel queue, or to every matching panel
+ * subscription when the queue is not enabled. */
+static void
+lb_gui_panels_notify_locked(QarSession* session, const LbGuiPanel* panel)
+{
+	if(lb_session_queue_enabled(session, LB_QUEUE_GUI_PANELS))
+	{
+		QarGuiPanelEvent event;
+		memset(&event, 0, sizeof(event));
+		event.panel_id = panel->id;
+		event.pose = panel->pose;
+		event.size = panel->size;
+		event.state = panel->state;
+		event.timestamp = lb_time_point(lb_now_ns());
+		lb_session_enqueue_locked(session, LB_QUEUE_GUI_PANELS, &event);
+		return;
+	}
+	for(LbSubscription* subscription = lb_session_next_subscription(
+			session, NULL, LB_SUBSCRIPTION_GUI_PANELS
+		);
+		subscription != NULL;
+		subscription = lb_session_next_subscription(
+			session, subscription, LB_SUBSCRIPTION_GUI_PANELS
+		))
+	{
+		if(subscription->has_filter
+		   && !lb_id_equals(subscription->filter_id, panel->id.data))
+		{
+			continue;
+		}
+		LbTask* task = lb_task_create(LB_TASK_GUI_PANEL_UPDATE, subscription);
+		if(task == NULL)
+		{
+			continue;
+		}
+		task->data.gui_panel = lb_gui_panel_snapshot(panel);
+		if(task->data.gui_panel == NULL)
+		{
+			lb_free(task);
+			continue;
+		}
+		lb_session_post_locked(session, task);
+	}
+}
+
+/* Common prologue of the panel mutators: validates arguments and returns the
+ * panel with the session lock held, or NULL with the lock released. */
+static LbGuiPanel*
+lb_gui_panels_lock(
+	QarSession* session, const QarGuiPanelId* id, QarResult* out_result
+)
+{
+	if(session == NULL || id == NULL)
+	{
+		*out_result = lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or panel id is NULL"
+		);
+		return NULL;
+	}
+	lb_mutex_lock(&session->lock);
+	LbGuiPanel* panel = lb_gui_panels_find(session, id);
+	if(panel == NULL)
+	{
+		lb_mutex_unlock(&session->lock);
+		*out_result = lb_error(
+			QAR_STATUS_GUI_PANEL_INVALID_ID, "unknown GUI panel id"
+		);
+		return NULL;
+	}
+	*out_result = lb_ok();
+	return panel;
+}
+
+// ============================================================================
+// PANEL API
+// ============================================================================
+
+QAR_C_API QarResult
+qar_impl_gui_panels_get_or_create(
+	QarSession* session,
+	const QarGuiPanelInit* init,
+	QarGuiPanelId* out_panel_id
+)
+{
+	if(session == NULL || out_panel_id == NULL || init == NULL
+	   || init->header.type != QAR_STRUCTURE_TYPE_GUI_PANEL_INIT
+	   || init->common_name == NULL
+	   || (init->visible_to_peers == NULL && init->visible_to_peer_count > 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_gui_panel_init_default with common_name "
+			"set"
+		);
+	}
+	QarGuiPanelId id;
+	lb_name_id("gui-panel", init->common_name, id.data);
+
+	lb_mutex_lock(&session->lock);
+	if(lb_gui_panels_find(session, &id) == NULL)
+	{
+		if(!lb_reserve(
+			   (void**)&session->gui_panels,
+			   &session->gui_panel_capacity,
+			   session->gui_panel_count + 1,
+			   sizeof(LbGuiPanel)
+		   ))
+		{
+			lb_mutex_unlock(&session->lock);
+			return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+		}
+		LbGuiPanel* panel = &session->gui_panels[session->gui_panel_count++];
+		memset(panel, 0, sizeof(*panel));
+		panel->id = id;
+		lb_copy_string(
+			panel->display_name,
+			sizeof(panel->display_name),
+			init->display_name != NULL ? init->display_name : init->common_name
+		);
+		panel->pose = init->pose;
+		panel->size = init->size;
+		panel->state = QAR_GUI_PANEL_STATE_VISIBLE;
+		for(size_t index = 0; index < init->visible_to_peer_count; ++index)
+		{
+			lb_peer_set_add(&panel->visible_to, &init->visible_to_peers[index]);
+		}
+		lb_gui_panels_notify_locked(session, panel);
+	}
+	lb_mutex_unlock(&session->lock);
+	*out_panel_id = id;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panels_update_pose(
+	QarSession* session, const QarGuiPanelId* id, const QarPose* pose
+)
+{
+	if(pose == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "pose is NULL");
+	}
+	QarResult result;
+	LbGuiPanel* panel = lb_gui_panels_lock(session, id, &result);
+	if(panel == NULL)
+	{
+		return result;
+	}
+	panel->pose = *pose;
+	lb_gui_panels_notify_locked(session, panel);
+	lb_mutex_unlock(&session->lock);
+	return result;
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panels_change_size(
+	QarSession* session, const QarGuiPanelId* id, const QarGuiPanelSize* size
+)
+{
+	if(size == NULL || size->width_meters <= 0.0f
+	   || size->height_meters <= 0.0f)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "panel size must be positive"
+		);
+	}
+	QarResult result;
+	LbGuiPanel* panel = lb_gui_panels_lock(session, id, &result);
+	if(panel == NULL)
+	{
+		return result;
+	}
+	panel->size = *size;
+	lb_gui_panels_notify_locked(session, panel);
+	lb_mutex_unlock(&session->lock);
+	return result;
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panels_set_state(
+	QarSession* session, const QarGuiPanelId* id, QarGuiPanelState state
+)
+{
+	if(state == QAR_GUI_PANEL_STATE_CLOSED)
+	{
+		return qar_impl_gui_panels_close_panel(session, id);
+	}
+	QarResult result;
+	LbGuiPanel* panel = lb_gui_panels_lock(session, id, &result);
+	if(panel == NULL)
+	{
+		return result;
+	}
+	panel->state = state;
+	lb_gui_panels_notify_locked(session, panel);
+	lb_mutex_unlock(&session->lock);
+	return result;
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panels_close_panel(QarSession* session, const QarGuiPanelId* id)
+{
+	QarResult result;
+	LbGuiPanel* panel = lb_gui_panels_lock(session, id, &result);
+	if(panel == NULL)
+	{
+		return result;
+	}
+	panel->state = QAR_GUI_PANEL_STATE_CLOSED;
+	lb_gui_panels_notify_locked(session, panel);
+	lb_gui_panels_remove(session, panel);
+	lb_mutex_unlock(&session->lock);
+	return result;
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panels_navigate_to_uri(
+	QarSession* session, const QarGuiPanelId* id, const char* uri
+)
+{
+	if(uri == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "uri is NULL");
+	}
+	QarResult result;
+	LbGuiPanel* panel = lb_gui_panels_lock(session, id, &result);
+	if(panel == NULL)
+	{
+		return result;
+	}
+	lb_copy_string(panel->content_uri, sizeof(panel->content_uri), uri);
+	lb_gui_panels_notify_locked(session, panel);
+	lb_mutex_unlock(&session->lock);
+	return result;
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panels_update_visible_to(
+	QarSession* session,
+	const QarGuiPanelId* id,
+	const QarPeerId** peer_ids_additions,
+	size_t additions_count,
+	const QarPeerId** peer_ids_removals,
+	size_t removals_count
+)
+{
+	if((peer_ids_additions == NULL && additions_count > 0)
+	   || (peer_ids_removals == NULL && removals_count > 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "peer id array is NULL"
+		);
+	}
+	QarResult result;
+	LbGuiPanel* panel = lb_gui_panels_lock(session, id, &result);
+	if(panel == NULL)
+	{
+		return result;
+	}
+	for(size_t index = 0; index < additions_count; ++index)
+	{
+		if(peer_ids_additions[index] != NULL
+		   && !lb_peer_set_add(&panel->visible_to, peer_ids_additions[index]))
+		{
+			result = lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+			break;
+		}
+	}
+	for(size_t index = 0; index < removals_count; ++index)
+	{
+		if(peer_ids_removals[index] != NULL)
+		{
+			lb_peer_set_remove(&panel->visible_to, peer_ids_removals[index]);
+		}
+	}
+	lb_gui_panels_notify_locked(session, panel);
+	lb_mutex_unlock(&session->lock);
+	return result;
+}
+
+static QarResult
+lb_gui_panels_subscribe(
+	QarSession* session,
+	const QarGuiPanelId* id,
+	qar_gui_panel_update_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	if(session == NULL || callback == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or callback is NULL"
+		);
+	}
+	LbSubscription subscription;
+	memset(&subscription, 0, sizeof(subscription));
+	subscription.kind = LB_SUBSCRIPTION_GUI_PANELS;
+	subscription.callback.gui_panel = callback;
+	subscription.user_state = user_state;
+	subscription.token = token;
+	if(id != NULL)
+	{
+		subscription.has_filter = true;
+		memcpy(subscription.filter_id, id->data, QAR_MAX_ID_LENGTH);
+	}
+	return lb_session_subscribe(session, &subscription);
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panels_subscribe_updates(
+	QarSession* session,
+	qar_gui_panel_update_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	return lb_gui_panels_subscribe(session, NULL, callback, user_state, token);
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panels_subscribe_panel_updates(
+	QarSession* session,
+	const QarGuiPanelId* id,
+	qar_gui_panel_update_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	if(id == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "panel id is NULL");
+	}
+	return lb_gui_panels_subscribe(session, id, callback, user_state, token);
+}
+
+QAR_C_API QarResult
+qar_impl_query_gui_panels_count(QarSession* session, size_t* out_count)
+{
+	if(session == NULL || out_count == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or out pointer is NULL"
+		);
+	}
+	lb_mutex_lock(&session->lock);
+	*out_count = session->gui_panel_count;
+	lb_mutex_unlock(&session->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_query_gui_panels(
+	QarSession* session,
+	QarGuiPanel** out_handles,
+	size_t handles_buffer_size,
+	size_t* out_handles_written
+)
+{
+	if(session == NULL || out_handles_written == NULL
+	   || (out_handles == NULL && handles_buffer_size > 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or out pointer is NULL"
+		);
+	}
+	size_t written = 0;
+	lb_mutex_lock(&session->lock);
+	while(written < session->gui_panel_count && written < handles_buffer_size)
+	{
+		out_handles[written] =
+			lb_gui_panel_snapshot(&session->gui_panels[written]);
+		if(out_handles[written] == NULL)
+		{
+			break;
+		}
+		++written;
+	}
+	lb_mutex_unlock(&session->lock);
+	*out_handles_written = written;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panels_poll_events(
+	QarSession* session,
+	QarGuiPanelEvent* out_events,
+	size_t capacity,
+	size_t* out_count
+)
+{
+	return lb_session_poll(
+		session, LB_QUEUE_GUI_PANELS, out_events, capacity, out_count
+	);
+}
+
+// ============================================================================
+// PANEL HANDLE API
+// ============================================================================
+
+QAR_C_API bool
+qar_impl_gui_panel_handle_is_valid(QarGuiPanel* handle)
+{
+	return handle != NULL;
+}
+
+QAR_C_API void
+qar_impl_gui_panel_handle_destroy(QarGuiPanel* handle)
+{
+	if(handle != NULL)
+	{
+		lb_peer_set_free(&handle->panel.visible_to);
+		lb_free(handle);
+	}
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panel_get_id(QarGuiPanel* handle, QarGuiPanelId* out_id)
+{
+	if(handle == NULL || out_id == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_id = handle->panel.id;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panel_get_display_name(
+	QarGuiPanel* handle, char* out_buffer, size_t buffer_size
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_write_string(handle->panel.display_name, out_buffer, buffer_size);
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panel_get_pose(QarGuiPanel* handle, QarPose* out_pose)
+{
+	if(handle == NULL || out_pose == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_pose = handle->panel.pose;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panel_get_size(QarGuiPanel* handle, QarGuiPanelSize* out_size)
+{
+	if(handle == NULL || out_size == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_size = handle->panel.size;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panel_get_content_uri(
+	QarGuiPanel* handle, char* out_uri, size_t buffer_size
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_write_string(handle->panel.content_uri, out_uri, buffer_size);
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panel_get_state(QarGuiPanel* handle, QarGuiPanelState* out_state)
+{
+	if(handle == NULL || out_state == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_state = handle->panel.state;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panel_get_visible_to_peers_count(
+	QarGuiPanel* handle, size_t* out_count
+)
+{
+	if(handle == NULL || out_count == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_count = handle->panel.visible_to.count;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_gui_panel_get_visible_to_peers(
+	QarGuiPanel* handle,
+	QarPeerId* out_peers,
+	size_t peers_buffer_size,
+	size_t* out_peers_written
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_peer_set_write(
+		&handle->panel.visible_to,
+		out_peers,
+		peers_buffer_size,
+		out_peers_written
+	);
+}
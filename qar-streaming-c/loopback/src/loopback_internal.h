@@ -0,0 +1,464 @@
+/**
+ * @file loopback_internal.h
+ * @brief Shared state and helpers of the loopback runtime.
+ *
+ * Locking: every session has one mutex protecting its peers, panels, volumes,
+ * subscriptions and the producer side of its event queues. Render senders
+ * have their own mutex. Library-wide state (error messages, configuration)
+ * is protected by g_lb.lock. Callbacks are always invoked without any loopback
+ * lock held.
+ */
+#ifndef QAR_LOOPBACK_INTERNAL_H
+#define QAR_LOOPBACK_INTERNAL_H
+
+#include "qar_loopback.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// ============================================================================
+// PLATFORM
+// ============================================================================
+
+#ifdef _WIN32
+typedef SRWLOCK LbMutex;
+typedef CONDITION_VARIABLE LbCond;
+typedef HANDLE LbThread;
+#define LB_MUTEX_INIT SRWLOCK_INIT
+#else
+typedef pthread_mutex_t LbMutex;
+typedef pthread_cond_t LbCond;
+typedef pthread_t LbThread;
+#define LB_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#endif
+
+typedef void (*lb_thread_fn_t)(void* arg);
+
+void lb_mutex_init(LbMutex* mutex);
+void lb_mutex_destroy(LbMutex* mutex);
+void lb_mutex_lock(LbMutex* mutex);
+void lb_mutex_unlock(LbMutex* mutex);
+
+void lb_cond_init(LbCond* cond);
+void lb_cond_destroy(LbCond* cond);
+void lb_cond_wait(LbCond* cond, LbMutex* mutex);
+/** @brief Wait at most `timeout_ns`; spurious wakeups are possible. */
+void lb_cond_wait_for(LbCond* cond, LbMutex* mutex, uint64_t timeout_ns);
+void lb_cond_broadcast(LbCond* cond);
+
+bool lb_thread_start(LbThread* thread, lb_thread_fn_t fn, void* arg);
+void lb_thread_join(LbThread thread);
+void lb_thread_detach(LbThread thread);
+bool lb_thread_is_current(LbThread thread);
+/** @brief Run `fn(arg)` on a new thread that is never joined. */
+bool lb_thread_start_detached(lb_thread_fn_t fn, void* arg);
+
+/** @brief Monotonic clock in nanoseconds. */
+uint64_t lb_now_ns(void);
+int64_t lb_unix_seconds(void);
+void lb_sleep_ns(uint64_t duration_ns);
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static inline int32_t
+lb_atomic_add_i32(volatile int32_t* value, int32_t delta)
+{
+	return (int32_t)_InterlockedExchangeAdd((volatile long*)value, delta)
+		+ delta;
+}
+static inline int32_t
+lb_atomic_exchange_i32(volatile int32_t* value, int32_t desired)
+{
+	return (int32_t)_InterlockedExchange((volatile long*)value, desired);
+}
+static inline int32_t
+lb_atomic_load_i32(const volatile int32_t* value)
+{
+	return (int32_t)_InterlockedOr((volatile long*)value, 0);
+}
+static inline uint64_t
+lb_atomic_add_u64(volatile uint64_t* value, uint64_t delta)
+{
+	return (uint64_t
+	)_InterlockedExchangeAdd64((volatile __int64*)value, (__int64)delta)
+		+ delta;
+}
+static inline uint64_t
+lb_atomic_load_u64(const volatile uint64_t* value)
+{
+	return (uint64_t)_InterlockedOr64((volatile __int64*)value, 0);
+}
+static inline void
+lb_atomic_store_u64(volatile uint64_t* value, uint64_t desired)
+{
+	_InterlockedExchange64((volatile __int64*)value, (__int64)desired);
+}
+#else
+static inline int32_t
+lb_atomic_add_i32(volatile int32_t* value, int32_t delta)
+{
+	return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+}
+static inline int32_t
+lb_atomic_exchange_i32(volatile int32_t* value, int32_t desired)
+{
+	return __atomic_exchange_n(value, desired, __ATOMIC_ACQ_REL);
+}
+static inline int32_t
+lb_atomic_load_i32(const volatile int32_t* value)
+{
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+static inline uint64_t
+lb_atomic_add_u64(volatile uint64_t* value, uint64_t delta)
+{
+	return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+}
+static inline uint64_t
+lb_atomic_load_u64(const volatile uint64_t* value)
+{
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+static inline void
+lb_atomic_store_u64(volatile uint64_t* value, uint64_t desired)
+{
+	__atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+#endif
+
+// ============================================================================
+// MEMORY
+// ============================================================================
+
+/** @brief Zero-initialized allocation counted in the allocation stats. */
+void* lb_alloc(size_t size);
+void lb_free(void* pointer);
+/** @brief Grow `*items` to hold at least `needed` items. */
+bool lb_reserve(
+	void** items, size_t* capacity, size_t needed, size_t item_size
+);
+/** @brief Zero-initialized, QAR_CPU_BUFFER_ALIGNMENT-aligned allocation. */
+uint8_t* lb_alloc_aligned(size_t size);
+void lb_free_aligned(uint8_t* pointer, size_t size);
+
+// ============================================================================
+// LIBRARY STATE
+// ============================================================================
+
+typedef struct LbGlobals
+{
+	LbMutex lock;
+	bool initialized;
+	bool console_logging;
+	QarLogSeverity log_severity;
+	/// Set by qar_loopback_configure; the environment no longer applies.
+	bool configured;
+	QarLoopbackConfig config;
+} LbGlobals;
+
+extern LbGlobals g_lb;
+
+QarResult lb_ok(void);
+/** @brief Error result without a message; never takes a lock. */
+QarResult lb_status(QarStatusCode code);
+/** @brief Error result with a printf-style message for qar_result_message. */
+QarResult lb_error(QarStatusCode code, const char* format, ...);
+void lb_log(QarLogSeverity severity, const char* format, ...);
+QarLoopbackConfig lb_config(void);
+
+/** @brief Copy a NUL-terminated string, truncating to `buffer_size`. */
+void lb_copy_string(char* out_buffer, size_t buffer_size, const char* text);
+/** @brief String getter body shared by all `*_get_*` string accessors. */
+QarResult lb_write_string(
+	const char* text, char* out_buffer, size_t buffer_size
+);
+
+// ============================================================================
+// IDS, TIME AND CANCELLATION
+// ============================================================================
+
+void lb_random_id(uint8_t out_id[QAR_MAX_ID_LENGTH]);
+/** @brief Stable id derived from `scope` and `name`. */
+void lb_name_id(
+	const char* scope, const char* name, uint8_t out_id[QAR_MAX_ID_LENGTH]
+);
+bool lb_id_is_zero(const uint8_t id[QAR_MAX_ID_LENGTH]);
+bool lb_id_equals(
+	const uint8_t a[QAR_MAX_ID_LENGTH], const uint8_t b[QAR_MAX_ID_LENGTH]
+);
+QarTimePoint lb_time_point(uint64_t time_ns);
+/** @brief Nanoseconds of a QarTimePoint in either precision. */
+uint64_t lb_time_point_ns(QarTimePoint time_point);
+
+struct QarCancelTokenHandle
+{
+	volatile int32_t ref_count;
+	volatile int32_t cancelled;
+	volatile int32_t timed_out;
+	volatile uint64_t deadline_ns; // 0 = no deadline
+};
+
+/** @brief Keep a token alive past the caller's handle (subscriptions). */
+QarCancelToken* lb_cancel_token_retain(QarCancelToken* token);
+void lb_cancel_token_release(QarCancelToken* token);
+/** @brief TIMEOUT or UNCLASSIFIED result for a cancelled operation. */
+QarResult lb_cancelled_result(const QarCancelToken* token);
+
+// ============================================================================
+// SESSION
+// ============================================================================
+
+typedef struct LbPeerSet
+{
+	QarPeerId* ids;
+	size_t count;
+	size_t capacity;
+} LbPeerSet;
+
+bool lb_peer_set_add(LbPeerSet* set, const QarPeerId* id);
+void lb_peer_set_remove(LbPeerSet* set, const QarPeerId* id);
+bool lb_peer_set_copy(LbPeerSet* out_set, const LbPeerSet* set);
+void lb_peer_set_free(LbPeerSet* set);
+QarResult lb_peer_set_write(
+	const LbPeerSet* set,
+	QarPeerId* out_peers,
+	size_t peers_buffer_size,
+	size_t* out_peers_written
+);
+
+typedef struct LbPeer
+{
+	QarPeerId id;
+	char display_name[QAR_MAX_STRING_LENGTH];
+	char app_version[QAR_MAX_STRING_LENGTH];
+	char app_custom_peer_info[QAR_MAX_STRING_LENGTH];
+	QarAppState app_state;
+	/// Synthetic visualizers request a render stream from every subscriber.
+	bool requests_render_stream;
+} LbPeer;
+
+typedef struct LbGuiPanel
+{
+	QarGuiPanelId id;
+	char display_name[QAR_MAX_STRING_LENGTH];
+	char content_uri[QAR_MAX_STRING_LENGTH];
+	QarPose pose;
+	QarGuiPanelSize size;
+	QarGuiPanelState state;
+	LbPeerSet visible_to;
+} LbGuiPanel;
+
+typedef struct LbAppVolume
+{
+	QarAppVolumeId id;
+	char display_name[QAR_MAX_STRING_LENGTH];
+	QarPose pose;
+	QarAppVolumeSize size;
+	LbPeerSet used_by;
+	QarPose app_pose;
+	float app_scale;
+	QarAppWorldAnchor app_world_anchor;
+	QarAppVolumeLifetimeStatus lifetime_status;
+	QarAppVolumeEditingStatus editing_status;
+	QarAppVolumeGestureConfiguration gesture_configuration;
+} LbAppVolume;
+
+typedef enum LbSubscriptionKind
+{
+	LB_SUBSCRIPTION_PEERS,
+	LB_SUBSCRIPTION_GUI_PANELS,
+	LB_SUBSCRIPTION_APP_VOLUMES,
+	LB_SUBSCRIPTION_APP_VOLUME_GESTURES,
+	LB_SUBSCRIPTION_RENDER_REQUESTS
+} LbSubscriptionKind;
+
+typedef union LbCallback
+{
+	qar_peer_update_callback_t peer;
+	qar_gui_panel_update_callback_t gui_panel;
+	qar_app_volume_update_callback_t app_volume;
+	qar_app_volume_gesture_event_callback_t gesture;
+	qar_render_sender_request_callback_t render_request;
+} LbCallback;
+
+typedef struct LbSubscription
+{
+	struct LbSubscription* next;
+	LbSubscriptionKind kind;
+	LbCallback callback;
+	void* user_state;
+	QarCancelToken* token; // retained, may be NULL
+	/// Panel or volume id the subscription is limited to.
+	bool has_filter;
+	uint8_t filter_id[QAR_MAX_ID_LENGTH];
+	QarGestureKind gesture_kind;
+} LbSubscription;
+
+typedef enum LbTaskKind
+{
+	LB_TASK_PEER_UPDATE,
+	LB_TASK_GUI_PANEL_UPDATE,
+	LB_TASK_APP_VOLUME_UPDATE,
+	LB_TASK_GESTURE,
+	LB_TASK_RENDER_REQUEST
+} LbTaskKind;
+
+/** @brief One callback invocation queued for the session dispatcher. */
+typedef struct LbTask
+{
+	struct LbTask* next;
+	LbTaskKind kind;
+	LbCallback callback;
+	void* user_state;
+	union
+	{
+		QarPeerSpec* peer;
+		QarGuiPanel* gui_panel;
+		QarAppVolume* app_volume;
+		QarAppVolumeGestureEvent gesture;
+		QarRenderStreamRequest* render_request;
+	} data;
+} LbTask;
+
+typedef enum LbQueue
+{
+	LB_QUEUE_PEERS,
+	LB_QUEUE_GUI_PANELS,
+	LB_QUEUE_APP_VOLUMES,
+	LB_QUEUE_APP_VOLUME_GESTURES,
+	LB_QUEUE_COUNT
+} LbQueue;
+
+/**
+ * @brief Single-producer/single-consumer event ring.
+ *
+ * The producer runs under the session lock; the consumer only touches `head`
+ * and the overflow flag, so polling never takes a lock.
+ */
+typedef struct LbEventRing
+{
+	uint8_t* items; // NULL when the queue is disabled
+	size_t item_size;
+	uint64_t mask;
+	volatile uint64_t head;
+	volatile uint64_t tail;
+	volatile int32_t overflowed;
+} LbEventRing;
+
+/** @brief Progress of the scripted gesture sequence. */
+typedef struct LbGestureScript
+{
+	uint64_t cycle_start_ns;
+	uint32_t next_step;
+} LbGestureScript;
+
+struct QarSessionHandle
+{
+	volatile int32_t ref_count;
+	QarSession* next_in_runtime;
+	QarRuntime* runtime;
+	QarSessionId id;
+	QarOnboardingId onboarding_id;
+	QarLoopbackConfig config;
+
+	LbMutex lock;
+	bool closed;
+	LbPeer self;
+	LbPeer* peers;
+	size_t peer_count;
+	size_t peer_capacity;
+	LbGuiPanel* gui_panels;
+	size_t gui_panel_count;
+	size_t gui_panel_capacity;
+	LbAppVolume* app_volumes;
+	size_t app_volume_count;
+	size_t app_volume_capacity;
+	LbSubscription* subscriptions;
+	LbEventRing queues[LB_QUEUE_COUNT];
+	/// Polls in flight; LB_QUEUE_SWAP_BIAS is added while the rings are
+	/// being replaced so new polls back off instead of reading them.
+	volatile int32_t queue_pollers;
+	LbGestureScript gesture_script;
+
+	LbCond dispatcher_wake;
+	LbThread dispatcher;
+	bool dispatcher_stop;
+	LbTask* tasks_head;
+	LbTask* tasks_tail;
+};
+
+struct QarRuntimeHandle
+{
+	/// The app's handle and every live session hold one reference each.
+	volatile int32_t ref_count;
+	volatile int32_t handle_released;
+	volatile int32_t shut_down;
+	LbMutex lock;
+	QarSession* sessions; // live sessions, linked through next_in_runtime
+};
+
+QarSession* lb_session_retain(QarSession* session);
+void lb_session_release(QarSession* session);
+
+/** @brief Register a subscription. Takes the session lock. */
+QarResult lb_session_subscribe(
+	QarSession* session, const LbSubscription* subscription
+);
+/** @brief Next live subscription of `kind` after `after` (lock held). */
+LbSubscription* lb_session_next_subscription(
+	QarSession* session, LbSubscription* after, LbSubscriptionKind kind
+);
+/** @brief Allocate a task for the dispatcher; NULL when out of memory. */
+LbTask* lb_task_create(LbTaskKind kind, const LbSubscription* subscription);
+/** @brief Queue a task for the dispatcher thread (session lock held). */
+void lb_session_post_locked(QarSession* session, LbTask* task);
+/** @brief Push an event if `queue` is enabled (session lock held). */
+bool lb_session_enqueue_locked(
+	QarSession* session, LbQueue queue, const void* event
+);
+bool lb_session_queue_enabled(const QarSession* session, LbQueue queue);
+QarResult lb_session_poll(
+	QarSession* session,
+	LbQueue queue,
+	void* out_events,
+	size_t capacity,
+	size_t* out_count
+);
+
+// Module hooks, called with the session lock held unless noted otherwise.
+bool lb_peers_init(
+	QarSession* session, const QarPeerPresentation* presentation
+);
+void lb_peers_free(QarSession* session);
+const LbPeer* lb_peers_find(const QarSession* session, const QarPeerId* id);
+/** @brief Deliver the pending render request of every visualizer peer. */
+void lb_peers_post_render_requests(
+	QarSession* session, const LbSubscription* subscription
+);
+QarRenderStreamRequest* lb_render_request_create(
+	const QarPeerId* target_peer_id
+);
+/** @brief Free the recycled frame infos (library shutdown). */
+void lb_render_frame_info_pool_drain(void);
+/** @brief Quantize rows of 32-bit float depth, see QarDepthEncoding. */
+void lb_encode_depth_rows(
+	uint8_t* destination,
+	uint32_t destination_pitch,
+	const uint8_t* source,
+	uint32_t source_pitch,
+	uint32_t width,
+	uint32_t rows,
+	bool hardware_depth,
+	QarDepthEncoding encoding,
+	QarNearFar near_far
+);
+void lb_gui_panels_free(QarSession* session);
+void lb_app_volumes_free(QarSession* session);
+/** @brief Play due scripted gestures; returns the next due time or 0. */
+uint64_t lb_app_volumes_script_tick(QarSession* session, uint64_t now_ns);
+
+#endif // QAR_LOOPBACK_INTERNAL_H
@@ -0,0 +1,506 @@
+/**
+ * @file peers.c
+ * @brief Peer specs, the synthetic hub and visualizer peers, and peer
+ * notifications.
+ */
+#include "loopback_internal.h"
+
+#define LB_VERSION_ID "loopback-0.1.0"
+#define LB_ROOM_TAG "loopback"
+
+struct QarPeerSpecHandle
+{
+	LbPeer peer;
+};
+
+// ============================================================================
+// PEER TABLE
+// ============================================================================
+
+static void
+lb_peer_init(
+	LbPeer* peer,
+	const char* display_name,
+	const char* app_version,
+	bool requests_render_stream
+)
+{
+	memset(peer, 0, sizeof(*peer));
+	lb_name_id("peer", display_name, peer->id.data);
+	lb_copy_string(
+		peer->display_name, sizeof(peer->display_name), display_name
+	);
+	lb_copy_string(peer->app_version, sizeof(peer->app_version), app_version);
+	peer->app_state = QAR_APP_STATE_RUNNING;
+	peer->requests_render_stream = requests_render_stream;
+}
+
+static LbPeer*
+lb_peers_append(QarSession* session)
+{
+	if(!lb_reserve(
+		   (void**)&session->peers,
+		   &session->peer_capacity,
+		   session->peer_count + 1,
+		   sizeof(LbPeer)
+	   ))
+	{
+		return NULL;
+	}
+	return &session->peers[session->peer_count++];
+}
+
+bool
+lb_peers_init(QarSession* session, const QarPeerPresentation* presentation)
+{
+	char onboarding_text[QAR_UUID_TEXT_BUFFER_SIZE];
+	qar_uuid_to_string(
+		session->onboarding_id.data, onboarding_text, sizeof(onboarding_text)
+	);
+
+	LbPeer* self = &session->self;
+	lb_peer_init(
+		self,
+		presentation->display_name != NULL ? presentation->display_name
+										   : "Loopback App",
+		presentation->app_version,
+		false
+	);
+	lb_name_id("peer", onboarding_text, self->id.data);
+	lb_copy_string(
+		self->app_custom_peer_info,
+		sizeof(self->app_custom_peer_info),
+		presentation->app_custom_peer_info
+	);
+
+	LbPeer* hub = lb_peers_append(session);
+	if(hub == NULL)
+	{
+		return false;
+	}
+	lb_peer_init(hub, "Quaternar Hub (loopback)", LB_VERSION_ID, false);
+	LbPeer* visualizer = lb_peers_append(session);
+	if(visualizer == NULL)
+	{
+		return false;
+	}
+	lb_peer_init(visualizer, "Loopback Visualizer", LB_VERSION_ID, true);
+	return true;
+}
+
+void
+lb_peers_free(QarSession* session)
+{
+	lb_free(session->peers);
+	session->peers = NULL;
+	session->peer_count = 0;
+	session->peer_capacity = 0;
+}
+
+const LbPeer*
+lb_peers_find(const QarSession* session, const QarPeerId* id)
+{
+	if(lb_id_equals(session->self.id.data, id->data))
+	{
+		return &session->self;
+	}
+	for(size_t index = 0; index < session->peer_count; ++index)
+	{
+		if(lb_id_equals(session->peers[index].id.data, id->data))
+		{
+			return &session->peers[index];
+		}
+	}
+	return NULL;
+}
+
+static QarPeerSpec*
+lb_peer_spec_create(const LbPeer* peer)
+{
+	QarPeerSpec* spec = lb_alloc(sizeof(*spec));
+	if(spec != NULL)
+	{
+		spec->peer = *peer;
+	}
+	return spec;
+}
+
+/* Publish a peer change to the peer queue, or to every peer subscription when
+ * the queue is not enabled. */
+static void
+lb_peers_notify_locked(QarSession* session, const LbPeer* peer)
+{
+	if(lb_session_queue_enabled(session, LB_QUEUE_PEERS))
+	{
+		QarPeerEvent event;
+		memset(&event, 0, sizeof(event));
+		event.peer_id = peer->id;
+		event.app_state = peer->app_state;
+		lb_copy_string(
+			event.display_name, sizeof(event.display_name), peer->display_name
+		);
+		event.timestamp = lb_time_point(lb_now_ns());
+		lb_session_enqueue_locked(session, LB_QUEUE_PEERS, &event);
+		return;
+	}
+	for(LbSubscription* subscription =
+			lb_session_next_subscription(session, NULL, LB_SUBSCRIPTION_PEERS);
+		subscription != NULL;
+		subscription = lb_session_next_subscription(
+			session, subscription, LB_SUBSCRIPTION_PEERS
+		))
+	{
+		LbTask* task = lb_task_create(LB_TASK_PEER_UPDATE, subscription);
+		if(task == NULL)
+		{
+			continue;
+		}
+		task->data.peer = lb_peer_spec_create(peer);
+		if(task->data.peer == NULL)
+		{
+			lb_free(task);
+			continue;
+		}
+		lb_session_post_locked(session, task);
+	}
+}
+
+void
+lb_peers_post_render_requests(
+	QarSession* session, const LbSubscription* subscription
+)
+{
+	for(size_t index = 0; index < session->peer_count; ++index)
+	{
+		const LbPeer* peer = &session->peers[index];
+		if(!peer->requests_render_stream)
+		{
+			continue;
+		}
+		LbTask* task = lb_task_create(LB_TASK_RENDER_REQUEST, subscription);
+		if(task == NULL)
+		{
+			continue;
+		}
+		task->data.render_request = lb_render_request_create(&peer->id);
+		if(task->data.render_request == NULL)
+		{
+			lb_free(task);
+			continue;
+		}
+		lb_session_post_locked(session, task);
+	}
+}
+
+// ============================================================================
+// PEER SPEC API
+// ============================================================================
+
+QAR_C_API bool
+qar_impl_peer_spec_handle_is_valid(QarPeerSpec* handle)
+{
+	return handle != NULL;
+}
+
+QAR_C_API void
+qar_impl_peer_spec_handle_destroy(QarPeerSpec* handle)
+{
+	lb_free(handle);
+}
+
+QAR_C_API QarResult
+qar_impl_peer_spec_get_id(QarPeerSpec* handle, QarPeerId* out_id)
+{
+	if(handle == NULL || out_id == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_id = handle->peer.id;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_peer_spec_get_display_name(
+	QarPeerSpec* handle, char* out_buffer, size_t buffer_size
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_write_string(handle->peer.display_name, out_buffer, buffer_size);
+}
+
+QAR_C_API QarResult
+qar_impl_peer_spec_get_app_version(
+	QarPeerSpec* handle, char* out_buffer, size_t buffer_size
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_write_string(handle->peer.app_version, out_buffer, buffer_size);
+}
+
+QAR_C_API QarResult
+qar_impl_peer_spec_get_app_custom_peer_info(
+	QarPeerSpec* handle, char* out_buffer, size_t buffer_size
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_write_string(
+		handle->peer.app_custom_peer_info, out_buffer, buffer_size
+	);
+}
+
+QAR_C_API QarResult
+qar_impl_peer_spec_get_app_state(QarPeerSpec* handle, QarAppState* out_state)
+{
+	if(handle == NULL || out_state == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_state = handle->peer.app_state;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_peer_spec_get_version_id(
+	QarPeerSpec* handle, char* out_buffer, size_t buffer_size
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_write_string(LB_VERSION_ID, out_buffer, buffer_size);
+}
+
+QAR_C_API QarResult
+qar_impl_peer_spec_get_room_tag(
+	QarPeerSpec* handle, char* out_buffer, size_t buffer_size
+)
+{
+	if(handle == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle is NULL");
+	}
+	return lb_write_string(LB_ROOM_TAG, out_buffer, buffer_size);
+}
+
+// ============================================================================
+// SESSION PEER API
+// ============================================================================
+
+QAR_C_API QarResult
+qar_impl_session_get_my_spec(
+	const QarSession* session, QarPeerSpec** out_handle
+)
+{
+	if(session == NULL || out_handle == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or out pointer is NULL"
+		);
+	}
+	QarSession* mutable_session = (QarSession*)session;
+	lb_mutex_lock(&mutable_session->lock);
+	*out_handle = lb_peer_spec_create(&session->self);
+	lb_mutex_unlock(&mutable_session->lock);
+	if(*out_handle == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_query_peer_specs_count(QarSession* session, size_t* out_count)
+{
+	if(session == NULL || out_count == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or out pointer is NULL"
+		);
+	}
+	lb_mutex_lock(&session->lock);
+	*out_count = session->peer_count;
+	lb_mutex_unlock(&session->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_query_peer_specs(
+	QarSession* session,
+	QarPeerSpec** out_handles,
+	size_t handles_buffer_size,
+	size_t* out_handles_written
+)
+{
+	if(session == NULL || out_handles_written == NULL
+	   || (out_handles == NULL && handles_buffer_size > 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or out pointer is NULL"
+		);
+	}
+	size_t written = 0;
+	lb_mutex_lock(&session->lock);
+	while(written < session->peer_count && written < handles_buffer_size)
+	{
+		out_handles[written] = lb_peer_spec_create(&session->peers[written]);
+		if(out_handles[written] == NULL)
+		{
+			break;
+		}
+		++written;
+	}
+	lb_mutex_unlock(&session->lock);
+	*out_handles_written = written;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_peer_update_display_name(QarSession* session, const char* name)
+{
+	if(session == NULL || name == NULL || name[0] == '\0')
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "display name must not be empty"
+		);
+	}
+	lb_mutex_lock(&session->lock);
+	lb_copy_string(
+		session->self.display_name, sizeof(session->self.display_name), name
+	);
+	lb_peers_notify_locked(session, &session->self);
+	lb_mutex_unlock(&session->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_peer_subscribe_updates(
+	QarSession* session,
+	qar_peer_update_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	if(session == NULL || callback == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or callback is NULL"
+		);
+	}
+	LbSubscription subscription;
+	memset(&subscription, 0, sizeof(subscription));
+	subscription.kind = LB_SUBSCRIPTION_PEERS;
+	subscription.callback.peer = callback;
+	subscription.user_state = user_state;
+	subscription.token = token;
+	QarResult result = lb_session_subscribe(session, &subscription);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+
+	// New subscribers first see every peer already in the room.
+	lb_mutex_lock(&session->lock);
+	if(!lb_session_queue_enabled(session, LB_QUEUE_PEERS))
+	{
+		for(size_t index = 0; index < session->peer_count; ++index)
+		{
+			LbTask* task = lb_task_create(LB_TASK_PEER_UPDATE, &subscription);
+			if(task == NULL)
+			{
+				break;
+			}
+			task->data.peer = lb_peer_spec_create(&session->peers[index]);
+			if(task->data.peer == NULL)
+			{
+				lb_free(task);
+				break;
+			}
+			lb_session_post_locked(session, task);
+		}
+	}
+	lb_mutex_unlock(&session->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_peer_poll_events(
+	QarSession* session,
+	QarPeerEvent* out_events,
+	size_t capacity,
+	size_t* out_count
+)
+{
+	return lb_session_poll(
+		session, LB_QUEUE_PEERS, out_events, capacity, out_count
+	);
+}
+
+// ============================================================================
+// LOOPBACK CONTROL
+// ============================================================================
+
+QAR_LOOPBACK_API QarResult
+qar_loopback_add_peer(
+	QarSession* session, const char* display_name, QarPeerId* out_peer_id
+)
+{
+	if(session == NULL || display_name == NULL || display_name[0] == '\0')
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "display name must not be empty"
+		);
+	}
+	lb_mutex_lock(&session->lock);
+	LbPeer* peer = lb_peers_append(session);
+	if(peer == NULL)
+	{
+		lb_mutex_unlock(&session->lock);
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	lb_peer_init(peer, display_name, LB_VERSION_ID, true);
+	// Several peers may share a display name; only the id must be unique.
+	lb_random_id(peer->id.data);
+	LbPeer added = *peer;
+	lb_peers_notify_locked(session, &added);
+	for(LbSubscription* subscription = lb_session_next_subscription(
+			session, NULL, LB_SUBSCRIPTION_RENDER_REQUESTS
+		);
+		subscription != NULL;
+		subscription = lb_session_next_subscription(
+			session, subscription, LB_SUBSCRIPTION_RENDER_REQUESTS
+		))
+	{
+		LbTask* task = lb_task_create(LB_TASK_RENDER_REQUEST, subscription);
+		if(task == NULL)
+		{
+			continue;
+		}
+		task->data.render_request = lb_render_request_create(&added.id);
+		if(task->data.render_request == NULL)
+		{
+			lb_free(task);
+			continue;
+		}
+		lb_session_post_locked(session, task);
+	}
+	lb_mutex_unlock(&session->lock);
+	if(out_peer_id != NULL)
+	{
+		*out_peer_id = added.id;
+	}
+	return lb_ok();
+}
@@ -0,0 +1,463 @@
+/**
+ * @file platform.c
+ * @brief Threads, locks, clocks and counted allocations of the loopback
+ * runtime.
+ */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "loopback_internal.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <time.h>
+#endif
+
+// ============================================================================
+// LOCKS AND THREADS
+// ============================================================================
+
+#ifdef _WIN32
+
+void
+lb_mutex_init(LbMutex* mutex)
+{
+	InitializeSRWLock(mutex);
+}
+
+void
+lb_mutex_destroy(LbMutex* mutex)
+{
+	(void)mutex;
+}
+
+void
+lb_mutex_lock(LbMutex* mutex)
+{
+	AcquireSRWLockExclusive(mutex);
+}
+
+void
+lb_mutex_unlock(LbMutex* mutex)
+{
+	ReleaseSRWLockExclusive(mutex);
+}
+
+void
+lb_cond_init(LbCond* cond)
+{
+	InitializeConditionVariable(cond);
+}
+
+void
+lb_cond_destroy(LbCond* cond)
+{
+	(void)cond;
+}
+
+void
+lb_cond_wait(LbCond* cond, LbMutex* mutex)
+{
+	SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+
+void
+lb_cond_wait_for(LbCond* cond, LbMutex* mutex, uint64_t timeout_ns)
+{
+	uint64_t timeout_ms = (timeout_ns + 999999) / 1000000;
+	if(timeout_ms >= INFINITE)
+	{
+		timeout_ms = INFINITE - 1;
+	}
+	SleepConditionVariableSRW(cond, mutex, (DWORD)timeout_ms, 0);
+}
+
+void
+lb_cond_broadcast(LbCond* cond)
+{
+	WakeAllConditionVariable(cond);
+}
+
+typedef struct LbThreadStart
+{
+	lb_thread_fn_t fn;
+	void* arg;
+} LbThreadStart;
+
+static DWORD WINAPI
+lb_thread_main(LPVOID param)
+{
+	LbThreadStart start = *(LbThreadStart*)param;
+	lb_free(param);
+	start.fn(start.arg);
+	return 0;
+}
+
+bool
+lb_thread_start(LbThread* thread, lb_thread_fn_t fn, void* arg)
+{
+	LbThreadStart* start = lb_alloc(sizeof(*start));
+	if(start == NULL)
+	{
+		return false;
+	}
+	start->fn = fn;
+	start->arg = arg;
+	*thread = CreateThread(NULL, 0, lb_thread_main, start, 0, NULL);
+	if(*thread == NULL)
+	{
+		lb_free(start);
+		return false;
+	}
+	return true;
+}
+
+void
+lb_thread_join(LbThread thread)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+
+void
+lb_thread_detach(LbThread thread)
+{
+	CloseHandle(thread);
+}
+
+bool
+lb_thread_is_current(LbThread thread)
+{
+	return GetThreadId(thread) == GetCurrentThreadId();
+}
+
+bool
+lb_thread_start_detached(lb_thread_fn_t fn, void* arg)
+{
+	LbThread thread;
+	if(!lb_thread_start(&thread, fn, arg))
+	{
+		return false;
+	}
+	lb_thread_detach(thread);
+	return true;
+}
+
+uint64_t
+lb_now_ns(void)
+{
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	if(frequency.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ull
+		+ (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ull
+		/ (uint64_t)frequency.QuadPart;
+}
+
+int64_t
+lb_unix_seconds(void)
+{
+	FILETIME file_time;
+	ULARGE_INTEGER ticks;
+	GetSystemTimeAsFileTime(&file_time);
+	ticks.LowPart = file_time.dwLowDateTime;
+	ticks.HighPart = file_time.dwHighDateTime;
+	return (int64_t)(ticks.QuadPart / 10000000ull) - 11644473600ll;
+}
+
+void
+lb_sleep_ns(uint64_t duration_ns)
+{
+	Sleep((DWORD)((duration_ns + 999999) / 1000000));
+}
+
+#else
+
+void
+lb_mutex_init(LbMutex* mutex)
+{
+	pthread_mutex_init(mutex, NULL);
+}
+
+void
+lb_mutex_destroy(LbMutex* mutex)
+{
+	pthread_mutex_destroy(mutex);
+}
+
+void
+lb_mutex_lock(LbMutex* mutex)
+{
+	pthread_mutex_lock(mutex);
+}
+
+void
+lb_mutex_unlock(LbMutex* mutex)
+{
+	pthread_mutex_unlock(mutex);
+}
+
+void
+lb_cond_init(LbCond* cond)
+{
+	pthread_condattr_t attributes;
+	pthread_condattr_init(&attributes);
+	pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+	pthread_cond_init(cond, &attributes);
+	pthread_condattr_destroy(&attributes);
+}
+
+void
+lb_cond_destroy(LbCond* cond)
+{
+	pthread_cond_destroy(cond);
+}
+
+void
+lb_cond_wait(LbCond* cond, LbMutex* mutex)
+{
+	pthread_cond_wait(cond, mutex);
+}
+
+void
+lb_cond_wait_for(LbCond* cond, LbMutex* mutex, uint64_t timeout_ns)
+{
+	uint64_t deadline_ns = lb_now_ns() + timeout_ns;
+	struct timespec deadline;
+	deadline.tv_sec = (time_t)(deadline_ns / 1000000000ull);
+	deadline.tv_nsec = (long)(deadline_ns % 1000000000ull);
+	pthread_cond_timedwait(cond, mutex, &deadline);
+}
+
+void
+lb_cond_broadcast(LbCond* cond)
+{
+	pthread_cond_broadcast(cond);
+}
+
+typedef struct LbThreadStart
+{
+	lb_thread_fn_t fn;
+	void* arg;
+} LbThreadStart;
+
+static void*
+lb_thread_main(void* param)
+{
+	LbThreadStart start = *(LbThreadStart*)param;
+	lb_free(param);
+	start.fn(start.arg);
+	return NULL;
+}
+
+bool
+lb_thread_start(LbThread* thread, lb_thread_fn_t fn, void* arg)
+{
+	LbThreadStart* start = lb_alloc(sizeof(*start));
+	if(start == NULL)
+	{
+		return false;
+	}
+	start->fn = fn;
+	start->arg = arg;
+	if(pthread_create(thread, NULL, lb_thread_main, start) != 0)
+	{
+		lb_free(start);
+		return false;
+	}
+	return true;
+}
+
+void
+lb_thread_join(LbThread thread)
+{
+	pthread_join(thread, NULL);
+}
+
+void
+lb_thread_detach(LbThread thread)
+{
+	pthread_detach(thread);
+}
+
+bool
+lb_thread_is_current(LbThread thread)
+{
+	return pthread_equal(thread, pthread_self()) != 0;
+}
+
+bool
+lb_thread_start_detached(lb_thread_fn_t fn, void* arg)
+{
+	LbThread thread;
+	if(!lb_thread_start(&thread, fn, arg))
+	{
+		return false;
+	}
+	lb_thread_detach(thread);
+	return true;
+}
+
+uint64_t
+lb_now_ns(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+int64_t
+lb_unix_seconds(void)
+{
+	return (int64_t)time(NULL);
+}
+
+void
+lb_sleep_ns(uint64_t duration_ns)
+{
+	struct timespec duration;
+	duration.tv_sec = (time_t)(duration_ns / 1000000000ull);
+	duration.tv_nsec = (long)(duration_ns % 1000000000ull);
+	while(nanosleep(&duration, &duration) != 0 && errno == EINTR)
+	{
+	}
+}
+
+#endif
+
+// ============================================================================
+// MEMORY
+// ============================================================================
+
+static volatile uint64_t g_allocation_count;
+static volatile uint64_t g_free_count;
+static volatile uint64_t g_bytes_allocated;
+static volatile uint64_t g_bytes_in_use;
+
+/* Every lb_alloc block starts with its size so frees can be accounted. */
+typedef union LbAllocationHeader
+{
+	size_t size;
+	max_align_t alignment;
+} LbAllocationHeader;
+
+static void
+lb_count_allocation(size_t size)
+{
+	lb_atomic_add_u64(&g_allocation_count, 1);
+	lb_atomic_add_u64(&g_bytes_allocated, size);
+	lb_atomic_add_u64(&g_bytes_in_use, size);
+}
+
+static void
+lb_count_free(size_t size)
+{
+	lb_atomic_add_u64(&g_free_count, 1);
+	lb_atomic_add_u64(&g_bytes_in_use, (uint64_t)0 - size);
+}
+
+void*
+lb_alloc(size_t size)
+{
+	LbAllocationHeader* header = calloc(1, sizeof(*header) + size);
+	if(header == NULL)
+	{
+		return NULL;
+	}
+	header->size = size;
+	lb_count_allocation(size);
+	return header + 1;
+}
+
+void
+lb_free(void* pointer)
+{
+	if(pointer == NULL)
+	{
+		return;
+	}
+	LbAllocationHeader* header = (LbAllocationHeader*)pointer - 1;
+	lb_count_free(header->size);
+	free(header);
+}
+
+bool
+lb_reserve(void** items, size_t* capacity, size_t needed, size_t item_size)
+{
+	if(needed <= *capacity)
+	{
+		return true;
+	}
+	size_t new_capacity = *capacity < 4 ? 4 : *capacity * 2;
+	while(new_capacity < needed)
+	{
+		new_capacity *= 2;
+	}
+	void* new_items = lb_alloc(new_capacity * item_size);
+	if(new_items == NULL)
+	{
+		return false;
+	}
+	if(*items != NULL)
+	{
+		memcpy(new_items, *items, *capacity * item_size);
+		lb_free(*items);
+	}
+	*items = new_items;
+	*capacity = new_capacity;
+	return true;
+}
+
+uint8_t*
+lb_alloc_aligned(size_t size)
+{
+	void* pointer = NULL;
+#ifdef _WIN32
+	pointer = _aligned_malloc(size, QAR_CPU_BUFFER_ALIGNMENT);
+#else
+	if(posix_memalign(&pointer, QAR_CPU_BUFFER_ALIGNMENT, size) != 0)
+	{
+		pointer = NULL;
+	}
+#endif
+	if(pointer == NULL)
+	{
+		return NULL;
+	}
+	memset(pointer, 0, size);
+	lb_count_allocation(size);
+	return pointer;
+}
+
+void
+lb_free_aligned(uint8_t* pointer, size_t size)
+{
+	if(pointer == NULL)
+	{
+		return;
+	}
+	lb_count_free(size);
+#ifdef _WIN32
+	_aligned_free(pointer);
+#else
+	free(pointer);
+#endif
+}
+
+QAR_LOOPBACK_API void
+qar_loopback_get_allocation_stats(QarLoopbackAllocationStats* out_stats)
+{
+	if(out_stats == NULL)
+	{
+		return;
+	}
+	out_stats->allocation_count = lb_atomic_load_u64(&g_allocation_count);
+	out_stats->free_count = lb_atomic_load_u64(&g_free_count);
+	out_stats->bytes_allocated = lb_atomic_load_u64(&g_bytes_allocated);
+	out_stats->bytes_in_use = lb_atomic_load_u64(&g_bytes_in_use);
+}
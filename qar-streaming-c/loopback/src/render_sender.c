@@ -0,0 +1,2482 @@
+/**
+ * @file render_sender.c
+ * @brief Render stream requests and CPU render senders.
+ *
+ * Shown frames are copied into a per-sender "consumed" texture set, the way
+ * the encoder of the real runtime reads them, so a benchmark against the
+ * loopback pays the same memory traffic per shown byte.
+ */
+#include "loopback_internal.h"
+#include "qar_streaming_math.h"
+
+#include <math.h>
+
+#define LB_IPD_METERS 0.064f
+#define LB_HALF_FOV_RADIANS 0.785f
+#define LB_HEAD_HEIGHT_METERS 1.6f
+#define LB_ROW_ALIGNMENT 64u
+#define LB_FRAME_INFO_POOL_LIMIT 16
+/// Weight of the newest sample in the smoothed stats (about 16 frames).
+#define LB_STATS_SMOOTHING (1.0 / 16.0)
+/// Dynamic resolution keeps the smoothed encode time between these shares
+/// of the display period.
+#define LB_ENCODE_BUDGET_HIGH 0.5
+#define LB_ENCODE_BUDGET_LOW 0.3
+#define LB_RESOLUTION_STEP_DOWN 0.9f
+#define LB_RESOLUTION_STEP_UP 1.05f
+/// Frames to wait after a step so the smoothed encode time catches up.
+#define LB_RESOLUTION_HOLD_FRAMES 16
+/// Rate of the synthetic hand tracker, independent of the frame rate.
+#define LB_HAND_TRACKING_HZ 90
+/// The synthetic hands sway around their rest position at this rate.
+#define LB_HAND_SWAY_RADIANS_PER_SECOND 3.0f
+
+// ============================================================================
+// RENDER STREAM REQUESTS
+// ============================================================================
+
+struct QarRenderStreamRequestHandle
+{
+	QarPeerId target_peer_id;
+	QarStreamId stream_id;
+};
+
+QarRenderStreamRequest*
+lb_render_request_create(const QarPeerId* target_peer_id)
+{
+	QarRenderStreamRequest* request = lb_alloc(sizeof(*request));
+	if(request != NULL)
+	{
+		request->target_peer_id = *target_peer_id;
+		lb_random_id(request->stream_id.data);
+	}
+	return request;
+}
+
+QAR_C_API void
+qar_impl_render_request_handle_destroy(QarRenderStreamRequest* request)
+{
+	lb_free(request);
+}
+
+QAR_C_API QarResult
+qar_impl_render_request_get_target_peer_id(
+	QarRenderStreamRequest* request, QarPeerId* out_peer_id
+)
+{
+	if(request == NULL || out_peer_id == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "request or out pointer is NULL"
+		);
+	}
+	*out_peer_id = request->target_peer_id;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_request_get_stream_id(
+	QarRenderStreamRequest* request, QarStreamId* out_stream_id
+)
+{
+	if(request == NULL || out_stream_id == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "request or out pointer is NULL"
+		);
+	}
+	*out_stream_id = request->stream_id;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_subscribe_requests(
+	QarSession* session,
+	qar_render_sender_request_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	if(session == NULL || callback == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or callback is NULL"
+		);
+	}
+	LbSubscription subscription;
+	memset(&subscription, 0, sizeof(subscription));
+	subscription.kind = LB_SUBSCRIPTION_RENDER_REQUESTS;
+	subscription.callback.render_request = callback;
+	subscription.user_state = user_state;
+	subscription.token = token;
+	QarResult result = lb_session_subscribe(session, &subscription);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	lb_mutex_lock(&session->lock);
+	lb_peers_post_render_requests(session, &subscription);
+	lb_mutex_unlock(&session->lock);
+	return lb_ok();
+}
+
+// ============================================================================
+// FRAME INFO
+// ============================================================================
+
+struct QarRenderFrameInfoHandle
+{
+	struct QarRenderFrameInfoHandle* next_free;
+	QarRenderFrameBegin frame;
+};
+
+/* Frame infos are recycled so a steady begin/show loop does not allocate. */
+static LbMutex g_frame_info_pool_lock = LB_MUTEX_INIT;
+static QarRenderFrameInfo* g_frame_info_pool;
+static size_t g_frame_info_pool_count;
+
+static QarRenderFrameInfo*
+lb_frame_info_acquire(void)
+{
+	lb_mutex_lock(&g_frame_info_pool_lock);
+	QarRenderFrameInfo* info = g_frame_info_pool;
+	if(info != NULL)
+	{
+		g_frame_info_pool = info->next_free;
+		--g_frame_info_pool_count;
+	}
+	lb_mutex_unlock(&g_frame_info_pool_lock);
+	if(info == NULL)
+	{
+		return lb_alloc(sizeof(*info));
+	}
+	memset(info, 0, sizeof(*info));
+	return info;
+}
+
+void
+lb_render_frame_info_pool_drain(void)
+{
+	lb_mutex_lock(&g_frame_info_pool_lock);
+	QarRenderFrameInfo* info = g_frame_info_pool;
+	g_frame_info_pool = NULL;
+	g_frame_info_pool_count = 0;
+	lb_mutex_unlock(&g_frame_info_pool_lock);
+	while(info != NULL)
+	{
+		QarRenderFrameInfo* next = info->next_free;
+		lb_free(info);
+		info = next;
+	}
+}
+
+QAR_C_API void
+qar_impl_render_frame_info_handle_destroy(QarRenderFrameInfo* handle)
+{
+	if(handle == NULL)
+	{
+		return;
+	}
+	lb_mutex_lock(&g_frame_info_pool_lock);
+	if(g_frame_info_pool_count < LB_FRAME_INFO_POOL_LIMIT)
+	{
+		handle->next_free = g_frame_info_pool;
+		g_frame_info_pool = handle;
+		++g_frame_info_pool_count;
+		handle = NULL;
+	}
+	lb_mutex_unlock(&g_frame_info_pool_lock);
+	lb_free(handle);
+}
+
+QAR_C_API QarResult
+qar_impl_render_frame_info_get_view_pose(
+	QarRenderFrameInfo* handle, size_t view_index, QarPose* out_pose
+)
+{
+	if(handle == NULL || out_pose == NULL
+	   || view_index >= handle->frame.views_count)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"view index %zu out of range",
+			view_index
+		);
+	}
+	*out_pose = handle->frame.view_poses[view_index];
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_frame_info_get_view_fov(
+	QarRenderFrameInfo* handle, size_t view_index, QarFov* out_fov
+)
+{
+	if(handle == NULL || out_fov == NULL
+	   || view_index >= handle->frame.views_count)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"view index %zu out of range",
+			view_index
+		);
+	}
+	*out_fov = handle->frame.view_fovs[view_index];
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_frame_info_get_view_active_rect(
+	QarRenderFrameInfo* handle,
+	size_t view_index,
+	QarRenderFrameViewRect* out_rect
+)
+{
+	if(handle == NULL || out_rect == NULL
+	   || view_index >= handle->frame.views_count)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"view index %zu out of range",
+			view_index
+		);
+	}
+	*out_rect = handle->frame.view_active_rects[view_index];
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_frame_info_get_resolution_scale(
+	QarRenderFrameInfo* handle, float* out_scale
+)
+{
+	if(handle == NULL || out_scale == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_scale = handle->frame.resolution_scale;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_frame_info_get_frame_index(
+	QarRenderFrameInfo* handle, uint64_t* out_frame_index
+)
+{
+	if(handle == NULL || out_frame_index == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_frame_index = handle->frame.frame_index;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_frame_info_get_predicted_display_time(
+	QarRenderFrameInfo* handle, QarTimePoint* out_display_time
+)
+{
+	if(handle == NULL || out_display_time == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_display_time = handle->frame.predicted_display_time;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_frame_info_get_pose_sample_time(
+	QarRenderFrameInfo* handle, QarTimePoint* out_sample_time
+)
+{
+	if(handle == NULL || out_sample_time == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_sample_time = handle->frame.pose_sample_time;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_frame_info_get_prediction_horizon(
+	QarRenderFrameInfo* handle, QarTimePoint* out_horizon
+)
+{
+	if(handle == NULL || out_horizon == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "handle or out pointer is NULL"
+		);
+	}
+	*out_horizon = handle->frame.prediction_horizon;
+	return lb_ok();
+}
+
+// ============================================================================
+// SENDER
+// ============================================================================
+
+struct QarRenderStreamSenderHandle
+{
+	volatile int32_t ref_count;
+	QarSession* session; // retained
+	QarPeerId peer_id;
+	uint32_t max_frames_in_flight;
+	uint64_t display_period_ns;
+	bool paced;
+	/// Tangent-space share of the FOV covered by fovea views.
+	float fovea_fraction;
+
+	LbMutex lock;
+	LbCond frame_shown;
+	QarVideoFrameLayout layout;
+	/// Runtime-owned textures, one set per in-flight frame.
+	QarVideoTextureCpu frames[QAR_MAX_FRAMES_IN_FLIGHT][QAR_MAX_FRAME_TEXTURES];
+	/// What the encoder last read; dirty rects are applied on top of it.
+	QarVideoTextureCpu consumed[QAR_MAX_FRAME_TEXTURES];
+	bool consumed_valid;
+
+	bool has_ring;
+	QarRenderSenderCpuBufferRing ring;
+	uint32_t next_ring_slot;
+	/// Bit per ring slot acquired but not shown yet.
+	uint32_t ring_slots_in_use;
+
+	/// Frames [frames_shown, frames_begun) are in flight, oldest first.
+	uint64_t frames_begun;
+	uint64_t frames_shown;
+	uint64_t last_vsync_ns;
+	uint64_t begin_ns[QAR_MAX_FRAMES_IN_FLIGHT];
+	uint64_t display_ns[QAR_MAX_FRAMES_IN_FLIGHT];
+	/// Requested pose prediction horizon; 0 predicts for the display time.
+	uint64_t prediction_horizon_ns;
+
+	bool dynamic_resolution;
+	float min_resolution_scale;
+	/// Scale the next begun frame gets.
+	float resolution_scale;
+	float shown_resolution_scale;
+	float frame_scales[QAR_MAX_FRAMES_IN_FLIGHT];
+	uint32_t frames_since_resolution_step;
+	QarRenderFrameViewRect active_rects[QAR_MAX_FRAMES_IN_FLIGHT]
+									   [QAR_MAX_FRAME_VIEWS];
+
+	QarDepthEncoding depth_encoding;
+	/// Near/far of the frame being consumed, for the depth encodings.
+	QarNearFar shown_near_far;
+	bool skip_transparent_tiles;
+	/// Caller tile masks of the frame being consumed, or NULL.
+	const QarRenderFrameShowOccupancyExt* shown_occupancy;
+
+	uint64_t bytes_consumed;
+	uint64_t last_show_ns;
+	/// Exponentially smoothed timings in nanoseconds.
+	double frame_interval_ns;
+	double frame_interval_variance;
+	double encode_ns;
+	double pose_to_photon_ns;
+
+	/// Synthetic tracker samples, oldest at hand_history_start.
+	QarDeviceHandsWithJoints hand_history[QAR_HAND_HISTORY_CAPACITY];
+	size_t hand_history_start;
+	size_t hand_history_count;
+	uint64_t last_hand_sample_ns;
+};
+
+static bool
+lb_pixel_format_supported(QarPixelFormat format)
+{
+	return qar_pixel_format_size(format) != 0;
+}
+
+static uint32_t
+lb_row_pitch(const QarTextureSize* size)
+{
+	uint32_t row = size->width * qar_pixel_format_size(size->format);
+	return (row + LB_ROW_ALIGNMENT - 1) & ~(LB_ROW_ALIGNMENT - 1);
+}
+
+static size_t
+lb_texture_bytes(const QarTextureSize* size, uint32_t pitch)
+{
+	return (size_t)pitch * size->height * size->array_layers;
+}
+
+static void
+lb_texture_free(QarVideoTextureCpu* texture)
+{
+	lb_free_aligned(texture->texture_data, texture->texture_data_size);
+	*texture = qar_video_texture_cpu_default();
+}
+
+static bool
+lb_texture_alloc(QarVideoTextureCpu* texture, const QarTextureSize* size)
+{
+	texture->size = *size;
+	texture->pitch = lb_row_pitch(size);
+	texture->texture_data_size = lb_texture_bytes(size, texture->pitch);
+	texture->texture_data = lb_alloc_aligned(texture->texture_data_size);
+	return texture->texture_data != NULL;
+}
+
+static void
+lb_sender_free_textures(QarRenderSender* sender)
+{
+	for(size_t slot = 0; slot < QAR_MAX_FRAMES_IN_FLIGHT; ++slot)
+	{
+		for(size_t texture = 0; texture < QAR_MAX_FRAME_TEXTURES; ++texture)
+		{
+			lb_texture_free(&sender->frames[slot][texture]);
+		}
+	}
+	for(size_t texture = 0; texture < QAR_MAX_FRAME_TEXTURES; ++texture)
+	{
+		lb_texture_free(&sender->consumed[texture]);
+	}
+	sender->consumed_valid = false;
+}
+
+static bool
+lb_sender_alloc_textures(QarRenderSender* sender)
+{
+	for(size_t texture = 0; texture < sender->layout.textures_count; ++texture)
+	{
+		const QarTextureSize* size = &sender->layout.textures[texture];
+		for(uint32_t slot = 0; slot < sender->max_frames_in_flight; ++slot)
+		{
+			if(!lb_texture_alloc(&sender->frames[slot][texture], size))
+			{
+				return false;
+			}
+		}
+		if(!lb_texture_alloc(&sender->consumed[texture], size))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Pixel rectangle a view covers in its texture layer. */
+static QarRenderFrameViewRect
+lb_view_bounds(const QarVideoFrameView* view)
+{
+	QarRenderFrameViewRect bounds;
+	bounds.x = view->start_x < view->end_x ? view->start_x : view->end_x;
+	bounds.y = view->start_y < view->end_y ? view->start_y : view->end_y;
+	bounds.width = view->start_x < view->end_x ? view->end_x - view->start_x
+											   : view->start_x - view->end_x;
+	bounds.height = view->start_y < view->end_y ? view->end_y - view->start_y
+												: view->start_y - view->end_y;
+	return bounds;
+}
+
+static QarResult
+lb_validate_layout(const QarVideoFrameLayout* layout)
+{
+	if(layout->views_count == 0 || layout->views_count > QAR_MAX_FRAME_VIEWS
+	   || layout->textures_count == 0
+	   || layout->textures_count > QAR_MAX_FRAME_TEXTURES)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"layout needs 1..%d views and 1..%d textures",
+			QAR_MAX_FRAME_VIEWS,
+			QAR_MAX_FRAME_TEXTURES
+		);
+	}
+	for(size_t index = 0; index < layout->textures_count; ++index)
+	{
+		const QarTextureSize* size = &layout->textures[index];
+		if(size->width == 0 || size->height == 0 || size->array_layers == 0
+		   || !lb_pixel_format_supported(size->format))
+		{
+			return lb_error(
+				QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+				"texture %zu has no size or an unsupported format",
+				index
+			);
+		}
+	}
+	for(size_t index = 0; index < layout->views_count; ++index)
+	{
+		const QarVideoFrameView* view = &layout->views[index];
+		if(view->texture_index >= layout->textures_count)
+		{
+			return lb_error(
+				QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+				"view %zu references texture %u",
+				index,
+				view->texture_index
+			);
+		}
+		const QarTextureSize* size = &layout->textures[view->texture_index];
+		uint32_t max_x =
+			view->start_x > view->end_x ? view->start_x : view->end_x;
+		uint32_t max_y =
+			view->start_y > view->end_y ? view->start_y : view->end_y;
+		if(max_x > size->width || max_y > size->height
+		   || view->array_layer_index >= size->array_layers
+		   || view->texture_format != size->format)
+		{
+			return lb_error(
+				QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+				"view %zu does not fit texture %u",
+				index,
+				view->texture_index
+			);
+		}
+	}
+	return lb_ok();
+}
+
+static bool
+lb_color_format_supported(QarPixelFormat format)
+{
+	return format == QAR_PIXEL_FORMAT_R8G8B8A8
+		|| format == QAR_PIXEL_FORMAT_B8G8R8A8
+		|| format == QAR_PIXEL_FORMAT_R16G16B16A16
+		|| format == QAR_PIXEL_FORMAT_R32_FLOAT;
+}
+
+static bool
+lb_depth_format_supported(QarPixelFormat format)
+{
+	return format == QAR_PIXEL_FORMAT_D32_FLOAT
+		|| format == QAR_PIXEL_FORMAT_R32_FLOAT;
+}
+
+/* Build the initial layout from the sender init. Views sharing a texture are
+ * placed side by side (LAYOUT_SIDE_BY_SIDE) or on separate layers
+ * (LAYOUT_LAYERED); SEPARATED_TEXTURES gives every view its own texture.
+ * With foveation every requested view becomes a fovea and a periphery view
+ * of the same texture. */
+static QarResult
+lb_build_layout(
+	const QarRenderSenderInit* init,
+	const QarRenderSenderFoveationExt* foveation,
+	const QarLoopbackConfig* config,
+	QarVideoFrameLayout* out_layout
+)
+{
+	static const QarRenderFrameView k_default_views[] = {
+		{ QAR_VIDEO_FRAME_VIEW_TYPE_COLOR, QAR_VIDEO_FRAME_VIEW_EYE_LEFT, 0 },
+		{ QAR_VIDEO_FRAME_VIEW_TYPE_COLOR, QAR_VIDEO_FRAME_VIEW_EYE_RIGHT, 0 },
+		{ QAR_VIDEO_FRAME_VIEW_TYPE_DEPTH, QAR_VIDEO_FRAME_VIEW_EYE_LEFT, 1 },
+		{ QAR_VIDEO_FRAME_VIEW_TYPE_DEPTH, QAR_VIDEO_FRAME_VIEW_EYE_RIGHT, 1 },
+	};
+	const QarRenderFrameView* views = init->frame_views;
+	size_t views_count = init->frame_views_count;
+	if(views_count == 0)
+	{
+		views = k_default_views;
+		views_count = sizeof(k_default_views) / sizeof(k_default_views[0]);
+	}
+	size_t regions = foveation != NULL ? 2 : 1;
+	if(views_count * regions > QAR_MAX_FRAME_VIEWS)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"at most %d frame views (%d with foveation)",
+			QAR_MAX_FRAME_VIEWS,
+			QAR_MAX_FRAME_VIEWS / 2
+		);
+	}
+
+	QarVideoFrameLayout layout = qar_video_frame_layout_default();
+	uint32_t views_per_texture[QAR_MAX_FRAME_TEXTURES] = { 0 };
+	for(size_t index = 0; index < views_count * regions; ++index)
+	{
+		const QarRenderFrameView* source = &views[index / regions];
+		// A fovea and its periphery always share their texture.
+		uint32_t texture_index =
+			init->texture_layout == QAR_FRAME_LAYOUT_SEPARATED_TEXTURES
+			? (uint32_t)(index / regions)
+			: source->texture_index;
+		if(texture_index >= QAR_MAX_FRAME_TEXTURES)
+		{
+			return lb_error(
+				QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+				"view %zu needs texture %u, at most %d are supported",
+				index,
+				texture_index,
+				QAR_MAX_FRAME_TEXTURES
+			);
+		}
+
+		QarVideoFrameViewRegion region = QAR_VIDEO_FRAME_VIEW_REGION_FULL;
+		uint32_t width = config->eye_width;
+		uint32_t height = config->eye_height;
+		if(foveation != NULL && index % 2 == 0)
+		{
+			region = QAR_VIDEO_FRAME_VIEW_REGION_FOVEA;
+			float fraction = foveation->fovea_fraction;
+			width = (uint32_t)((float)width * fraction) & ~1u;
+			height = (uint32_t)((float)height * fraction) & ~1u;
+		}
+		else if(foveation != NULL)
+		{
+			region = QAR_VIDEO_FRAME_VIEW_REGION_PERIPHERY;
+			width /= foveation->periphery_downscale;
+			height /= foveation->periphery_downscale;
+		}
+		width = width > 0 ? width : 1;
+		height = height > 0 ? height : 1;
+
+		QarPixelFormat format =
+			source->data_type == QAR_VIDEO_FRAME_VIEW_TYPE_DEPTH
+			? init->depth_format
+			: init->color_format;
+		QarTextureSize* texture = &layout.textures[texture_index];
+		uint32_t slot = views_per_texture[texture_index]++;
+		if(slot == 0)
+		{
+			texture->format = format;
+			texture->width = 0;
+			texture->height = 0;
+			texture->array_layers = 1;
+		}
+		else if(texture->format != format)
+		{
+			return lb_error(
+				QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+				"color and depth views cannot share texture %u",
+				texture_index
+			);
+		}
+
+		QarVideoFrameView* view = &layout.views[index];
+		view->texture_index = texture_index;
+		view->texture_format = format;
+		view->data_type = source->data_type;
+		view->eye = source->eye;
+		view->region = region;
+		view->start_y = 0;
+		view->end_y = height;
+		if(init->texture_layout == QAR_FRAME_LAYOUT_LAYERED)
+		{
+			view->start_x = 0;
+			view->array_layer_index = slot;
+			texture->array_layers = slot + 1;
+			texture->width = width > texture->width ? width : texture->width;
+		}
+		else
+		{
+			view->start_x = texture->width;
+			texture->width += width;
+		}
+		view->end_x = view->start_x + width;
+		texture->height = height > texture->height ? height : texture->height;
+		if(layout.textures_count <= texture_index)
+		{
+			layout.textures_count = texture_index + 1;
+		}
+	}
+	layout.views_count = views_count * regions;
+	*out_layout = layout;
+	return lb_validate_layout(out_layout);
+}
+
+static QarRenderSender*
+lb_sender_retain(QarRenderSender* sender)
+{
+	lb_atomic_add_i32(&sender->ref_count, 1);
+	return sender;
+}
+
+static void
+lb_sender_release(QarRenderSender* sender)
+{
+	if(lb_atomic_add_i32(&sender->ref_count, -1) != 0)
+	{
+		return;
+	}
+	lb_sender_free_textures(sender);
+	lb_cond_destroy(&sender->frame_shown);
+	lb_mutex_destroy(&sender->lock);
+	lb_session_release(sender->session);
+	lb_free(sender);
+}
+
+static bool
+lb_sender_session_closed(QarRenderSender* sender)
+{
+	lb_mutex_lock(&sender->session->lock);
+	bool closed = sender->session->closed;
+	lb_mutex_unlock(&sender->session->lock);
+	return closed;
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_create(
+	QarSession* session,
+	QarRenderSenderInit* init,
+	QarCancelToken* cancel,
+	QarRenderSender** out_stream
+)
+{
+	if(session == NULL || out_stream == NULL || init == NULL
+	   || init->header.type != QAR_STRUCTURE_TYPE_RENDERING_STREAM_SENDER_INIT)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_render_sender_init_default"
+		);
+	}
+	if(init->graphics_api != QAR_GRAPHICS_API_CPU)
+	{
+		return lb_error(
+			QAR_STATUS_NOT_IMPLEMENTED,
+			"the loopback runtime only has CPU senders"
+		);
+	}
+	if(lb_id_is_zero(init->peer_id.data))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"peer_id of the receiver is required"
+		);
+	}
+	if(!lb_color_format_supported(init->color_format)
+	   || !lb_depth_format_supported(init->depth_format))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"unsupported color or depth format"
+		);
+	}
+	if(qar_impl_cancel_token_is_cancelled(cancel))
+	{
+		return lb_cancelled_result(cancel);
+	}
+
+	const QarRenderSenderFoveationExt* foveation = NULL;
+	const QarRenderSenderFramesInFlightExt* in_flight = NULL;
+	const QarRenderSenderDynamicResolutionExt* dynamic = NULL;
+	const QarRenderSenderDepthEncodingExt* depth = NULL;
+	const QarRenderSenderTransparentTilesExt* tiles = NULL;
+	for(const QarStructureHeader* ext = init->header.next; ext != NULL;
+		ext = ext->next)
+	{
+		if(ext->type
+		   == QAR_STRUCTURE_TYPE_RENDERING_STREAM_SENDER_FOVEATION_EXT)
+		{
+			foveation = (const QarRenderSenderFoveationExt*)ext;
+		}
+		else if(ext->type
+				== QAR_STRUCTURE_TYPE_RENDERING_SENDER_FRAMES_IN_FLIGHT_EXT)
+		{
+			in_flight = (const QarRenderSenderFramesInFlightExt*)ext;
+		}
+		else if(ext->type
+				== QAR_STRUCTURE_TYPE_RENDERING_SENDER_DYNAMIC_RESOLUTION_EXT)
+		{
+			dynamic = (const QarRenderSenderDynamicResolutionExt*)ext;
+		}
+		else if(ext->type
+				== QAR_STRUCTURE_TYPE_RENDERING_SENDER_DEPTH_ENCODING_EXT)
+		{
+			depth = (const QarRenderSenderDepthEncodingExt*)ext;
+		}
+		else if(ext->type
+				== QAR_STRUCTURE_TYPE_RENDERING_SENDER_TRANSPARENT_TILES_EXT)
+		{
+			tiles = (const QarRenderSenderTransparentTilesExt*)ext;
+		}
+	}
+	if(in_flight != NULL
+	   && (in_flight->max_frames_in_flight == 0
+		   || in_flight->max_frames_in_flight > QAR_MAX_FRAMES_IN_FLIGHT))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"max_frames_in_flight must be 1..%d",
+			QAR_MAX_FRAMES_IN_FLIGHT
+		);
+	}
+	if(dynamic != NULL
+	   && !(dynamic->min_resolution_scale > 0.0f
+			&& dynamic->min_resolution_scale <= 1.0f))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"min_resolution_scale must be in (0, 1]"
+		);
+	}
+	QarDepthEncoding depth_encoding =
+		depth != NULL ? depth->depth_encoding : QAR_DEPTH_ENCODING_FLOAT32;
+	if(depth_encoding != QAR_DEPTH_ENCODING_FLOAT32
+	   && depth_encoding != QAR_DEPTH_ENCODING_REVERSED_Z16
+	   && depth_encoding != QAR_DEPTH_ENCODING_LOG12)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"unsupported depth encoding %d",
+			(int)depth_encoding
+		);
+	}
+	if(foveation != NULL
+	   && (!(foveation->fovea_fraction > 0.0f
+			 && foveation->fovea_fraction < 1.0f)
+		   || foveation->periphery_downscale < 2))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"fovea_fraction must be in (0, 1) and periphery_downscale at "
+			"least 2"
+		);
+	}
+
+	QarLoopbackConfig config = session->config;
+	QarVideoFrameLayout layout;
+	QarResult result = lb_build_layout(init, foveation, &config, &layout);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	lb_mutex_lock(&session->lock);
+	bool closed = session->closed;
+	lb_mutex_unlock(&session->lock);
+	if(closed)
+	{
+		return lb_error(
+			QAR_STATUS_RENDERING_PRODUCER_STREAM_IS_CLOSED, "session is closed"
+		);
+	}
+
+	QarRenderSender* sender = lb_alloc(sizeof(*sender));
+	if(sender == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	sender->ref_count = 1;
+	sender->session = lb_session_retain(session);
+	sender->peer_id = init->peer_id;
+	sender->max_frames_in_flight =
+		in_flight != NULL ? in_flight->max_frames_in_flight : 1;
+	sender->display_period_ns = 1000000000ull / config.display_hz;
+	sender->paced = config.paced;
+	sender->fovea_fraction =
+		foveation != NULL ? foveation->fovea_fraction : 1.0f;
+	sender->dynamic_resolution = dynamic != NULL;
+	sender->min_resolution_scale =
+		dynamic != NULL ? dynamic->min_resolution_scale : 1.0f;
+	sender->resolution_scale = 1.0f;
+	sender->shown_resolution_scale = 1.0f;
+	sender->frames_since_resolution_step = 0;
+	sender->depth_encoding = depth_encoding;
+	sender->shown_near_far = qar_near_far_default();
+	sender->skip_transparent_tiles =
+		tiles != NULL && tiles->skip_transparent_tiles;
+	sender->shown_occupancy = NULL;
+	lb_mutex_init(&sender->lock);
+	lb_cond_init(&sender->frame_shown);
+	sender->layout = layout;
+	for(size_t slot = 0; slot < QAR_MAX_FRAMES_IN_FLIGHT; ++slot)
+	{
+		for(size_t texture = 0; texture < QAR_MAX_FRAME_TEXTURES; ++texture)
+		{
+			sender->frames[slot][texture] = qar_video_texture_cpu_default();
+		}
+	}
+	for(size_t texture = 0; texture < QAR_MAX_FRAME_TEXTURES; ++texture)
+	{
+		sender->consumed[texture] = qar_video_texture_cpu_default();
+	}
+	if(!lb_sender_alloc_textures(sender))
+	{
+		lb_sender_release(sender);
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory for textures");
+	}
+	*out_stream = sender;
+	lb_log(
+		QAR_LOG_SEVERITY_INFO,
+		"render sender created (%zu views, %zu textures, %u in flight)",
+		layout.views_count,
+		layout.textures_count,
+		sender->max_frames_in_flight
+	);
+	return lb_ok();
+}
+
+QAR_C_API void
+qar_impl_render_stream_handle_destroy(QarRenderSender* handle)
+{
+	if(handle != NULL)
+	{
+		lb_sender_release(handle);
+	}
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_layout(
+	QarRenderSender* stream, QarVideoFrameLayout* out_layout
+)
+{
+	if(stream == NULL || out_layout == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "stream or out pointer is NULL"
+		);
+	}
+	lb_mutex_lock(&stream->lock);
+	*out_layout = stream->layout;
+	lb_mutex_unlock(&stream->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_change_layout(
+	QarRenderSender* stream,
+	const QarVideoFrameLayout* layout,
+	QarCancelToken* token
+)
+{
+	if(stream == NULL || layout == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "stream or layout is NULL"
+		);
+	}
+	QarResult result = lb_validate_layout(layout);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	if(qar_impl_cancel_token_is_cancelled(token))
+	{
+		return lb_cancelled_result(token);
+	}
+	lb_mutex_lock(&stream->lock);
+	if(stream->frames_begun != stream->frames_shown)
+	{
+		lb_mutex_unlock(&stream->lock);
+		return lb_error(
+			QAR_STATUS_LOGIC_ERROR,
+			"show every begun frame before a layout change"
+		);
+	}
+	lb_sender_free_textures(stream);
+	stream->layout = *layout;
+	stream->has_ring = false;
+	stream->next_ring_slot = 0;
+	stream->ring_slots_in_use = 0;
+	lb_cond_broadcast(&stream->frame_shown);
+	stream->resolution_scale = 1.0f;
+	stream->frames_since_resolution_step = 0;
+	bool allocated = lb_sender_alloc_textures(stream);
+	lb_mutex_unlock(&stream->lock);
+	if(!allocated)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory for textures");
+	}
+	return lb_ok();
+}
+
+static void
+lb_frame_cpu_fill(
+	const QarRenderSender* sender,
+	const QarVideoTextureCpu* textures,
+	QarVideoFrameCpu* out_frame
+)
+{
+	memcpy(
+		out_frame->texture_views,
+		sender->layout.views,
+		sizeof(out_frame->texture_views)
+	);
+	out_frame->texture_views_count = sender->layout.views_count;
+	for(size_t index = 0; index < QAR_MAX_FRAME_TEXTURES; ++index)
+	{
+		out_frame->textures[index] = index < sender->layout.textures_count
+			? textures[index]
+			: qar_video_texture_cpu_default();
+	}
+	out_frame->textures_count = sender->layout.textures_count;
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_frame_cpu(
+	QarRenderSender* stream, QarVideoFrameCpu* out_frame
+)
+{
+	if(stream == NULL || out_frame == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "stream or out pointer is NULL"
+		);
+	}
+	lb_mutex_lock(&stream->lock);
+	uint64_t latest = stream->frames_begun > 0 ? stream->frames_begun - 1 : 0;
+	lb_frame_cpu_fill(
+		stream, stream->frames[latest % stream->max_frames_in_flight], out_frame
+	);
+	lb_mutex_unlock(&stream->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_register_cpu_buffers(
+	QarRenderSender* stream, const QarRenderSenderCpuBufferRing* ring
+)
+{
+	if(stream == NULL || ring == NULL
+	   || ring->header.type != QAR_STRUCTURE_TYPE_RENDERING_CPU_BUFFER_RING
+	   || ring->slot_count > QAR_MAX_CPU_BUFFER_RING_SIZE)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"ring must come from qar_render_sender_cpu_buffer_ring_default "
+			"with at most %d slots",
+			QAR_MAX_CPU_BUFFER_RING_SIZE
+		);
+	}
+	lb_mutex_lock(&stream->lock);
+	if(ring->slot_count == 0)
+	{
+		stream->has_ring = false;
+		stream->ring_slots_in_use = 0;
+		lb_cond_broadcast(&stream->frame_shown);
+		lb_mutex_unlock(&stream->lock);
+		return lb_ok();
+	}
+	const QarVideoFrameLayout* layout = &stream->layout;
+	bool matches = ring->textures_count == layout->textures_count;
+	for(size_t slot = 0; matches && slot < ring->slot_count; ++slot)
+	{
+		for(size_t index = 0; matches && index < layout->textures_count;
+			++index)
+		{
+			const QarVideoTextureCpu* buffer = &ring->slots[slot][index];
+			const QarTextureSize* size = &layout->textures[index];
+			uintptr_t address = (uintptr_t)buffer->texture_data;
+			matches = buffer->texture_data != NULL
+				&& (address % QAR_CPU_BUFFER_ALIGNMENT) == 0
+				&& buffer->size.format == size->format
+				&& buffer->size.width == size->width
+				&& buffer->size.height == size->height
+				&& buffer->size.array_layers == size->array_layers
+				&& buffer->pitch
+					>= size->width * qar_pixel_format_size(size->format)
+				&& buffer->texture_data_size
+					>= lb_texture_bytes(size, buffer->pitch);
+		}
+	}
+	if(!matches)
+	{
+		lb_mutex_unlock(&stream->lock);
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"ring buffers do not match the layout, are too small or not "
+			"aligned to %d bytes",
+			QAR_CPU_BUFFER_ALIGNMENT
+		);
+	}
+	stream->ring = *ring;
+	stream->has_ring = true;
+	stream->next_ring_slot = 0;
+	stream->ring_slots_in_use = 0;
+	lb_cond_broadcast(&stream->frame_shown);
+	lb_mutex_unlock(&stream->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_acquire_cpu_buffer(
+	QarRenderSender* stream,
+	QarCancelToken* token,
+	QarVideoFrameCpu* out_frame,
+	uint32_t* out_buffer_index
+)
+{
+	if(stream == NULL || out_frame == NULL || out_buffer_index == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "stream or out pointer is NULL"
+		);
+	}
+	if(qar_impl_cancel_token_is_cancelled(token))
+	{
+		return lb_cancelled_result(token);
+	}
+	lb_mutex_lock(&stream->lock);
+	// The loopback encoder consumes synchronously in show_frame, so a slot is
+	// free again as soon as the frame rendered into it was shown.
+	while(stream->has_ring
+		  && (stream->ring_slots_in_use & (1u << stream->next_ring_slot)) != 0)
+	{
+		if(qar_impl_cancel_token_is_cancelled(token))
+		{
+			lb_mutex_unlock(&stream->lock);
+			return lb_cancelled_result(token);
+		}
+		// Woken by show_frame; the timeout only bounds cancellation latency.
+		lb_cond_wait_for(&stream->frame_shown, &stream->lock, 10000000ull);
+	}
+	if(!stream->has_ring)
+	{
+		lb_mutex_unlock(&stream->lock);
+		return lb_error(
+			QAR_STATUS_LOGIC_ERROR, "no CPU buffer ring is registered"
+		);
+	}
+	uint32_t index = stream->next_ring_slot;
+	stream->next_ring_slot = (uint32_t)((index + 1) % stream->ring.slot_count);
+	stream->ring_slots_in_use |= 1u << index;
+	lb_frame_cpu_fill(stream, stream->ring.slots[index], out_frame);
+	lb_mutex_unlock(&stream->lock);
+	*out_buffer_index = index;
+	return lb_ok();
+}
+
+// ============================================================================
+// FRAME LOOP
+// ============================================================================
+
+/* Synthetic head: standing at the origin, slowly looking left and right. */
+static void
+lb_predict_views(
+	const QarVideoFrameLayout* layout,
+	float fovea_fraction,
+	uint64_t pose_ns,
+	QarRenderFrameBegin* out_frame
+)
+{
+	float seconds = (float)((double)pose_ns * 1e-9);
+	float yaw = 0.1f * sinf(seconds * 0.5f);
+	QarQuaternion head = { 0.0f, sinf(yaw * 0.5f), 0.0f, cosf(yaw * 0.5f) };
+	QarFov fov = { -LB_HALF_FOV_RADIANS,
+				   LB_HALF_FOV_RADIANS,
+				   LB_HALF_FOV_RADIANS,
+				   -LB_HALF_FOV_RADIANS };
+	// Fovea views see the central part of the image plane.
+	float fovea_half_angle =
+		atanf(tanf(LB_HALF_FOV_RADIANS) * fovea_fraction);
+	QarFov fovea_fov = { -fovea_half_angle,
+						 fovea_half_angle,
+						 fovea_half_angle,
+						 -fovea_half_angle };
+
+	out_frame->views_count = layout->views_count;
+	for(size_t index = 0; index < layout->views_count; ++index)
+	{
+		float eye_offset = 0.0f;
+		if(layout->views[index].eye == QAR_VIDEO_FRAME_VIEW_EYE_LEFT)
+		{
+			eye_offset = -0.5f * LB_IPD_METERS;
+		}
+		else if(layout->views[index].eye == QAR_VIDEO_FRAME_VIEW_EYE_RIGHT)
+		{
+			eye_offset = 0.5f * LB_IPD_METERS;
+		}
+		QarPose* pose = &out_frame->view_poses[index];
+		pose->orientation = head;
+		pose->position.x = eye_offset * cosf(yaw);
+		pose->position.y = LB_HEAD_HEIGHT_METERS;
+		pose->position.z = -eye_offset * sinf(yaw);
+		out_frame->view_fovs[index] =
+			layout->views[index].region == QAR_VIDEO_FRAME_VIEW_REGION_FOVEA
+			? fovea_fov
+			: fov;
+	}
+}
+
+/* Active rectangle of every view at the current resolution scale, sizes
+ * rounded down to even pixel counts for chroma-subsampled encoders (lock
+ * held). */
+static void
+lb_sender_active_rects(
+	QarRenderSender* sender, size_t slot, QarRenderFrameBegin* out_frame
+)
+{
+	float scale = sender->resolution_scale;
+	for(size_t index = 0; index < sender->layout.views_count; ++index)
+	{
+		QarRenderFrameViewRect bounds =
+			lb_view_bounds(&sender->layout.views[index]);
+		QarRenderFrameViewRect rect = { 0, 0, bounds.width, bounds.height };
+		if(scale < 1.0f)
+		{
+			rect.width = (uint32_t)((float)bounds.width * scale) & ~1u;
+			rect.height = (uint32_t)((float)bounds.height * scale) & ~1u;
+			rect.width = rect.width > 0 ? rect.width : bounds.width;
+			rect.height = rect.height > 0 ? rect.height : bounds.height;
+		}
+		sender->active_rects[slot][index] = rect;
+		out_frame->view_active_rects[index] = rect;
+	}
+	sender->frame_scales[slot] = scale;
+	out_frame->resolution_scale = scale;
+}
+
+/* Shared by both begin_frame variants: waits for a free in-flight slot and
+ * predicts the frame into `out_frame`. */
+static QarResult
+lb_sender_begin_frame(
+	QarRenderSender* stream,
+	QarCancelToken* token,
+	QarRenderFrameBegin* out_frame
+)
+{
+	if(lb_sender_session_closed(stream))
+	{
+		return lb_error(
+			QAR_STATUS_RENDERING_PRODUCER_STREAM_IS_CLOSED, "session is closed"
+		);
+	}
+
+	lb_mutex_lock(&stream->lock);
+	while(stream->frames_begun - stream->frames_shown
+		  >= stream->max_frames_in_flight)
+	{
+		if(qar_impl_cancel_token_is_cancelled(token))
+		{
+			lb_mutex_unlock(&stream->lock);
+			return lb_cancelled_result(token);
+		}
+		// Woken by show_frame; the timeout only bounds cancellation latency.
+		lb_cond_wait_for(&stream->frame_shown, &stream->lock, 10000000ull);
+	}
+
+	uint64_t now_ns = lb_now_ns();
+	uint64_t base_ns = now_ns;
+	if(stream->paced)
+	{
+		uint64_t vsync_ns = stream->last_vsync_ns + stream->display_period_ns;
+		if(vsync_ns > now_ns)
+		{
+			lb_mutex_unlock(&stream->lock);
+			lb_sleep_ns(vsync_ns - now_ns);
+			lb_mutex_lock(&stream->lock);
+			base_ns = vsync_ns;
+		}
+		stream->last_vsync_ns = base_ns;
+	}
+	uint64_t in_flight = stream->frames_begun - stream->frames_shown;
+	uint64_t display_ns = base_ns + (in_flight + 1) * stream->display_period_ns;
+	size_t slot = stream->frames_begun % stream->max_frames_in_flight;
+	stream->begin_ns[slot] = now_ns;
+	stream->display_ns[slot] = display_ns;
+	// The synthetic head is sampled at begin time.
+	uint64_t pose_ns = stream->prediction_horizon_ns != 0
+		? now_ns + stream->prediction_horizon_ns
+		: display_ns;
+	out_frame->frame_index = stream->frames_begun++;
+	out_frame->predicted_display_time = lb_time_point(display_ns);
+	out_frame->pose_sample_time = lb_time_point(now_ns);
+	out_frame->prediction_horizon = lb_time_point(pose_ns - now_ns);
+	lb_predict_views(
+		&stream->layout, stream->fovea_fraction, pose_ns, out_frame
+	);
+	lb_sender_active_rects(stream, slot, out_frame);
+	lb_mutex_unlock(&stream->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_begin_frame(
+	QarRenderSender* stream,
+	QarCancelToken* token,
+	QarRenderFrameInfo** out_frame_info
+)
+{
+	if(stream == NULL || out_frame_info == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "stream or out pointer is NULL"
+		);
+	}
+	QarRenderFrameInfo* info = lb_frame_info_acquire();
+	if(info == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	QarResult result = lb_sender_begin_frame(stream, token, &info->frame);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		qar_impl_render_frame_info_handle_destroy(info);
+		return result;
+	}
+	*out_frame_info = info;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_begin_frame_ex(
+	QarRenderSender* stream,
+	QarCancelToken* token,
+	QarRenderFrameBegin* out_frame
+)
+{
+	if(stream == NULL || out_frame == NULL
+	   || out_frame->header.type != QAR_STRUCTURE_TYPE_RENDERING_BEGIN_FRAME)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"stream is NULL or out_frame is not a QarRenderFrameBegin"
+		);
+	}
+	// Fill a copy so a cancelled call leaves the caller's struct untouched.
+	QarRenderFrameBegin frame = *out_frame;
+	QarResult result = lb_sender_begin_frame(stream, token, &frame);
+	if(result.code == QAR_STATUS_SUCCESS)
+	{
+		*out_frame = frame;
+	}
+	return result;
+}
+
+/* Copy `rows` rows of `row_bytes` between two textures with their own
+ * pitches. */
+static void
+lb_copy_rows(
+	uint8_t* destination,
+	uint32_t destination_pitch,
+	const uint8_t* source,
+	uint32_t source_pitch,
+	size_t row_bytes,
+	uint32_t rows
+)
+{
+	for(uint32_t row = 0; row < rows; ++row)
+	{
+		memcpy(
+			destination + (size_t)row * destination_pitch,
+			source + (size_t)row * source_pitch,
+			row_bytes
+		);
+	}
+}
+
+/* Natural logarithm of a positive normal float via its exponent and the
+ * atanh series of the mantissa. Absolute error is below 1e-7, far under a
+ * LOG12 step, and unlike logf() it vectorizes. */
+static inline float
+lb_fast_log(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	int32_t exponent = (int32_t)((bits >> 23) & 0xffu) - 127;
+	bits = (bits & 0x007fffffu) | 0x3f800000u;
+	float mantissa;
+	memcpy(&mantissa, &bits, sizeof(mantissa));
+	float half = mantissa * 0.5f;
+	int32_t high = mantissa > 1.41421356f;
+	mantissa = high ? half : mantissa;
+	exponent += high;
+	float t = (mantissa - 1.0f) / (mantissa + 1.0f);
+	float t2 = t * t;
+	float series =
+		1.0f + t2 * (1.0f / 3.0f + t2 * (1.0f / 5.0f + t2 * (1.0f / 7.0f)));
+	return (float)exponent * 0.69314718f + 2.0f * t * series;
+}
+
+/* Linearize and quantize `rows` rows of `width` depth samples into 16-bit
+ * samples, see QarDepthEncoding. `hardware_depth` marks D32_FLOAT input of a
+ * conventional projection. Both encodings work on `near / z`, which is
+ * linear in hardware depth. */
+void
+lb_encode_depth_rows(
+	uint8_t* destination,
+	uint32_t destination_pitch,
+	const uint8_t* source,
+	uint32_t source_pitch,
+	uint32_t width,
+	uint32_t rows,
+	bool hardware_depth,
+	QarDepthEncoding encoding,
+	QarNearFar near_far
+)
+{
+	float near_plane = near_far.near_plane;
+	float far_plane = near_far.far_plane;
+	// near / z = near_scale * d + near_bias for hardware depth d; the
+	// quotients are computed for both inputs and selected so the loops
+	// have no control flow.
+	float near_scale = (near_plane - far_plane) / far_plane;
+	float near_bias = 1.0f;
+	float min_ratio = near_plane / far_plane;
+	float log_scale = 4095.0f / logf(far_plane / near_plane);
+	for(uint32_t row = 0; row < rows; ++row)
+	{
+		const float* in = (const float*)(source + (size_t)row * source_pitch);
+		uint16_t* out =
+			(uint16_t*)(destination + (size_t)row * destination_pitch);
+		if(encoding == QAR_DEPTH_ENCODING_REVERSED_Z16)
+		{
+			for(uint32_t x = 0; x < width; ++x)
+			{
+				float linear = near_plane / in[x];
+				float hardware = near_scale * in[x] + near_bias;
+				float ratio = hardware_depth ? hardware : linear;
+				// Cleared (non-finite) or negative depth is infinitely far.
+				int32_t valid = (ratio > 0.0f) & (ratio < INFINITY);
+				ratio = valid ? ratio : 0.0f;
+				ratio = ratio < 1.0f ? ratio : 1.0f;
+				out[x] = (uint16_t)(int32_t)(65535.0f * ratio + 0.5f);
+			}
+		}
+		else
+		{
+			for(uint32_t x = 0; x < width; ++x)
+			{
+				float linear = near_plane / in[x];
+				float hardware = near_scale * in[x] + near_bias;
+				float ratio = hardware_depth ? hardware : linear;
+				// Clamp to [near, far]; NaN ends up on the far plane.
+				ratio = ratio > min_ratio ? ratio : min_ratio;
+				ratio = ratio < 1.0f ? ratio : 1.0f;
+				int32_t q = (int32_t)(-lb_fast_log(ratio) * log_scale + 0.5f);
+				out[x] = (uint16_t)((q < 4095 ? q : 4095) << 4);
+			}
+		}
+	}
+}
+
+static bool
+lb_format_has_alpha(QarPixelFormat format)
+{
+	return format == QAR_PIXEL_FORMAT_R8G8B8A8
+		|| format == QAR_PIXEL_FORMAT_B8G8R8A8
+		|| format == QAR_PIXEL_FORMAT_R16G16B16A16;
+}
+
+/* Whether any pixel of the block has a non-zero alpha. Whole pixels are ORed
+ * together and masked once per row, a reduction the compiler vectorizes;
+ * rows are checked one at a time so content is found early. Little-endian:
+ * alpha is the top byte (8-bit formats) or top half float (-0 counts as
+ * transparent). */
+static bool
+lb_rows_have_alpha(
+	const uint8_t* pixels,
+	uint32_t pitch,
+	uint32_t width,
+	uint32_t rows,
+	QarPixelFormat format
+)
+{
+	bool wide = format == QAR_PIXEL_FORMAT_R16G16B16A16;
+	for(uint32_t row = 0; row < rows; ++row)
+	{
+		const uint8_t* line = pixels + (size_t)row * pitch;
+		if(wide)
+		{
+			uint64_t any = 0;
+			for(uint32_t x = 0; x < width; ++x)
+			{
+				uint64_t pixel;
+				memcpy(&pixel, line + (size_t)x * 8, sizeof(pixel));
+				any |= pixel;
+			}
+			if((any & 0x7fff000000000000ull) != 0)
+			{
+				return true;
+			}
+		}
+		else
+		{
+			uint32_t any = 0;
+			for(uint32_t x = 0; x < width; ++x)
+			{
+				uint32_t pixel;
+				memcpy(&pixel, line + (size_t)x * 4, sizeof(pixel));
+				any |= pixel;
+			}
+			if((any & 0xff000000u) != 0)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/* Tile-wise consume of `block` of a color view whose top row is `view_row`:
+ * occupied tiles are copied, transparent ones (per `mask`, or by scanning
+ * the alpha channel without one) go out as a bare "transparent" marker, so
+ * they are neither copied nor counted. */
+static uint64_t
+lb_consume_tiles(
+	const QarVideoTextureCpu* source,
+	QarVideoTextureCpu* target,
+	size_t view_row,
+	const QarRenderFrameViewRect* bounds,
+	const QarRenderFrameViewRect* block,
+	const uint8_t* mask
+)
+{
+	const uint32_t tile = QAR_OCCUPANCY_TILE_SIZE;
+	QarPixelFormat format = target->size.format;
+	uint32_t pixel_size = qar_pixel_format_size(format);
+	uint32_t tiles_per_row = (bounds->width + tile - 1) / tile;
+	uint32_t x_end = block->x + block->width;
+	uint32_t y_end = block->y + block->height;
+	uint64_t bytes = 0;
+	for(uint32_t tile_y = block->y / tile; tile_y * tile < y_end; ++tile_y)
+	{
+		uint32_t y0 = tile_y * tile > block->y ? tile_y * tile : block->y;
+		uint32_t y1 = (tile_y + 1) * tile < y_end ? (tile_y + 1) * tile : y_end;
+		for(uint32_t tile_x = block->x / tile; tile_x * tile < x_end; ++tile_x)
+		{
+			uint32_t x0 = tile_x * tile > block->x ? tile_x * tile : block->x;
+			uint32_t x1 =
+				(tile_x + 1) * tile < x_end ? (tile_x + 1) * tile : x_end;
+			size_t row = view_row + y0;
+			size_t column = (size_t)(bounds->x + x0) * pixel_size;
+			size_t row_bytes = (size_t)(x1 - x0) * pixel_size;
+			const uint8_t* from =
+				source->texture_data + row * source->pitch + column;
+			uint8_t* to = target->texture_data + row * target->pitch + column;
+			bool occupied = mask != NULL
+				? mask[tile_y * tiles_per_row + tile_x] != 0
+				: lb_rows_have_alpha(
+					  from, source->pitch, x1 - x0, y1 - y0, format
+				  );
+			if(occupied)
+			{
+				lb_copy_rows(
+					to, target->pitch, from, source->pitch, row_bytes, y1 - y0
+				);
+				bytes += (uint64_t)row_bytes * (y1 - y0);
+			}
+		}
+	}
+	return bytes;
+}
+
+/* Copy `rect` of a view, clipped to `limit`, into the consumed textures.
+ * Depth views are encoded with the sender's depth encoding on the way, and
+ * transparent tiles of color views are skipped when asked to. */
+static uint64_t
+lb_consume_view_rect(
+	QarRenderSender* sender,
+	const QarVideoTextureCpu* textures,
+	size_t view_index,
+	const QarRenderFrameViewRect* rect,
+	const QarRenderFrameViewRect* limit
+)
+{
+	if(rect->x >= limit->width || rect->y >= limit->height)
+	{
+		return 0;
+	}
+	uint32_t width = rect->width < limit->width - rect->x
+		? rect->width
+		: limit->width - rect->x;
+	uint32_t height = rect->height < limit->height - rect->y
+		? rect->height
+		: limit->height - rect->y;
+
+	const QarVideoFrameView* view = &sender->layout.views[view_index];
+	QarRenderFrameViewRect bounds = lb_view_bounds(view);
+	const QarVideoTextureCpu* source = &textures[view->texture_index];
+	QarVideoTextureCpu* target = &sender->consumed[view->texture_index];
+	uint32_t pixel_size = qar_pixel_format_size(target->size.format);
+	size_t row = (size_t)view->array_layer_index * target->size.height
+		+ bounds.y + rect->y;
+	if(view->data_type == QAR_VIDEO_FRAME_VIEW_TYPE_DEPTH
+	   && sender->depth_encoding != QAR_DEPTH_ENCODING_FLOAT32)
+	{
+		lb_encode_depth_rows(
+			target->texture_data + row * target->pitch
+				+ (size_t)(bounds.x + rect->x) * sizeof(uint16_t),
+			target->pitch,
+			source->texture_data + row * source->pitch
+				+ (size_t)(bounds.x + rect->x) * pixel_size,
+			source->pitch,
+			width,
+			height,
+			target->size.format == QAR_PIXEL_FORMAT_D32_FLOAT,
+			sender->depth_encoding,
+			sender->shown_near_far
+		);
+		return (uint64_t)width * height * sizeof(uint16_t);
+	}
+	const uint8_t* mask = sender->shown_occupancy != NULL
+		? sender->shown_occupancy->view_tile_masks[view_index]
+		: NULL;
+	if(view->data_type != QAR_VIDEO_FRAME_VIEW_TYPE_DEPTH
+	   && (mask != NULL
+		   || (sender->skip_transparent_tiles
+			   && lb_format_has_alpha(target->size.format))))
+	{
+		QarRenderFrameViewRect block = { rect->x, rect->y, width, height };
+		return lb_consume_tiles(
+			source, target, row - rect->y, &bounds, &block, mask
+		);
+	}
+	size_t column = (size_t)(bounds.x + rect->x) * pixel_size;
+	lb_copy_rows(
+		target->texture_data + row * target->pitch + column,
+		target->pitch,
+		source->texture_data + row * source->pitch + column,
+		source->pitch,
+		(size_t)width * pixel_size,
+		height
+	);
+	return (uint64_t)width * height * pixel_size;
+}
+
+static uint64_t
+lb_consume_full(
+	QarRenderSender* sender, const QarVideoTextureCpu* textures, size_t slot
+)
+{
+	uint64_t bytes = 0;
+	if(sender->dynamic_resolution
+	   || sender->depth_encoding != QAR_DEPTH_ENCODING_FLOAT32
+	   || sender->skip_transparent_tiles || sender->shown_occupancy != NULL)
+	{
+		// Only the active area of every view carries the frame, and depth
+		// encoding and tile skipping work view by view.
+		for(size_t index = 0; index < sender->layout.views_count; ++index)
+		{
+			const QarRenderFrameViewRect* active =
+				&sender->active_rects[slot][index];
+			bytes +=
+				lb_consume_view_rect(sender, textures, index, active, active);
+		}
+		return bytes;
+	}
+	for(size_t index = 0; index < sender->layout.textures_count; ++index)
+	{
+		const QarVideoTextureCpu* source = &textures[index];
+		QarVideoTextureCpu* target = &sender->consumed[index];
+		size_t row_bytes = (size_t)target->size.width
+			* qar_pixel_format_size(target->size.format);
+		uint32_t rows = target->size.height * target->size.array_layers;
+		lb_copy_rows(
+			target->texture_data,
+			target->pitch,
+			source->texture_data,
+			source->pitch,
+			row_bytes,
+			rows
+		);
+		bytes += (uint64_t)row_bytes * rows;
+	}
+	return bytes;
+}
+
+static uint64_t
+lb_consume_dirty(
+	QarRenderSender* sender,
+	const QarVideoTextureCpu* textures,
+	size_t slot,
+	const QarRenderFrameShowDirtyRectsExt* dirty
+)
+{
+	uint64_t bytes = 0;
+	size_t count = dirty->rects_count < QAR_MAX_DIRTY_RECTS
+		? dirty->rects_count
+		: QAR_MAX_DIRTY_RECTS;
+	for(size_t index = 0; index < count; ++index)
+	{
+		const QarRenderFrameDirtyRect* dirty_rect = &dirty->rects[index];
+		if(dirty_rect->view_index >= sender->layout.views_count)
+		{
+			continue;
+		}
+		QarRenderFrameViewRect rect = { dirty_rect->x,
+										dirty_rect->y,
+										dirty_rect->width,
+										dirty_rect->height };
+		bytes += lb_consume_view_rect(
+			sender,
+			textures,
+			dirty_rect->view_index,
+			&rect,
+			&sender->active_rects[slot][dirty_rect->view_index]
+		);
+	}
+	return bytes;
+}
+
+static double
+lb_smooth(double average, double sample, bool first)
+{
+	return first ? sample : average + (sample - average) * LB_STATS_SMOOTHING;
+}
+
+/* Update the smoothed timings for the oldest in-flight frame, which was just
+ * consumed between `encode_start_ns` and `encode_end_ns` (lock held). */
+static void
+lb_sender_record_show(
+	QarRenderSender* sender, uint64_t encode_start_ns, uint64_t encode_end_ns
+)
+{
+	size_t slot = sender->frames_shown % sender->max_frames_in_flight;
+	bool first = sender->frames_shown == 0;
+	// The frame is lit at its predicted display time, or at the next refresh
+	// when it was consumed too late for it.
+	uint64_t photon_ns = sender->display_ns[slot];
+	if(encode_end_ns > photon_ns)
+	{
+		photon_ns = encode_end_ns + sender->display_period_ns;
+	}
+	sender->encode_ns = lb_smooth(
+		sender->encode_ns, (double)(encode_end_ns - encode_start_ns), first
+	);
+	sender->pose_to_photon_ns = lb_smooth(
+		sender->pose_to_photon_ns,
+		(double)(photon_ns - sender->begin_ns[slot]),
+		first
+	);
+	if(!first)
+	{
+		double interval = (double)(encode_end_ns - sender->last_show_ns);
+		bool first_interval = sender->frames_shown == 1;
+		double deviation = interval - sender->frame_interval_ns;
+		sender->frame_interval_ns =
+			lb_smooth(sender->frame_interval_ns, interval, first_interval);
+		sender->frame_interval_variance = lb_smooth(
+			sender->frame_interval_variance,
+			first_interval ? 0.0 : deviation * deviation,
+			first_interval
+		);
+	}
+	sender->last_show_ns = encode_end_ns;
+}
+
+/* Dynamic resolution controller: shrink quickly when the smoothed encode
+ * time exceeds its budget, grow slowly once the predicted encode time at the
+ * larger scale fits comfortably (lock held). The loopback has no network,
+ * so encode time is its only load signal. */
+static void
+lb_sender_adapt_resolution(QarRenderSender* sender)
+{
+	size_t slot = sender->frames_shown % sender->max_frames_in_flight;
+	sender->shown_resolution_scale = sender->frame_scales[slot];
+	if(!sender->dynamic_resolution)
+	{
+		return;
+	}
+	if(++sender->frames_since_resolution_step < LB_RESOLUTION_HOLD_FRAMES)
+	{
+		return;
+	}
+	double period = (double)sender->display_period_ns;
+	// Encode cost follows the area, i.e. the square of the scale.
+	double growth = (double)LB_RESOLUTION_STEP_UP * LB_RESOLUTION_STEP_UP;
+	float scale = sender->resolution_scale;
+	float next = scale;
+	if(sender->encode_ns > LB_ENCODE_BUDGET_HIGH * period)
+	{
+		next = scale * LB_RESOLUTION_STEP_DOWN;
+	}
+	else if(sender->encode_ns * growth < LB_ENCODE_BUDGET_LOW * period)
+	{
+		next = scale * LB_RESOLUTION_STEP_UP;
+	}
+	if(next < sender->min_resolution_scale)
+	{
+		next = sender->min_resolution_scale;
+	}
+	next = next > 1.0f ? 1.0f : next;
+	if(next != scale)
+	{
+		sender->resolution_scale = next;
+		sender->frames_since_resolution_step = 0;
+	}
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_show_frame(
+	QarRenderSender* stream, const QarRenderFrameShow* frame_show
+)
+{
+	if(stream == NULL || frame_show == NULL
+	   || frame_show->header.type != QAR_STRUCTURE_TYPE_RENDERING_END_FRAME)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"frame_show must come from qar_render_frame_show_default"
+		);
+	}
+	const QarRenderFrameShowCpuBufferExt* cpu_buffer = NULL;
+	const QarRenderFrameShowDirtyRectsExt* dirty = NULL;
+	const QarRenderFrameShowOccupancyExt* occupancy = NULL;
+	for(const QarStructureHeader* ext = frame_show->header.next; ext != NULL;
+		ext = ext->next)
+	{
+		if(ext->type == QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_CPU_BUFFER_EXT)
+		{
+			cpu_buffer = (const QarRenderFrameShowCpuBufferExt*)ext;
+		}
+		else if(ext->type
+				== QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_DIRTY_RECTS_EXT)
+		{
+			dirty = (const QarRenderFrameShowDirtyRectsExt*)ext;
+		}
+		else if(ext->type
+				== QAR_STRUCTURE_TYPE_RENDERING_END_FRAME_OCCUPANCY_EXT)
+		{
+			occupancy = (const QarRenderFrameShowOccupancyExt*)ext;
+		}
+	}
+
+	lb_mutex_lock(&stream->lock);
+	if(stream->frames_begun == stream->frames_shown)
+	{
+		lb_mutex_unlock(&stream->lock);
+		return lb_error(QAR_STATUS_LOGIC_ERROR, "no frame was begun");
+	}
+	const QarVideoTextureCpu* textures =
+		stream->frames[stream->frames_shown % stream->max_frames_in_flight];
+	if(cpu_buffer != NULL)
+	{
+		if(!stream->has_ring
+		   || cpu_buffer->buffer_index >= stream->ring.slot_count)
+		{
+			lb_mutex_unlock(&stream->lock);
+			return lb_error(
+				QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+				"buffer_index %u is not a registered ring slot",
+				cpu_buffer->buffer_index
+			);
+		}
+		textures = stream->ring.slots[cpu_buffer->buffer_index];
+	}
+	if(stream->depth_encoding != QAR_DEPTH_ENCODING_FLOAT32
+	   && !(frame_show->rendered_near_far.near_plane > 0.0f
+			&& frame_show->rendered_near_far.far_plane
+				   > frame_show->rendered_near_far.near_plane))
+	{
+		lb_mutex_unlock(&stream->lock);
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"depth encodings need rendered_near_far with 0 < near < far"
+		);
+	}
+	stream->shown_near_far = frame_show->rendered_near_far;
+	stream->shown_occupancy = occupancy;
+	size_t slot = stream->frames_shown % stream->max_frames_in_flight;
+	uint64_t encode_start_ns = lb_now_ns();
+	if(dirty != NULL && stream->consumed_valid)
+	{
+		stream->bytes_consumed +=
+			lb_consume_dirty(stream, textures, slot, dirty);
+	}
+	else
+	{
+		stream->bytes_consumed += lb_consume_full(stream, textures, slot);
+		stream->consumed_valid = true;
+	}
+	stream->shown_occupancy = NULL; // caller memory, only valid until here
+	lb_sender_record_show(stream, encode_start_ns, lb_now_ns());
+	lb_sender_adapt_resolution(stream);
+	++stream->frames_shown;
+	if(cpu_buffer != NULL)
+	{
+		stream->ring_slots_in_use &= ~(1u << cpu_buffer->buffer_index);
+	}
+	lb_cond_broadcast(&stream->frame_shown);
+	lb_mutex_unlock(&stream->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_get_stats(
+	QarRenderSender* stream, QarRenderSenderStats* out_stats
+)
+{
+	if(stream == NULL || out_stats == NULL
+	   || out_stats->header.type != QAR_STRUCTURE_TYPE_RENDERING_SENDER_STATS)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"out_stats must come from qar_render_sender_stats_default"
+		);
+	}
+	lb_mutex_lock(&stream->lock);
+	// Shown frames are consumed synchronously and nothing leaves the
+	// process, so sent equals shown and latency equals encode time.
+	out_stats->frames_shown = stream->frames_shown;
+	out_stats->frames_sent = stream->frames_shown;
+	out_stats->frames_dropped = 0;
+	out_stats->bytes_sent = stream->bytes_consumed;
+	out_stats->queue_depth =
+		(uint32_t)(stream->frames_begun - stream->frames_shown);
+	float fps = stream->frame_interval_ns > 0.0
+		? (float)(1e9 / stream->frame_interval_ns)
+		: 0.0f;
+	out_stats->upstream_fps = fps;
+	out_stats->downstream_fps = fps;
+	out_stats->encode_time_ms = (float)(stream->encode_ns * 1e-6);
+	out_stats->latency_ms = out_stats->encode_time_ms;
+	out_stats->jitter_ms =
+		(float)(sqrt(stream->frame_interval_variance) * 1e-6);
+	out_stats->pose_to_photon_ms = (float)(stream->pose_to_photon_ns * 1e-6);
+	out_stats->resolution_scale = stream->shown_resolution_scale;
+	lb_mutex_unlock(&stream->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_set_prediction_horizon(
+	QarRenderSender* stream, QarTimePoint horizon
+)
+{
+	if(stream == NULL || horizon.precision > 1)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"stream is NULL or horizon precision %u is unknown",
+			(unsigned)horizon.precision
+		);
+	}
+	lb_mutex_lock(&stream->lock);
+	stream->prediction_horizon_ns = lb_time_point_ns(horizon);
+	lb_mutex_unlock(&stream->lock);
+	return lb_ok();
+}
+
+/* Synthetic hands: both held in front of the body, fingers fanned out,
+ * swaying slowly so consumers of the history see motion and velocities. */
+static void
+lb_synthetic_hands(
+	const QarPeerId* device_id,
+	uint64_t sample_ns,
+	QarDeviceHandsWithJoints* out_hands
+)
+{
+	memset(out_hands, 0, sizeof(*out_hands));
+	out_hands->device_id = *device_id;
+	out_hands->device_timestamp = lb_time_point(sample_ns);
+	const uint64_t flags = QAR_ORIENTATION_VALID_BIT | QAR_POSITION_VALID_BIT
+		| QAR_ORIENTATION_TRACKED_BIT | QAR_POSITION_TRACKED_BIT;
+	const float omega = LB_HAND_SWAY_RADIANS_PER_SECOND;
+	float phase =
+		(float)fmod((double)sample_ns * 1e-9 * omega, 6.283185307179586);
+	QarVector3 sway = { 0.05f * sinf(phase), 0.03f * sinf(2.0f * phase), 0.0f };
+	QarVector3 velocity = { 0.05f * omega * cosf(phase),
+							0.06f * omega * cosf(2.0f * phase),
+							0.0f };
+	for(int side = 0; side < 2; ++side)
+	{
+		QarHandJoints* hand =
+			side == 0 ? &out_hands->left_hand : &out_hands->right_hand;
+		float x = side == 0 ? -0.2f : 0.2f;
+		hand->is_tracked = true;
+		hand->is_active = true;
+		hand->has_velocity = true;
+		hand->pose = qar_pose_default();
+		hand->pose.position.x = x + sway.x;
+		hand->pose.position.y = 1.3f + sway.y;
+		hand->pose.position.z = -0.4f;
+		for(uint32_t joint = 0; joint < QAR_HAND_JOINT_COUNT; ++joint)
+		{
+			// Joints 2..25 are five fingers of 4-5 joints each.
+			uint32_t finger = joint < 2 ? 0 : (joint - 2 + 4) / 5;
+			uint32_t segment = joint < 2 ? 0 : (joint - 2 + 4) % 5;
+			QarHandJointLocation* location = &hand->joint_locations[joint];
+			location->joint_id = joint;
+			location->location_flags = flags;
+			location->pose = hand->pose;
+			location->pose.position.x += (side == 0 ? 1.0f : -1.0f)
+				* ((float)finger - 2.0f) * 0.02f;
+			location->pose.position.z -= (float)segment * 0.025f;
+			location->radius = joint < 2 ? 0.02f : 0.008f;
+			// The hand translates rigidly, so every joint moves with it.
+			QarHandJointVelocity* joint_velocity =
+				&hand->joint_velocities[joint];
+			joint_velocity->joint_id = joint;
+			joint_velocity->flags =
+				QAR_LINEAR_VELOCITY_VALID_BIT | QAR_ANGULAR_VELOCITY_VALID_BIT;
+			joint_velocity->linear_velocity = velocity;
+		}
+	}
+}
+
+/* Append the tracker samples taken up to `now_ns` to the hand history (lock
+ * held). Samples fall on multiples of the tracking period; after a long
+ * pause only the last QAR_HAND_HISTORY_CAPACITY of them are generated. */
+static void
+lb_sender_track_hands(QarRenderSender* sender, uint64_t now_ns)
+{
+	const uint64_t period_ns = 1000000000ull / LB_HAND_TRACKING_HZ;
+	const uint64_t window_ns = (QAR_HAND_HISTORY_CAPACITY - 1) * period_ns;
+	uint64_t latest_ns = now_ns - now_ns % period_ns;
+	uint64_t oldest_ns = latest_ns > window_ns ? latest_ns - window_ns : 0;
+	uint64_t sample_ns = sender->last_hand_sample_ns + period_ns;
+	if(sender->last_hand_sample_ns == 0 || sample_ns < oldest_ns)
+	{
+		sample_ns = oldest_ns;
+	}
+	for(; sample_ns <= latest_ns; sample_ns += period_ns)
+	{
+		size_t index = (sender->hand_history_start + sender->hand_history_count)
+			% QAR_HAND_HISTORY_CAPACITY;
+		if(sender->hand_history_count == QAR_HAND_HISTORY_CAPACITY)
+		{
+			sender->hand_history_start =
+				(sender->hand_history_start + 1) % QAR_HAND_HISTORY_CAPACITY;
+		}
+		else
+		{
+			++sender->hand_history_count;
+		}
+		lb_synthetic_hands(
+			&sender->peer_id, sample_ns, &sender->hand_history[index]
+		);
+		sender->last_hand_sample_ns = sample_ns;
+	}
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_last_hands(
+	QarRenderSender* stream, QarDeviceHandsWithJoints* out_hands
+)
+{
+	if(stream == NULL || out_hands == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "stream or out pointer is NULL"
+		);
+	}
+	lb_mutex_lock(&stream->lock);
+	lb_sender_track_hands(stream, lb_now_ns());
+	size_t newest = stream->hand_history_start + stream->hand_history_count - 1;
+	*out_hands = stream->hand_history[newest % QAR_HAND_HISTORY_CAPACITY];
+	lb_mutex_unlock(&stream->lock);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_hands_since(
+	QarRenderSender* stream,
+	QarTimePoint since,
+	QarDeviceHandsWithJoints* out_samples,
+	size_t capacity,
+	size_t* out_count
+)
+{
+	if(stream == NULL || out_count == NULL
+	   || (out_samples == NULL && capacity != 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"stream, out_count or out_samples is NULL"
+		);
+	}
+	uint64_t since_ns = lb_time_point_ns(since);
+	size_t count = 0;
+	lb_mutex_lock(&stream->lock);
+	lb_sender_track_hands(stream, lb_now_ns());
+	for(size_t offset = 0;
+		offset < stream->hand_history_count && count < capacity;
+		++offset)
+	{
+		const QarDeviceHandsWithJoints* sample = &stream->hand_history
+			[(stream->hand_history_start + offset) % QAR_HAND_HISTORY_CAPACITY];
+		if(sample->device_timestamp.count > since_ns)
+		{
+			out_samples[count++] = *sample;
+		}
+	}
+	lb_mutex_unlock(&stream->lock);
+	*out_count = count;
+	return lb_ok();
+}
+
+/* Rotate `orientation` by a room-space angular velocity for `seconds`. */
+static QarQuaternion
+lb_quaternion_integrate(
+	QarQuaternion orientation, QarVector3 angular_velocity, float seconds
+)
+{
+	float rate = sqrtf(
+		angular_velocity.x * angular_velocity.x
+		+ angular_velocity.y * angular_velocity.y
+		+ angular_velocity.z * angular_velocity.z
+	);
+	if(rate * seconds < 1e-6f)
+	{
+		return orientation;
+	}
+	float half_angle = 0.5f * rate * seconds;
+	float scale = sinf(half_angle) / rate;
+	QarQuaternion delta = { angular_velocity.x * scale,
+							angular_velocity.y * scale,
+							angular_velocity.z * scale,
+							cosf(half_angle) };
+	return qar_quaternion_multiply(delta, orientation);
+}
+
+static QarPose
+lb_pose_blend(const QarPose* a, const QarPose* b, float t)
+{
+	QarPose result;
+	result.position = qar_vector3_lerp(a->position, b->position, t);
+	result.orientation =
+		qar_quaternion_slerp(a->orientation, b->orientation, t);
+	return result;
+}
+
+/* Blend hand `a` towards `b` in place. A hand tracked in only one of the two
+ * samples cannot be blended and is taken from the nearer one. */
+static void
+lb_hand_blend(QarHandJoints* a, const QarHandJoints* b, float t)
+{
+	if(!a->is_tracked || !b->is_tracked)
+	{
+		if(t >= 0.5f)
+		{
+			*a = *b;
+		}
+		return;
+	}
+	a->is_active = t < 0.5f ? a->is_active : b->is_active;
+	a->pose = lb_pose_blend(&a->pose, &b->pose, t);
+	for(uint32_t joint = 0; joint < QAR_HAND_JOINT_COUNT; ++joint)
+	{
+		QarHandJointLocation* location = &a->joint_locations[joint];
+		const QarHandJointLocation* next = &b->joint_locations[joint];
+		location->location_flags &= next->location_flags;
+		location->pose = lb_pose_blend(&location->pose, &next->pose, t);
+		location->radius += (next->radius - location->radius) * t;
+	}
+	a->has_velocity = a->has_velocity && b->has_velocity;
+	if(!a->has_velocity)
+	{
+		return;
+	}
+	for(uint32_t joint = 0; joint < QAR_HAND_JOINT_COUNT; ++joint)
+	{
+		QarHandJointVelocity* velocity = &a->joint_velocities[joint];
+		const QarHandJointVelocity* next = &b->joint_velocities[joint];
+		velocity->flags &= next->flags;
+		velocity->linear_velocity = qar_vector3_lerp(
+			velocity->linear_velocity, next->linear_velocity, t
+		);
+		velocity->angular_velocity = qar_vector3_lerp(
+			velocity->angular_velocity, next->angular_velocity, t
+		);
+	}
+}
+
+static void
+lb_pose_extrapolate(
+	QarPose* pose, const QarHandJointVelocity* velocity, float seconds
+)
+{
+	if(velocity->flags & QAR_LINEAR_VELOCITY_VALID_BIT)
+	{
+		QarVector3 offset =
+			qar_vector3_scale(velocity->linear_velocity, seconds);
+		pose->position = qar_vector3_add(pose->position, offset);
+	}
+	if(velocity->flags & QAR_ANGULAR_VELOCITY_VALID_BIT)
+	{
+		pose->orientation = lb_quaternion_integrate(
+			pose->orientation, velocity->angular_velocity, seconds
+		);
+	}
+}
+
+/* Move a hand on with its joint velocities; the hand pose follows the
+ * palm. */
+static void
+lb_hand_extrapolate(QarHandJoints* hand, float seconds)
+{
+	if(!hand->is_tracked || !hand->has_velocity)
+	{
+		return;
+	}
+	lb_pose_extrapolate(
+		&hand->pose,
+		&hand->joint_velocities[QAR_HAND_JOINT_PALM_EXT],
+		seconds
+	);
+	for(uint32_t joint = 0; joint < QAR_HAND_JOINT_COUNT; ++joint)
+	{
+		lb_pose_extrapolate(
+			&hand->joint_locations[joint].pose,
+			&hand->joint_velocities[joint],
+			seconds
+		);
+	}
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_sample_hands_at(
+	QarRenderSender* stream,
+	QarTimePoint time,
+	QarDeviceHandsWithJoints* out_hands
+)
+{
+	if(stream == NULL || out_hands == NULL || time.precision > 1)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"stream or out pointer is NULL or time precision %u is unknown",
+			(unsigned)time.precision
+		);
+	}
+	uint64_t time_ns = lb_time_point_ns(time);
+	lb_mutex_lock(&stream->lock);
+	lb_sender_track_hands(stream, lb_now_ns());
+	const QarDeviceHandsWithJoints* history = stream->hand_history;
+	size_t start = stream->hand_history_start;
+	size_t count = stream->hand_history_count;
+	const QarDeviceHandsWithJoints* oldest = &history[start];
+	const QarDeviceHandsWithJoints* newest =
+		&history[(start + count - 1) % QAR_HAND_HISTORY_CAPACITY];
+	uint64_t newest_ns = newest->device_timestamp.count;
+	if(time_ns >= newest_ns)
+	{
+		const uint64_t max_ns = QAR_HAND_MAX_EXTRAPOLATION_MS * 1000000ull;
+		uint64_t ahead_ns = time_ns - newest_ns;
+		ahead_ns = ahead_ns < max_ns ? ahead_ns : max_ns;
+		*out_hands = *newest;
+		float seconds = (float)((double)ahead_ns * 1e-9);
+		lb_hand_extrapolate(&out_hands->left_hand, seconds);
+		lb_hand_extrapolate(&out_hands->right_hand, seconds);
+		out_hands->device_timestamp = lb_time_point(newest_ns + ahead_ns);
+	}
+	else if(time_ns <= oldest->device_timestamp.count)
+	{
+		*out_hands = *oldest;
+	}
+	else
+	{
+		// First sample after `time`; the history is sorted by capture time.
+		size_t low = 1;
+		size_t high = count - 1;
+		while(low < high)
+		{
+			size_t middle = low + (high - low) / 2;
+			const QarDeviceHandsWithJoints* sample =
+				&history[(start + middle) % QAR_HAND_HISTORY_CAPACITY];
+			if(sample->device_timestamp.count > time_ns)
+			{
+				high = middle;
+			}
+			else
+			{
+				low = middle + 1;
+			}
+		}
+		const QarDeviceHandsWithJoints* before =
+			&history[(start + low - 1) % QAR_HAND_HISTORY_CAPACITY];
+		const QarDeviceHandsWithJoints* after =
+			&history[(start + low) % QAR_HAND_HISTORY_CAPACITY];
+		uint64_t before_ns = before->device_timestamp.count;
+		uint64_t span_ns = after->device_timestamp.count - before_ns;
+		float t = (float)((double)(time_ns - before_ns) / (double)span_ns);
+		*out_hands = *before;
+		lb_hand_blend(&out_hands->left_hand, &after->left_hand, t);
+		lb_hand_blend(&out_hands->right_hand, &after->right_hand, t);
+		out_hands->device_timestamp = lb_time_point(time_ns);
+	}
+	lb_mutex_unlock(&stream->lock);
+	return lb_ok();
+}
+
+// ============================================================================
+// ASYNC VARIANTS
+// ============================================================================
+
+typedef struct LbSenderJob
+{
+	QarSession* session;
+	QarRenderSender* sender;
+	QarRenderSenderInit init;
+	QarVideoFrameLayout layout;
+	union
+	{
+		qar_render_sender_create_callback_t create;
+		qar_render_sender_change_layout_callback_t change_layout;
+		qar_render_sender_begin_frame_callback_t begin_frame;
+	} callback;
+	void* user_state;
+	QarCancelToken* token;
+} LbSenderJob;
+
+static LbSenderJob*
+lb_sender_job_create(
+	QarSession* session, QarRenderSender* sender, QarCancelToken* token
+)
+{
+	LbSenderJob* job = lb_alloc(sizeof(*job));
+	if(job != NULL)
+	{
+		job->session = session != NULL ? lb_session_retain(session) : NULL;
+		job->sender = sender != NULL ? lb_sender_retain(sender) : NULL;
+		job->token = lb_cancel_token_retain(token);
+	}
+	return job;
+}
+
+static void
+lb_sender_job_free(LbSenderJob* job)
+{
+	lb_cancel_token_release(job->token);
+	if(job->sender != NULL)
+	{
+		lb_sender_release(job->sender);
+	}
+	if(job->session != NULL)
+	{
+		lb_session_release(job->session);
+	}
+	lb_free(job);
+}
+
+static QarResult
+lb_sender_job_start(LbSenderJob* job, lb_thread_fn_t fn)
+{
+	if(!lb_thread_start_detached(fn, job))
+	{
+		lb_sender_job_free(job);
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "failed to start a thread");
+	}
+	return lb_ok();
+}
+
+static void
+lb_create_job_main(void* arg)
+{
+	LbSenderJob* job = arg;
+	QarRenderSender* sender = NULL;
+	QarResult result = qar_impl_render_sender_create(
+		job->session, &job->init, job->token, &sender
+	);
+	if(job->callback.create != NULL)
+	{
+		job->callback.create(result, sender, job->user_state);
+	}
+	else
+	{
+		qar_impl_render_stream_handle_destroy(sender);
+	}
+	lb_sender_job_free(job);
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_create_async(
+	QarSession* session,
+	QarRenderSenderInit* init,
+	qar_render_sender_create_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	if(session == NULL || init == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or init is NULL"
+		);
+	}
+	LbSenderJob* job = lb_sender_job_create(session, NULL, token);
+	if(job == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	job->init = *init;
+	job->callback.create = callback;
+	job->user_state = user_state;
+	return lb_sender_job_start(job, lb_create_job_main);
+}
+
+static void
+lb_change_layout_job_main(void* arg)
+{
+	LbSenderJob* job = arg;
+	QarResult result = qar_impl_render_sender_change_layout(
+		job->sender, &job->layout, job->token
+	);
+	if(job->callback.change_layout != NULL)
+	{
+		job->callback.change_layout(result, job->user_state);
+	}
+	lb_sender_job_free(job);
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_change_layout_async(
+	QarRenderSender* stream,
+	const QarVideoFrameLayout* layout,
+	qar_render_sender_change_layout_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	if(stream == NULL || layout == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "stream or layout is NULL"
+		);
+	}
+	LbSenderJob* job = lb_sender_job_create(NULL, stream, token);
+	if(job == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	job->layout = *layout;
+	job->callback.change_layout = callback;
+	job->user_state = user_state;
+	return lb_sender_job_start(job, lb_change_layout_job_main);
+}
+
+static void
+lb_begin_frame_job_main(void* arg)
+{
+	LbSenderJob* job = arg;
+	QarRenderFrameInfo* info = NULL;
+	QarResult result =
+		qar_impl_render_sender_begin_frame(job->sender, job->token, &info);
+	if(job->callback.begin_frame != NULL)
+	{
+		job->callback.begin_frame(result, info, job->user_state);
+	}
+	else
+	{
+		qar_impl_render_frame_info_handle_destroy(info);
+	}
+	lb_sender_job_free(job);
+}
+
+QAR_C_API QarResult
+qar_impl_render_sender_begin_frame_async(
+	QarRenderSender* stream,
+	qar_render_sender_begin_frame_callback_t callback,
+	void* user_state,
+	QarCancelToken* token
+)
+{
+	if(stream == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "stream is NULL");
+	}
+	LbSenderJob* job = lb_sender_job_create(NULL, stream, token);
+	if(job == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	job->callback.begin_frame = callback;
+	job->user_state = user_state;
+	return lb_sender_job_start(job, lb_begin_frame_job_main);
+}
+
+#ifdef QAR_ENABLE_D3D11
+QAR_C_API QarResult
+qar_impl_render_sender_frame_d3d11(
+	QarRenderSender* stream, QarVideoFrameD3D11* out_frame
+)
+{
+	(void)stream;
+	(void)out_frame;
+	return lb_error(
+		QAR_STATUS_NOT_IMPLEMENTED, "the loopback runtime only has CPU senders"
+	);
+}
+#endif
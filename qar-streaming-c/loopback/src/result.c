@@ -0,0 +1,385 @@
+/**
+ * @file result.c
+ * @brief Results, error messages, logging and library lifetime.
+ */
+#include "loopback_internal.h"
+
+#include <stdio.h>
+
+LbGlobals g_lb = {
+	LB_MUTEX_INIT,			// lock
+	false,					// initialized
+	false,					// console_logging
+	QAR_LOG_SEVERITY_TRACE, // log_severity
+	false,					// configured
+	{ 0, false, 0, 0, 0 }	// config
+};
+
+// ============================================================================
+// ERROR MESSAGES
+// ============================================================================
+
+/* Messages live in a small ring; handles older than LB_ERROR_SLOTS errors
+ * fall back to a generic message. */
+#define LB_ERROR_SLOTS 256
+#define LB_ERROR_MESSAGE_LENGTH 256
+
+typedef struct LbErrorEntry
+{
+	uint32_t handle;
+	char message[LB_ERROR_MESSAGE_LENGTH];
+} LbErrorEntry;
+
+static LbErrorEntry g_errors[LB_ERROR_SLOTS];
+static uint32_t g_next_error_handle = 1;
+
+static QarResult
+lb_error_from_message(QarStatusCode code, const char* message)
+{
+	QarResult result = { code, 0 };
+	if(code == QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	lb_mutex_lock(&g_lb.lock);
+	result.error_handle = g_next_error_handle++;
+	if(g_next_error_handle == 0)
+	{
+		g_next_error_handle = 1;
+	}
+	LbErrorEntry* entry = &g_errors[result.error_handle % LB_ERROR_SLOTS];
+	entry->handle = result.error_handle;
+	lb_copy_string(entry->message, sizeof(entry->message), message);
+	lb_mutex_unlock(&g_lb.lock);
+	return result;
+}
+
+QarResult
+lb_ok(void)
+{
+	QarResult result = { QAR_STATUS_SUCCESS, 0 };
+	return result;
+}
+
+QarResult
+lb_status(QarStatusCode code)
+{
+	QarResult result = { code, 0 };
+	return result;
+}
+
+QarResult
+lb_error(QarStatusCode code, const char* format, ...)
+{
+	char message[LB_ERROR_MESSAGE_LENGTH];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
+	lb_log(QAR_LOG_SEVERITY_DEBUG, "%s (status %d)", message, (int)code);
+	return lb_error_from_message(code, message);
+}
+
+void
+lb_log(QarLogSeverity severity, const char* format, ...)
+{
+	lb_mutex_lock(&g_lb.lock);
+	bool enabled = g_lb.console_logging && severity >= g_lb.log_severity;
+	lb_mutex_unlock(&g_lb.lock);
+	if(!enabled)
+	{
+		return;
+	}
+	va_list args;
+	va_start(args, format);
+	fprintf(stderr, "[qar-loopback] ");
+	vfprintf(stderr, format, args);
+	fprintf(stderr, "\n");
+	va_end(args);
+}
+
+void
+lb_copy_string(char* out_buffer, size_t buffer_size, const char* text)
+{
+	if(out_buffer == NULL || buffer_size == 0)
+	{
+		return;
+	}
+	size_t length = text != NULL ? strlen(text) : 0;
+	if(length >= buffer_size)
+	{
+		length = buffer_size - 1;
+	}
+	if(length > 0)
+	{
+		memcpy(out_buffer, text, length);
+	}
+	out_buffer[length] = '\0';
+}
+
+QarResult
+lb_write_string(const char* text, char* out_buffer, size_t buffer_size)
+{
+	if(out_buffer == NULL || buffer_size == 0)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "output buffer is empty"
+		);
+	}
+	lb_copy_string(out_buffer, buffer_size, text);
+	return lb_ok();
+}
+
+// ============================================================================
+// RESULT API
+// ============================================================================
+
+QAR_C_API QarResult
+qar_impl_result_error(QarStatusCode code, const char* message)
+{
+	return lb_error_from_message(code, message);
+}
+
+// qar_result_success and the result checks are inline in qar_streaming.h. The
+// symbols stay exported for applications built against older headers, which
+// still resolve them from the runtime.
+
+QAR_C_API QarResult
+qar_impl_result_success(void)
+{
+	return lb_ok();
+}
+
+QAR_C_API bool
+qar_impl_result_is_success(QarResult result)
+{
+	return result.code == QAR_STATUS_SUCCESS;
+}
+
+QAR_C_API bool
+qar_impl_result_is_error(QarResult result)
+{
+	return result.code != QAR_STATUS_SUCCESS;
+}
+
+QAR_C_API bool
+qar_impl_result_has_code(QarResult result, QarStatusCode code)
+{
+	return result.code == code;
+}
+
+QAR_C_API void
+qar_impl_result_message(
+	QarResult result, char* out_buffer, size_t buffer_size
+)
+{
+	if(out_buffer == NULL || buffer_size == 0)
+	{
+		return;
+	}
+	if(result.code == QAR_STATUS_SUCCESS)
+	{
+		lb_copy_string(out_buffer, buffer_size, "success");
+		return;
+	}
+	lb_mutex_lock(&g_lb.lock);
+	const LbErrorEntry* entry = &g_errors[result.error_handle % LB_ERROR_SLOTS];
+	if(result.error_handle != 0 && entry->handle == result.error_handle)
+	{
+		lb_copy_string(out_buffer, buffer_size, entry->message);
+	}
+	else
+	{
+		snprintf(out_buffer, buffer_size, "status %d", (int)result.code);
+	}
+	lb_mutex_unlock(&g_lb.lock);
+}
+
+QAR_C_API QarResult
+qar_impl_error_wrap_result(
+	QarResult inner_result, QarStatusCode new_code, const char* new_message
+)
+{
+	char inner_message[LB_ERROR_MESSAGE_LENGTH];
+	qar_impl_result_message(inner_result, inner_message, sizeof(inner_message));
+	return lb_error(
+		new_code, "%s: %s", new_message ? new_message : "", inner_message
+	);
+}
+
+QAR_C_API void
+qar_impl_result_log_if_error(QarResult result)
+{
+	if(result.code == QAR_STATUS_SUCCESS)
+	{
+		return;
+	}
+	char message[LB_ERROR_MESSAGE_LENGTH];
+	qar_impl_result_message(result, message, sizeof(message));
+	fprintf(stderr, "[qar-loopback] error %d: %s\n", (int)result.code, message);
+}
+
+// ============================================================================
+// LIBRARY LIFETIME AND CONFIGURATION
+// ============================================================================
+
+static void
+lb_config_from_env(const char* name, uint32_t* value)
+{
+	const char* text = getenv(name);
+	if(text != NULL && text[0] != '\0')
+	{
+		*value = (uint32_t)strtoul(text, NULL, 10);
+	}
+}
+
+QAR_C_API QarResult
+qar_impl_library_init(const QarLibraryInit* init)
+{
+	if(init == NULL || init->header.type != QAR_STRUCTURE_TYPE_LIBRARY_INIT)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_library_init_default"
+		);
+	}
+
+	QarLoopbackConfig config = qar_loopback_config_default();
+	uint32_t paced = config.paced ? 1 : 0;
+	lb_config_from_env("QAR_LOOPBACK_DISPLAY_HZ", &config.display_hz);
+	lb_config_from_env("QAR_LOOPBACK_PACED", &paced);
+	lb_config_from_env("QAR_LOOPBACK_EYE_WIDTH", &config.eye_width);
+	lb_config_from_env("QAR_LOOPBACK_EYE_HEIGHT", &config.eye_height);
+	lb_config_from_env(
+		"QAR_LOOPBACK_GESTURE_INTERVAL_MS", &config.gesture_interval_ms
+	);
+	config.paced = paced != 0;
+	if(config.display_hz == 0 || config.eye_width == 0
+	   || config.eye_height == 0)
+	{
+		config = qar_loopback_config_default();
+	}
+
+	lb_mutex_lock(&g_lb.lock);
+	if(g_lb.initialized)
+	{
+		lb_mutex_unlock(&g_lb.lock);
+		return lb_error(
+			QAR_STATUS_LOGIC_ERROR, "qar_library_init called twice"
+		);
+	}
+	g_lb.initialized = true;
+	g_lb.console_logging = init->enable_console_logging;
+	g_lb.log_severity = init->log_severity;
+	if(!g_lb.configured)
+	{
+		g_lb.config = config;
+	}
+	config = g_lb.config;
+	lb_mutex_unlock(&g_lb.lock);
+
+	lb_log(
+		QAR_LOG_SEVERITY_INFO,
+		"loopback runtime initialized (%u Hz%s, %ux%u per view)",
+		config.display_hz,
+		config.paced ? ", paced" : "",
+		config.eye_width,
+		config.eye_height
+	);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_library_destroy(void)
+{
+	lb_mutex_lock(&g_lb.lock);
+	bool was_initialized = g_lb.initialized;
+	g_lb.initialized = false;
+	lb_mutex_unlock(&g_lb.lock);
+	if(!was_initialized)
+	{
+		return lb_error(
+			QAR_STATUS_LOGIC_ERROR, "qar_library_init was not called"
+		);
+	}
+	lb_render_frame_info_pool_drain();
+	return lb_ok();
+}
+
+QarLoopbackConfig
+lb_config(void)
+{
+	lb_mutex_lock(&g_lb.lock);
+	QarLoopbackConfig config = g_lb.config;
+	lb_mutex_unlock(&g_lb.lock);
+	return config.display_hz != 0 ? config : qar_loopback_config_default();
+}
+
+QAR_LOOPBACK_API QarResult
+qar_loopback_configure(const QarLoopbackConfig* config)
+{
+	if(config == NULL || config->display_hz == 0 || config->eye_width == 0
+	   || config->eye_height == 0)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"display_hz, eye_width and eye_height must be non-zero"
+		);
+	}
+	lb_mutex_lock(&g_lb.lock);
+	g_lb.config = *config;
+	g_lb.configured = true;
+	lb_mutex_unlock(&g_lb.lock);
+	return lb_ok();
+}
+
+QAR_LOOPBACK_API QarResult
+qar_loopback_get_config(QarLoopbackConfig* out_config)
+{
+	if(out_config == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "out_config is NULL"
+		);
+	}
+	*out_config = lb_config();
+	return lb_ok();
+}
+
+// ============================================================================
+// DISPATCH TABLE
+// ============================================================================
+
+#define LB_DISPATCH_ENTRY(STATUS, RET, NAME, PARAMS, ARGS) qar_impl_##NAME,
+
+static const QarDispatchTable g_lb_dispatch_table = {
+	QAR_DISPATCH_FUNCTION_LIST(LB_DISPATCH_ENTRY)
+};
+
+#undef LB_DISPATCH_ENTRY
+
+QAR_C_API QarResult
+qar_impl_get_dispatch_table(
+	uint32_t version, QarDispatchTable* out_table, size_t table_size
+)
+{
+	if(version != QAR_DISPATCH_TABLE_VERSION
+	   || table_size != sizeof(QarDispatchTable))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"dispatch table version %u (%zu bytes) requested, loopback "
+			"provides version %u (%zu bytes)",
+			version,
+			table_size,
+			QAR_DISPATCH_TABLE_VERSION,
+			sizeof(QarDispatchTable)
+		);
+	}
+	if(out_table == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "out_table is NULL");
+	}
+	*out_table = g_lb_dispatch_table;
+	return lb_ok();
+}
@@ -0,0 +1,1293 @@
+/**
+ * @file runtime.c
+ * @brief Runtime, onboarding, invites and the session core: dispatcher
+ * thread, subscriptions and polled event queues.
+ */
+#include "loopback_internal.h"
+
+// ============================================================================
+// RUNTIME
+// ============================================================================
+
+static QarRuntime*
+lb_runtime_retain(QarRuntime* runtime)
+{
+	lb_atomic_add_i32(&runtime->ref_count, 1);
+	return runtime;
+}
+
+static void
+lb_runtime_release(QarRuntime* runtime)
+{
+	if(lb_atomic_add_i32(&runtime->ref_count, -1) == 0)
+	{
+		lb_mutex_destroy(&runtime->lock);
+		lb_free(runtime);
+	}
+}
+
+QAR_C_API QarResult
+qar_impl_runtime_create(const QarRuntimeInit* init, QarRuntime** out_runtime)
+{
+	if(init == NULL || init->header.type != QAR_STRUCTURE_TYPE_RUNTIME_INIT
+	   || out_runtime == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_runtime_init_default"
+		);
+	}
+	lb_mutex_lock(&g_lb.lock);
+	bool initialized = g_lb.initialized;
+	lb_mutex_unlock(&g_lb.lock);
+	if(!initialized)
+	{
+		return lb_error(
+			QAR_STATUS_LOGIC_ERROR,
+			"call qar_library_init before creating a runtime"
+		);
+	}
+
+	QarRuntime* runtime = lb_alloc(sizeof(*runtime));
+	if(runtime == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	runtime->ref_count = 1;
+	lb_mutex_init(&runtime->lock);
+	*out_runtime = runtime;
+	lb_log(QAR_LOG_SEVERITY_INFO, "runtime created");
+	return lb_ok();
+}
+
+QAR_C_API void
+qar_impl_runtime_handle_destroy(QarRuntime* handle)
+{
+	if(handle != NULL
+	   && lb_atomic_exchange_i32(&handle->handle_released, 1) == 0)
+	{
+		lb_runtime_release(handle);
+	}
+}
+
+QAR_C_API void
+qar_impl_runtime_destroy(QarRuntime* runtime)
+{
+	if(runtime == NULL)
+	{
+		return;
+	}
+	lb_atomic_exchange_i32(&runtime->shut_down, 1);
+	qar_impl_runtime_handle_destroy(runtime);
+}
+
+static QarResult
+lb_runtime_check(const QarRuntime* runtime)
+{
+	if(runtime == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "runtime is NULL");
+	}
+	if(lb_atomic_load_i32(&runtime->shut_down) != 0)
+	{
+		return lb_error(QAR_STATUS_LOGIC_ERROR, "runtime was destroyed");
+	}
+	return lb_ok();
+}
+
+// ============================================================================
+// SESSION LIFETIME
+// ============================================================================
+
+static void lb_dispatcher_main(void* arg);
+static void lb_task_finish(LbTask* task, bool deliver);
+
+static void
+lb_event_ring_free(LbEventRing* ring)
+{
+	lb_free(ring->items);
+	memset(ring, 0, sizeof(*ring));
+}
+
+QarSession*
+lb_session_retain(QarSession* session)
+{
+	lb_atomic_add_i32(&session->ref_count, 1);
+	return session;
+}
+
+void
+lb_session_release(QarSession* session)
+{
+	if(lb_atomic_add_i32(&session->ref_count, -1) != 0)
+	{
+		return;
+	}
+	while(session->tasks_head != NULL)
+	{
+		LbTask* task = session->tasks_head;
+		session->tasks_head = task->next;
+		lb_task_finish(task, false);
+	}
+	while(session->subscriptions != NULL)
+	{
+		LbSubscription* subscription = session->subscriptions;
+		session->subscriptions = subscription->next;
+		lb_cancel_token_release(subscription->token);
+		lb_free(subscription);
+	}
+	for(int queue = 0; queue < LB_QUEUE_COUNT; ++queue)
+	{
+		lb_event_ring_free(&session->queues[queue]);
+	}
+	lb_peers_free(session);
+	lb_gui_panels_free(session);
+	lb_app_volumes_free(session);
+	lb_cond_destroy(&session->dispatcher_wake);
+	lb_mutex_destroy(&session->lock);
+	lb_runtime_release(session->runtime);
+	lb_free(session);
+}
+
+static QarResult
+lb_session_create(
+	QarRuntime* runtime,
+	const QarOnboardingId* onboarding_id,
+	const QarPeerPresentation* presentation,
+	QarSession** out_session
+)
+{
+	QarSession* session = lb_alloc(sizeof(*session));
+	if(session == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	session->ref_count = 1;
+	session->runtime = lb_runtime_retain(runtime);
+	lb_random_id(session->id.data);
+	session->onboarding_id = *onboarding_id;
+	session->config = lb_config();
+	lb_mutex_init(&session->lock);
+	lb_cond_init(&session->dispatcher_wake);
+
+	if(!lb_peers_init(session, presentation))
+	{
+		lb_session_release(session);
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+
+	lb_session_retain(session); // owned by the dispatcher thread
+	if(!lb_thread_start(&session->dispatcher, lb_dispatcher_main, session))
+	{
+		lb_session_release(session);
+		lb_session_release(session);
+		return lb_error(
+			QAR_STATUS_UNCLASSIFIED, "failed to start the dispatcher thread"
+		);
+	}
+
+	lb_mutex_lock(&runtime->lock);
+	session->next_in_runtime = runtime->sessions;
+	runtime->sessions = session;
+	lb_mutex_unlock(&runtime->lock);
+
+	*out_session = session;
+	return lb_ok();
+}
+
+QAR_C_API void
+qar_impl_session_handle_destroy(QarSession* handle)
+{
+	if(handle == NULL)
+	{
+		return;
+	}
+	QarRuntime* runtime = handle->runtime;
+	lb_mutex_lock(&runtime->lock);
+	for(QarSession** link = &runtime->sessions; *link != NULL;
+		link = &(*link)->next_in_runtime)
+	{
+		if(*link == handle)
+		{
+			*link = handle->next_in_runtime;
+			break;
+		}
+	}
+	lb_mutex_unlock(&runtime->lock);
+
+	lb_mutex_lock(&handle->lock);
+	handle->closed = true;
+	handle->dispatcher_stop = true;
+	lb_cond_broadcast(&handle->dispatcher_wake);
+	lb_mutex_unlock(&handle->lock);
+
+	// From inside a callback the dispatcher finishes on its own once the
+	// callback returns; joining it here would deadlock.
+	if(lb_thread_is_current(handle->dispatcher))
+	{
+		lb_thread_detach(handle->dispatcher);
+	}
+	else
+	{
+		lb_thread_join(handle->dispatcher);
+	}
+	lb_session_release(handle);
+}
+
+QAR_C_API QarResult
+qar_impl_session_get_id(const QarSession* session, QarSessionId* out_session_id)
+{
+	if(session == NULL || out_session_id == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or out pointer is NULL"
+		);
+	}
+	*out_session_id = session->id;
+	return lb_ok();
+}
+
+// ============================================================================
+// DISPATCHER
+// ============================================================================
+
+LbTask*
+lb_task_create(LbTaskKind kind, const LbSubscription* subscription)
+{
+	LbTask* task = lb_alloc(sizeof(*task));
+	if(task != NULL)
+	{
+		task->kind = kind;
+		task->callback = subscription->callback;
+		task->user_state = subscription->user_state;
+	}
+	return task;
+}
+
+void
+lb_session_post_locked(QarSession* session, LbTask* task)
+{
+	if(task == NULL)
+	{
+		return;
+	}
+	if(session->dispatcher_stop)
+	{
+		lb_task_finish(task, false);
+		return;
+	}
+	task->next = NULL;
+	if(session->tasks_tail != NULL)
+	{
+		session->tasks_tail->next = task;
+	}
+	else
+	{
+		session->tasks_head = task;
+	}
+	session->tasks_tail = task;
+	lb_cond_broadcast(&session->dispatcher_wake);
+}
+
+/* Invoke (or drop) the callback of a task, then free everything it owns.
+ * Handles passed to update callbacks are borrowed; render requests belong to
+ * the callback. */
+static void
+lb_task_finish(LbTask* task, bool deliver)
+{
+	switch(task->kind)
+	{
+	case LB_TASK_PEER_UPDATE:
+		if(deliver)
+		{
+			task->callback.peer(task->data.peer, task->user_state);
+		}
+		qar_impl_peer_spec_handle_destroy(task->data.peer);
+		break;
+	case LB_TASK_GUI_PANEL_UPDATE:
+		if(deliver)
+		{
+			task->callback.gui_panel(task->data.gui_panel, task->user_state);
+		}
+		qar_impl_gui_panel_handle_destroy(task->data.gui_panel);
+		break;
+	case LB_TASK_APP_VOLUME_UPDATE:
+		if(deliver)
+		{
+			task->callback.app_volume(task->data.app_volume, task->user_state);
+		}
+		qar_impl_app_volume_handle_destroy(task->data.app_volume);
+		break;
+	case LB_TASK_GESTURE:
+		if(deliver)
+		{
+			task->callback.gesture(&task->data.gesture, task->user_state);
+		}
+		break;
+	case LB_TASK_RENDER_REQUEST:
+		if(deliver)
+		{
+			task->callback.render_request(
+				task->data.render_request, task->user_state
+			);
+		}
+		else
+		{
+			qar_impl_render_request_handle_destroy(task->data.render_request);
+		}
+		break;
+	}
+	lb_free(task);
+}
+
+static void
+lb_dispatcher_main(void* arg)
+{
+	QarSession* session = arg;
+	lb_mutex_lock(&session->lock);
+	while(!session->dispatcher_stop)
+	{
+		if(session->tasks_head != NULL)
+		{
+			LbTask* task = session->tasks_head;
+			session->tasks_head = task->next;
+			if(session->tasks_head == NULL)
+			{
+				session->tasks_tail = NULL;
+			}
+			lb_mutex_unlock(&session->lock);
+			lb_task_finish(task, true);
+			lb_mutex_lock(&session->lock);
+			continue;
+		}
+
+		uint64_t now_ns = lb_now_ns();
+		uint64_t next_ns = lb_app_volumes_script_tick(session, now_ns);
+		if(session->tasks_head != NULL)
+		{
+			continue;
+		}
+		if(next_ns == 0)
+		{
+			lb_cond_wait(&session->dispatcher_wake, &session->lock);
+		}
+		else if(next_ns > now_ns)
+		{
+			lb_cond_wait_for(
+				&session->dispatcher_wake, &session->lock, next_ns - now_ns
+			);
+		}
+	}
+	lb_mutex_unlock(&session->lock);
+	lb_session_release(session);
+}
+
+// ============================================================================
+// SUBSCRIPTIONS
+// ============================================================================
+
+QarResult
+lb_session_subscribe(QarSession* session, const LbSubscription* subscription)
+{
+	LbSubscription* copy = lb_alloc(sizeof(*copy));
+	if(copy == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	*copy = *subscription;
+	copy->next = NULL;
+	copy->token = lb_cancel_token_retain(subscription->token);
+
+	lb_mutex_lock(&session->lock);
+	if(session->closed)
+	{
+		lb_mutex_unlock(&session->lock);
+		lb_cancel_token_release(copy->token);
+		lb_free(copy);
+		return lb_error(QAR_STATUS_LOGIC_ERROR, "session is closed");
+	}
+	// Drop subscriptions whose token was cancelled, then append.
+	LbSubscription** link = &session->subscriptions;
+	while(*link != NULL)
+	{
+		LbSubscription* current = *link;
+		if(qar_impl_cancel_token_is_cancelled(current->token))
+		{
+			*link = current->next;
+			lb_cancel_token_release(current->token);
+			lb_free(current);
+			continue;
+		}
+		link = &current->next;
+	}
+	*link = copy;
+	lb_mutex_unlock(&session->lock);
+	return lb_ok();
+}
+
+LbSubscription*
+lb_session_next_subscription(
+	QarSession* session, LbSubscription* after, LbSubscriptionKind kind
+)
+{
+	LbSubscription* current = after != NULL ? after->next
+											: session->subscriptions;
+	while(current != NULL
+		  && (current->kind != kind
+			  || qar_impl_cancel_token_is_cancelled(current->token)))
+	{
+		current = current->next;
+	}
+	return current;
+}
+
+// ============================================================================
+// POLLED EVENT QUEUES
+// ============================================================================
+
+#define LB_MAX_EVENT_QUEUE_CAPACITY ((size_t)1 << 20)
+#define LB_QUEUE_SWAP_BIAS (INT32_MIN / 2)
+
+static const size_t k_queue_item_sizes[LB_QUEUE_COUNT] = {
+	sizeof(QarPeerEvent),
+	sizeof(QarGuiPanelEvent),
+	sizeof(QarAppVolumeEvent),
+	sizeof(QarAppVolumeGestureEvent),
+};
+
+QAR_C_API QarResult
+qar_impl_session_enable_event_queues(
+	QarSession* session, const QarEventQueueInit* init
+)
+{
+	if(session == NULL || init == NULL
+	   || init->header.type != QAR_STRUCTURE_TYPE_SESSION_EVENT_QUEUE_INIT)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_event_queue_init_default"
+		);
+	}
+	size_t requested = init->capacity != 0 ? init->capacity
+										   : QAR_DEFAULT_EVENT_QUEUE_CAPACITY;
+	if(requested > LB_MAX_EVENT_QUEUE_CAPACITY)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"event queue capacity %zu exceeds %zu",
+			requested,
+			LB_MAX_EVENT_QUEUE_CAPACITY
+		);
+	}
+	size_t capacity = 1;
+	while(capacity < requested)
+	{
+		capacity <<= 1;
+	}
+
+	LbEventRing rings[LB_QUEUE_COUNT];
+	memset(rings, 0, sizeof(rings));
+	for(int queue = 0; queue < LB_QUEUE_COUNT; ++queue)
+	{
+		if((init->sources & (1u << queue)) == 0)
+		{
+			continue;
+		}
+		rings[queue].items = lb_alloc(capacity * k_queue_item_sizes[queue]);
+		if(rings[queue].items == NULL)
+		{
+			for(int index = 0; index < queue; ++index)
+			{
+				lb_event_ring_free(&rings[index]);
+			}
+			return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+		}
+		rings[queue].item_size = k_queue_item_sizes[queue];
+		rings[queue].mask = capacity - 1;
+	}
+
+	// The lock keeps producers out; the bias turns new polls away and the
+	// wait lets polls already reading the old rings finish.
+	lb_mutex_lock(&session->lock);
+	lb_atomic_add_i32(&session->queue_pollers, LB_QUEUE_SWAP_BIAS);
+	while(lb_atomic_load_i32(&session->queue_pollers) != LB_QUEUE_SWAP_BIAS)
+	{
+		lb_sleep_ns(10000);
+	}
+	for(int queue = 0; queue < LB_QUEUE_COUNT; ++queue)
+	{
+		lb_event_ring_free(&session->queues[queue]);
+		session->queues[queue] = rings[queue];
+	}
+	lb_atomic_add_i32(&session->queue_pollers, -LB_QUEUE_SWAP_BIAS);
+	lb_mutex_unlock(&session->lock);
+	return lb_ok();
+}
+
+bool
+lb_session_queue_enabled(const QarSession* session, LbQueue queue)
+{
+	return session->queues[queue].items != NULL;
+}
+
+bool
+lb_session_enqueue_locked(QarSession* session, LbQueue queue, const void* event)
+{
+	LbEventRing* ring = &session->queues[queue];
+	if(ring->items == NULL)
+	{
+		return false;
+	}
+	uint64_t tail = ring->tail;
+	if(tail - lb_atomic_load_u64(&ring->head) > ring->mask)
+	{
+		lb_atomic_exchange_i32(&ring->overflowed, 1);
+		return true;
+	}
+	memcpy(
+		ring->items + (size_t)(tail & ring->mask) * ring->item_size,
+		event,
+		ring->item_size
+	);
+	lb_atomic_store_u64(&ring->tail, tail + 1);
+	return true;
+}
+
+QarResult
+lb_session_poll(
+	QarSession* session,
+	LbQueue queue,
+	void* out_events,
+	size_t capacity,
+	size_t* out_count
+)
+{
+	if(session == NULL || out_count == NULL
+	   || (out_events == NULL && capacity > 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "session or out pointer is NULL"
+		);
+	}
+	*out_count = 0;
+	if(lb_atomic_add_i32(&session->queue_pollers, 1) < 0)
+	{
+		// The rings are being replaced; the caller polls again later.
+		lb_atomic_add_i32(&session->queue_pollers, -1);
+		return lb_ok();
+	}
+	LbEventRing* ring = &session->queues[queue];
+	if(ring->items == NULL)
+	{
+		lb_atomic_add_i32(&session->queue_pollers, -1);
+		return lb_error(
+			QAR_STATUS_LOGIC_ERROR,
+			"event queue not enabled with qar_session_enable_event_queues"
+		);
+	}
+	uint64_t head = ring->head;
+	uint64_t available = lb_atomic_load_u64(&ring->tail) - head;
+	size_t count = available < capacity ? (size_t)available : capacity;
+	uint8_t* out = out_events;
+	for(size_t index = 0; index < count; ++index)
+	{
+		memcpy(
+			out + index * ring->item_size,
+			ring->items
+				+ (size_t)((head + index) & ring->mask) * ring->item_size,
+			ring->item_size
+		);
+	}
+	lb_atomic_store_u64(&ring->head, head + count);
+	*out_count = count;
+	bool overflowed = lb_atomic_exchange_i32(&ring->overflowed, 0) != 0;
+	lb_atomic_add_i32(&session->queue_pollers, -1);
+	return overflowed ? lb_status(QAR_STATUS_EVENT_QUEUE_OVERFLOW) : lb_ok();
+}
+
+// ============================================================================
+// ONBOARDING
+// ============================================================================
+
+struct QarOnboardingInviteHandle
+{
+	QarOnboardingMethod method;
+	int64_t expires_unix;
+	uint8_t secret[QAR_MAX_ID_LENGTH];
+};
+
+/* Wire format: magic, version, method, expiry (little endian), secret. */
+#define LB_INVITE_MAGIC "QLBI"
+#define LB_INVITE_WIRE_SIZE (4 + 1 + 1 + 8 + QAR_MAX_ID_LENGTH)
+#define LB_INVITE_LIFETIME_SECONDS 600
+
+/** @brief Onboard or rejoin request, copied out of the caller's init. */
+typedef struct LbOnboardRequest
+{
+	bool is_rejoin;
+	QarOnboardingId onboarding_id;
+	char display_name[QAR_MAX_STRING_LENGTH];
+	char app_version[QAR_MAX_STRING_LENGTH];
+	char app_custom_peer_info[QAR_MAX_STRING_LENGTH];
+	bool has_display_name;
+	bool has_app_version;
+	bool has_app_custom_peer_info;
+} LbOnboardRequest;
+
+static void
+lb_onboard_request_set_presentation(
+	LbOnboardRequest* request, const QarPeerPresentation* presentation
+)
+{
+	request->has_display_name = presentation->display_name != NULL;
+	request->has_app_version = presentation->app_version != NULL;
+	request->has_app_custom_peer_info =
+		presentation->app_custom_peer_info != NULL;
+	lb_copy_string(
+		request->display_name,
+		sizeof(request->display_name),
+		presentation->display_name
+	);
+	lb_copy_string(
+		request->app_version,
+		sizeof(request->app_version),
+		presentation->app_version
+	);
+	lb_copy_string(
+		request->app_custom_peer_info,
+		sizeof(request->app_custom_peer_info),
+		presentation->app_custom_peer_info
+	);
+}
+
+static QarResult
+lb_onboard_request_from_onboard(
+	const QarOnboardInit* init, LbOnboardRequest* out_request
+)
+{
+	if(init == NULL
+	   || init->header.type != QAR_STRUCTURE_TYPE_RUNTIME_ONBOARD_INIT)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_onboard_init_default"
+		);
+	}
+	bool has_mode = false;
+	for(const QarStructureHeader* ext = init->header.next; ext != NULL;
+		ext = ext->next)
+	{
+		if(ext->type == QAR_STRUCTURE_TYPE_RUNTIME_ONBOARD_CODE_EXT)
+		{
+			const QarOnboardCodeExt* code = (const QarOnboardCodeExt*)ext;
+			if(code->code == NULL || code->code[0] == '\0')
+			{
+				return lb_error(QAR_STATUS_PAKE_ERROR, "pairing code is empty");
+			}
+			has_mode = true;
+		}
+		else if(ext->type == QAR_STRUCTURE_TYPE_RUNTIME_ONBOARD_INVITE_EXT)
+		{
+			const QarOnboardInviteExt* invite = (const QarOnboardInviteExt*)ext;
+			if(invite->invite == NULL)
+			{
+				return lb_error(
+					QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "invite is NULL"
+				);
+			}
+			if(invite->invite->expires_unix < lb_unix_seconds())
+			{
+				return lb_error(QAR_STATUS_ONBOARDING_FAILED, "invite expired");
+			}
+			has_mode = true;
+		}
+		else if(ext->type == QAR_STRUCTURE_TYPE_RUNTIME_ONBOARD_HOST_EXT)
+		{
+			const QarOnboardHostExt* host = (const QarOnboardHostExt*)ext;
+			if(host->hostname == NULL || host->hostname[0] == '\0')
+			{
+				return lb_error(
+					QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "hostname is empty"
+				);
+			}
+		}
+	}
+	if(!has_mode)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"chain QarOnboardCodeExt or QarOnboardInviteExt"
+		);
+	}
+	memset(out_request, 0, sizeof(*out_request));
+	out_request->onboarding_id = init->onboarding_id;
+	if(lb_id_is_zero(out_request->onboarding_id.data))
+	{
+		lb_random_id(out_request->onboarding_id.data);
+	}
+	lb_onboard_request_set_presentation(out_request, &init->presentation);
+	return lb_ok();
+}
+
+static QarResult
+lb_onboard_request_from_rejoin(
+	const QarRejoinInit* init, LbOnboardRequest* out_request
+)
+{
+	if(init == NULL
+	   || init->header.type != QAR_STRUCTURE_TYPE_RUNTIME_REJOIN_INIT)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_rejoin_init_default"
+		);
+	}
+	if(lb_id_is_zero(init->onboarding_id.data))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "onboarding_id must not be zero"
+		);
+	}
+	memset(out_request, 0, sizeof(*out_request));
+	out_request->is_rejoin = true;
+	out_request->onboarding_id = init->onboarding_id;
+	lb_onboard_request_set_presentation(out_request, &init->presentation);
+	return lb_ok();
+}
+
+static void
+lb_report_progress(
+	qar_progress_callback_t on_progress,
+	void* progress_state,
+	QarActionSeverity severity,
+	float percent,
+	const char* message
+)
+{
+	if(on_progress != NULL)
+	{
+		on_progress(severity, percent, message, progress_state);
+	}
+}
+
+static QarResult
+lb_onboard_execute(
+	QarRuntime* runtime,
+	const LbOnboardRequest* request,
+	qar_progress_callback_t on_progress,
+	void* progress_state,
+	QarCancelToken* cancel,
+	QarSession** out_session
+)
+{
+	QarResult result = lb_runtime_check(runtime);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	lb_report_progress(
+		on_progress,
+		progress_state,
+		QAR_ACTION_SEVERITY_INFO,
+		0.0f,
+		request->is_rejoin ? "Rejoining loopback hub"
+						   : "Onboarding with loopback hub"
+	);
+	if(qar_impl_cancel_token_is_cancelled(cancel))
+	{
+		return lb_cancelled_result(cancel);
+	}
+
+	QarPeerPresentation presentation = qar_peer_presentation_default();
+	presentation.display_name =
+		request->has_display_name ? request->display_name : NULL;
+	presentation.app_version =
+		request->has_app_version ? request->app_version : NULL;
+	presentation.app_custom_peer_info = request->has_app_custom_peer_info
+		? request->app_custom_peer_info
+		: NULL;
+	result = lb_session_create(
+		runtime, &request->onboarding_id, &presentation, out_session
+	);
+	if(result.code == QAR_STATUS_SUCCESS)
+	{
+		lb_report_progress(
+			on_progress,
+			progress_state,
+			QAR_ACTION_SEVERITY_DONE,
+			100.0f,
+			"Connected to loopback hub"
+		);
+	}
+	return result;
+}
+
+QAR_C_API QarResult
+qar_impl_runtime_onboard(
+	QarRuntime* runtime,
+	const QarOnboardInit* init,
+	qar_progress_callback_t on_progress,
+	void* progress_state,
+	QarCancelToken* cancel,
+	QarOnboardingId* out_onboarding_id,
+	QarSession** out_session
+)
+{
+	LbOnboardRequest request;
+	QarResult result = lb_onboard_request_from_onboard(init, &request);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	if(out_onboarding_id == NULL || out_session == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "out pointer is NULL"
+		);
+	}
+	result = lb_onboard_execute(
+		runtime, &request, on_progress, progress_state, cancel, out_session
+	);
+	if(result.code == QAR_STATUS_SUCCESS)
+	{
+		*out_onboarding_id = request.onboarding_id;
+	}
+	return result;
+}
+
+QAR_C_API QarResult
+qar_impl_runtime_rejoin(
+	QarRuntime* runtime,
+	const QarRejoinInit* init,
+	qar_progress_callback_t on_progress,
+	void* progress_state,
+	QarCancelToken* cancel,
+	QarSession** out_session
+)
+{
+	LbOnboardRequest request;
+	QarResult result = lb_onboard_request_from_rejoin(init, &request);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	if(out_session == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "out_session is NULL"
+		);
+	}
+	return lb_onboard_execute(
+		runtime, &request, on_progress, progress_state, cancel, out_session
+	);
+}
+
+typedef struct LbOnboardJob
+{
+	QarRuntime* runtime;
+	LbOnboardRequest request;
+	qar_runtime_onboard_result_callback_t result_callback;
+	qar_progress_callback_t update_callback;
+	void* user_state;
+	QarCancelToken* cancel;
+} LbOnboardJob;
+
+static void
+lb_onboard_job_main(void* arg)
+{
+	LbOnboardJob* job = arg;
+	QarSession* session = NULL;
+	QarResult result = lb_onboard_execute(
+		job->runtime,
+		&job->request,
+		job->update_callback,
+		job->user_state,
+		job->cancel,
+		&session
+	);
+	if(job->result_callback != NULL)
+	{
+		job->result_callback(
+			result,
+			result.code == QAR_STATUS_SUCCESS ? &job->request.onboarding_id
+											  : NULL,
+			session,
+			job->user_state
+		);
+	}
+	else if(session != NULL)
+	{
+		qar_impl_session_handle_destroy(session);
+	}
+	lb_cancel_token_release(job->cancel);
+	lb_runtime_release(job->runtime);
+	lb_free(job);
+}
+
+static QarResult
+lb_onboard_start_job(
+	QarRuntime* runtime,
+	const LbOnboardRequest* request,
+	qar_runtime_onboard_result_callback_t result_callback,
+	qar_progress_callback_t update_callback,
+	void* user_state,
+	QarCancelToken* cancel
+)
+{
+	QarResult result = lb_runtime_check(runtime);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	LbOnboardJob* job = lb_alloc(sizeof(*job));
+	if(job == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	job->runtime = lb_runtime_retain(runtime);
+	job->request = *request;
+	job->result_callback = result_callback;
+	job->update_callback = update_callback;
+	job->user_state = user_state;
+	job->cancel = lb_cancel_token_retain(cancel);
+	if(!lb_thread_start_detached(lb_onboard_job_main, job))
+	{
+		lb_cancel_token_release(job->cancel);
+		lb_runtime_release(job->runtime);
+		lb_free(job);
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "failed to start a thread");
+	}
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_runtime_onboard_async(
+	QarRuntime* runtime,
+	const QarOnboardInit* init,
+	qar_runtime_onboard_result_callback_t result_callback,
+	qar_progress_callback_t update_callback,
+	void* user_state,
+	QarCancelToken* cancel
+)
+{
+	LbOnboardRequest request;
+	QarResult result = lb_onboard_request_from_onboard(init, &request);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	return lb_onboard_start_job(
+		runtime, &request, result_callback, update_callback, user_state, cancel
+	);
+}
+
+QAR_C_API QarResult
+qar_impl_runtime_rejoin_async(
+	QarRuntime* runtime,
+	const QarRejoinInit* init,
+	qar_runtime_onboard_result_callback_t result_callback,
+	qar_progress_callback_t update_callback,
+	void* user_state,
+	QarCancelToken* cancel
+)
+{
+	LbOnboardRequest request;
+	QarResult result = lb_onboard_request_from_rejoin(init, &request);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	return lb_onboard_start_job(
+		runtime, &request, result_callback, update_callback, user_state, cancel
+	);
+}
+
+QAR_C_API QarResult
+qar_impl_runtime_forget(QarRuntime* runtime, const QarForgetInit* init)
+{
+	QarResult result = lb_runtime_check(runtime);
+	if(result.code != QAR_STATUS_SUCCESS)
+	{
+		return result;
+	}
+	if(init == NULL
+	   || init->header.type != QAR_STRUCTURE_TYPE_RUNTIME_FORGET_INIT
+	   || lb_id_is_zero(init->onboarding_id.data))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_forget_init_default with a non-zero id"
+		);
+	}
+	bool still_active = false;
+	lb_mutex_lock(&runtime->lock);
+	for(QarSession* session = runtime->sessions; session != NULL;
+		session = session->next_in_runtime)
+	{
+		still_active = still_active
+			|| lb_id_equals(
+						   session->onboarding_id.data, init->onboarding_id.data
+			);
+	}
+	lb_mutex_unlock(&runtime->lock);
+	if(still_active)
+	{
+		return lb_error(
+			QAR_STATUS_ONBOARDING_SESSION_STILL_ACTIVE,
+			"destroy the session handle before forgetting its identity"
+		);
+	}
+	return lb_ok();
+}
+
+// ============================================================================
+// INVITES
+// ============================================================================
+
+static QarResult
+lb_request_invite(
+	QarSession* session,
+	const QarRequestInviteInit* init,
+	QarOnboardingInvite** out_invite
+)
+{
+	if(session == NULL || out_invite == NULL || init == NULL
+	   || init->header.type != QAR_STRUCTURE_TYPE_SESSION_REQUEST_INVITE_INIT)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_request_invite_init_default"
+		);
+	}
+	QarOnboardingInvite* invite = lb_alloc(sizeof(*invite));
+	if(invite == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	invite->method = QAR_ONBOARDING_METHOD_PASSWORD;
+	invite->expires_unix = lb_unix_seconds() + LB_INVITE_LIFETIME_SECONDS;
+	lb_random_id(invite->secret);
+	*out_invite = invite;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_session_request_onboarding_invite(
+	QarSession* session,
+	const QarRequestInviteInit* init,
+	qar_progress_callback_t on_progress,
+	void* progress_state,
+	QarCancelToken* cancel,
+	QarOnboardingInvite** out_invite
+)
+{
+	if(qar_impl_cancel_token_is_cancelled(cancel))
+	{
+		return lb_cancelled_result(cancel);
+	}
+	QarResult result = lb_request_invite(session, init, out_invite);
+	if(result.code == QAR_STATUS_SUCCESS)
+	{
+		lb_report_progress(
+			on_progress,
+			progress_state,
+			QAR_ACTION_SEVERITY_DONE,
+			100.0f,
+			"Invite ready"
+		);
+	}
+	return result;
+}
+
+typedef struct LbInviteJob
+{
+	QarSession* session;
+	qar_session_request_invite_result_callback_t result_callback;
+	qar_progress_callback_t update_callback;
+	void* user_state;
+	QarCancelToken* cancel;
+} LbInviteJob;
+
+static void
+lb_invite_job_main(void* arg)
+{
+	LbInviteJob* job = arg;
+	QarRequestInviteInit init = qar_request_invite_init_default();
+	QarOnboardingInvite* invite = NULL;
+	QarResult result = qar_impl_session_request_onboarding_invite(
+		job->session,
+		&init,
+		job->update_callback,
+		job->user_state,
+		job->cancel,
+		&invite
+	);
+	if(job->result_callback != NULL)
+	{
+		job->result_callback(result, invite, job->user_state);
+	}
+	else
+	{
+		qar_impl_onboarding_invite_handle_destroy(invite);
+	}
+	lb_cancel_token_release(job->cancel);
+	lb_session_release(job->session);
+	lb_free(job);
+}
+
+QAR_C_API QarResult
+qar_impl_session_request_onboarding_invite_async(
+	QarSession* session,
+	const QarRequestInviteInit* init,
+	qar_session_request_invite_result_callback_t result_callback,
+	qar_progress_callback_t update_callback,
+	void* user_state,
+	QarCancelToken* cancel
+)
+{
+	if(session == NULL || init == NULL
+	   || init->header.type != QAR_STRUCTURE_TYPE_SESSION_REQUEST_INVITE_INIT)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"init must come from qar_request_invite_init_default"
+		);
+	}
+	LbInviteJob* job = lb_alloc(sizeof(*job));
+	if(job == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	job->session = lb_session_retain(session);
+	job->result_callback = result_callback;
+	job->update_callback = update_callback;
+	job->user_state = user_state;
+	job->cancel = lb_cancel_token_retain(cancel);
+	if(!lb_thread_start_detached(lb_invite_job_main, job))
+	{
+		lb_cancel_token_release(job->cancel);
+		lb_session_release(job->session);
+		lb_free(job);
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "failed to start a thread");
+	}
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_onboarding_invite_deserialize(
+	const uint8_t* wire_data,
+	size_t wire_data_size,
+	QarOnboardingInvite** out_invite
+)
+{
+	if(wire_data == NULL || out_invite == NULL
+	   || wire_data_size != LB_INVITE_WIRE_SIZE
+	   || memcmp(wire_data, LB_INVITE_MAGIC, 4) != 0 || wire_data[4] != 1)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "not a loopback invite blob"
+		);
+	}
+	QarOnboardingInvite* invite = lb_alloc(sizeof(*invite));
+	if(invite == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	invite->method = (QarOnboardingMethod)wire_data[5];
+	uint64_t expires = 0;
+	for(int index = 0; index < 8; ++index)
+	{
+		expires |= (uint64_t)wire_data[6 + index] << (8 * index);
+	}
+	invite->expires_unix = (int64_t)expires;
+	memcpy(invite->secret, wire_data + 14, QAR_MAX_ID_LENGTH);
+	*out_invite = invite;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_onboarding_invite_serialized_size(
+	const QarOnboardingInvite* invite, size_t* out_size
+)
+{
+	if(invite == NULL || out_size == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "invite or out_size is NULL"
+		);
+	}
+	*out_size = LB_INVITE_WIRE_SIZE;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_onboarding_invite_serialize(
+	const QarOnboardingInvite* invite,
+	uint8_t* out_buffer,
+	size_t buffer_size,
+	size_t* out_bytes_written
+)
+{
+	if(invite == NULL || out_buffer == NULL || out_bytes_written == NULL
+	   || buffer_size < LB_INVITE_WIRE_SIZE)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"serialize needs %d bytes of output",
+			LB_INVITE_WIRE_SIZE
+		);
+	}
+	memcpy(out_buffer, LB_INVITE_MAGIC, 4);
+	out_buffer[4] = 1;
+	out_buffer[5] = (uint8_t)invite->method;
+	for(int index = 0; index < 8; ++index)
+	{
+		out_buffer[6 + index] =
+			(uint8_t)((uint64_t)invite->expires_unix >> (8 * index));
+	}
+	memcpy(out_buffer + 14, invite->secret, QAR_MAX_ID_LENGTH);
+	*out_bytes_written = LB_INVITE_WIRE_SIZE;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_onboarding_invite_get_method(
+	const QarOnboardingInvite* invite, QarOnboardingMethod* out_method
+)
+{
+	if(invite == NULL || out_method == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "invite or out pointer is NULL"
+		);
+	}
+	*out_method = invite->method;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_onboarding_invite_get_expires_unix(
+	const QarOnboardingInvite* invite, int64_t* out_expires_unix
+)
+{
+	if(invite == NULL || out_expires_unix == NULL)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "invite or out pointer is NULL"
+		);
+	}
+	*out_expires_unix = invite->expires_unix;
+	return lb_ok();
+}
+
+QAR_C_API bool
+qar_impl_onboarding_invite_handle_is_valid(const QarOnboardingInvite* invite)
+{
+	return invite != NULL;
+}
+
+QAR_C_API void
+qar_impl_onboarding_invite_handle_destroy(QarOnboardingInvite* invite)
+{
+	lb_free(invite);
+}
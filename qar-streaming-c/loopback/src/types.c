@@ -0,0 +1,442 @@
+/**
+ * @file types.c
+ * @brief Identifiers, UUID text, cancellation tokens and peer sets.
+ */
+#include "loopback_internal.h"
+
+// ============================================================================
+// IDENTIFIERS
+// ============================================================================
+
+static volatile uint64_t g_random_state;
+
+static uint64_t
+lb_splitmix64(uint64_t value)
+{
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+	return value ^ (value >> 31);
+}
+
+static uint64_t
+lb_random_u64(void)
+{
+	if(lb_atomic_load_u64(&g_random_state) == 0)
+	{
+		lb_atomic_store_u64(
+			&g_random_state, lb_now_ns() ^ ((uint64_t)lb_unix_seconds() << 32)
+		);
+	}
+	return lb_splitmix64(
+		lb_atomic_add_u64(&g_random_state, 0x9e3779b97f4a7c15ull)
+	);
+}
+
+static void
+lb_store_u64(uint8_t* out, uint64_t value)
+{
+	for(int index = 0; index < 8; ++index)
+	{
+		out[index] = (uint8_t)(value >> (56 - 8 * index));
+	}
+}
+
+void
+lb_random_id(uint8_t out_id[QAR_MAX_ID_LENGTH])
+{
+	lb_store_u64(out_id, lb_random_u64());
+	lb_store_u64(out_id + 8, lb_random_u64());
+	out_id[6] = (uint8_t)((out_id[6] & 0x0f) | 0x40); // version 4
+	out_id[8] = (uint8_t)((out_id[8] & 0x3f) | 0x80); // RFC 4122 variant
+}
+
+static uint64_t
+lb_fnv1a(uint64_t hash, const char* text)
+{
+	for(const char* c = text ? text : ""; *c != '\0'; ++c)
+	{
+		hash = (hash ^ (uint8_t)*c) * 0x100000001b3ull;
+	}
+	return (hash ^ 0xff) * 0x100000001b3ull;
+}
+
+void
+lb_name_id(
+	const char* scope, const char* name, uint8_t out_id[QAR_MAX_ID_LENGTH]
+)
+{
+	uint64_t high = lb_fnv1a(lb_fnv1a(0xcbf29ce484222325ull, scope), name);
+	uint64_t low = lb_fnv1a(lb_fnv1a(0x84222325cbf29ce4ull, name), scope);
+	lb_store_u64(out_id, lb_splitmix64(high));
+	lb_store_u64(out_id + 8, lb_splitmix64(low));
+	out_id[6] = (uint8_t)((out_id[6] & 0x0f) | 0x80); // version 8 (custom)
+	out_id[8] = (uint8_t)((out_id[8] & 0x3f) | 0x80);
+}
+
+bool
+lb_id_is_zero(const uint8_t id[QAR_MAX_ID_LENGTH])
+{
+	for(size_t index = 0; index < QAR_MAX_ID_LENGTH; ++index)
+	{
+		if(id[index] != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool
+lb_id_equals(
+	const uint8_t a[QAR_MAX_ID_LENGTH], const uint8_t b[QAR_MAX_ID_LENGTH]
+)
+{
+	return memcmp(a, b, QAR_MAX_ID_LENGTH) == 0;
+}
+
+QarTimePoint
+lb_time_point(uint64_t time_ns)
+{
+	QarTimePoint time_point = { time_ns, 1 };
+	return time_point;
+}
+
+uint64_t
+lb_time_point_ns(QarTimePoint time_point)
+{
+	return time_point.precision == 0 ? time_point.count * 1000000ull
+									 : time_point.count;
+}
+
+QAR_C_API QarPeerId
+qar_impl_peer_id_unique(void)
+{
+	QarPeerId id;
+	lb_random_id(id.data);
+	return id;
+}
+
+QAR_C_API QarSessionId
+qar_impl_session_unique(void)
+{
+	QarSessionId id;
+	lb_random_id(id.data);
+	return id;
+}
+
+QAR_C_API QarGuiPanelId
+qar_impl_gui_panel_id_unique(void)
+{
+	QarGuiPanelId id;
+	lb_random_id(id.data);
+	return id;
+}
+
+// qar_uuid_to_string and qar_uuid_from_string are inline in qar_streaming.h.
+// The symbols stay exported for applications built against older headers.
+
+QAR_C_API QarResult
+qar_impl_uuid_to_string(
+	const uint8_t* uuid_bytes, char* out_buffer, size_t buffer_size
+)
+{
+	static const char digits[] = "0123456789abcdef";
+	if(uuid_bytes == NULL || out_buffer == NULL
+	   || buffer_size < QAR_UUID_TEXT_BUFFER_SIZE)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"uuid_to_string needs %d bytes of output",
+			QAR_UUID_TEXT_BUFFER_SIZE
+		);
+	}
+	char* out = out_buffer;
+	for(int index = 0; index < QAR_MAX_ID_LENGTH; ++index)
+	{
+		if(index == 4 || index == 6 || index == 8 || index == 10)
+		{
+			*out++ = '-';
+		}
+		*out++ = digits[uuid_bytes[index] >> 4];
+		*out++ = digits[uuid_bytes[index] & 0x0f];
+	}
+	*out = '\0';
+	return lb_ok();
+}
+
+static int
+lb_hex_value(char c)
+{
+	if(c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+	if(c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+	if(c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+QAR_C_API QarResult
+qar_impl_uuid_from_string(const char* text, uint8_t* out_uuid_bytes)
+{
+	if(text == NULL || out_uuid_bytes == NULL
+	   || strlen(text) != QAR_UUID_TEXT_LENGTH)
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+			"expected xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+		);
+	}
+	uint8_t bytes[QAR_MAX_ID_LENGTH];
+	size_t byte_index = 0;
+	for(size_t index = 0; index < QAR_UUID_TEXT_LENGTH;)
+	{
+		if(index == 8 || index == 13 || index == 18 || index == 23)
+		{
+			if(text[index] != '-')
+			{
+				return lb_error(
+					QAR_STATUS_ARGUMENT_NOT_SUPPORTED,
+					"malformed uuid '%s'",
+					text
+				);
+			}
+			++index;
+			continue;
+		}
+		int high = lb_hex_value(text[index]);
+		int low = lb_hex_value(text[index + 1]);
+		if(high < 0 || low < 0)
+		{
+			return lb_error(
+				QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "malformed uuid '%s'", text
+			);
+		}
+		bytes[byte_index++] = (uint8_t)(high << 4 | low);
+		index += 2;
+	}
+	memcpy(out_uuid_bytes, bytes, sizeof(bytes));
+	return lb_ok();
+}
+
+// ============================================================================
+// CANCELLATION TOKENS
+// ============================================================================
+
+QAR_C_API QarResult
+qar_impl_cancel_token_create(QarCancelToken** token)
+{
+	if(token == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "token is NULL");
+	}
+	*token = lb_alloc(sizeof(**token));
+	if(*token == NULL)
+	{
+		return lb_error(QAR_STATUS_UNCLASSIFIED, "out of memory");
+	}
+	(*token)->ref_count = 1;
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_cancel_token_create_with_timeout(
+	QarCancelToken** token, uint32_t timeout_ms
+)
+{
+	QarResult result = qar_impl_cancel_token_create(token);
+	if(result.code == QAR_STATUS_SUCCESS)
+	{
+		result = qar_impl_cancel_token_cancel_after(*token, timeout_ms);
+	}
+	return result;
+}
+
+QarCancelToken*
+lb_cancel_token_retain(QarCancelToken* token)
+{
+	if(token != NULL)
+	{
+		lb_atomic_add_i32(&token->ref_count, 1);
+	}
+	return token;
+}
+
+void
+lb_cancel_token_release(QarCancelToken* token)
+{
+	if(token != NULL && lb_atomic_add_i32(&token->ref_count, -1) == 0)
+	{
+		lb_free(token);
+	}
+}
+
+QAR_C_API void
+qar_impl_cancel_token_handle_destroy(QarCancelToken* handle)
+{
+	lb_cancel_token_release(handle);
+}
+
+QAR_C_API QarResult
+qar_impl_cancel_token_cancel(QarCancelToken* token)
+{
+	if(token == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "token is NULL");
+	}
+	lb_atomic_exchange_i32(&token->cancelled, 1);
+	return lb_ok();
+}
+
+QAR_C_API QarResult
+qar_impl_cancel_token_cancel_after(QarCancelToken* token, uint32_t timeout_ms)
+{
+	if(token == NULL)
+	{
+		return lb_error(QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "token is NULL");
+	}
+	lb_atomic_store_u64(
+		&token->deadline_ns, lb_now_ns() + (uint64_t)timeout_ms * 1000000ull
+	);
+	return lb_ok();
+}
+
+QAR_C_API bool
+qar_impl_cancel_token_is_cancelled(const QarCancelToken* token)
+{
+	if(token == NULL)
+	{
+		return false;
+	}
+	QarCancelToken* mutable_token = (QarCancelToken*)token;
+	if(lb_atomic_load_i32(&mutable_token->cancelled) != 0)
+	{
+		return true;
+	}
+	uint64_t deadline_ns = lb_atomic_load_u64(&mutable_token->deadline_ns);
+	if(deadline_ns != 0 && lb_now_ns() >= deadline_ns)
+	{
+		lb_atomic_exchange_i32(&mutable_token->timed_out, 1);
+		lb_atomic_exchange_i32(&mutable_token->cancelled, 1);
+		return true;
+	}
+	return false;
+}
+
+QAR_C_API bool
+qar_impl_cancel_token_is_timeout(const QarCancelToken* token)
+{
+	return qar_impl_cancel_token_is_cancelled(token)
+		&& lb_atomic_load_i32(&token->timed_out) != 0;
+}
+
+QarResult
+lb_cancelled_result(const QarCancelToken* token)
+{
+	if(qar_impl_cancel_token_is_timeout(token))
+	{
+		return lb_error(QAR_STATUS_TIMEOUT, "operation timed out");
+	}
+	return lb_error(QAR_STATUS_UNCLASSIFIED, "operation cancelled");
+}
+
+// ============================================================================
+// PEER SETS
+// ============================================================================
+
+bool
+lb_peer_set_add(LbPeerSet* set, const QarPeerId* id)
+{
+	for(size_t index = 0; index < set->count; ++index)
+	{
+		if(lb_id_equals(set->ids[index].data, id->data))
+		{
+			return true;
+		}
+	}
+	if(!lb_reserve(
+		   (void**)&set->ids, &set->capacity, set->count + 1, sizeof(QarPeerId)
+	   ))
+	{
+		return false;
+	}
+	set->ids[set->count++] = *id;
+	return true;
+}
+
+void
+lb_peer_set_remove(LbPeerSet* set, const QarPeerId* id)
+{
+	for(size_t index = 0; index < set->count; ++index)
+	{
+		if(lb_id_equals(set->ids[index].data, id->data))
+		{
+			set->ids[index] = set->ids[--set->count];
+			return;
+		}
+	}
+}
+
+bool
+lb_peer_set_copy(LbPeerSet* out_set, const LbPeerSet* set)
+{
+	out_set->ids = NULL;
+	out_set->count = 0;
+	out_set->capacity = 0;
+	if(set->count == 0)
+	{
+		return true;
+	}
+	if(!lb_reserve(
+		   (void**)&out_set->ids,
+		   &out_set->capacity,
+		   set->count,
+		   sizeof(QarPeerId)
+	   ))
+	{
+		return false;
+	}
+	memcpy(out_set->ids, set->ids, set->count * sizeof(QarPeerId));
+	out_set->count = set->count;
+	return true;
+}
+
+void
+lb_peer_set_free(LbPeerSet* set)
+{
+	lb_free(set->ids);
+	set->ids = NULL;
+	set->count = 0;
+	set->capacity = 0;
+}
+
+QarResult
+lb_peer_set_write(
+	const LbPeerSet* set,
+	QarPeerId* out_peers,
+	size_t peers_buffer_size,
+	size_t* out_peers_written
+)
+{
+	if(out_peers_written == NULL
+	   || (out_peers == NULL && peers_buffer_size > 0))
+	{
+		return lb_error(
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED, "output pointers are NULL"
+		);
+	}
+	size_t count = set->count < peers_buffer_size ? set->count
+												   : peers_buffer_size;
+	if(count > 0)
+	{
+		memcpy(out_peers, set->ids, count * sizeof(QarPeerId));
+	}
+	*out_peers_written = count;
+	return lb_ok();
+}
@@ -0,0 +1,161 @@
+/**
+ * @file app_volume_states_test.c
+ * @brief Batched latest-state reads agree with the per-field getters.
+ */
+#include "test_common.h"
+
+#include <string.h>
+
+#define TEST_VOLUMES 3
+
+static QarAppVolumeId
+create_volume(QarSession* session, const char* name, float offset)
+{
+	QarAppVolumeInit init = qar_app_volume_init_default();
+	init.common_name = name;
+	init.pose.position.x = offset;
+	init.size.width_meters = 1.0f + offset;
+	init.app_pose.position.y = -offset;
+	init.app_scale = 2.0f + offset;
+	QarAppVolumeId id;
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volumes_get_or_create(session, &init, &id)
+	));
+	return id;
+}
+
+static bool
+poses_equal(const QarPose* a, const QarPose* b)
+{
+	return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+/* Each valid entry holds exactly what the four single getters return. */
+static void
+check_matches_getters(
+	QarSession* session,
+	const QarAppVolumeId* id,
+	const QarAppVolumeLatestState* state
+)
+{
+	QarPose pose;
+	QarAppVolumeSize size;
+	QarPose app_pose;
+	float app_scale = 0.0f;
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volume_get_latest_pose(session, id, &pose)
+	));
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volume_get_latest_size(session, id, &size)
+	));
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volume_get_latest_app_pose(session, id, &app_pose)
+	));
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volume_get_latest_app_scale(session, id, &app_scale)
+	));
+	TEST_CHECK(state->is_valid);
+	TEST_CHECK(poses_equal(&state->pose, &pose));
+	TEST_CHECK(memcmp(&state->size, &size, sizeof(size)) == 0);
+	TEST_CHECK(poses_equal(&state->app_pose, &app_pose));
+	TEST_CHECK(state->app_scale == app_scale);
+}
+
+static void
+check_invalid(const QarAppVolumeLatestState* state)
+{
+	QarPose identity = qar_pose_default();
+	TEST_CHECK(!state->is_valid);
+	TEST_CHECK(poses_equal(&state->pose, &identity));
+	TEST_CHECK(poses_equal(&state->app_pose, &identity));
+	TEST_CHECK(state->app_scale == 1.0f);
+}
+
+static void
+test_batch_matches_getters(QarSession* session)
+{
+	QarAppVolumeId ids[TEST_VOLUMES] = {
+		create_volume(session, "states-a", 0.0f),
+		create_volume(session, "states-b", 1.0f),
+		create_volume(session, "states-c", 2.0f),
+	};
+	// Changes after creation show up in the next batch.
+	QarPose moved = qar_pose_default();
+	moved.position.z = 5.0f;
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volumes_change_pose(session, &ids[1], &moved)
+	));
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volumes_change_app_scale(session, &ids[1], 0.25f)
+	));
+
+	QarAppVolumeLatestState states[TEST_VOLUMES];
+	memset(states, 0xcd, sizeof(states));
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volumes_get_latest_states(session, ids, TEST_VOLUMES, states)
+	));
+	for(size_t index = 0; index < TEST_VOLUMES; ++index)
+	{
+		check_matches_getters(session, &ids[index], &states[index]);
+	}
+	TEST_CHECK(states[1].pose.position.z == 5.0f);
+	TEST_CHECK(states[1].app_scale == 0.25f);
+	TEST_CHECK(states[2].size.width_meters == 3.0f);
+
+	// Unknown and closed ids are reported but do not stop the batch.
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volumes_close_volume(session, &ids[0])
+	));
+	QarAppVolumeId mixed[4] = { ids[2], ids[0], ids[1], { { 0 } } };
+	memset(mixed[3].data, 0x5a, sizeof(mixed[3].data));
+	QarAppVolumeLatestState mixed_states[4];
+	memset(mixed_states, 0xcd, sizeof(mixed_states));
+	TEST_CHECK_CODE(
+		qar_app_volumes_get_latest_states(session, mixed, 4, mixed_states),
+		QAR_STATUS_APP_VOLUME_INVALID_ID
+	);
+	check_matches_getters(session, &ids[2], &mixed_states[0]);
+	check_invalid(&mixed_states[1]);
+	check_matches_getters(session, &ids[1], &mixed_states[2]);
+	check_invalid(&mixed_states[3]);
+
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volumes_close_volume(session, &ids[1])
+	));
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volumes_close_volume(session, &ids[2])
+	));
+}
+
+static void
+test_arguments(QarSession* session)
+{
+	TEST_CHECK(qar_result_is_success(
+		qar_app_volumes_get_latest_states(session, NULL, 0, NULL)
+	));
+	QarAppVolumeLatestState state;
+	TEST_CHECK_CODE(
+		qar_app_volumes_get_latest_states(session, NULL, 1, &state),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+	QarAppVolumeId id = { { 0 } };
+	TEST_CHECK_CODE(
+		qar_app_volumes_get_latest_states(NULL, &id, 1, &state),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+}
+
+int
+main(void)
+{
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	test_batch_matches_getters(session);
+	test_arguments(session);
+	test_close_session(runtime, session);
+	return 0;
+}
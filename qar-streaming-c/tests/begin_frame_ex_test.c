@@ -0,0 +1,248 @@
+/**
+ * @file begin_frame_ex_test.c
+ * @brief begin_frame_ex reports what the QarRenderFrameInfo getters report.
+ */
+#include "test_common.h"
+
+#include <math.h>
+#include <string.h>
+
+#define TEST_ROUNDS 4
+/* Consecutive frames are predicted a few milliseconds apart; the synthetic
+ * head turns far less than this in that time. */
+#define TEST_POSE_TOLERANCE 1e-3f
+
+static QarRenderSender*
+create_sender(QarSession* session)
+{
+	QarRenderSenderFoveationExt foveation =
+		qar_render_sender_foveation_ext_default();
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.header.next = &foveation.header;
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	QarRenderSender* sender = NULL;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_create(session, &init, NULL, &sender)
+	));
+	return sender;
+}
+
+static bool
+nearly_equal(float a, float b)
+{
+	return fabsf(a - b) <= TEST_POSE_TOLERANCE;
+}
+
+static bool
+poses_close(const QarPose* a, const QarPose* b)
+{
+	return nearly_equal(a->orientation.x, b->orientation.x)
+		&& nearly_equal(a->orientation.y, b->orientation.y)
+		&& nearly_equal(a->orientation.z, b->orientation.z)
+		&& nearly_equal(a->orientation.w, b->orientation.w)
+		&& nearly_equal(a->position.x, b->position.x)
+		&& nearly_equal(a->position.y, b->position.y)
+		&& nearly_equal(a->position.z, b->position.z);
+}
+
+static uint64_t
+time_ns(QarTimePoint time_point)
+{
+	return time_point.precision == 0 ? time_point.count * 1000000u
+									 : time_point.count;
+}
+
+static void
+show_frame(QarRenderSender* sender)
+{
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	QarResult result = qar_render_sender_show_frame(sender, &show);
+	TEST_CHECK(qar_result_is_success(result));
+}
+
+/* Reads everything the handle offers into a QarRenderFrameBegin. */
+static QarRenderFrameBegin
+read_handle(QarRenderFrameInfo* info)
+{
+	QarRenderFrameBegin frame = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_frame_info_get_frame_index(info, &frame.frame_index)
+	));
+	TEST_CHECK(
+		qar_result_is_success(qar_render_frame_info_get_predicted_display_time(
+			info, &frame.predicted_display_time
+		))
+	);
+	TEST_CHECK(
+		qar_result_is_success(qar_render_frame_info_get_pose_sample_time(
+			info, &frame.pose_sample_time
+		))
+	);
+	TEST_CHECK(
+		qar_result_is_success(qar_render_frame_info_get_prediction_horizon(
+			info, &frame.prediction_horizon
+		))
+	);
+	TEST_CHECK(
+		qar_result_is_success(qar_render_frame_info_get_resolution_scale(
+			info, &frame.resolution_scale
+		))
+	);
+	size_t count = 0;
+	while(count < QAR_MAX_FRAME_VIEWS
+		  && qar_result_is_success(qar_render_frame_info_get_view_pose(
+			  info, count, &frame.view_poses[count]
+		  )))
+	{
+		TEST_CHECK(qar_result_is_success(
+			qar_render_frame_info_get_view_fov(
+				info, count, &frame.view_fovs[count]
+			)
+		));
+		TEST_CHECK(
+			qar_result_is_success(qar_render_frame_info_get_view_active_rect(
+				info, count, &frame.view_active_rects[count]
+			))
+		);
+		++count;
+	}
+	frame.views_count = count;
+	QarFov fov;
+	TEST_CHECK_CODE(
+		qar_render_frame_info_get_view_fov(info, count, &fov),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+	return frame;
+}
+
+static void
+check_agree(
+	const QarRenderFrameBegin* handle, const QarRenderFrameBegin* ex
+)
+{
+	TEST_CHECK(handle->views_count == ex->views_count);
+	TEST_CHECK(handle->resolution_scale == ex->resolution_scale);
+	for(size_t index = 0; index < ex->views_count; ++index)
+	{
+		const QarPose* pose = &ex->view_poses[index];
+		TEST_CHECK(poses_close(&handle->view_poses[index], pose));
+		TEST_CHECK(
+			memcmp(
+				&handle->view_fovs[index],
+				&ex->view_fovs[index],
+				sizeof(QarFov)
+			)
+			== 0
+		);
+		TEST_CHECK(
+			memcmp(
+				&handle->view_active_rects[index],
+				&ex->view_active_rects[index],
+				sizeof(QarRenderFrameViewRect)
+			)
+			== 0
+		);
+	}
+	// Both frames were predicted the same distance ahead.
+	TEST_CHECK(
+		time_ns(handle->predicted_display_time)
+			- time_ns(handle->pose_sample_time)
+		== time_ns(ex->predicted_display_time) - time_ns(ex->pose_sample_time)
+	);
+	TEST_CHECK(
+		time_ns(handle->prediction_horizon) == time_ns(ex->prediction_horizon)
+	);
+}
+
+/* Alternates both ways of beginning a frame; they share the frame sequence
+ * and report the same views. */
+static void
+test_ex_matches_handle(QarRenderSender* sender)
+{
+	uint64_t expected_index = 0;
+	uint64_t last_sample_ns = 0;
+	for(int round = 0; round < TEST_ROUNDS; ++round)
+	{
+		QarRenderFrameInfo* info = NULL;
+		TEST_CHECK(qar_result_is_success(
+			qar_render_sender_begin_frame(sender, NULL, &info)
+		));
+		QarRenderFrameBegin handle = read_handle(info);
+		qar_render_frame_info_handle_destroy(info);
+		show_frame(sender);
+
+		QarRenderFrameBegin ex = qar_render_frame_begin_default();
+		TEST_CHECK(qar_result_is_success(
+			qar_render_sender_begin_frame_ex(sender, NULL, &ex)
+		));
+		show_frame(sender);
+
+		TEST_CHECK(ex.header.type == QAR_STRUCTURE_TYPE_RENDERING_BEGIN_FRAME);
+		TEST_CHECK(handle.frame_index == expected_index);
+		TEST_CHECK(ex.frame_index == expected_index + 1);
+		expected_index += 2;
+		TEST_CHECK(time_ns(handle.pose_sample_time) >= last_sample_ns);
+		TEST_CHECK(
+			time_ns(ex.pose_sample_time) >= time_ns(handle.pose_sample_time)
+		);
+		last_sample_ns = time_ns(ex.pose_sample_time);
+		TEST_CHECK(ex.views_count == 8);
+		check_agree(&handle, &ex);
+	}
+}
+
+/* A rejected or cancelled call leaves the caller's struct untouched. */
+static void
+test_ex_failures(QarRenderSender* sender)
+{
+	QarRenderFrameBegin frame = qar_render_frame_begin_default();
+	frame.header.type = QAR_STRUCTURE_TYPE_RENDERING_END_FRAME;
+	TEST_CHECK_CODE(
+		qar_render_sender_begin_frame_ex(sender, NULL, &frame),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+
+	// The single in-flight slot is taken, so the next begin has to wait.
+	QarRenderFrameBegin first = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(sender, NULL, &first)
+	));
+	QarCancelToken* token = NULL;
+	TEST_CHECK(
+		qar_result_is_success(qar_cancel_token_create_with_timeout(&token, 20))
+	);
+	QarRenderFrameBegin waiting = qar_render_frame_begin_default();
+	memset(&waiting.view_poses, 0x7f, sizeof(waiting.view_poses));
+	QarRenderFrameBegin before;
+	memcpy(&before, &waiting, sizeof(before));
+	TEST_CHECK_CODE(
+		qar_render_sender_begin_frame_ex(sender, token, &waiting),
+		QAR_STATUS_TIMEOUT
+	);
+	TEST_CHECK(memcmp(&waiting, &before, sizeof(waiting)) == 0);
+	qar_cancel_token_handle_destroy(token);
+	show_frame(sender);
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = 64;
+	config.eye_height = 64;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	QarRenderSender* sender = create_sender(session);
+	test_ex_matches_handle(sender);
+	test_ex_failures(sender);
+	qar_render_stream_handle_destroy(sender);
+	test_close_session(runtime, session);
+	return 0;
+}
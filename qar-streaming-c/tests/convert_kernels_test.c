@@ -0,0 +1,310 @@
+/**
+ * @file convert_kernels_test.c
+ * @brief The conversions of qar_streaming_convert.h write the same bytes as
+ * their scalar helpers for every width, whichever SIMD path is built.
+ */
+#include "test_common.h"
+
+#include <math.h>
+#include <qar_streaming_convert.h>
+#include <string.h>
+
+/// Widths from 1 to this cover the vector loops and every tail length.
+#define TEST_MAX_WIDTH 40
+#define TEST_HEIGHT 3
+/// The documented 0.544 LSB error of the sRGB fit, rounded up.
+#define TEST_SRGB8_MAX_ERROR 0.545
+/// Written around the converted region; must survive every conversion.
+#define TEST_GUARD 0xa5
+
+static uint32_t g_seed = 0x9e3779b9u;
+/// Destination of every conversion, sized for the widest texture.
+static uint8_t g_storage[(TEST_MAX_WIDTH + 6) * (TEST_HEIGHT + 1) * 4];
+
+static uint32_t
+random_u32(void)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return g_seed;
+}
+
+/* A texture whose rows are padded by 3 pixels and that has room for an odd
+ * offset of (3, 1), backed by `storage` and filled with TEST_GUARD. */
+static QarVideoTextureCpu
+guarded_texture(
+	QarPixelFormat format,
+	uint32_t width,
+	uint32_t height,
+	uint8_t* storage,
+	size_t storage_size
+)
+{
+	QarVideoTextureCpu texture;
+	memset(&texture, 0, sizeof(texture));
+	texture.size.format = format;
+	texture.size.width = width + 3;
+	texture.size.height = height + 1;
+	texture.size.array_layers = 1;
+	texture.pitch = (texture.size.width + 3) * qar_pixel_format_size(format);
+	texture.texture_data = storage;
+	texture.texture_data_size = (size_t)texture.pitch * texture.size.height;
+	TEST_CHECK(texture.texture_data_size <= storage_size);
+	memset(storage, TEST_GUARD, storage_size);
+	return texture;
+}
+
+/* A tightly packed source texture over `data`. */
+static QarVideoTextureCpu
+source_texture(
+	QarPixelFormat format, uint32_t width, uint32_t height, const void* data
+)
+{
+	QarVideoTextureCpu texture;
+	memset(&texture, 0, sizeof(texture));
+	texture.size.format = format;
+	texture.size.width = width;
+	texture.size.height = height;
+	texture.size.array_layers = 1;
+	texture.pitch = width * qar_pixel_format_size(format);
+	texture.texture_data = (uint8_t*)data;
+	texture.texture_data_size = (size_t)texture.pitch * height;
+	return texture;
+}
+
+/* Pixel (x, y) of the converted image, placed at offset (3, 1). */
+static const uint8_t*
+converted_pixel(const QarVideoTextureCpu* dst, uint32_t x, uint32_t y)
+{
+	size_t pixel_size = qar_pixel_format_size(dst->size.format);
+	return dst->texture_data + (size_t)(y + 1) * dst->pitch
+		 + (size_t)(x + 3) * pixel_size;
+}
+
+/* Every byte outside the converted `width` x `height` region still holds
+ * the guard. */
+static void
+check_guard(const QarVideoTextureCpu* dst, uint32_t width, uint32_t height)
+{
+	size_t pixel_size = qar_pixel_format_size(dst->size.format);
+	for(size_t offset = 0; offset < dst->texture_data_size; ++offset)
+	{
+		size_t y = offset / dst->pitch;
+		size_t x = offset % dst->pitch / pixel_size;
+		bool inside = y >= 1 && y < 1 + height && x >= 3 && x < 3 + width;
+		TEST_CHECK(inside || dst->texture_data[offset] == TEST_GUARD);
+	}
+}
+
+static double
+exact_srgb(double linear)
+{
+	linear = linear < 0.0 ? 0.0 : linear > 1.0 ? 1.0 : linear;
+	double encoded = linear <= 0.0031308
+		? 12.92 * linear
+		: 1.055 * pow(linear, 1.0 / 2.4) - 0.055;
+	return encoded * 255.0;
+}
+
+/* The scalar helpers against the exact curve, over every half float. */
+static void
+test_scalar_against_exact_curve(void)
+{
+	for(uint32_t half = 0; half <= 0xffffu; ++half)
+	{
+		float linear = qar_convert_half_to_float((uint16_t)half);
+		uint8_t encoded = qar_convert_linear_to_srgb8(linear);
+		if(isnan(linear))
+		{
+			TEST_CHECK(encoded == 0);
+			continue;
+		}
+		TEST_CHECK(
+			fabs((double)encoded - exact_srgb(linear)) <= TEST_SRGB8_MAX_ERROR
+		);
+	}
+	// Out-of-range inputs clamp.
+	TEST_CHECK(qar_convert_linear_to_srgb8(-1.0f) == 0);
+	TEST_CHECK(qar_convert_linear_to_srgb8(1.0f) == 255);
+	TEST_CHECK(qar_convert_linear_to_srgb8(INFINITY) == 255);
+	TEST_CHECK(qar_convert_linear_to_srgb8(NAN) == 0);
+}
+
+/* Converts `width` x TEST_HEIGHT pixels of `src` and compares every pixel
+ * with the scalar pixel helper. */
+static void
+check_rgba16f_to_srgb8(const uint16_t* src, uint32_t width, bool swap_rb)
+{
+	QarVideoTextureCpu source = source_texture(
+		QAR_PIXEL_FORMAT_R16G16B16A16, width, TEST_HEIGHT, src
+	);
+	QarPixelFormat format =
+		swap_rb ? QAR_PIXEL_FORMAT_B8G8R8A8 : QAR_PIXEL_FORMAT_R8G8B8A8;
+	QarVideoTextureCpu dst = guarded_texture(
+		format, width, TEST_HEIGHT, g_storage, sizeof(g_storage)
+	);
+	TEST_CHECK(qar_convert_rgba16f_to_srgb8(&source, &dst, 3, 1));
+	for(uint32_t y = 0; y < TEST_HEIGHT; ++y)
+	{
+		for(uint32_t x = 0; x < width; ++x)
+		{
+			const uint16_t* pixel = src + ((size_t)y * width + x) * 4;
+			uint8_t expected[4];
+			qar_convert_rgba16f_pixel_scalar(pixel, expected, swap_rb);
+			const uint8_t* converted = converted_pixel(&dst, x, y);
+			TEST_CHECK(memcmp(converted, expected, 4) == 0);
+		}
+	}
+	check_guard(&dst, width, TEST_HEIGHT);
+}
+
+/* Every half float goes through each channel of the kernel, at every width
+ * and both channel orders. */
+static void
+test_rgba16f_to_srgb8(void)
+{
+	static uint16_t src[TEST_MAX_WIDTH * TEST_HEIGHT * 4];
+	const size_t channels = sizeof(src) / sizeof(src[0]);
+	uint32_t next_half = 0;
+	while(next_half <= 0xffffu)
+	{
+		for(size_t channel = 0; channel < channels; ++channel)
+		{
+			src[channel] = (uint16_t)(next_half++ & 0xffffu);
+		}
+		for(uint32_t width = 1; width <= TEST_MAX_WIDTH; ++width)
+		{
+			check_rgba16f_to_srgb8(src, width, false);
+			check_rgba16f_to_srgb8(src, width, true);
+		}
+	}
+}
+
+static void
+test_swizzle_rgba8(void)
+{
+	static uint8_t src[TEST_MAX_WIDTH * TEST_HEIGHT * 4];
+	for(size_t byte = 0; byte < sizeof(src); ++byte)
+	{
+		src[byte] = (uint8_t)(random_u32() >> 24);
+	}
+	for(uint32_t width = 1; width <= TEST_MAX_WIDTH; ++width)
+	{
+		QarVideoTextureCpu source =
+			source_texture(QAR_PIXEL_FORMAT_R8G8B8A8, width, TEST_HEIGHT, src);
+		for(int swap = 0; swap < 2; ++swap)
+		{
+			QarPixelFormat format = swap ? QAR_PIXEL_FORMAT_B8G8R8A8
+										 : QAR_PIXEL_FORMAT_R8G8B8A8;
+			QarVideoTextureCpu dst = guarded_texture(
+				format, width, TEST_HEIGHT, g_storage, sizeof(g_storage)
+			);
+			TEST_CHECK(qar_convert_swizzle_rgba8(&source, &dst, 3, 1));
+			for(uint32_t y = 0; y < TEST_HEIGHT; ++y)
+			{
+				for(uint32_t x = 0; x < width; ++x)
+				{
+					const uint8_t* pixel = src + ((size_t)y * width + x) * 4;
+					const uint8_t* out = converted_pixel(&dst, x, y);
+					TEST_CHECK(out[0] == pixel[swap ? 2 : 0]);
+					TEST_CHECK(out[1] == pixel[1]);
+					TEST_CHECK(out[2] == pixel[swap ? 0 : 2]);
+					TEST_CHECK(out[3] == pixel[3]);
+				}
+			}
+			check_guard(&dst, width, TEST_HEIGHT);
+		}
+
+		// In place swaps R and B back and forth.
+		static uint8_t copy[sizeof(src)];
+		memcpy(copy, src, sizeof(src));
+		QarVideoTextureCpu in_place =
+			source_texture(QAR_PIXEL_FORMAT_R8G8B8A8, width, TEST_HEIGHT, copy);
+		QarVideoTextureCpu swapped = in_place;
+		swapped.size.format = QAR_PIXEL_FORMAT_B8G8R8A8;
+		TEST_CHECK(qar_convert_swizzle_rgba8(&in_place, &swapped, 0, 0));
+		TEST_CHECK(copy[0] == src[2] && copy[2] == src[0]);
+		TEST_CHECK(qar_convert_swizzle_rgba8(&swapped, &in_place, 0, 0));
+		TEST_CHECK(memcmp(copy, src, sizeof(src)) == 0);
+	}
+}
+
+static uint32_t
+float_bits(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+/* Depth values include both ends of the range. Vector and scalar code use
+ * the same operations, but a compiler may contract the scalar one into a
+ * fused multiply-add, so results may differ by one ulp. */
+static void
+test_depth_to_linear(void)
+{
+	static float src[TEST_MAX_WIDTH * TEST_HEIGHT];
+	for(size_t index = 0; index < sizeof(src) / sizeof(src[0]); ++index)
+	{
+		src[index] = (float)(random_u32() >> 8) / (float)(1u << 24);
+	}
+	src[0] = 0.0f;
+	src[1] = 1.0f;
+	const QarNearFar near_far = { 0.1f, 100.0f };
+	const float numerator = near_far.near_plane * near_far.far_plane;
+	const float range = near_far.far_plane - near_far.near_plane;
+	for(uint32_t width = 1; width <= TEST_MAX_WIDTH; ++width)
+	{
+		QarVideoTextureCpu source =
+			source_texture(QAR_PIXEL_FORMAT_D32_FLOAT, width, TEST_HEIGHT, src);
+		QarVideoTextureCpu dst = guarded_texture(
+			QAR_PIXEL_FORMAT_R32_FLOAT,
+			width,
+			TEST_HEIGHT,
+			g_storage,
+			sizeof(g_storage)
+		);
+		TEST_CHECK(qar_convert_depth_to_linear(&source, near_far, &dst, 3, 1));
+		for(uint32_t y = 0; y < TEST_HEIGHT; ++y)
+		{
+			for(uint32_t x = 0; x < width; ++x)
+			{
+				float depth = src[(size_t)y * width + x];
+				float expected =
+					numerator / (near_far.far_plane - depth * range);
+				float linear;
+				memcpy(&linear, converted_pixel(&dst, x, y), sizeof(linear));
+				uint32_t a = float_bits(linear);
+				uint32_t b = float_bits(expected);
+				TEST_CHECK((a > b ? a - b : b - a) <= 1);
+			}
+		}
+		check_guard(&dst, width, TEST_HEIGHT);
+	}
+}
+
+int
+main(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(QAR_CONVERT_AVX2)
+	if(!__builtin_cpu_supports("avx2")
+#if defined(QAR_CONVERT_F16C)
+	   || !__builtin_cpu_supports("f16c")
+#endif
+	)
+	{
+		return TEST_SKIPPED;
+	}
+#elif defined(QAR_CONVERT_SSE41)
+	if(!__builtin_cpu_supports("sse4.1"))
+	{
+		return TEST_SKIPPED;
+	}
+#endif
+#endif
+	test_scalar_against_exact_curve();
+	test_rgba16f_to_srgb8();
+	test_swizzle_rgba8();
+	test_depth_to_linear();
+	return 0;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file cpp_wrappers_test.cpp
+ * @brief The C++17 layer of qar_streaming.hpp against the loopback runtime.
+ *
+ * Built like an application: through qar-streaming-cpp-headers, with
+ * dynamic loading, against the loopback shared library passed as argv[1].
+ */
+#include <qar_streaming.hpp>
+
+#include "test_common.h"
+
+#include <cstring>
+#include <utility>
+
+QAR_IMPLEMENT_DYNAMIC_LOADING()
+
+namespace
+{
+
+/* The loopback's own entry points are not part of the loader. */
+struct Loopback
+{
+	qar_loopback_configure_fn_t configure = nullptr;
+	qar_loopback_add_peer_fn_t add_peer = nullptr;
+	qar_loopback_get_allocation_stats_fn_t get_allocation_stats = nullptr;
+};
+
+Loopback g_loopback;
+
+template<typename F>
+F
+load_loopback_symbol(const char* name)
+{
+	F function = reinterpret_cast<F>(
+		qar_load_symbol(g_qar_dynamic_library_handle, name)
+	);
+	TEST_CHECK(function != nullptr);
+	return function;
+}
+
+void
+load_loopback()
+{
+	g_loopback.configure = load_loopback_symbol<qar_loopback_configure_fn_t>(
+		"qar_loopback_configure"
+	);
+	g_loopback.add_peer = load_loopback_symbol<qar_loopback_add_peer_fn_t>(
+		"qar_loopback_add_peer"
+	);
+	g_loopback.get_allocation_stats =
+		load_loopback_symbol<qar_loopback_get_allocation_stats_fn_t>(
+			"qar_loopback_get_allocation_stats"
+		);
+}
+
+std::uint64_t
+bytes_in_use()
+{
+	QarLoopbackAllocationStats stats{};
+	g_loopback.get_allocation_stats(&stats);
+	return stats.bytes_in_use;
+}
+
+/* Peers stay registered with the session, so each test adds one and
+ * creates all its senders for it. */
+QarRenderSenderInit
+sender_init(QarSession* session)
+{
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar::Result(
+		g_loopback.add_peer(session, "receiver", &init.peer_id)
+	));
+	return init;
+}
+
+qar::Result
+create_sender(
+	QarSession* session, QarRenderSenderInit init, qar::RenderSender& out_sender
+)
+{
+	return qar_render_sender_create(session, &init, nullptr, out_sender.put());
+}
+
+void
+test_result()
+{
+	qar::Result success;
+	TEST_CHECK(success.ok() && success);
+	TEST_CHECK(success.code() == QAR_STATUS_SUCCESS);
+
+	QarResult c_result = { QAR_STATUS_ARGUMENT_NOT_SUPPORTED, 0 };
+	qar::Result failure = c_result;
+	TEST_CHECK(!failure.ok() && !failure);
+	TEST_CHECK(failure.has_code(QAR_STATUS_ARGUMENT_NOT_SUPPORTED));
+	TEST_CHECK(!failure.has_code(QAR_STATUS_TIMEOUT));
+	QarResult back = failure;
+	TEST_CHECK(back.code == c_result.code);
+	TEST_CHECK(failure.c().code == c_result.code);
+
+	// A failing call carries its message through the wrapper.
+	qar::Result rejected = qar_render_sender_get_stats(nullptr, nullptr);
+	TEST_CHECK(rejected.has_code(QAR_STATUS_ARGUMENT_NOT_SUPPORTED));
+	char message[128] = { 0 };
+	rejected.message(message, sizeof(message));
+	TEST_CHECK(std::strlen(message) > 0);
+}
+
+/* Senders are destroyed when their owner goes out of scope, is reset, is
+ * moved over, or its slot is reused through put(). */
+void
+test_unique_handle(QarSession* session)
+{
+	const QarRenderSenderInit init = sender_init(session);
+	const std::uint64_t baseline = bytes_in_use();
+	std::uint64_t one_sender = 0;
+	{
+		qar::RenderSender sender;
+		TEST_CHECK(!sender && sender.get() == nullptr);
+		TEST_CHECK(create_sender(session, init, sender).ok());
+		TEST_CHECK(sender && sender.get() != nullptr);
+		one_sender = bytes_in_use();
+		TEST_CHECK(one_sender > baseline);
+
+		// put() destroys the previous sender before the new one is created.
+		TEST_CHECK(create_sender(session, init, sender).ok());
+		TEST_CHECK(bytes_in_use() == one_sender);
+
+		qar::RenderSender moved(std::move(sender));
+		TEST_CHECK(!sender && moved);
+		TEST_CHECK(bytes_in_use() == one_sender);
+
+		qar::RenderSender other;
+		TEST_CHECK(create_sender(session, init, other).ok());
+		TEST_CHECK(bytes_in_use() > one_sender);
+		other = std::move(moved);
+		TEST_CHECK(!moved && other);
+		TEST_CHECK(bytes_in_use() == one_sender);
+	}
+	TEST_CHECK(bytes_in_use() == baseline);
+
+	// release() hands ownership back to C code.
+	qar::RenderSender sender;
+	TEST_CHECK(create_sender(session, init, sender).ok());
+	QarRenderSender* raw = sender.release();
+	TEST_CHECK(!sender && raw != nullptr);
+	sender.reset();
+	TEST_CHECK(bytes_in_use() == one_sender);
+	qar_render_stream_handle_destroy(raw);
+	TEST_CHECK(bytes_in_use() == baseline);
+
+	qar::CancelToken token;
+	TEST_CHECK(
+		qar::Result(qar_cancel_token_create_with_timeout(token.put(), 10)).ok()
+	);
+	token.reset();
+	TEST_CHECK(bytes_in_use() == baseline);
+}
+
+/* The span helpers cover exactly the valid entries of the C structs. */
+void
+test_frame_spans(QarSession* session)
+{
+	const QarRenderSenderInit init = sender_init(session);
+	qar::RenderSender sender;
+	TEST_CHECK(create_sender(session, init, sender).ok());
+
+	QarRenderFrameBegin frame;
+	TEST_CHECK(qar::begin_frame(sender.get(), frame).ok());
+	qar::span<const QarPose> poses = qar::view_poses(frame);
+	qar::span<const QarFov> fovs = qar::view_fovs(frame);
+	TEST_CHECK(poses.size() == frame.views_count && !poses.empty());
+	TEST_CHECK(poses.data() == frame.view_poses);
+	TEST_CHECK(fovs.size() == frame.views_count);
+	TEST_CHECK(fovs.data() == frame.view_fovs);
+	std::size_t visited = 0;
+	for(const QarFov& fov : fovs)
+	{
+		TEST_CHECK(&fov == &frame.view_fovs[visited++]);
+	}
+	TEST_CHECK(visited == frame.views_count);
+
+	QarVideoFrameCpu cpu = qar_video_frame_cpu_default();
+	TEST_CHECK(qar::frame_cpu(sender.get(), cpu).ok());
+	qar::span<QarVideoTextureCpu> textures = qar::textures(cpu);
+	qar::span<const QarVideoFrameView> views = qar::views(cpu);
+	TEST_CHECK(textures.size() == cpu.textures_count && !textures.empty());
+	TEST_CHECK(views.size() == cpu.texture_views_count);
+	TEST_CHECK(views.data() == cpu.texture_views);
+	qar::span<const QarVideoTextureCpu> const_textures = textures;
+	TEST_CHECK(const_textures.data() == textures.data());
+
+	// Rows skip the pitch padding and alias the texture memory.
+	qar::TextureView view = qar::texture(cpu, 0);
+	const std::size_t pixel_size = qar_pixel_format_size(view.format());
+	TEST_CHECK(view.width() == cpu.textures[0].size.width);
+	TEST_CHECK(view.bytes().size() == cpu.textures[0].texture_data_size);
+	for(std::uint32_t y = 0; y < view.height(); ++y)
+	{
+		qar::span<std::uint8_t> row = view.row(y);
+		TEST_CHECK(row.size() == view.width() * pixel_size);
+		TEST_CHECK(
+			row.data() == view.bytes().data() + std::size_t(y) * view.pitch()
+		);
+	}
+	if(pixel_size == sizeof(std::uint32_t))
+	{
+		qar::span<std::uint32_t> pixels = view.row_as<std::uint32_t>(1);
+		TEST_CHECK(pixels.size() == view.width());
+		pixels[2] = 0x11223344u;
+		std::uint32_t read = 0;
+		std::memcpy(&read, view.row(1).subspan(8, 4).data(), sizeof(read));
+		TEST_CHECK(read == 0x11223344u);
+	}
+
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	TEST_CHECK(qar::show_frame(sender.get(), show).ok());
+	QarRenderSenderStats stats;
+	TEST_CHECK(qar::get_stats(sender.get(), stats).ok());
+	TEST_CHECK(stats.frames_shown == 1);
+
+	// The handle overload owns the frame info it begins.
+	qar::RenderFrameInfo info;
+	TEST_CHECK(qar::begin_frame(sender.get(), info).ok());
+	TEST_CHECK(info);
+	TEST_CHECK(qar::show_frame(sender.get(), show).ok());
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+	TEST_CHECK(argc == 2);
+	TEST_CHECK(qar_library_load(argv[1]));
+	load_loopback();
+
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = 64;
+	config.eye_height = 64;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar::Result(g_loopback.configure(&config)).ok());
+
+	test_result();
+	qar::Runtime runtime;
+	qar::Session session(test_open_session(runtime.put()));
+	test_unique_handle(session.get());
+	test_frame_spans(session.get());
+	session.reset();
+	runtime.reset();
+	qar_library_destroy();
+	qar_library_unload();
+	return 0;
+}
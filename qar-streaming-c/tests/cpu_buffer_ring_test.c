@@ -0,0 +1,135 @@
+/**
+ * @file cpu_buffer_ring_test.c
+ * @brief Caller-owned CPU buffer rings: slots stay in use until shown.
+ */
+#include "test_common.h"
+
+#include <stdint.h>
+
+#define TEST_RING_SLOTS 3
+#define TEST_POOL_BYTES ((size_t)4 << 20)
+
+_Alignas(QAR_CPU_BUFFER_ALIGNMENT) static uint8_t g_pool[TEST_POOL_BYTES];
+
+static QarRenderSender*
+create_small_sender(QarSession* session)
+{
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	QarRenderSender* sender = NULL;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_create(session, &init, NULL, &sender)
+	));
+	TEST_CHECK(sender != NULL);
+	return sender;
+}
+
+/* Carve every slot texture out of g_pool, each on its own aligned start. */
+static void
+register_ring(QarRenderSender* sender)
+{
+	QarVideoFrameLayout layout = qar_video_frame_layout_default();
+	QarResult layout_result = qar_render_sender_layout(sender, &layout);
+	TEST_CHECK(qar_result_is_success(layout_result));
+
+	QarRenderSenderCpuBufferRing ring =
+		qar_render_sender_cpu_buffer_ring_default();
+	ring.slot_count = TEST_RING_SLOTS;
+	ring.textures_count = layout.textures_count;
+	size_t offset = 0;
+	for(size_t slot = 0; slot < TEST_RING_SLOTS; ++slot)
+	{
+		for(size_t index = 0; index < layout.textures_count; ++index)
+		{
+			const QarTextureSize* size = &layout.textures[index];
+			uint32_t pitch = size->width * qar_pixel_format_size(size->format);
+			size_t bytes = (size_t)pitch * size->height * size->array_layers;
+			TEST_CHECK(offset + bytes <= TEST_POOL_BYTES);
+
+			QarVideoTextureCpu* texture = &ring.slots[slot][index];
+			texture->size = *size;
+			texture->pitch = pitch;
+			texture->texture_data = g_pool + offset;
+			texture->texture_data_size = bytes;
+			offset += (bytes + QAR_CPU_BUFFER_ALIGNMENT - 1)
+				/ QAR_CPU_BUFFER_ALIGNMENT * QAR_CPU_BUFFER_ALIGNMENT;
+		}
+	}
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_register_cpu_buffers(sender, &ring)
+	));
+}
+
+static void
+show_slot(QarRenderSender* sender, uint32_t buffer_index)
+{
+	QarRenderFrameBegin begin = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(sender, NULL, &begin)
+	));
+	QarRenderFrameShowCpuBufferExt buffer =
+		qar_render_frame_show_cpu_buffer_ext_default();
+	buffer.buffer_index = buffer_index;
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	show.header.next = &buffer.header;
+	QarResult show_result = qar_render_sender_show_frame(sender, &show);
+	TEST_CHECK(qar_result_is_success(show_result));
+}
+
+/* Acquiring one slot more than the ring holds waits for a slot to be shown
+ * instead of handing out a buffer that is still being rendered into. */
+static void
+test_acquire_past_ring_waits(QarRenderSender* sender)
+{
+	QarVideoFrameCpu frame = qar_video_frame_cpu_default();
+	uint32_t indices[TEST_RING_SLOTS];
+	for(uint32_t slot = 0; slot < TEST_RING_SLOTS; ++slot)
+	{
+		TEST_CHECK(qar_result_is_success(qar_render_sender_acquire_cpu_buffer(
+			sender, NULL, &frame, &indices[slot]
+		)));
+		TEST_CHECK(indices[slot] == slot);
+	}
+
+	QarCancelToken* token = NULL;
+	TEST_CHECK(
+		qar_result_is_success(qar_cancel_token_create_with_timeout(&token, 50))
+	);
+	uint32_t extra = UINT32_MAX;
+	TEST_CHECK_CODE(
+		qar_render_sender_acquire_cpu_buffer(sender, token, &frame, &extra),
+		QAR_STATUS_TIMEOUT
+	);
+	TEST_CHECK(extra == UINT32_MAX);
+	qar_cancel_token_handle_destroy(token);
+
+	// Showing the oldest slot frees it for the next acquire.
+	show_slot(sender, indices[0]);
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_acquire_cpu_buffer(sender, NULL, &frame, &extra)
+	));
+	TEST_CHECK(extra == indices[0]);
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = 64;
+	config.eye_height = 64;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	QarRenderSender* sender = create_small_sender(session);
+	register_ring(sender);
+	test_acquire_past_ring_waits(sender);
+	qar_render_stream_handle_destroy(sender);
+	test_close_session(runtime, session);
+	return 0;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file depth_encoding_test.c
+ * @brief Quantized depth decodes back within the documented error bounds.
+ */
+#include "test_common.h"
+
+#include "loopback_internal.h"
+
+#include <math.h>
+
+#define TEST_NEAR 0.1f
+#define TEST_FAR 100.0f
+/* Odd, so no vector loop covers the row without a tail. */
+#define TEST_WIDTH 37
+#define TEST_ROWS 3
+/* Float slack on top of the bounds: the encoder works in single
+ * precision, and hardware depth loses bits close to 1. */
+#define TEST_SLACK 1e-4
+
+static const QarNearFar g_near_far = { TEST_NEAR, TEST_FAR };
+
+/* Distance of sample `index`, spread logarithmically over [near, far]. */
+static double
+sample_depth(size_t index)
+{
+	double t = (double)index / (TEST_WIDTH * TEST_ROWS - 1);
+	return TEST_NEAR * pow((double)TEST_FAR / TEST_NEAR, t);
+}
+
+/* Conventional (not reversed) projection depth of distance `z`. */
+static float
+hardware_depth(double z)
+{
+	return (float)(TEST_FAR * (z - TEST_NEAR) / (z * (TEST_FAR - TEST_NEAR)));
+}
+
+static double
+decode(QarDepthEncoding encoding, uint16_t sample)
+{
+	if(encoding == QAR_DEPTH_ENCODING_REVERSED_Z16)
+	{
+		return sample == 0 ? INFINITY : TEST_NEAR * 65535.0 / sample;
+	}
+	double steps = log((double)TEST_FAR / TEST_NEAR) / 4095.0;
+	return TEST_NEAR * exp((sample >> 4) * steps);
+}
+
+/* Largest error the encoding documents for distance `z`. */
+static double
+error_bound(QarDepthEncoding encoding, double z)
+{
+	if(encoding == QAR_DEPTH_ENCODING_REVERSED_Z16)
+	{
+		return z * z / (130000.0 * TEST_NEAR) + z * TEST_SLACK;
+	}
+	return z * (log((double)TEST_FAR / TEST_NEAR) / 8180.0 + TEST_SLACK);
+}
+
+/* Encodes a padded block of depth and decodes every sample. */
+static void
+test_round_trip(QarDepthEncoding encoding, bool hardware)
+{
+	float source[TEST_ROWS][TEST_WIDTH + 3];
+	uint16_t encoded[TEST_ROWS][TEST_WIDTH + 5];
+	memset(encoded, 0xab, sizeof(encoded));
+	for(size_t row = 0; row < TEST_ROWS; ++row)
+	{
+		for(size_t x = 0; x < TEST_WIDTH; ++x)
+		{
+			double z = sample_depth(row * TEST_WIDTH + x);
+			source[row][x] = hardware ? hardware_depth(z) : (float)z;
+		}
+	}
+	lb_encode_depth_rows(
+		(uint8_t*)encoded,
+		sizeof(encoded[0]),
+		(const uint8_t*)source,
+		sizeof(source[0]),
+		TEST_WIDTH,
+		TEST_ROWS,
+		hardware,
+		encoding,
+		g_near_far
+	);
+	for(size_t row = 0; row < TEST_ROWS; ++row)
+	{
+		for(size_t x = 0; x < TEST_WIDTH; ++x)
+		{
+			double z = sample_depth(row * TEST_WIDTH + x);
+			double error = fabs(decode(encoding, encoded[row][x]) - z);
+			TEST_CHECK(error <= error_bound(encoding, z));
+		}
+		// The padding past the row stays untouched.
+		TEST_CHECK(encoded[row][TEST_WIDTH] == 0xabab);
+	}
+}
+
+/* Cleared linear depth (infinity) and NaN land on the far end. */
+static void
+test_cleared_depth(void)
+{
+	float source[2] = { INFINITY, NAN };
+	uint16_t encoded[2];
+	lb_encode_depth_rows(
+		(uint8_t*)encoded,
+		sizeof(encoded),
+		(const uint8_t*)source,
+		sizeof(source),
+		2,
+		1,
+		false,
+		QAR_DEPTH_ENCODING_REVERSED_Z16,
+		g_near_far
+	);
+	TEST_CHECK(encoded[0] == 0 && encoded[1] == 0);
+	lb_encode_depth_rows(
+		(uint8_t*)encoded,
+		sizeof(encoded),
+		(const uint8_t*)source,
+		sizeof(source),
+		2,
+		1,
+		false,
+		QAR_DEPTH_ENCODING_LOG12,
+		g_near_far
+	);
+	TEST_CHECK(encoded[0] == 4095u << 4 && encoded[1] == 4095u << 4);
+}
+
+static QarRenderSender*
+create_sender(QarSession* session, QarDepthEncoding encoding)
+{
+	QarRenderSenderDepthEncodingExt depth =
+		qar_render_sender_depth_encoding_ext_default();
+	depth.depth_encoding = encoding;
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.header.next = &depth.header;
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	QarRenderSender* sender = NULL;
+	QarResult result = qar_render_sender_create(session, &init, NULL, &sender);
+	if(!qar_result_is_success(result))
+	{
+		TEST_CHECK(sender == NULL);
+		TEST_CHECK_CODE(result, QAR_STATUS_ARGUMENT_NOT_SUPPORTED);
+		return NULL;
+	}
+	return sender;
+}
+
+static uint64_t
+show_frame(QarRenderSender* sender, QarNearFar near_far, QarStatusCode code)
+{
+	QarRenderFrameBegin begin = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(sender, NULL, &begin)
+	));
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	show.rendered_near_far = near_far;
+	TEST_CHECK_CODE(qar_render_sender_show_frame(sender, &show), code);
+	QarRenderSenderStats stats = qar_render_sender_stats_default();
+	QarResult stats_result = qar_render_sender_get_stats(sender, &stats);
+	TEST_CHECK(qar_result_is_success(stats_result));
+	return stats.bytes_sent;
+}
+
+/* A quantizing sender sends two bytes per depth pixel instead of four and
+ * rejects frames whose near and far planes cannot rebuild depth. */
+static void
+test_sender_quantizes_depth(QarSession* session)
+{
+	QarRenderSender* full = create_sender(session, QAR_DEPTH_ENCODING_FLOAT32);
+	QarRenderSender* quantized =
+		create_sender(session, QAR_DEPTH_ENCODING_LOG12);
+	TEST_CHECK(full != NULL && quantized != NULL);
+
+	QarVideoFrameLayout layout = qar_video_frame_layout_default();
+	TEST_CHECK(
+		qar_result_is_success(qar_render_sender_layout(quantized, &layout))
+	);
+	uint64_t depth_pixels = 0;
+	for(size_t index = 0; index < layout.views_count; ++index)
+	{
+		const QarVideoFrameView* view = &layout.views[index];
+		if(view->data_type == QAR_VIDEO_FRAME_VIEW_TYPE_DEPTH)
+		{
+			uint64_t width = view->end_x > view->start_x
+				? view->end_x - view->start_x
+				: view->start_x - view->end_x;
+			uint64_t height = view->end_y > view->start_y
+				? view->end_y - view->start_y
+				: view->start_y - view->end_y;
+			depth_pixels += width * height;
+		}
+	}
+	TEST_CHECK(depth_pixels > 0);
+
+	uint64_t full_bytes = show_frame(full, g_near_far, QAR_STATUS_SUCCESS);
+	uint64_t quantized_bytes =
+		show_frame(quantized, g_near_far, QAR_STATUS_SUCCESS);
+	TEST_CHECK(full_bytes - quantized_bytes == depth_pixels * 2);
+
+	QarNearFar inverted = { TEST_FAR, TEST_NEAR };
+	show_frame(quantized, inverted, QAR_STATUS_ARGUMENT_NOT_SUPPORTED);
+	// Without quantization the planes are not needed.
+	show_frame(full, inverted, QAR_STATUS_SUCCESS);
+
+	qar_render_stream_handle_destroy(quantized);
+	qar_render_stream_handle_destroy(full);
+	TEST_CHECK(create_sender(session, (QarDepthEncoding)7) == NULL);
+}
+
+int
+main(void)
+{
+	test_round_trip(QAR_DEPTH_ENCODING_REVERSED_Z16, false);
+	test_round_trip(QAR_DEPTH_ENCODING_REVERSED_Z16, true);
+	test_round_trip(QAR_DEPTH_ENCODING_LOG12, false);
+	test_round_trip(QAR_DEPTH_ENCODING_LOG12, true);
+	test_cleared_depth();
+
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = 64;
+	config.eye_height = 64;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	test_sender_quantizes_depth(session);
+	test_close_session(runtime, session);
+	return 0;
+}
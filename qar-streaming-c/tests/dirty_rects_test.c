@@ -0,0 +1,240 @@
+/**
+ * @file dirty_rects_test.c
+ * @brief Dirty rectangles: only the listed regions are copied and sent.
+ */
+#include "test_common.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define TEST_EYE_SIZE 64
+#define TEST_PIXEL_SIZE 4
+#define TEST_POOL_BYTES ((size_t)1 << 20)
+
+_Alignas(QAR_CPU_BUFFER_ALIGNMENT) static uint8_t g_pool[TEST_POOL_BYTES];
+
+typedef struct TestSender
+{
+	QarRenderSender* sender;
+	QarVideoFrameLayout layout;
+	QarRenderSenderCpuBufferRing ring;
+	uint64_t bytes_sent;
+} TestSender;
+
+/* A sender rendering into a one-slot ring carved out of g_pool. */
+static void
+create_sender(QarSession* session, bool skip_tiles, TestSender* out_test)
+{
+	memset(out_test, 0, sizeof(*out_test));
+	QarRenderSenderTransparentTilesExt tiles =
+		qar_render_sender_transparent_tiles_ext_default();
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.header.next = skip_tiles ? &tiles.header : NULL;
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_create(session, &init, NULL, &out_test->sender)
+	));
+
+	out_test->layout = qar_video_frame_layout_default();
+	QarResult layout_result =
+		qar_render_sender_layout(out_test->sender, &out_test->layout);
+	TEST_CHECK(qar_result_is_success(layout_result));
+	QarRenderSenderCpuBufferRing* ring = &out_test->ring;
+	*ring = qar_render_sender_cpu_buffer_ring_default();
+	ring->slot_count = 1;
+	ring->textures_count = out_test->layout.textures_count;
+	size_t offset = 0;
+	for(size_t index = 0; index < ring->textures_count; ++index)
+	{
+		const QarTextureSize* size = &out_test->layout.textures[index];
+		uint32_t pitch = size->width * qar_pixel_format_size(size->format);
+		size_t bytes = (size_t)pitch * size->height * size->array_layers;
+		TEST_CHECK(offset + bytes <= TEST_POOL_BYTES);
+		QarVideoTextureCpu* texture = &ring->slots[0][index];
+		texture->size = *size;
+		texture->pitch = pitch;
+		texture->texture_data = g_pool + offset;
+		texture->texture_data_size = bytes;
+		offset += (bytes + QAR_CPU_BUFFER_ALIGNMENT - 1)
+			/ QAR_CPU_BUFFER_ALIGNMENT * QAR_CPU_BUFFER_ALIGNMENT;
+	}
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_register_cpu_buffers(out_test->sender, ring)
+	));
+	memset(g_pool, 0, sizeof(g_pool));
+}
+
+static size_t
+find_view(const TestSender* test, QarVideoFrameViewType type)
+{
+	for(size_t index = 0; index < test->layout.views_count; ++index)
+	{
+		if(test->layout.views[index].data_type == type)
+		{
+			return index;
+		}
+	}
+	TEST_CHECK(false);
+	return 0;
+}
+
+/* Alpha byte of pixel (x, y) of view `view_index` (B8G8R8A8). */
+static uint8_t*
+view_alpha(const TestSender* test, size_t view_index, uint32_t x, uint32_t y)
+{
+	const QarVideoFrameView* view = &test->layout.views[view_index];
+	const QarVideoTextureCpu* texture =
+		&test->ring.slots[0][view->texture_index];
+	uint32_t left = view->start_x < view->end_x ? view->start_x : view->end_x;
+	uint32_t top = view->start_y < view->end_y ? view->start_y : view->end_y;
+	size_t row = (size_t)view->array_layer_index * texture->size.height
+		+ top + y;
+	return texture->texture_data + row * texture->pitch
+		+ (size_t)(left + x) * TEST_PIXEL_SIZE + 3;
+}
+
+/* Shows the ring slot with `dirty` chained (may be NULL) and returns the
+ * bytes the frame cost. */
+static uint64_t
+send_frame(TestSender* test, const QarRenderFrameShowDirtyRectsExt* dirty)
+{
+	QarVideoFrameCpu frame = qar_video_frame_cpu_default();
+	uint32_t buffer_index = 0;
+	TEST_CHECK(qar_result_is_success(qar_render_sender_acquire_cpu_buffer(
+		test->sender, NULL, &frame, &buffer_index
+	)));
+	QarRenderFrameBegin begin = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(test->sender, NULL, &begin)
+	));
+	QarRenderFrameShowCpuBufferExt buffer =
+		qar_render_frame_show_cpu_buffer_ext_default();
+	buffer.buffer_index = buffer_index;
+	buffer.header.next = (void*)dirty;
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	show.header.next = &buffer.header;
+	QarResult show_result = qar_render_sender_show_frame(test->sender, &show);
+	TEST_CHECK(qar_result_is_success(show_result));
+
+	QarRenderSenderStats stats = qar_render_sender_stats_default();
+	QarResult stats_result = qar_render_sender_get_stats(test->sender, &stats);
+	TEST_CHECK(qar_result_is_success(stats_result));
+	uint64_t bytes = stats.bytes_sent - test->bytes_sent;
+	test->bytes_sent = stats.bytes_sent;
+	return bytes;
+}
+
+static uint64_t
+send_rect(
+	TestSender* test,
+	size_t view_index,
+	uint32_t x,
+	uint32_t y,
+	uint32_t width,
+	uint32_t height
+)
+{
+	QarRenderFrameShowDirtyRectsExt dirty =
+		qar_render_frame_show_dirty_rects_ext_default();
+	QarRenderFrameDirtyRect rect = { view_index, x, y, width, height };
+	dirty.rects[0] = rect;
+	dirty.rects_count = 1;
+	return send_frame(test, &dirty);
+}
+
+/* The first frame has nothing to patch and goes out in full; after that only
+ * the rectangles, clipped to their view, are copied. */
+static void
+test_rectangles_are_clipped(QarSession* session)
+{
+	TestSender test;
+	create_sender(session, false, &test);
+	size_t color = find_view(&test, QAR_VIDEO_FRAME_VIEW_TYPE_COLOR);
+	size_t depth = find_view(&test, QAR_VIDEO_FRAME_VIEW_TYPE_DEPTH);
+
+	QarRenderFrameShowDirtyRectsExt none =
+		qar_render_frame_show_dirty_rects_ext_default();
+	uint64_t full = send_frame(&test, &none);
+	TEST_CHECK(full >= (uint64_t)TEST_EYE_SIZE * TEST_EYE_SIZE * 4);
+	TEST_CHECK(send_frame(&test, &none) == 0);
+	TEST_CHECK(send_frame(&test, NULL) == full);
+
+	TEST_CHECK(send_rect(&test, color, 3, 5, 10, 7) == 10 * 7 * 4);
+	TEST_CHECK(send_rect(&test, depth, 3, 5, 10, 7) == 10 * 7 * 4);
+	// Hanging over the right and bottom edges.
+	TEST_CHECK(
+		send_rect(&test, color, TEST_EYE_SIZE - 4, TEST_EYE_SIZE - 3, 10, 10)
+		== 4 * 3 * 4
+	);
+	TEST_CHECK(send_rect(&test, color, TEST_EYE_SIZE, 0, 4, 4) == 0);
+	TEST_CHECK(send_rect(&test, color, 0, 0, 0, 0) == 0);
+	TEST_CHECK(send_rect(&test, QAR_MAX_FRAME_VIEWS, 0, 0, 4, 4) == 0);
+
+	// Overlapping rectangles are each copied.
+	QarRenderFrameShowDirtyRectsExt two =
+		qar_render_frame_show_dirty_rects_ext_default();
+	QarRenderFrameDirtyRect first = { color, 0, 0, 8, 8 };
+	QarRenderFrameDirtyRect second = { color, 4, 4, 8, 8 };
+	two.rects[0] = first;
+	two.rects[1] = second;
+	two.rects_count = 2;
+	TEST_CHECK(send_frame(&test, &two) == 2 * 8 * 8 * 4);
+	qar_render_stream_handle_destroy(test.sender);
+}
+
+/* With tile skipping, the bytes show which pixels a rectangle covered: only
+ * a rectangle that contains the single opaque pixel sends anything, and
+ * then only its own part of that pixel's tile. */
+static void
+test_rectangle_position(QarSession* session)
+{
+	TestSender test;
+	create_sender(session, true, &test);
+	size_t color = find_view(&test, QAR_VIDEO_FRAME_VIEW_TYPE_COLOR);
+	TEST_CHECK(test.layout.views[color].texture_format
+			   == QAR_PIXEL_FORMAT_B8G8R8A8);
+	*view_alpha(&test, color, 40, 10) = 0xff;
+	send_frame(&test, NULL);
+
+	QarRenderFrameDirtyRect misses[] = {
+		{ color, 0, 0, 32, 32 },  // the tile to the left
+		{ color, 32, 0, 32, 10 }, // rows above the pixel
+		{ color, 41, 0, 23, 32 }, // columns right of the pixel
+	};
+	for(size_t index = 0; index < sizeof(misses) / sizeof(misses[0]);
+		++index)
+	{
+		const QarRenderFrameDirtyRect* rect = &misses[index];
+		TEST_CHECK(
+			send_rect(
+				&test, color, rect->x, rect->y, rect->width, rect->height
+			)
+			== 0
+		);
+	}
+	TEST_CHECK(send_rect(&test, color, 36, 8, 8, 8) == 8 * 8 * 4);
+	// Clipped to the tile it shares with the pixel.
+	TEST_CHECK(send_rect(&test, color, 24, 8, 17, 4) == 9 * 4 * 4);
+	qar_render_stream_handle_destroy(test.sender);
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = TEST_EYE_SIZE;
+	config.eye_height = TEST_EYE_SIZE;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	test_rectangles_are_clipped(session);
+	test_rectangle_position(session);
+	test_close_session(runtime, session);
+	return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file dynamic_loading_test.c
+ * @brief Loader: optional entry points missing from older runtimes.
+ *
+ * Built once per loader flavour (per-module tables, dispatch table, lazy
+ * loading) and run against the loopback shared library passed as argv[1].
+ */
+#include "test_common.h"
+
+QAR_IMPLEMENT_DYNAMIC_LOADING()
+
+#ifdef QAR_ENABLE_DISPATCH_TABLE
+#define TEST_SENDER_API g_qar_dispatch_table
+#else
+#define TEST_SENDER_API g_qar_render_stream_sender_api
+#endif
+
+/* A runtime without an optional symbol still loads; a missing required
+ * symbol fails the module. */
+static void
+test_missing_optional_symbol_is_left_null(void)
+{
+	static const char* const names[] = { "qar_impl_result_error",
+										 "qar_impl_not_exported" };
+	static const bool optional[] = { true, false };
+	static const bool required[] = { true, true };
+	qar_generic_func_t functions[2] = { NULL, NULL };
+
+	TEST_CHECK(qar_load_module_symbols(
+		g_qar_dynamic_library_handle, "test", names, optional, 2, functions
+	));
+	TEST_CHECK(functions[0] != NULL);
+	TEST_CHECK(functions[1] == NULL);
+
+	fprintf(stderr, "Expected failure to load 'qar_impl_not_exported':\n");
+	TEST_CHECK(!qar_load_module_symbols(
+		g_qar_dynamic_library_handle, "test", names, required, 2, functions
+	));
+}
+
+/* The wrapper of an optional entry the runtime does not provide returns
+ * QAR_STATUS_NOT_IMPLEMENTED instead of aborting. */
+static void
+test_missing_optional_entry_is_not_implemented(void)
+{
+	QarVideoFrameCpu frame = qar_video_frame_cpu_default();
+	uint32_t index = 0;
+	// Resolves the sender module when it is loaded lazily.
+	TEST_CHECK_CODE(
+		qar_render_sender_acquire_cpu_buffer(NULL, NULL, &frame, &index),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+
+	qar_render_sender_acquire_cpu_buffer_func_t loaded =
+		TEST_SENDER_API.render_sender_acquire_cpu_buffer;
+	TEST_SENDER_API.render_sender_acquire_cpu_buffer = NULL;
+	TEST_CHECK_CODE(
+		qar_render_sender_acquire_cpu_buffer(NULL, NULL, &frame, &index),
+		QAR_STATUS_NOT_IMPLEMENTED
+	);
+	TEST_SENDER_API.render_sender_acquire_cpu_buffer = loaded;
+}
+
+int
+main(int argc, char** argv)
+{
+	TEST_CHECK(argc == 2);
+	TEST_CHECK(qar_library_load(argv[1]));
+	test_missing_optional_symbol_is_left_null();
+	test_missing_optional_entry_is_not_implemented();
+	qar_library_unload();
+	return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file dynamic_resolution_test.c
+ * @brief Dynamic resolution: active areas stay within the scale bounds.
+ */
+#include "test_common.h"
+
+#define TEST_MIN_SCALE 0.7f
+#define TEST_FRAMES 200
+
+static QarRenderSender*
+create_sender(QarSession* session, QarStructureHeader* next)
+{
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.header.next = next;
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	QarRenderSender* sender = NULL;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_create(session, &init, NULL, &sender)
+	));
+	TEST_CHECK(sender != NULL);
+	return sender;
+}
+
+static uint32_t
+view_extent(uint32_t start, uint32_t end)
+{
+	return start < end ? end - start : start - end;
+}
+
+/* Shows one frame and checks that its active rectangles follow the scale
+ * the runtime reported for it. Returns that scale. */
+static float
+show_checked_frame(QarRenderSender* sender, const QarVideoFrameLayout* layout)
+{
+	QarRenderFrameBegin begin = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(sender, NULL, &begin)
+	));
+	TEST_CHECK(begin.views_count == layout->views_count);
+	float scale = begin.resolution_scale;
+	for(size_t index = 0; index < begin.views_count; ++index)
+	{
+		const QarVideoFrameView* view = &layout->views[index];
+		uint32_t width = view_extent(view->start_x, view->end_x);
+		uint32_t height = view_extent(view->start_y, view->end_y);
+		const QarRenderFrameViewRect* rect = &begin.view_active_rects[index];
+		TEST_CHECK(rect->x == 0 && rect->y == 0);
+		if(scale < 1.0f)
+		{
+			TEST_CHECK(rect->width == ((uint32_t)((float)width * scale) & ~1u));
+			TEST_CHECK(
+				rect->height == ((uint32_t)((float)height * scale) & ~1u)
+			);
+		}
+		else
+		{
+			TEST_CHECK(rect->width == width && rect->height == height);
+		}
+	}
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	QarResult show_result = qar_render_sender_show_frame(sender, &show);
+	TEST_CHECK(qar_result_is_success(show_result));
+	return scale;
+}
+
+/* The loopback display period is 1 ns, so every encode is over budget and
+ * the scale shrinks until it reaches the floor, then stays there. */
+static void
+test_scale_stops_at_minimum(QarSession* session)
+{
+	QarRenderSenderDynamicResolutionExt dynamic =
+		qar_render_sender_dynamic_resolution_ext_default();
+	dynamic.min_resolution_scale = TEST_MIN_SCALE;
+	QarRenderSender* sender = create_sender(session, &dynamic.header);
+	QarVideoFrameLayout layout = qar_video_frame_layout_default();
+	TEST_CHECK(
+		qar_result_is_success(qar_render_sender_layout(sender, &layout))
+	);
+
+	float previous = 1.0f;
+	float scale = 1.0f;
+	for(int frame = 0; frame < TEST_FRAMES; ++frame)
+	{
+		scale = show_checked_frame(sender, &layout);
+		TEST_CHECK(scale >= TEST_MIN_SCALE && scale <= 1.0f);
+		TEST_CHECK(scale <= previous);
+		previous = scale;
+	}
+	TEST_CHECK(scale == TEST_MIN_SCALE);
+
+	QarRenderSenderStats stats = qar_render_sender_stats_default();
+	QarResult stats_result = qar_render_sender_get_stats(sender, &stats);
+	TEST_CHECK(qar_result_is_success(stats_result));
+	TEST_CHECK(stats.resolution_scale == TEST_MIN_SCALE);
+	qar_render_stream_handle_destroy(sender);
+}
+
+/* Without the extension the whole view is rendered, whatever the load. */
+static void
+test_disabled_keeps_full_views(QarSession* session)
+{
+	QarRenderSender* sender = create_sender(session, NULL);
+	QarVideoFrameLayout layout = qar_video_frame_layout_default();
+	TEST_CHECK(
+		qar_result_is_success(qar_render_sender_layout(sender, &layout))
+	);
+	for(int frame = 0; frame < TEST_FRAMES; ++frame)
+	{
+		TEST_CHECK(show_checked_frame(sender, &layout) == 1.0f);
+	}
+	qar_render_stream_handle_destroy(sender);
+}
+
+static void
+test_rejects_out_of_range_minimum(QarSession* session)
+{
+	const float invalid[] = { 0.0f, -0.5f, 1.5f };
+	for(size_t index = 0; index < sizeof(invalid) / sizeof(invalid[0]);
+		++index)
+	{
+		QarRenderSenderDynamicResolutionExt dynamic =
+			qar_render_sender_dynamic_resolution_ext_default();
+		dynamic.min_resolution_scale = invalid[index];
+		QarRenderSenderInit init = qar_render_sender_init_default();
+		init.header.next = &dynamic.header;
+		init.graphics_api = QAR_GRAPHICS_API_CPU;
+		TEST_CHECK(qar_result_is_success(
+			qar_loopback_add_peer(session, "receiver", &init.peer_id)
+		));
+		QarRenderSender* sender = NULL;
+		TEST_CHECK_CODE(
+			qar_render_sender_create(session, &init, NULL, &sender),
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+		);
+		TEST_CHECK(sender == NULL);
+	}
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.display_hz = 1000000000u;
+	config.eye_width = 64;
+	config.eye_height = 64;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	test_scale_stops_at_minimum(session);
+	test_disabled_keeps_full_views(session);
+	test_rejects_out_of_range_minimum(session);
+	test_close_session(runtime, session);
+	return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file event_queue_test.c
+ * @brief Polled event queues: default capacity, overflow and reconfiguration.
+ */
+#include "test_common.h"
+
+static QarPeerEvent g_events[QAR_DEFAULT_EVENT_QUEUE_CAPACITY + 1];
+
+static void
+post_peer_events(QarSession* session, size_t count)
+{
+	for(size_t index = 0; index < count; ++index)
+	{
+		TEST_CHECK(qar_result_is_success(
+			qar_peer_update_display_name(session, index % 2 ? "odd" : "even")
+		));
+	}
+}
+
+static QarResult
+poll_peer_events(QarSession* session, size_t* out_count)
+{
+	return qar_peer_poll_events(
+		session,
+		g_events,
+		sizeof(g_events) / sizeof(g_events[0]),
+		out_count
+	);
+}
+
+/* Capacity 0 selects QAR_DEFAULT_EVENT_QUEUE_CAPACITY: exactly that many
+ * events fit, one more overflows. */
+static void
+test_zero_capacity_uses_default(QarSession* session)
+{
+	QarEventQueueInit init = qar_event_queue_init_default();
+	init.sources = QAR_EVENT_QUEUE_SOURCE_PEERS;
+	init.capacity = 0;
+	TEST_CHECK(
+		qar_result_is_success(qar_session_enable_event_queues(session, &init))
+	);
+
+	size_t count = 0;
+	post_peer_events(session, QAR_DEFAULT_EVENT_QUEUE_CAPACITY);
+	TEST_CHECK(qar_result_is_success(poll_peer_events(session, &count)));
+	TEST_CHECK(count == QAR_DEFAULT_EVENT_QUEUE_CAPACITY);
+
+	post_peer_events(session, QAR_DEFAULT_EVENT_QUEUE_CAPACITY + 1);
+	TEST_CHECK_CODE(
+		poll_peer_events(session, &count), QAR_STATUS_EVENT_QUEUE_OVERFLOW
+	);
+	TEST_CHECK(count == QAR_DEFAULT_EVENT_QUEUE_CAPACITY);
+
+	// The overflow is reported once.
+	TEST_CHECK(qar_result_is_success(poll_peer_events(session, &count)));
+	TEST_CHECK(count == 0);
+}
+
+static void
+test_reconfigure_drops_queued_events(QarSession* session)
+{
+	QarEventQueueInit init = qar_event_queue_init_default();
+	init.sources = QAR_EVENT_QUEUE_SOURCE_PEERS;
+	init.capacity = 4;
+	post_peer_events(session, 2);
+	TEST_CHECK(
+		qar_result_is_success(qar_session_enable_event_queues(session, &init))
+	);
+
+	size_t count = 1;
+	TEST_CHECK(qar_result_is_success(poll_peer_events(session, &count)));
+	TEST_CHECK(count == 0);
+
+	init.sources = 0;
+	TEST_CHECK(
+		qar_result_is_success(qar_session_enable_event_queues(session, &init))
+	);
+	TEST_CHECK_CODE(poll_peer_events(session, &count), QAR_STATUS_LOGIC_ERROR);
+}
+
+static void
+test_oversized_capacity_is_rejected(QarSession* session)
+{
+	QarEventQueueInit init = qar_event_queue_init_default();
+	init.sources = QAR_EVENT_QUEUE_SOURCE_PEERS;
+	init.capacity = SIZE_MAX;
+	TEST_CHECK_CODE(
+		qar_session_enable_event_queues(session, &init),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+}
+
+int
+main(void)
+{
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	test_zero_capacity_uses_default(session);
+	test_reconfigure_drops_queued_events(session);
+	test_oversized_capacity_is_rejected(session);
+	test_close_session(runtime, session);
+	return 0;
+}
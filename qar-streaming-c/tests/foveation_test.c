@@ -0,0 +1,216 @@
+/**
+ * @file foveation_test.c
+ * @brief Foveated layouts: every view splits into a fovea and a periphery.
+ */
+#include "test_common.h"
+
+#include <math.h>
+
+#define TEST_EYE_SIZE 64
+
+static QarResult
+create_sender(
+	QarSession* session,
+	QarFrameLayout texture_layout,
+	QarRenderSenderFoveationExt* foveation,
+	QarRenderSender** out_sender
+)
+{
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.header.next = foveation != NULL ? &foveation->header : NULL;
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	init.texture_layout = texture_layout;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	*out_sender = NULL;
+	return qar_render_sender_create(session, &init, NULL, out_sender);
+}
+
+static uint32_t
+extent(uint32_t start, uint32_t end)
+{
+	return start < end ? end - start : start - end;
+}
+
+static bool
+views_overlap(const QarVideoFrameView* a, const QarVideoFrameView* b)
+{
+	return a->texture_index == b->texture_index
+		&& a->array_layer_index == b->array_layer_index
+		&& a->start_x < b->end_x && b->start_x < a->end_x
+		&& a->start_y < b->end_y && b->start_y < a->end_y;
+}
+
+/* Checks the views of a foveated layout, pair by pair, and their FOVs in a
+ * begun frame. */
+static void
+check_layout(
+	QarRenderSender* sender,
+	float fovea_fraction,
+	uint32_t fovea_size,
+	uint32_t periphery_size
+)
+{
+	QarVideoFrameLayout layout = qar_video_frame_layout_default();
+	TEST_CHECK(
+		qar_result_is_success(qar_render_sender_layout(sender, &layout))
+	);
+	// The four default views (color and depth per eye) each split in two.
+	TEST_CHECK(layout.views_count == 8);
+	for(size_t index = 0; index < layout.views_count; ++index)
+	{
+		const QarVideoFrameView* view = &layout.views[index];
+		const QarTextureSize* texture = &layout.textures[view->texture_index];
+		TEST_CHECK(view->texture_index < layout.textures_count);
+		TEST_CHECK(view->end_x <= texture->width);
+		TEST_CHECK(view->end_y <= texture->height);
+		TEST_CHECK(view->array_layer_index < texture->array_layers);
+		for(size_t other = 0; other < index; ++other)
+		{
+			TEST_CHECK(!views_overlap(view, &layout.views[other]));
+		}
+	}
+	for(size_t index = 0; index < layout.views_count; index += 2)
+	{
+		const QarVideoFrameView* fovea = &layout.views[index];
+		const QarVideoFrameView* periphery = &layout.views[index + 1];
+		TEST_CHECK(fovea->region == QAR_VIDEO_FRAME_VIEW_REGION_FOVEA);
+		TEST_CHECK(periphery->region == QAR_VIDEO_FRAME_VIEW_REGION_PERIPHERY);
+		TEST_CHECK(fovea->eye == periphery->eye);
+		TEST_CHECK(fovea->data_type == periphery->data_type);
+		TEST_CHECK(fovea->texture_index == periphery->texture_index);
+		TEST_CHECK(extent(fovea->start_x, fovea->end_x) == fovea_size);
+		TEST_CHECK(extent(fovea->start_y, fovea->end_y) == fovea_size);
+		TEST_CHECK(extent(periphery->start_x, periphery->end_x)
+				   == periphery_size);
+		TEST_CHECK(extent(periphery->start_y, periphery->end_y)
+				   == periphery_size);
+	}
+
+	// Fovea views see `fovea_fraction` of the image plane; peripheries see
+	// the whole FOV.
+	QarRenderFrameBegin begin = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(sender, NULL, &begin)
+	));
+	TEST_CHECK(begin.views_count == layout.views_count);
+	for(size_t index = 0; index < begin.views_count; index += 2)
+	{
+		const QarFov* fovea = &begin.view_fovs[index];
+		const QarFov* full = &begin.view_fovs[index + 1];
+		float ratio = tanf(fovea->angle_right) / tanf(full->angle_right);
+		TEST_CHECK(fabsf(ratio - fovea_fraction) < 1e-4f);
+		TEST_CHECK(fabsf(fovea->angle_left + fovea->angle_right) < 1e-6f);
+		TEST_CHECK(fabsf(fovea->angle_up + fovea->angle_down) < 1e-6f);
+	}
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	QarResult show_result = qar_render_sender_show_frame(sender, &show);
+	TEST_CHECK(qar_result_is_success(show_result));
+}
+
+static void
+test_default_foveation_halves_pixels(QarSession* session)
+{
+	QarRenderSenderFoveationExt foveation =
+		qar_render_sender_foveation_ext_default();
+	QarRenderSender* sender = NULL;
+	TEST_CHECK(qar_result_is_success(create_sender(
+		session, QAR_FRAME_LAYOUT_SIDE_BY_SIDE, &foveation, &sender
+	)));
+	// Fovea and periphery of an eye together cost half its full pixels.
+	uint32_t half = TEST_EYE_SIZE / 2;
+	TEST_CHECK(2 * half * half == TEST_EYE_SIZE * TEST_EYE_SIZE / 2);
+	check_layout(sender, foveation.fovea_fraction, half, half);
+	qar_render_stream_handle_destroy(sender);
+}
+
+/* Sizes round down: the fovea to even pixel counts, the periphery by the
+ * downscale factor. Layered textures stack the views instead. */
+static void
+test_custom_foveation(QarSession* session)
+{
+	QarRenderSenderFoveationExt foveation =
+		qar_render_sender_foveation_ext_default();
+	foveation.fovea_fraction = 0.3f;
+	foveation.periphery_downscale = 3;
+	QarFrameLayout layouts[] = { QAR_FRAME_LAYOUT_SIDE_BY_SIDE,
+								 QAR_FRAME_LAYOUT_SEPARATED_TEXTURES,
+								 QAR_FRAME_LAYOUT_LAYERED };
+	for(size_t index = 0; index < sizeof(layouts) / sizeof(layouts[0]);
+		++index)
+	{
+		QarRenderSender* sender = NULL;
+		TEST_CHECK(qar_result_is_success(
+			create_sender(session, layouts[index], &foveation, &sender)
+		));
+		check_layout(sender, 0.3f, 18, TEST_EYE_SIZE / 3);
+		qar_render_stream_handle_destroy(sender);
+	}
+}
+
+static void
+test_without_extension(QarSession* session)
+{
+	QarRenderSender* sender = NULL;
+	TEST_CHECK(qar_result_is_success(
+		create_sender(session, QAR_FRAME_LAYOUT_SIDE_BY_SIDE, NULL, &sender)
+	));
+	QarVideoFrameLayout layout = qar_video_frame_layout_default();
+	TEST_CHECK(
+		qar_result_is_success(qar_render_sender_layout(sender, &layout))
+	);
+	TEST_CHECK(layout.views_count == 4);
+	for(size_t index = 0; index < layout.views_count; ++index)
+	{
+		const QarVideoFrameView* view = &layout.views[index];
+		TEST_CHECK(view->region == QAR_VIDEO_FRAME_VIEW_REGION_FULL);
+		TEST_CHECK(extent(view->start_x, view->end_x) == TEST_EYE_SIZE);
+	}
+	qar_render_stream_handle_destroy(sender);
+}
+
+static void
+test_rejects_invalid_parameters(QarSession* session)
+{
+	const QarRenderSenderFoveationExt defaults =
+		qar_render_sender_foveation_ext_default();
+	QarRenderSenderFoveationExt invalid[4] = {
+		defaults, defaults, defaults, defaults
+	};
+	invalid[0].fovea_fraction = 0.0f;
+	invalid[1].fovea_fraction = 1.0f;
+	invalid[2].fovea_fraction = NAN;
+	invalid[3].periphery_downscale = 1;
+	for(size_t index = 0; index < 4; ++index)
+	{
+		QarRenderSender* sender = NULL;
+		TEST_CHECK_CODE(
+			create_sender(
+				session, QAR_FRAME_LAYOUT_SIDE_BY_SIDE, &invalid[index], &sender
+			),
+			QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+		);
+		TEST_CHECK(sender == NULL);
+	}
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = TEST_EYE_SIZE;
+	config.eye_height = TEST_EYE_SIZE;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	test_default_foveation_halves_pixels(session);
+	test_custom_foveation(session);
+	test_without_extension(session);
+	test_rejects_invalid_parameters(session);
+	test_close_session(runtime, session);
+	return 0;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file hands_history_test.c
+ * @brief Reading the hand history in pieces neither skips nor repeats.
+ */
+#include "test_common.h"
+
+/// The loopback tracker runs at 90 Hz.
+#define TEST_TRACKING_PERIOD_NS (1000000000u / 90u)
+/// Samples to follow as they arrive, about a quarter of a second.
+#define TEST_LIVE_SAMPLES 24
+
+static QarDeviceHandsWithJoints g_samples[QAR_HAND_HISTORY_CAPACITY];
+
+static QarRenderSender*
+create_sender(QarSession* session)
+{
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	QarRenderSender* sender = NULL;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_create(session, &init, NULL, &sender)
+	));
+	return sender;
+}
+
+static uint64_t
+time_ns(QarTimePoint time_point)
+{
+	return time_point.precision == 0 ? time_point.count * 1000000u
+									 : time_point.count;
+}
+
+static size_t
+hands_since(
+	QarRenderSender* sender,
+	uint64_t since_ns,
+	QarDeviceHandsWithJoints* out_samples,
+	size_t capacity
+)
+{
+	QarTimePoint since = { since_ns, 1 };
+	size_t count = 0;
+	QarResult result = qar_render_sender_hands_since(
+		sender, since, out_samples, capacity, &count
+	);
+	TEST_CHECK(qar_result_is_success(result));
+	TEST_CHECK(count <= capacity);
+	return count;
+}
+
+/* Each sample follows the previous one by exactly one tracking period.
+ * Returns the time of the last sample. */
+static uint64_t
+check_continuous(
+	const QarDeviceHandsWithJoints* samples, size_t count, uint64_t last_ns
+)
+{
+	for(size_t index = 0; index < count; ++index)
+	{
+		uint64_t sample_ns = time_ns(samples[index].device_timestamp);
+		TEST_CHECK(sample_ns % TEST_TRACKING_PERIOD_NS == 0);
+		TEST_CHECK(
+			last_ns == 0 || sample_ns == last_ns + TEST_TRACKING_PERIOD_NS
+		);
+		TEST_CHECK(samples[index].left_hand.is_tracked);
+		TEST_CHECK(samples[index].right_hand.is_tracked);
+		last_ns = sample_ns;
+	}
+	return last_ns;
+}
+
+static void
+test_whole_history(QarRenderSender* sender)
+{
+	// The history starts out full.
+	size_t count = hands_since(sender, 0, g_samples, QAR_HAND_HISTORY_CAPACITY);
+	TEST_CHECK(count == QAR_HAND_HISTORY_CAPACITY);
+	uint64_t newest_ns = check_continuous(g_samples, count, 0);
+
+	// Hands reported by last_hands are the newest sample of the history.
+	QarDeviceHandsWithJoints last;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_last_hands(sender, &last)
+	));
+	TEST_CHECK(time_ns(last.device_timestamp) >= newest_ns);
+
+	// Frames are timed on the same clock: a frame begun now samples its
+	// pose no earlier than the newest tracker sample.
+	QarRenderFrameBegin begin = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(sender, NULL, &begin)
+	));
+	uint64_t pose_ns = time_ns(begin.pose_sample_time);
+	TEST_CHECK(pose_ns >= time_ns(last.device_timestamp));
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	QarResult result = qar_render_sender_show_frame(sender, &show);
+	TEST_CHECK(qar_result_is_success(result));
+}
+
+/* A small buffer gets the oldest pending samples; continuing from the last
+ * one copied picks up exactly where the previous call stopped. */
+static void
+test_chunked_reads(QarRenderSender* sender)
+{
+	QarDeviceHandsWithJoints chunk[5];
+	size_t count = hands_since(sender, 0, chunk, 5);
+	TEST_CHECK(count == 5);
+	uint64_t oldest_ns = time_ns(chunk[0].device_timestamp);
+	uint64_t last_ns = check_continuous(chunk, count, 0);
+	size_t total = count;
+	while(total < QAR_HAND_HISTORY_CAPACITY)
+	{
+		count = hands_since(sender, last_ns, chunk, 5);
+		TEST_CHECK(count > 0);
+		last_ns = check_continuous(chunk, count, last_ns);
+		total += count;
+	}
+	TEST_CHECK(last_ns > oldest_ns);
+
+	// A time between two samples continues with the later one.
+	uint64_t between_ns = last_ns - TEST_TRACKING_PERIOD_NS / 2;
+	count = hands_since(sender, between_ns, chunk, 1);
+	TEST_CHECK(count == 1);
+	TEST_CHECK(time_ns(chunk[0].device_timestamp) == last_ns);
+}
+
+/* Polling faster than the history wraps sees every sample once. */
+static void
+test_live_samples(QarRenderSender* sender)
+{
+	size_t count = hands_since(sender, 0, g_samples, QAR_HAND_HISTORY_CAPACITY);
+	uint64_t last_ns = check_continuous(g_samples, count, 0);
+	size_t received = 0;
+	while(received < TEST_LIVE_SAMPLES)
+	{
+		count = hands_since(
+			sender, last_ns, g_samples, QAR_HAND_HISTORY_CAPACITY
+		);
+		last_ns = check_continuous(g_samples, count, last_ns);
+		received += count;
+	}
+}
+
+static void
+test_arguments(QarRenderSender* sender)
+{
+	QarTimePoint zero = qar_time_point_default();
+	size_t count = 1;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_hands_since(sender, zero, NULL, 0, &count)
+	));
+	TEST_CHECK(count == 0);
+	TEST_CHECK_CODE(
+		qar_render_sender_hands_since(sender, zero, NULL, 1, &count),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+	TEST_CHECK_CODE(
+		qar_render_sender_hands_since(sender, zero, g_samples, 1, NULL),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = 64;
+	config.eye_height = 64;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	QarRenderSender* sender = create_sender(session);
+	test_whole_history(sender);
+	test_chunked_reads(sender);
+	test_live_samples(sender);
+	test_arguments(sender);
+	qar_render_stream_handle_destroy(sender);
+	test_close_session(runtime, session);
+	return 0;
+}
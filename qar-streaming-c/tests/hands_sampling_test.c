@@ -0,0 +1,287 @@
+/**
+ * @file hands_sampling_test.c
+ * @brief Hands sampled between, before and past the tracker samples.
+ */
+#include "test_common.h"
+
+#include <math.h>
+
+/// The loopback tracker runs at 90 Hz.
+#define TEST_TRACKING_PERIOD_NS (1000000000u / 90u)
+#define TEST_MAX_EXTRAPOLATION_NS (QAR_HAND_MAX_EXTRAPOLATION_MS * 1000000u)
+#define TEST_POSITION_TOLERANCE 1e-5f
+
+static QarDeviceHandsWithJoints g_history[QAR_HAND_HISTORY_CAPACITY];
+
+static QarRenderSender*
+create_sender(QarSession* session)
+{
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	QarRenderSender* sender = NULL;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_create(session, &init, NULL, &sender)
+	));
+	return sender;
+}
+
+static uint64_t
+time_ns(QarTimePoint time_point)
+{
+	return time_point.precision == 0 ? time_point.count * 1000000u
+									 : time_point.count;
+}
+
+static size_t
+read_history(QarRenderSender* sender)
+{
+	QarTimePoint zero = qar_time_point_default();
+	size_t count = 0;
+	QarResult result = qar_render_sender_hands_since(
+		sender, zero, g_history, QAR_HAND_HISTORY_CAPACITY, &count
+	);
+	TEST_CHECK(qar_result_is_success(result));
+	TEST_CHECK(count == QAR_HAND_HISTORY_CAPACITY);
+	return count;
+}
+
+/* The history sample taken exactly at `sample_ns`, which must still be
+ * held. */
+static QarDeviceHandsWithJoints
+sample_taken_at(QarRenderSender* sender, uint64_t sample_ns)
+{
+	QarTimePoint since = { sample_ns - 1, 1 };
+	QarDeviceHandsWithJoints sample;
+	size_t count = 0;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_hands_since(sender, since, &sample, 1, &count)
+	));
+	TEST_CHECK(count == 1);
+	TEST_CHECK(time_ns(sample.device_timestamp) == sample_ns);
+	return sample;
+}
+
+static QarDeviceHandsWithJoints
+sample_at(QarRenderSender* sender, QarTimePoint time)
+{
+	QarDeviceHandsWithJoints hands;
+	QarResult result = qar_render_sender_sample_hands_at(sender, time, &hands);
+	TEST_CHECK(qar_result_is_success(result));
+	return hands;
+}
+
+static bool
+nearly_equal(float a, float b)
+{
+	return fabsf(a - b) <= TEST_POSITION_TOLERANCE;
+}
+
+static bool
+vectors_close(QarVector3 a, QarVector3 b)
+{
+	return nearly_equal(a.x, b.x) && nearly_equal(a.y, b.y)
+		&& nearly_equal(a.z, b.z);
+}
+
+static QarVector3
+lerp(QarVector3 a, QarVector3 b, float t)
+{
+	QarVector3 result = { a.x + (b.x - a.x) * t,
+						  a.y + (b.y - a.y) * t,
+						  a.z + (b.z - a.z) * t };
+	return result;
+}
+
+/* Every joint of `hands` sits `t` of the way from `a` to `b`. */
+static void
+check_between(
+	const QarDeviceHandsWithJoints* hands,
+	const QarDeviceHandsWithJoints* a,
+	const QarDeviceHandsWithJoints* b,
+	float t
+)
+{
+	const QarHandJoints* sides[3][2] = {
+		{ &hands->left_hand, &hands->right_hand },
+		{ &a->left_hand, &a->right_hand },
+		{ &b->left_hand, &b->right_hand },
+	};
+	for(int side = 0; side < 2; ++side)
+	{
+		const QarHandJoints* hand = sides[0][side];
+		const QarHandJoints* from = sides[1][side];
+		const QarHandJoints* to = sides[2][side];
+		TEST_CHECK(vectors_close(
+			hand->pose.position,
+			lerp(from->pose.position, to->pose.position, t)
+		));
+		for(uint32_t joint = 0; joint < QAR_HAND_JOINT_COUNT; ++joint)
+		{
+			TEST_CHECK(vectors_close(
+				hand->joint_locations[joint].pose.position,
+				lerp(
+					from->joint_locations[joint].pose.position,
+					to->joint_locations[joint].pose.position,
+					t
+				)
+			));
+			TEST_CHECK(vectors_close(
+				hand->joint_velocities[joint].linear_velocity,
+				lerp(
+					from->joint_velocities[joint].linear_velocity,
+					to->joint_velocities[joint].linear_velocity,
+					t
+				)
+			));
+		}
+	}
+}
+
+/* Every joint of `hands` has moved on from `from` with its velocity for
+ * `seconds`. */
+static void
+check_extrapolated(
+	const QarDeviceHandsWithJoints* hands,
+	const QarDeviceHandsWithJoints* from,
+	float seconds
+)
+{
+	const QarHandJoints* sides[2][2] = {
+		{ &hands->left_hand, &hands->right_hand },
+		{ &from->left_hand, &from->right_hand },
+	};
+	for(int side = 0; side < 2; ++side)
+	{
+		const QarHandJoints* hand = sides[0][side];
+		const QarHandJoints* base = sides[1][side];
+		for(uint32_t joint = 0; joint < QAR_HAND_JOINT_COUNT; ++joint)
+		{
+			QarVector3 velocity =
+				base->joint_velocities[joint].linear_velocity;
+			QarVector3 moved = base->joint_locations[joint].pose.position;
+			moved.x += velocity.x * seconds;
+			moved.y += velocity.y * seconds;
+			moved.z += velocity.z * seconds;
+			TEST_CHECK(vectors_close(
+				hand->joint_locations[joint].pose.position, moved
+			));
+		}
+	}
+}
+
+/* The middle of the history stays held for about a third of a second, long
+ * enough to sample around it. */
+static void
+test_interpolation(QarRenderSender* sender)
+{
+	size_t count = read_history(sender);
+	const QarDeviceHandsWithJoints* before = &g_history[count / 2];
+	const QarDeviceHandsWithJoints* after = &g_history[count / 2 + 1];
+	uint64_t before_ns = time_ns(before->device_timestamp);
+	TEST_CHECK(
+		time_ns(after->device_timestamp) == before_ns + TEST_TRACKING_PERIOD_NS
+	);
+
+	// On a sample, that sample is returned.
+	QarTimePoint on_sample = { before_ns, 1 };
+	QarDeviceHandsWithJoints hands = sample_at(sender, on_sample);
+	TEST_CHECK(time_ns(hands.device_timestamp) == before_ns);
+	check_between(&hands, before, after, 0.0f);
+
+	static const float fractions[] = { 0.25f, 0.5f, 0.75f };
+	for(size_t index = 0; index < 3; ++index)
+	{
+		uint64_t offset_ns =
+			(uint64_t)(fractions[index] * (float)TEST_TRACKING_PERIOD_NS);
+		QarTimePoint time = { before_ns + offset_ns, 1 };
+		hands = sample_at(sender, time);
+		TEST_CHECK(time_ns(hands.device_timestamp) == before_ns + offset_ns);
+		float t = (float)offset_ns / (float)TEST_TRACKING_PERIOD_NS;
+		check_between(&hands, before, after, t);
+	}
+}
+
+/* Before the oldest sample, the oldest one held is returned unchanged. */
+static void
+test_before_history(QarRenderSender* sender)
+{
+	size_t count = read_history(sender);
+	uint64_t oldest_ns = time_ns(g_history[0].device_timestamp);
+	QarTimePoint early = { oldest_ns - TEST_TRACKING_PERIOD_NS, 1 };
+	QarDeviceHandsWithJoints hands = sample_at(sender, early);
+	uint64_t returned_ns = time_ns(hands.device_timestamp);
+	TEST_CHECK(returned_ns >= oldest_ns);
+	TEST_CHECK(returned_ns < time_ns(g_history[count - 1].device_timestamp));
+	TEST_CHECK(returned_ns % TEST_TRACKING_PERIOD_NS == 0);
+	QarDeviceHandsWithJoints oldest = sample_taken_at(sender, returned_ns);
+	check_between(&hands, &oldest, &oldest, 0.0f);
+}
+
+/* Far in the future, joints move on for QAR_HAND_MAX_EXTRAPOLATION_MS and
+ * stop there, in either time precision. */
+static void
+test_extrapolation_bound(QarRenderSender* sender)
+{
+	size_t count = read_history(sender);
+	uint64_t newest_ns = time_ns(g_history[count - 1].device_timestamp);
+	QarTimePoint nanoseconds = { newest_ns + 10000000000u, 1 };
+	QarTimePoint milliseconds = { newest_ns / 1000000u + 10000u, 0 };
+	QarTimePoint times[2] = { nanoseconds, milliseconds };
+	for(size_t index = 0; index < 2; ++index)
+	{
+		QarDeviceHandsWithJoints hands = sample_at(sender, times[index]);
+		uint64_t returned_ns = time_ns(hands.device_timestamp);
+		// The tracker may have moved on since the history was read.
+		TEST_CHECK(returned_ns >= newest_ns + TEST_MAX_EXTRAPOLATION_NS);
+		QarDeviceHandsWithJoints base =
+			sample_taken_at(sender, returned_ns - TEST_MAX_EXTRAPOLATION_NS);
+		float seconds = (float)QAR_HAND_MAX_EXTRAPOLATION_MS / 1000.0f;
+		check_extrapolated(&hands, &base, seconds);
+	}
+
+	// Within the bound, the hands describe the requested time.
+	QarTimePoint near = { newest_ns + TEST_MAX_EXTRAPOLATION_NS / 2, 1 };
+	QarDeviceHandsWithJoints hands = sample_at(sender, near);
+	TEST_CHECK(time_ns(hands.device_timestamp) == time_ns(near));
+}
+
+static void
+test_arguments(QarRenderSender* sender)
+{
+	QarDeviceHandsWithJoints hands;
+	QarTimePoint unknown = { 5, 2 };
+	TEST_CHECK_CODE(
+		qar_render_sender_sample_hands_at(sender, unknown, &hands),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+	QarTimePoint zero = qar_time_point_default();
+	TEST_CHECK_CODE(
+		qar_render_sender_sample_hands_at(sender, zero, NULL),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = 64;
+	config.eye_height = 64;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	QarRenderSender* sender = create_sender(session);
+	test_interpolation(sender);
+	test_before_history(sender);
+	test_extrapolation_bound(sender);
+	test_arguments(sender);
+	qar_render_stream_handle_destroy(sender);
+	test_close_session(runtime, session);
+	return 0;
+}
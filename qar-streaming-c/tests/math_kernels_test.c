@@ -0,0 +1,290 @@
+/**
+ * @file math_kernels_test.c
+ * @brief The batch hand transforms of qar_streaming_math.h agree with the
+ * single-pose helpers for every joint count, whichever SIMD path is built.
+ */
+#include "test_common.h"
+
+#include <qar_streaming_math.h>
+#include <string.h>
+
+/* The lanes evaluate the same expressions as the scalar helpers; only
+ * contracted multiply-adds may round differently. */
+#define TEST_TOLERANCE 1e-6f
+/// Enough joints for a full vector pass plus every tail length.
+#define TEST_MAX_JOINTS (2 * QAR_HAND_JOINT_COUNT)
+
+static uint32_t g_seed = 0x2545f491u;
+
+static float
+random_float(float low, float high)
+{
+	g_seed = g_seed * 1664525u + 1013904223u;
+	return low + (high - low) * (float)(g_seed >> 8) / (float)(1u << 24);
+}
+
+static QarVector3
+random_vector(float range)
+{
+	QarVector3 v = { random_float(-range, range),
+					 random_float(-range, range),
+					 random_float(-range, range) };
+	return v;
+}
+
+static QarQuaternion
+random_rotation(void)
+{
+	QarQuaternion q = { random_float(-1.0f, 1.0f),
+						random_float(-1.0f, 1.0f),
+						random_float(-1.0f, 1.0f),
+						random_float(-1.0f, 1.0f) };
+	return qar_quaternion_normalize(q);
+}
+
+static QarScaledPose
+random_transform(void)
+{
+	QarScaledPose transform;
+	transform.pose.orientation = random_rotation();
+	transform.pose.position = random_vector(3.0f);
+	transform.scale = random_float(0.25f, 4.0f);
+	return transform;
+}
+
+static void
+random_joints(
+	QarHandJointLocation* locations,
+	QarHandJointVelocity* velocities,
+	size_t count
+)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		locations[i].joint_id = (uint32_t)i;
+		locations[i].location_flags = QAR_POSITION_VALID_BIT | (uint64_t)i;
+		locations[i].pose.orientation = random_rotation();
+		locations[i].pose.position = random_vector(1.0f);
+		locations[i].radius = random_float(0.005f, 0.03f);
+		velocities[i].joint_id = (uint32_t)i;
+		velocities[i].flags = QAR_LINEAR_VELOCITY_VALID_BIT | (uint64_t)i;
+		velocities[i].linear_velocity = random_vector(2.0f);
+		velocities[i].angular_velocity = random_vector(6.0f);
+	}
+}
+
+static bool
+nearly_equal(float a, float b)
+{
+	float magnitude = fabsf(a) > 1.0f ? fabsf(a) : 1.0f;
+	return fabsf(a - b) <= TEST_TOLERANCE * magnitude;
+}
+
+static bool
+vectors_close(QarVector3 a, QarVector3 b)
+{
+	return nearly_equal(a.x, b.x) && nearly_equal(a.y, b.y)
+		&& nearly_equal(a.z, b.z);
+}
+
+static bool
+poses_close(QarPose a, QarPose b)
+{
+	return nearly_equal(a.orientation.x, b.orientation.x)
+		&& nearly_equal(a.orientation.y, b.orientation.y)
+		&& nearly_equal(a.orientation.z, b.orientation.z)
+		&& nearly_equal(a.orientation.w, b.orientation.w)
+		&& vectors_close(a.position, b.position);
+}
+
+static void
+check_location(
+	const QarScaledPose* transform,
+	const QarHandJointLocation* src,
+	const QarHandJointLocation* dst
+)
+{
+	QarPose expected = qar_scaled_pose_transform_pose(transform, src->pose);
+	TEST_CHECK(dst->joint_id == src->joint_id);
+	TEST_CHECK(dst->location_flags == src->location_flags);
+	TEST_CHECK(poses_close(dst->pose, expected));
+	TEST_CHECK(nearly_equal(dst->radius, src->radius * transform->scale));
+}
+
+static void
+check_velocity(
+	const QarScaledPose* transform,
+	const QarHandJointVelocity* src,
+	const QarHandJointVelocity* dst
+)
+{
+	QarQuaternion rotation = transform->pose.orientation;
+	QarVector3 linear = qar_quaternion_rotate(
+		rotation, qar_vector3_scale(src->linear_velocity, transform->scale)
+	);
+	QarVector3 angular = qar_quaternion_rotate(rotation, src->angular_velocity);
+	TEST_CHECK(dst->joint_id == src->joint_id);
+	TEST_CHECK(dst->flags == src->flags);
+	TEST_CHECK(vectors_close(dst->linear_velocity, linear));
+	TEST_CHECK(vectors_close(dst->angular_velocity, angular));
+}
+
+static bool
+locations_equal(const QarHandJointLocation* a, const QarHandJointLocation* b)
+{
+	return a->joint_id == b->joint_id && a->location_flags == b->location_flags
+		&& memcmp(&a->pose, &b->pose, sizeof(a->pose)) == 0
+		&& memcmp(&a->radius, &b->radius, sizeof(a->radius)) == 0;
+}
+
+static bool
+velocities_equal(const QarHandJointVelocity* a, const QarHandJointVelocity* b)
+{
+	const size_t size = sizeof(a->linear_velocity);
+	return a->joint_id == b->joint_id && a->flags == b->flags
+		&& memcmp(&a->linear_velocity, &b->linear_velocity, size) == 0
+		&& memcmp(&a->angular_velocity, &b->angular_velocity, size) == 0;
+}
+
+/* Every count from 0 up covers the vector loop and each tail length. The
+ * joint after the last one must not be written. */
+static void
+test_joint_counts(void)
+{
+	static QarHandJointLocation locations[TEST_MAX_JOINTS + 1];
+	static QarHandJointVelocity velocities[TEST_MAX_JOINTS + 1];
+	static QarHandJointLocation out_locations[TEST_MAX_JOINTS + 1];
+	static QarHandJointVelocity out_velocities[TEST_MAX_JOINTS + 1];
+	for(size_t count = 0; count <= TEST_MAX_JOINTS; ++count)
+	{
+		QarScaledPose transform = random_transform();
+		random_joints(locations, velocities, TEST_MAX_JOINTS + 1);
+		memset(out_locations, 0xa5, sizeof(out_locations));
+		memset(out_velocities, 0xa5, sizeof(out_velocities));
+		qar_scaled_pose_transform_joint_locations(
+			&transform, locations, out_locations, count
+		);
+		qar_scaled_pose_transform_joint_velocities(
+			&transform, velocities, out_velocities, count
+		);
+		for(size_t i = 0; i < count; ++i)
+		{
+			check_location(&transform, &locations[i], &out_locations[i]);
+			check_velocity(&transform, &velocities[i], &out_velocities[i]);
+		}
+		const uint8_t* location_guard = (const uint8_t*)&out_locations[count];
+		const uint8_t* velocity_guard = (const uint8_t*)&out_velocities[count];
+		for(size_t byte = 0; byte < sizeof(QarHandJointLocation); ++byte)
+		{
+			TEST_CHECK(location_guard[byte] == 0xa5);
+		}
+		for(size_t byte = 0; byte < sizeof(QarHandJointVelocity); ++byte)
+		{
+			TEST_CHECK(velocity_guard[byte] == 0xa5);
+		}
+
+		// In place gives exactly the out-of-place result. Structs are
+		// compared field by field as their padding is not copied.
+		qar_scaled_pose_transform_joint_locations(
+			&transform, locations, locations, count
+		);
+		qar_scaled_pose_transform_joint_velocities(
+			&transform, velocities, velocities, count
+		);
+		for(size_t i = 0; i < count; ++i)
+		{
+			TEST_CHECK(locations_equal(&locations[i], &out_locations[i]));
+			TEST_CHECK(velocities_equal(&velocities[i], &out_velocities[i]));
+		}
+	}
+}
+
+static void
+random_hand(QarHandJoints* hand, bool has_velocity)
+{
+	memset(hand, 0, sizeof(*hand));
+	hand->is_tracked = true;
+	hand->is_active = true;
+	hand->has_velocity = has_velocity;
+	hand->pose.orientation = random_rotation();
+	hand->pose.position = random_vector(1.0f);
+	random_joints(
+		hand->joint_locations, hand->joint_velocities, QAR_HAND_JOINT_COUNT
+	);
+}
+
+static void
+test_hands(void)
+{
+	QarScaledPose transform = random_transform();
+	QarDeviceHandsWithJoints hands;
+	memset(&hands, 0, sizeof(hands));
+	hands.device_timestamp.count = 42;
+	random_hand(&hands.left_hand, true);
+	random_hand(&hands.right_hand, false);
+
+	QarDeviceHandsWithJoints out;
+	memset(&out, 0, sizeof(out));
+	qar_scaled_pose_transform_hands(&transform, &hands, &out);
+	TEST_CHECK(out.device_timestamp.count == 42);
+	TEST_CHECK(poses_close(
+		out.left_hand.pose,
+		qar_scaled_pose_transform_pose(&transform, hands.left_hand.pose)
+	));
+	for(uint32_t joint = 0; joint < QAR_HAND_JOINT_COUNT; ++joint)
+	{
+		check_location(
+			&transform,
+			&hands.left_hand.joint_locations[joint],
+			&out.left_hand.joint_locations[joint]
+		);
+		check_location(
+			&transform,
+			&hands.right_hand.joint_locations[joint],
+			&out.right_hand.joint_locations[joint]
+		);
+		check_velocity(
+			&transform,
+			&hands.left_hand.joint_velocities[joint],
+			&out.left_hand.joint_velocities[joint]
+		);
+	}
+	// Velocities of a hand without them are copied untouched.
+	TEST_CHECK(!out.right_hand.has_velocity);
+	TEST_CHECK(
+		memcmp(
+			out.right_hand.joint_velocities,
+			hands.right_hand.joint_velocities,
+			sizeof(hands.right_hand.joint_velocities)
+		)
+		== 0
+	);
+
+	// Room -> app undoes app -> room.
+	QarScaledPose inverse = qar_scaled_pose_inverse(transform);
+	QarDeviceHandsWithJoints back;
+	qar_scaled_pose_transform_hands(&inverse, &out, &back);
+	for(uint32_t joint = 0; joint < QAR_HAND_JOINT_COUNT; ++joint)
+	{
+		const QarVector3 a =
+			hands.left_hand.joint_locations[joint].pose.position;
+		const QarVector3 b =
+			back.left_hand.joint_locations[joint].pose.position;
+		TEST_CHECK(fabsf(a.x - b.x) + fabsf(a.y - b.y) + fabsf(a.z - b.z)
+				   < 1e-4f);
+	}
+}
+
+int
+main(void)
+{
+#if defined(QAR_MATH_AVX) && (defined(__GNUC__) || defined(__clang__))
+	if(!__builtin_cpu_supports("avx"))
+	{
+		return TEST_SKIPPED;
+	}
+#endif
+	test_joint_counts();
+	test_hands();
+	return 0;
+}
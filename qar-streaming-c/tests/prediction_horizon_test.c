@@ -0,0 +1,149 @@
+/**
+ * @file prediction_horizon_test.c
+ * @brief Frames report the prediction horizon their poses were made for.
+ */
+#include "test_common.h"
+
+#define TEST_DISPLAY_HZ 100
+#define TEST_PERIOD_NS (1000000000u / TEST_DISPLAY_HZ)
+
+static QarRenderSender*
+create_sender(QarSession* session)
+{
+	QarRenderSenderFramesInFlightExt in_flight =
+		qar_render_sender_frames_in_flight_ext_default();
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.header.next = &in_flight.header;
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	QarRenderSender* sender = NULL;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_create(session, &init, NULL, &sender)
+	));
+	return sender;
+}
+
+static uint64_t
+time_ns(QarTimePoint time_point)
+{
+	return time_point.precision == 0 ? time_point.count * 1000000u
+									 : time_point.count;
+}
+
+static QarRenderFrameBegin
+begin_frame(QarRenderSender* sender)
+{
+	QarRenderFrameBegin frame = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(sender, NULL, &frame)
+	));
+	TEST_CHECK(
+		time_ns(frame.predicted_display_time) > time_ns(frame.pose_sample_time)
+	);
+	return frame;
+}
+
+static void
+show_frame(QarRenderSender* sender)
+{
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	QarResult result = qar_render_sender_show_frame(sender, &show);
+	TEST_CHECK(qar_result_is_success(result));
+}
+
+static uint64_t
+display_lead_ns(const QarRenderFrameBegin* frame)
+{
+	return time_ns(frame->predicted_display_time)
+		- time_ns(frame->pose_sample_time);
+}
+
+/* Two frames begun back to back: the second is displayed one refresh
+ * later. Returns the horizons both frames reported. */
+static void
+begin_two(QarRenderSender* sender, uint64_t out_horizons[2])
+{
+	QarRenderFrameBegin first = begin_frame(sender);
+	QarRenderFrameBegin second = begin_frame(sender);
+	TEST_CHECK(
+		time_ns(second.predicted_display_time)
+		== time_ns(first.predicted_display_time) + TEST_PERIOD_NS
+		   + (time_ns(second.pose_sample_time)
+			  - time_ns(first.pose_sample_time))
+	);
+	out_horizons[0] = time_ns(first.prediction_horizon);
+	out_horizons[1] = time_ns(second.prediction_horizon);
+
+	// Display times do not depend on the horizon.
+	TEST_CHECK(display_lead_ns(&first) == TEST_PERIOD_NS);
+	TEST_CHECK(display_lead_ns(&second) == 2 * TEST_PERIOD_NS);
+	show_frame(sender);
+	show_frame(sender);
+}
+
+static void
+test_horizon(QarRenderSender* sender)
+{
+	uint64_t horizons[2];
+
+	// By default poses are predicted for the display time.
+	begin_two(sender, horizons);
+	TEST_CHECK(horizons[0] == TEST_PERIOD_NS);
+	TEST_CHECK(horizons[1] == 2 * TEST_PERIOD_NS);
+
+	// A fixed horizon applies to every frame, in either precision.
+	QarTimePoint milliseconds = { 5, 0 };
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_set_prediction_horizon(sender, milliseconds)
+	));
+	begin_two(sender, horizons);
+	TEST_CHECK(horizons[0] == 5000000u && horizons[1] == 5000000u);
+
+	QarTimePoint nanoseconds = { 12345, 1 };
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_set_prediction_horizon(sender, nanoseconds)
+	));
+	begin_two(sender, horizons);
+	TEST_CHECK(horizons[0] == 12345u && horizons[1] == 12345u);
+
+	QarTimePoint unknown = { 5, 2 };
+	TEST_CHECK_CODE(
+		qar_render_sender_set_prediction_horizon(sender, unknown),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+	begin_two(sender, horizons);
+	TEST_CHECK(horizons[0] == 12345u);
+
+	// A zero horizon restores the default.
+	QarTimePoint reset = { 0, 1 };
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_set_prediction_horizon(sender, reset)
+	));
+	begin_two(sender, horizons);
+	TEST_CHECK(horizons[0] == TEST_PERIOD_NS);
+	TEST_CHECK(horizons[1] == 2 * TEST_PERIOD_NS);
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created. Unpaced, the
+	// first frame in flight is displayed one period after it was begun.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.display_hz = TEST_DISPLAY_HZ;
+	config.paced = false;
+	config.eye_width = 64;
+	config.eye_height = 64;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	QarRenderSender* sender = create_sender(session);
+	test_horizon(sender);
+	qar_render_stream_handle_destroy(sender);
+	test_close_session(runtime, session);
+	return 0;
+}
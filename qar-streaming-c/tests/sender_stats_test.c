@@ -0,0 +1,148 @@
+/**
+ * @file sender_stats_test.c
+ * @brief Render sender statistics count what the sender actually did.
+ */
+#include "test_common.h"
+
+#include <math.h>
+
+#define TEST_FRAMES 10
+
+static QarRenderSender*
+create_sender(QarSession* session, uint32_t max_frames_in_flight)
+{
+	QarRenderSenderFramesInFlightExt in_flight =
+		qar_render_sender_frames_in_flight_ext_default();
+	in_flight.max_frames_in_flight = max_frames_in_flight;
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.header.next = &in_flight.header;
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	QarRenderSender* sender = NULL;
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_create(session, &init, NULL, &sender)
+	));
+	return sender;
+}
+
+static QarRenderSenderStats
+get_stats(QarRenderSender* sender)
+{
+	QarRenderSenderStats stats = qar_render_sender_stats_default();
+	QarResult result = qar_render_sender_get_stats(sender, &stats);
+	TEST_CHECK(qar_result_is_success(result));
+	return stats;
+}
+
+static void
+begin_frame(QarRenderSender* sender)
+{
+	QarRenderFrameBegin begin = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(sender, NULL, &begin)
+	));
+}
+
+static void
+show_frame(QarRenderSender* sender)
+{
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	QarResult result = qar_render_sender_show_frame(sender, &show);
+	TEST_CHECK(qar_result_is_success(result));
+}
+
+/* Bytes of one full frame of the sender's layout. */
+static uint64_t
+frame_bytes(QarRenderSender* sender)
+{
+	QarVideoFrameLayout layout = qar_video_frame_layout_default();
+	TEST_CHECK(
+		qar_result_is_success(qar_render_sender_layout(sender, &layout))
+	);
+	uint64_t bytes = 0;
+	for(size_t index = 0; index < layout.views_count; ++index)
+	{
+		const QarVideoFrameView* view = &layout.views[index];
+		uint64_t width = view->end_x > view->start_x
+			? view->end_x - view->start_x
+			: view->start_x - view->end_x;
+		uint64_t height = view->end_y > view->start_y
+			? view->end_y - view->start_y
+			: view->start_y - view->end_y;
+		bytes += width * height * qar_pixel_format_size(view->texture_format);
+	}
+	return bytes;
+}
+
+static void
+test_counters(QarSession* session)
+{
+	QarRenderSender* sender = create_sender(session, 2);
+	uint64_t bytes = frame_bytes(sender);
+
+	QarRenderSenderStats stats = get_stats(sender);
+	TEST_CHECK(stats.frames_shown == 0 && stats.frames_sent == 0);
+	TEST_CHECK(stats.frames_dropped == 0 && stats.bytes_sent == 0);
+	TEST_CHECK(stats.queue_depth == 0);
+	TEST_CHECK(stats.upstream_fps == 0.0f && stats.encode_time_ms == 0.0f);
+	TEST_CHECK(stats.resolution_scale == 1.0f);
+
+	// Begun frames are queued until they are shown.
+	begin_frame(sender);
+	TEST_CHECK(get_stats(sender).queue_depth == 1);
+	begin_frame(sender);
+	TEST_CHECK(get_stats(sender).queue_depth == 2);
+	show_frame(sender);
+	stats = get_stats(sender);
+	TEST_CHECK(stats.queue_depth == 1);
+	TEST_CHECK(stats.frames_shown == 1 && stats.frames_sent == 1);
+	TEST_CHECK(stats.bytes_sent == bytes);
+	// One frame has no interval yet.
+	TEST_CHECK(stats.upstream_fps == 0.0f && stats.jitter_ms == 0.0f);
+	show_frame(sender);
+
+	for(int frame = 2; frame < TEST_FRAMES; ++frame)
+	{
+		begin_frame(sender);
+		show_frame(sender);
+	}
+	stats = get_stats(sender);
+	TEST_CHECK(stats.frames_shown == TEST_FRAMES);
+	TEST_CHECK(stats.frames_sent == TEST_FRAMES);
+	TEST_CHECK(stats.frames_dropped == 0);
+	TEST_CHECK(stats.bytes_sent == bytes * TEST_FRAMES);
+	TEST_CHECK(stats.queue_depth == 0);
+	TEST_CHECK(stats.upstream_fps > 0.0f && isfinite(stats.upstream_fps));
+	TEST_CHECK(stats.downstream_fps == stats.upstream_fps);
+	TEST_CHECK(stats.encode_time_ms >= 0.0f);
+	TEST_CHECK(stats.latency_ms >= stats.encode_time_ms);
+	TEST_CHECK(stats.jitter_ms >= 0.0f && isfinite(stats.jitter_ms));
+	TEST_CHECK(stats.pose_to_photon_ms > 0.0f);
+
+	QarRenderSenderStats wrong = qar_render_sender_stats_default();
+	wrong.header.type = QAR_STRUCTURE_TYPE_RENDERING_END_FRAME;
+	TEST_CHECK_CODE(
+		qar_render_sender_get_stats(sender, &wrong),
+		QAR_STATUS_ARGUMENT_NOT_SUPPORTED
+	);
+	qar_render_stream_handle_destroy(sender);
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = 64;
+	config.eye_height = 64;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	test_counters(session);
+	test_close_session(runtime, session);
+	return 0;
+}
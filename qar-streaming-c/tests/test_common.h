@@ -0,0 +1,67 @@
+#pragma once
+#include <qar_loopback.h>
+#include <qar_streaming.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static inline void
+test_fail(const char* file, int line, const char* expression)
+{
+	fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+	exit(1);
+}
+
+/** \brief Fail the test with the location and expression when \p cond is
+ *  false. */
+#define TEST_CHECK(cond)                                                       \
+	do                                                                         \
+	{                                                                          \
+		if(!(cond))                                                            \
+		{                                                                      \
+			test_fail(__FILE__, __LINE__, #cond);                              \
+		}                                                                      \
+	} while(0)
+
+/** \brief Exit code of a test that cannot run on this machine, e.g. for
+ *  lack of an instruction set; registered as the tests' SKIP_RETURN_CODE. */
+#define TEST_SKIPPED 77
+
+/** \brief Fail the test when \p result does not carry \p code. */
+#define TEST_CHECK_CODE(result, code)                                         \
+	TEST_CHECK(qar_result_has_code((result), (code)))
+
+/** \brief Initialize the loopback runtime and onboard a fresh session. */
+static inline QarSession*
+test_open_session(QarRuntime** out_runtime)
+{
+	QarLibraryInit library_init = qar_library_init_default();
+	TEST_CHECK(qar_result_is_success(qar_library_init(&library_init)));
+
+	QarRuntimeInit runtime_init = qar_runtime_init_default();
+	TEST_CHECK(
+		qar_result_is_success(qar_runtime_create(&runtime_init, out_runtime))
+	);
+
+	QarOnboardInit onboard_init = qar_onboard_init_default();
+	QarOnboardCodeExt onboard_code = qar_onboard_code_ext_default();
+	onboard_init.presentation.display_name = "qar_test";
+	onboard_code.code = "123456";
+	onboard_init.header.next = &onboard_code.header;
+
+	QarOnboardingId onboarding_id = qar_onboarding_id_default();
+	QarSession* session = NULL;
+	TEST_CHECK(qar_result_is_success(qar_runtime_onboard(
+		*out_runtime, &onboard_init, NULL, NULL, NULL, &onboarding_id, &session
+	)));
+	TEST_CHECK(session != NULL);
+	return session;
+}
+
+/** \brief Release everything test_open_session created. */
+static inline void
+test_close_session(QarRuntime* runtime, QarSession* session)
+{
+	qar_session_handle_destroy(session);
+	qar_runtime_destroy(runtime);
+	qar_library_destroy();
+}
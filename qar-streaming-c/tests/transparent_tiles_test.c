@@ -0,0 +1,243 @@
+/**
+ * @file transparent_tiles_test.c
+ * @brief Fully transparent tiles of color views are not sent.
+ */
+#include "test_common.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* Neither is a multiple of the tile size, so the last tile column and row
+ * are partial. */
+#define TEST_EYE_WIDTH 80
+#define TEST_EYE_HEIGHT 48
+#define TEST_PIXEL_SIZE 4
+#define TEST_POOL_BYTES ((size_t)1 << 20)
+
+_Alignas(QAR_CPU_BUFFER_ALIGNMENT) static uint8_t g_pool[TEST_POOL_BYTES];
+
+typedef struct TestSender
+{
+	QarRenderSender* sender;
+	QarVideoFrameLayout layout;
+	QarRenderSenderCpuBufferRing ring;
+	uint64_t bytes_sent;
+} TestSender;
+
+static uint64_t
+view_pixels(const QarVideoFrameView* view)
+{
+	uint64_t width = view->end_x > view->start_x ? view->end_x - view->start_x
+												 : view->start_x - view->end_x;
+	uint64_t height = view->end_y > view->start_y
+		? view->end_y - view->start_y
+		: view->start_y - view->end_y;
+	return width * height;
+}
+
+/* Bytes of all views of `type` when sent in full. */
+static uint64_t
+full_bytes(const TestSender* test, QarVideoFrameViewType type)
+{
+	uint64_t bytes = 0;
+	for(size_t index = 0; index < test->layout.views_count; ++index)
+	{
+		const QarVideoFrameView* view = &test->layout.views[index];
+		if(view->data_type == type)
+		{
+			bytes += view_pixels(view)
+				* qar_pixel_format_size(view->texture_format);
+		}
+	}
+	return bytes;
+}
+
+/* A sender rendering into a one-slot ring carved out of g_pool. */
+static void
+create_sender(QarSession* session, bool skip_tiles, TestSender* out_test)
+{
+	memset(out_test, 0, sizeof(*out_test));
+	QarRenderSenderTransparentTilesExt tiles =
+		qar_render_sender_transparent_tiles_ext_default();
+	QarRenderSenderInit init = qar_render_sender_init_default();
+	init.header.next = skip_tiles ? &tiles.header : NULL;
+	init.graphics_api = QAR_GRAPHICS_API_CPU;
+	TEST_CHECK(qar_result_is_success(
+		qar_loopback_add_peer(session, "receiver", &init.peer_id)
+	));
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_create(session, &init, NULL, &out_test->sender)
+	));
+
+	out_test->layout = qar_video_frame_layout_default();
+	QarResult layout_result =
+		qar_render_sender_layout(out_test->sender, &out_test->layout);
+	TEST_CHECK(qar_result_is_success(layout_result));
+	QarRenderSenderCpuBufferRing* ring = &out_test->ring;
+	*ring = qar_render_sender_cpu_buffer_ring_default();
+	ring->slot_count = 1;
+	ring->textures_count = out_test->layout.textures_count;
+	size_t offset = 0;
+	for(size_t index = 0; index < ring->textures_count; ++index)
+	{
+		const QarTextureSize* size = &out_test->layout.textures[index];
+		uint32_t pitch = size->width * qar_pixel_format_size(size->format);
+		size_t bytes = (size_t)pitch * size->height * size->array_layers;
+		TEST_CHECK(offset + bytes <= TEST_POOL_BYTES);
+		QarVideoTextureCpu* texture = &ring->slots[0][index];
+		texture->size = *size;
+		texture->pitch = pitch;
+		texture->texture_data = g_pool + offset;
+		texture->texture_data_size = bytes;
+		offset += (bytes + QAR_CPU_BUFFER_ALIGNMENT - 1)
+			/ QAR_CPU_BUFFER_ALIGNMENT * QAR_CPU_BUFFER_ALIGNMENT;
+	}
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_register_cpu_buffers(out_test->sender, ring)
+	));
+	memset(g_pool, 0, sizeof(g_pool));
+}
+
+/* Pointer to pixel (x, y) of view `view_index`. */
+static uint8_t*
+view_pixel(const TestSender* test, size_t view_index, uint32_t x, uint32_t y)
+{
+	const QarVideoFrameView* view = &test->layout.views[view_index];
+	const QarVideoTextureCpu* texture =
+		&test->ring.slots[0][view->texture_index];
+	uint32_t left = view->start_x < view->end_x ? view->start_x : view->end_x;
+	uint32_t top = view->start_y < view->end_y ? view->start_y : view->end_y;
+	size_t row = (size_t)view->array_layer_index * texture->size.height
+		+ top + y;
+	return texture->texture_data + row * texture->pitch
+		+ (size_t)(left + x) * TEST_PIXEL_SIZE;
+}
+
+/* Shows the ring slot and returns the bytes the frame cost. */
+static uint64_t
+send_frame(TestSender* test, const QarRenderFrameShowOccupancyExt* occupancy)
+{
+	QarVideoFrameCpu frame = qar_video_frame_cpu_default();
+	uint32_t buffer_index = 0;
+	TEST_CHECK(qar_result_is_success(qar_render_sender_acquire_cpu_buffer(
+		test->sender, NULL, &frame, &buffer_index
+	)));
+	QarRenderFrameBegin begin = qar_render_frame_begin_default();
+	TEST_CHECK(qar_result_is_success(
+		qar_render_sender_begin_frame_ex(test->sender, NULL, &begin)
+	));
+	QarRenderFrameShowCpuBufferExt buffer =
+		qar_render_frame_show_cpu_buffer_ext_default();
+	buffer.buffer_index = buffer_index;
+	buffer.header.next = (void*)occupancy;
+	QarRenderFrameShow show = qar_render_frame_show_default();
+	show.header.next = &buffer.header;
+	QarResult show_result = qar_render_sender_show_frame(test->sender, &show);
+	TEST_CHECK(qar_result_is_success(show_result));
+
+	QarRenderSenderStats stats = qar_render_sender_stats_default();
+	QarResult stats_result = qar_render_sender_get_stats(test->sender, &stats);
+	TEST_CHECK(qar_result_is_success(stats_result));
+	uint64_t bytes = stats.bytes_sent - test->bytes_sent;
+	test->bytes_sent = stats.bytes_sent;
+	return bytes;
+}
+
+static size_t
+first_color_view(const TestSender* test)
+{
+	for(size_t index = 0; index < test->layout.views_count; ++index)
+	{
+		if(test->layout.views[index].data_type
+		   == QAR_VIDEO_FRAME_VIEW_TYPE_COLOR)
+		{
+			return index;
+		}
+	}
+	TEST_CHECK(false);
+	return 0;
+}
+
+/* Only tiles with a non-zero alpha somewhere are sent; color without
+ * alpha does not count, and partial edge tiles cost their real size. */
+static void
+test_skips_transparent_tiles(QarSession* session)
+{
+	TestSender test;
+	create_sender(session, true, &test);
+	uint64_t depth = full_bytes(&test, QAR_VIDEO_FRAME_VIEW_TYPE_DEPTH);
+	TEST_CHECK(test.layout.views[first_color_view(&test)].texture_format
+			   == QAR_PIXEL_FORMAT_B8G8R8A8);
+
+	TEST_CHECK(send_frame(&test, NULL) == depth);
+
+	// Color with zero alpha is still transparent.
+	size_t view = first_color_view(&test);
+	uint8_t* pixel = view_pixel(&test, view, 5, 5);
+	pixel[0] = pixel[1] = pixel[2] = 0xff;
+	TEST_CHECK(send_frame(&test, NULL) == depth);
+
+	// One opaque pixel in the bottom right tile, which is 16 x 16 here.
+	view_pixel(&test, view, TEST_EYE_WIDTH - 1, TEST_EYE_HEIGHT - 1)[3] = 1;
+	uint32_t tile = QAR_OCCUPANCY_TILE_SIZE;
+	uint64_t edge_tile = (uint64_t)(TEST_EYE_WIDTH % tile)
+		* (TEST_EYE_HEIGHT % tile) * TEST_PIXEL_SIZE;
+	TEST_CHECK(send_frame(&test, NULL) == depth + edge_tile);
+
+	// A full interior tile.
+	view_pixel(&test, view, tile, 0)[3] = 0x80;
+	TEST_CHECK(
+		send_frame(&test, NULL)
+		== depth + edge_tile + (uint64_t)tile * tile * TEST_PIXEL_SIZE
+	);
+	qar_render_stream_handle_destroy(test.sender);
+}
+
+/* Without the extension everything is sent, unless the frame brings its own
+ * occupancy masks. */
+static void
+test_occupancy_without_extension(QarSession* session)
+{
+	TestSender test;
+	create_sender(session, false, &test);
+	uint64_t depth = full_bytes(&test, QAR_VIDEO_FRAME_VIEW_TYPE_DEPTH);
+	uint64_t color = full_bytes(&test, QAR_VIDEO_FRAME_VIEW_TYPE_COLOR);
+	TEST_CHECK(send_frame(&test, NULL) == depth + color);
+
+	// Only the top left tile of the first color view is marked occupied;
+	// the other views have no mask and are sent in full.
+	size_t view = first_color_view(&test);
+	uint32_t tile = QAR_OCCUPANCY_TILE_SIZE;
+	uint8_t mask[((TEST_EYE_WIDTH + QAR_OCCUPANCY_TILE_SIZE - 1)
+				  / QAR_OCCUPANCY_TILE_SIZE)
+				 * ((TEST_EYE_HEIGHT + QAR_OCCUPANCY_TILE_SIZE - 1)
+					/ QAR_OCCUPANCY_TILE_SIZE)] = { 1 };
+	QarRenderFrameShowOccupancyExt occupancy =
+		qar_render_frame_show_occupancy_ext_default();
+	occupancy.view_tile_masks[view] = mask;
+	uint64_t view_bytes =
+		view_pixels(&test.layout.views[view]) * TEST_PIXEL_SIZE;
+	TEST_CHECK(
+		send_frame(&test, &occupancy)
+		== depth + color - view_bytes + (uint64_t)tile * tile * TEST_PIXEL_SIZE
+	);
+	qar_render_stream_handle_destroy(test.sender);
+}
+
+int
+main(void)
+{
+	// Sessions copy the configuration when they are created.
+	QarLoopbackConfig config = qar_loopback_config_default();
+	config.eye_width = TEST_EYE_WIDTH;
+	config.eye_height = TEST_EYE_HEIGHT;
+	config.gesture_interval_ms = 0;
+	TEST_CHECK(qar_result_is_success(qar_loopback_configure(&config)));
+
+	QarRuntime* runtime = NULL;
+	QarSession* session = test_open_session(&runtime);
+	test_skips_transparent_tiles(session);
+	test_occupancy_without_extension(session);
+	test_close_session(runtime, session);
+	return 0;
+}